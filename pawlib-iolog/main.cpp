@@ -0,0 +1,179 @@
+/** PawLIB IOLog
+  * Version: 1.0
+  *
+  * Reads binary logs written by IOBinarySink, and prints them as text or
+  * JSON, optionally filtered by verbosity and category.
+  *
+  * Author(s): Jason C. McDonald
+  */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2019 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "pawlib/iobinary.hpp"
+#include "pawlib/iochannel.hpp"
+
+namespace
+{
+    void usage()
+    {
+        ioc << "Usage: pawlib-iolog [--json] [--vrb=LEVEL] [--cat=CATS] FILE...\n"
+            << "  --json       Print one JSON object per message.\n"
+            << "  --vrb=LEVEL  Show messages up to quiet, normal, chatty, or tmi.\n"
+            << "  --cat=CATS   Show only the categories in a comma-separated list\n"
+            << "               of normal, warning, error, debug, and testing."
+            << IOCtrl::endl;
+    }
+
+    bool parse_vrb(std::string_view name, IOVrb& vrb)
+    {
+        if(name == "quiet"){vrb = IOVrb::quiet;}
+        else if(name == "normal"){vrb = IOVrb::normal;}
+        else if(name == "chatty"){vrb = IOVrb::chatty;}
+        else if(name == "tmi"){vrb = IOVrb::tmi;}
+        else{return false;}
+        return true;
+    }
+
+    bool parse_cats(std::string_view names, IOCat& cats)
+    {
+        int mask = 0;
+        while(!names.empty())
+        {
+            size_t comma = names.find(',');
+            std::string_view name = names.substr(0, comma);
+            if(name == "normal"){mask |= static_cast<int>(IOCat::normal);}
+            else if(name == "warning"){mask |= static_cast<int>(IOCat::warning);}
+            else if(name == "error"){mask |= static_cast<int>(IOCat::error);}
+            else if(name == "debug"){mask |= static_cast<int>(IOCat::debug);}
+            else if(name == "testing"){mask |= static_cast<int>(IOCat::testing);}
+            else{return false;}
+            names.remove_prefix((comma == std::string_view::npos) ? names.size() : comma + 1);
+        }
+        cats = static_cast<IOCat>(mask);
+        return mask != 0;
+    }
+
+    bool load(const char* path, std::string& data)
+    {
+        FILE* file = fopen(path, "rb");
+        if(file == nullptr){return false;}
+        char chunk[65536];
+        size_t got;
+        while((got = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        {
+            data.append(chunk, got);
+        }
+        bool ok = !ferror(file);
+        fclose(file);
+        return ok;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    ioc.configure_echo(IOEchoMode::printf);
+
+    bool json = false;
+    IOVrb vrb = IOVrb::tmi;
+    IOCat cats = IOCat::all;
+    int first_file = argc;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        if(arg == "--json"){json = true;}
+        else if(arg.substr(0, 6) == "--vrb=" && parse_vrb(arg.substr(6), vrb)){}
+        else if(arg.substr(0, 6) == "--cat=" && parse_cats(arg.substr(6), cats)){}
+        else if(arg.substr(0, 2) == "--")
+        {
+            usage();
+            return 2;
+        }
+        else
+        {
+            first_file = i;
+            break;
+        }
+    }
+    if(first_file == argc)
+    {
+        usage();
+        return 2;
+    }
+
+    int r = 0;
+    std::string out;
+    for(int i = first_file; i < argc; ++i)
+    {
+        std::string data;
+        if(!load(argv[i], data))
+        {
+            ioc << IOCat::error << "pawlib-iolog: Cannot read " << argv[i] << IOCtrl::endl;
+            r = 1;
+            continue;
+        }
+
+        IOBinaryReader reader(data, vrb, cats);
+        IOBinaryRecord rec;
+        while(reader.next(rec))
+        {
+            if(json){IOBinaryReader::render_json(rec, out);}
+            else{IOBinaryReader::render_text(rec, out);}
+
+            // Print in large pieces, rather than a line at a time.
+            if(out.size() >= 65536)
+            {
+                fwrite(out.data(), 1, out.size(), stdout);
+                out.clear();
+            }
+        }
+        fwrite(out.data(), 1, out.size(), stdout);
+        out.clear();
+
+        if(reader.failed())
+        {
+            ioc << IOCat::error << "pawlib-iolog: " << argv[i]
+                << " is not a binary log, or is damaged." << IOCtrl::endl;
+            r = 1;
+        }
+    }
+    fflush(stdout);
+    return r;
+}
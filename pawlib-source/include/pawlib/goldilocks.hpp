@@ -58,6 +58,8 @@
 #include <memory>
 // std::map (we will use this here)
 #include <map>
+// std::ostream and std::ofstream (for benchmark reports)
+#include <fstream>
 // std::vector (we will use this here)
 #include <vector>
 
@@ -311,6 +313,118 @@ public:
      * \return true if the suite ran successfully, else false */
     bool run_suite(testsuitename_t);
 
+    /**The BenchmarkResult struct stores all of the statistical data
+     * from a single test benchmark. Having this struct makes our
+     * code more efficient, and allows us to write standard
+     * functions for calculating results and comparisons, and
+     * outputting everything.*/
+    struct BenchmarkResult
+    {
+        /// The accumulated count.
+        // cppcheck-suppress unusedStructMember
+        uint64_t acc = 0;
+
+        /// The adjusted accumulated count.
+        // cppcheck-suppress unusedStructMember
+        uint64_t acc_adj = 0;
+
+        /// The number of repetitions (size).
+        // cppcheck-suppress unusedStructMember
+        uint64_t repeat = 0;
+
+        /// The average (mean).
+        // cppcheck-suppress unusedStructMember
+        uint64_t mean = 0;
+
+        /// The adjusted average (mean).
+        // cppcheck-suppress unusedStructMember
+        uint64_t mean_adj = 0;
+
+        /// The median value.
+        // cppcheck-suppress unusedStructMember
+        uint64_t median = 0;
+
+        /// The lower quartile value.
+        // cppcheck-suppress unusedStructMember
+        uint64_t q1 = 0;
+
+        /// The upper quartile value.
+        // cppcheck-suppress unusedStructMember
+        uint64_t q3 = 0;
+
+        /// The range.
+        // cppcheck-suppress unusedStructMember
+        uint64_t range = 0;
+
+        /// The adjusted range.
+        // cppcheck-suppress unusedStructMember
+        uint64_t range_adj = 0;
+
+        /// The minimum value.
+        // cppcheck-suppress unusedStructMember
+        uint64_t min_val = 0;
+
+        /// The minimum non-outlier value.
+        // cppcheck-suppress unusedStructMember
+        uint64_t min_adj_val = 0;
+
+        /// The maximum value.
+        // cppcheck-suppress unusedStructMember
+        uint64_t max_val = 0;
+
+        /// The maximum non-outlier value.
+        // cppcheck-suppress unusedStructMember
+        uint64_t max_adj_val = 0;
+
+        /// Lower inner fence value.
+        // cppcheck-suppress unusedStructMember
+        uint64_t lif = 0;
+
+        /// Lower outer fence value
+        // cppcheck-suppress unusedStructMember
+        uint64_t lof = 0;
+
+        /// Upper inner fence value.
+        // cppcheck-suppress unusedStructMember
+        uint64_t uif = 0;
+
+        /// Upper outer fence value.
+        // cppcheck-suppress unusedStructMember
+        uint64_t uof = 0;
+
+        /// The number of low minor outliers
+        // cppcheck-suppress unusedStructMember
+        uint64_t low_out_minor = 0;
+
+        /// The number of low major outliers
+        // cppcheck-suppress unusedStructMember
+        uint64_t low_out_major = 0;
+
+        /// The number of upper minor outliers
+        // cppcheck-suppress unusedStructMember
+        uint64_t upp_out_minor = 0;
+
+        /// The number of upper major outliers
+        // cppcheck-suppress unusedStructMember
+        uint64_t upp_out_major = 0;
+
+        /// The standard deviance
+        // cppcheck-suppress unusedStructMember
+        double std_dev = 0;
+
+        /// The adjusted standard deviance
+        // cppcheck-suppress unusedStructMember
+        double std_dev_adj = 0;
+
+        /// The relative standard deviation (coefficient of variation)
+        // cppcheck-suppress unusedStructMember
+        uint8_t rsd = 0;
+
+        /// The adjusted relative standard deviation
+        // cppcheck-suppress unusedStructMember
+        uint8_t rsd_adj = 0;
+    };
+
     /**Measure the approximate number of CPU cycles that a particular
      * test takes to run.
      *
@@ -355,6 +469,19 @@ public:
     bool run_compare(testname_t, testname_t, unsigned int = 100,
                         bool = true, bool = true);
 
+    /**Measure the approximate number of CPU cycles that a test takes to
+     * run, without printing anything, and store the statistics. This is
+     * intended for automated benchmark sweeps, whose results are collected
+     * with a BenchmarkReport rather than read by a person.
+     *
+     * The test does not need to be registered with the TestManager.
+     * \param the test to measure
+     * \param the BenchmarkResult instance to write to
+     * \param the number of times to run the test (10 - 10,000, default 100)
+     * \return true if the test ran successfully, else false
+     */
+    bool measure(Test*, BenchmarkResult&, unsigned int = 100);
+
     // INTERACTIVE SYSTEM
 
     /**Interactively (confirm before start) load all suites.
@@ -434,118 +561,6 @@ protected:
     bool run_compare(Test*, Test*, unsigned int = 100, bool = true,
                         bool = true);
 
-    /**The BenchmarkResult struct stores all of the statistical data
-     * from a single test benchmark. Having this struct makes our
-     * code more efficient, and allows us to write standard
-     * functions for calculating results and comparisons, and
-     * outputting everything.*/
-    struct BenchmarkResult
-    {
-        /// The accumulated count.
-        // cppcheck-suppress unusedStructMember
-        uint64_t acc = 0;
-
-        /// The adjusted accumulated count.
-        // cppcheck-suppress unusedStructMember
-        uint64_t acc_adj = 0;
-
-        /// The number of repetitions (size).
-        // cppcheck-suppress unusedStructMember
-        uint64_t repeat = 0;
-
-        /// The average (mean).
-        // cppcheck-suppress unusedStructMember
-        uint64_t mean = 0;
-
-        /// The adjusted average (mean).
-        // cppcheck-suppress unusedStructMember
-        uint64_t mean_adj = 0;
-
-        /// The median value.
-        // cppcheck-suppress unusedStructMember
-        uint64_t median = 0;
-
-        /// The lower quartile value.
-        // cppcheck-suppress unusedStructMember
-        uint64_t q1 = 0;
-
-        /// The upper quartile value.
-        // cppcheck-suppress unusedStructMember
-        uint64_t q3 = 0;
-
-        /// The range.
-        // cppcheck-suppress unusedStructMember
-        uint64_t range = 0;
-
-        /// The adjusted range.
-        // cppcheck-suppress unusedStructMember
-        uint64_t range_adj = 0;
-
-        /// The minimum value.
-        // cppcheck-suppress unusedStructMember
-        uint64_t min_val = 0;
-
-        /// The minimum non-outlier value.
-        // cppcheck-suppress unusedStructMember
-        uint64_t min_adj_val = 0;
-
-        /// The maximum value.
-        // cppcheck-suppress unusedStructMember
-        uint64_t max_val = 0;
-
-        /// The maximum non-outlier value.
-        // cppcheck-suppress unusedStructMember
-        uint64_t max_adj_val = 0;
-
-        /// Lower inner fence value.
-        // cppcheck-suppress unusedStructMember
-        uint64_t lif = 0;
-
-        /// Lower outer fence value
-        // cppcheck-suppress unusedStructMember
-        uint64_t lof = 0;
-
-        /// Upper inner fence value.
-        // cppcheck-suppress unusedStructMember
-        uint64_t uif = 0;
-
-        /// Upper outer fence value.
-        // cppcheck-suppress unusedStructMember
-        uint64_t uof = 0;
-
-        /// The number of low minor outliers
-        // cppcheck-suppress unusedStructMember
-        uint64_t low_out_minor = 0;
-
-        /// The number of low major outliers
-        // cppcheck-suppress unusedStructMember
-        uint64_t low_out_major = 0;
-
-        /// The number of upper minor outliers
-        // cppcheck-suppress unusedStructMember
-        uint64_t upp_out_minor = 0;
-
-        /// The number of upper major outliers
-        // cppcheck-suppress unusedStructMember
-        uint64_t upp_out_major = 0;
-
-        /// The standard deviance
-        // cppcheck-suppress unusedStructMember
-        double std_dev = 0;
-
-        /// The adjusted standard deviance
-        // cppcheck-suppress unusedStructMember
-        double std_dev_adj = 0;
-
-        /// The relative standard deviation (coefficient of variation)
-        // cppcheck-suppress unusedStructMember
-        uint8_t rsd = 0;
-
-        /// The adjusted relative standard deviation
-        // cppcheck-suppress unusedStructMember
-        uint8_t rsd_adj = 0;
-    };
-
     /**Convert a raw array of clock measurements into a complete
      * benchmark result. This does all of our statistical computations.
      * \param the BenchmarkResult instance to write to
@@ -613,4 +628,65 @@ protected:
         * registration should be on-demand and front-loaded (all at once).*/
 };
 
+/**BenchmarkReport collects the results of many benchmarks, each labeled
+ * with a set of user-defined columns (such as algorithm, data type, and
+ * input size), and writes them out in a machine-readable format. This is
+ * useful for comparing whole families of tests, and for catching
+ * performance regressions between releases.*/
+class BenchmarkReport
+{
+public:
+    /// The output formats a report can be written in.
+    enum class Format
+    {
+        /// Comma-separated values, with a header row.
+        csv,
+        /// A JSON array of objects, one per result.
+        json
+    };
+
+    /**Create a new, empty report.
+     * \param the names of the label columns for every result */
+    explicit BenchmarkReport(const std::vector<testdoc_t>& columns)
+    : columns(columns), rows()
+    {}
+
+    /**Add a result to the report.
+     * \param the labels for the result, one per column
+     * \param the result to add */
+    void add(const std::vector<testdoc_t>&,
+             const TestManager::BenchmarkResult&);
+
+    /**Get the number of results in the report.
+     * \return the number of results */
+    size_t size() const { return rows.size(); }
+
+    /**Write the report to an output stream.
+     * \param the stream to write to
+     * \param the format to write in */
+    void write(std::ostream&, Format) const;
+
+    /**Write the report to a file, replacing its contents.
+     * \param the path to the file
+     * \param the format to write in
+     * \return true if the file was written, else false */
+    bool write(const std::string&, Format) const;
+
+    ~BenchmarkReport() {}
+
+private:
+    /// A single labeled result.
+    struct Row
+    {
+        std::vector<testdoc_t> labels;
+        TestManager::BenchmarkResult result;
+    };
+
+    /// The names of the label columns.
+    std::vector<testdoc_t> columns;
+
+    /// The results, in the order they were added.
+    std::vector<Row> rows;
+};
+
 #endif // PAWLIB_GOLDILOCKS_HPP
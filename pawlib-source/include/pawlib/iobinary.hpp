@@ -0,0 +1,243 @@
+/** IOBinary [PawLIB]
+  * Version: 0.1
+  *
+  * A compact binary log format for IOChannel. IOBinarySink writes each
+  * log() call as a reference to its format string and its arguments, in
+  * variable-length integers, without formatting anything. The static text
+  * of each format string is written once per file, in a string table.
+  * IOBinaryReader turns such a file back into text or JSON.
+  *
+  * Author(s): Jason C. McDonald
+  */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2019 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+
+#ifndef PAWLIB_IOBINARY_HPP
+#define PAWLIB_IOBINARY_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "pawlib/iochannel.hpp"
+#include "pawlib/iofmt.hpp"
+#include "pawlib/iosink.hpp"
+
+/* FILE FORMAT
+ * A file is one or more sessions. Each starts with the eight bytes
+ * "PAWLOG1\n" and a varint of the time it began, in microseconds since
+ * the Unix epoch, and resets the string table. After that come records,
+ * each starting with a byte for its kind:
+ * - IOBinaryTag::define: a varint id, then a varint length and the text
+ *   of a format string. Ids count up from 0 in each session.
+ * - IOBinaryTag::log: a tags byte (verbosity << 5 | category), a zigzag
+ *   varint of the microseconds since the last record or the session's
+ *   start, a varint format string id, and then each argument as an
+ *   IOArgType byte and its value. Integers are varints, signed ones
+ *   zigzagged; floats are their raw bytes, with long doubles narrowed
+ *   to doubles; text is a varint length and the bytes; bools and chars
+ *   are one byte.
+ * - IOBinaryTag::text: a tags byte, a zigzag varint time, and a varint
+ *   length and the bytes of a message sent without log().
+ * Varints are little-endian base 128, with the high bit set on every byte
+ * but the last.
+ */
+
+/// The kinds of record in a binary log.
+enum class IOBinaryTag : uint8_t
+{
+    define = 1,
+    log = 2,
+    text = 3
+};
+
+/**A log file in the binary format, which is usually much smaller than
+ * the text, and is far cheaper to write, as log() messages it gets are
+ * never formatted. It takes every message from the channel's
+ * signal_record. It rotates like IOFileSink, and each file starts a new
+ * session, so it can be read on its own.
+ */
+class IOBinarySink : public IOFileSink
+{
+    public:
+        /// The bytes that start each session.
+        static constexpr std::string_view MAGIC = std::string_view("PAWLOG1\n", 8);
+
+        /** Open a file for appending, creating it if needed, and start a
+             * session. Throws std::runtime_error if it can't be opened.
+             * \param the path of the file
+             * \param the number of bytes to gather before writing */
+        explicit IOBinarySink(const std::string& path, size_t buffer = 64 * 1024);
+
+        ~IOBinarySink() override;
+
+    protected:
+        void hook(iochannel&, IOVrb, IOCat) override;
+        void unhook(iochannel&) override;
+
+        /** Write a text record, as normal verbosity and category, for a
+             * message passed to write(). */
+        void store(std::string_view) override;
+
+        void started() override;
+
+    private:
+        /** Write a record for a message, rotating first if it's due.
+             * Called with the lock held.
+             * \param the message, packed if there is a format string
+             * \param the message verbosity
+             * \param the message category
+             * \param the format string, or null for text */
+        void record(std::string_view, IOVrb, IOCat, const IOFormatString*);
+
+        /** Encode a record, and any string table entry it needs, into
+             * the record buffer.
+             * \return false if the packed arguments were malformed */
+        bool encode(std::string_view, IOVrb, IOCat, const IOFormatString*);
+
+        // The sink's callback in the channel's signal_record.
+        iochannel::IOSignalRecord::Handle record_handle;
+        // The ids of the format strings seen this session.
+        std::unordered_map<const IOFormatString*, uint64_t> ids;
+        // The last format string seen, which is usually seen again next.
+        const IOFormatString* last_format = nullptr;
+        // The id of the last format string.
+        uint64_t last_id = 0;
+        // The record being encoded.
+        std::string encoded;
+        // The time of the last record, in microseconds since the epoch.
+        int64_t last_time = 0;
+};
+
+/// A message read back from a binary log.
+struct IOBinaryRecord
+{
+    /// When the message was recorded, in microseconds since the Unix epoch
+    int64_t time = 0;
+    /// The message verbosity
+    IOVrb vrb = IOVrb::normal;
+    /// The message category
+    IOCat cat = IOCat::normal;
+    /// The message text
+    std::string text;
+};
+
+/**Reads the messages back out of a binary log, skipping those that don't
+ * match a verbosity and categories without formatting them.
+ */
+class IOBinaryReader
+{
+    public:
+        /** Read a binary log held in memory.
+             * \param the contents of the log, which must outlive the reader
+             * \param the most verbose messages to read
+             * \param the categories to read */
+        explicit IOBinaryReader(std::string_view data, IOVrb = IOVrb::tmi,
+                                IOCat = IOCat::all);
+
+        /** Read the next message that matches.
+             * \param the record to read into
+             * \return false at the end of the log, or if it is malformed */
+        bool next(IOBinaryRecord&);
+
+        /// \return true if reading stopped at malformed data
+        bool failed() const { return bad; }
+
+        /** Append a message as a line of text, such as
+             * "2026-01-02T03:04:05.678901Z [chatty] [debug] Hello".
+             * \param the message
+             * \param the text to append to */
+        static void render_text(const IOBinaryRecord&, std::string&);
+
+        /** Append a message as a line of JSON, with the fields "time",
+             * "vrb", "cat", and "msg".
+             * \param the message
+             * \param the text to append to */
+        static void render_json(const IOBinaryRecord&, std::string&);
+
+    private:
+        /// A format string from the string table.
+        struct Format
+        {
+            std::string text;
+            std::vector<IOFormatPiece> pieces;
+        };
+
+        /** Read a varint, moving past it.
+             * \return false if the data ends first */
+        bool read_varint(uint64_t&);
+
+        /** Read the tags byte and time that start a message. */
+        bool read_header(IOBinaryRecord&);
+
+        /** Read the arguments of a log record into iofmt's packed form.
+             * \param the format string
+             * \return false if they are malformed */
+        bool read_args(const Format&);
+
+        /** Read a record from the string table. */
+        bool read_define();
+
+        /** Stop reading, marking the log as malformed.
+             * \return false */
+        bool fail()
+        {
+            bad = true;
+            return false;
+        }
+
+        // The log.
+        std::string_view data;
+        // Where the next record starts.
+        size_t at = 0;
+        // The most verbose messages to read.
+        IOVrb max_vrb;
+        // The categories to read.
+        IOCat cats;
+        // Whether the log was malformed.
+        bool bad = false;
+        // The time of the last record, in microseconds since the epoch.
+        int64_t time = 0;
+        // The string table for the current session.
+        std::vector<Format> formats;
+        // The arguments of the current log record, packed for iofmt.
+        std::string packed;
+};
+
+#endif // PAWLIB_IOBINARY_HPP
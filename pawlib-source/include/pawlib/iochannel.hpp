@@ -110,17 +110,28 @@
 //Needed for handling passed-in exceptions.
 #include <exception>
 
+//Needed for the asynchronous writer.
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 //Signals and callbacks.
 #include "eventpp/callbacklist.h"
 
 /*We are only using std::string and std::queue temporarily.
 These need to be swapped out for pawlib alternatives ASAP.*/
 #include <string>
+#include <string_view>
 
 //We use C's classes often.
 #include <cstdio>
 
 #include "pawlib/core_types.hpp"
+#include "pawlib/iofmt.hpp"
 #include "pawlib/stdutils.hpp"
 
 #include "pawlib/onechar.hpp"
@@ -247,6 +258,20 @@ enum class IOCursor
     right
 };
 
+/** What an asynchronous iochannel does when its queue is full. */
+enum class IOBackpressure
+{
+    /** Wait for the writer to make room. Nothing is lost, but a slow
+     * output can hold up the threads logging to it. */
+    block = 0,
+    /** Throw the message away, counting it in `dropped()`. */
+    drop = 1,
+    /** Once the queue is three-quarters full, keep only one message in
+     * every `sample_rate`, throwing away (and counting) the rest.
+     * Messages are dropped once it is entirely full. */
+    sample = 2
+};
+
 enum class IOEchoMode
 {
     /** Don't automatically output messages via the stdout echo. */
@@ -473,6 +498,19 @@ struct IOMemReadSize
     }
 };
 
+/* The most verbose messages to compile in, from 0 (IOVrb::quiet) to
+ * 3 (IOVrb::tmi). Define this before including IOChannel to leave the
+ * chattier messages sent with log(), IOC(), or IOLOG() out of a build. */
+#ifndef PAWLIB_IOCHANNEL_MAX_VRB
+#define PAWLIB_IOCHANNEL_MAX_VRB 3
+#endif
+
+/* The categories to compile in, as a mask of IOCat values, such as 7 for
+ * normal, warning, and error only. */
+#ifndef PAWLIB_IOCHANNEL_CATS
+#define PAWLIB_IOCHANNEL_CATS 31
+#endif
+
 /** The level of verbosity necessary for the message to display. */
 enum class IOVrb
 {
@@ -567,6 +605,129 @@ class IOFormat
 
 };
 
+/** A message that has been sent, and is waiting to be broadcast. */
+struct IORecord
+{
+    std::string msg;
+    IOVrb vrb = IOVrb::normal;
+    IOCat cat = IOCat::normal;
+    /* If set, msg holds the arguments for this format string, packed by
+     * iofmt::pack(), rather than the message itself. */
+    const IOFormatString* format = nullptr;
+};
+
+/** A fixed-size queue of records that any number of threads may push to,
+ * and one thread pops from, without locking. Records are swapped in and
+ * out rather than copied, so their string buffers go around the ring and
+ * back to the threads logging, and a busy channel stops allocating.
+ */
+class IORecordQueue
+{
+    private:
+        struct Cell
+        {
+            /* The push or pop that may use this cell next. A push at
+             * position p waits for p here, and leaves p + 1 for the pop. */
+            std::atomic<size_t> seq;
+            IORecord record;
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        size_t mask;
+
+        /* The next positions to push and pop, kept on separate cache lines
+         * so the producers and the consumer don't fight over them. */
+        alignas(64) std::atomic<size_t> head;
+        alignas(64) std::atomic<size_t> tail;
+
+    public:
+        /** Create a queue.
+             * \param the number of records it can hold, which is rounded
+             * up to a power of two */
+        explicit IORecordQueue(size_t capacity);
+
+        /** Push a record onto the queue, if there is room. On success,
+             * the record is left holding an empty, reusable buffer.
+             * \param the record to push
+             * \return true if the record was pushed, else false */
+        bool try_push(IORecord& record);
+
+        /** Pop a record from the queue. Only one thread may pop at a time.
+             * \param the record to swap the popped one into
+             * \return true if a record was popped, else false */
+        bool try_pop(IORecord& record);
+
+        /// \return the number of records pushed so far
+        size_t pushed() const { return head.load(std::memory_order_acquire); }
+
+        /// \return the number of records popped so far
+        size_t popped() const { return tail.load(std::memory_order_acquire); }
+
+        /// \return roughly how many records are waiting
+        size_t size() const { return pushed() - popped(); }
+
+        /// \return the number of records the queue can hold
+        size_t capacity() const { return mask + 1; }
+};
+
+/**Limits how often messages are let through, and can sample them at
+ * random, counting how many it turns away. The rate is enforced as a
+ * token bucket: up to `burst` messages may go at once, and then one more
+ * each 1/`per_second` seconds. It is safe to use from any thread.
+ */
+class IORateLimit
+{
+    public:
+        /** Create a limit.
+             * \param the messages to allow per second, or 0 for no limit
+             * \param the messages to allow at once, at least 1
+             * \param keep one in this many messages at random, before the
+             * rate is checked; 1 keeps them all */
+        explicit IORateLimit(double per_second = 0, double burst = 1,
+                             unsigned int sample = 1)
+        {
+            configure(per_second, burst, sample);
+        }
+
+        IORateLimit(const IORateLimit&) = delete;
+        IORateLimit& operator=(const IORateLimit&) = delete;
+
+        /** Change the limit, with the same arguments as the constructor. */
+        void configure(double per_second, double burst = 1, unsigned int sample = 1);
+
+        /** Take a message, if the limit allows it.
+             * \return true if the message may go, else false */
+        bool admit();
+
+        /// \return whether the limit ever turns anything away
+        bool active() const
+        {
+            return interval.load(std::memory_order_relaxed) > 0
+                || sample_rate.load(std::memory_order_relaxed) > 1;
+        }
+
+        /// \return the number of messages turned away since the last take
+        size_t suppressed() const { return suppressed_count.load(std::memory_order_relaxed); }
+
+        /// \return the number of messages turned away, resetting it to 0
+        size_t take_suppressed()
+        {
+            return suppressed_count.exchange(0, std::memory_order_relaxed);
+        }
+
+    private:
+        // The nanoseconds between messages, or 0 for no limit.
+        std::atomic<int64_t> interval{0};
+        // How far ahead of now the next slot may be, in nanoseconds.
+        std::atomic<int64_t> tolerance{0};
+        // Keep one in this many messages.
+        std::atomic<unsigned int> sample_rate{1};
+        // When the next message would be due if sent at the steady rate.
+        std::atomic<int64_t> next_slot{0};
+        // The messages turned away.
+        std::atomic<size_t> suppressed_count{0};
+};
+
 /**An iochannel allows console output to be custom routed to one or more
 * text-based output channels, including the terminal. It supports various
 * advanced functions, formatting and colors, and message priority.*/
@@ -576,95 +737,119 @@ class iochannel
         /**Declares a new iochannel instance.*/
         iochannel();
 
+        /* Every callback is handed a view of the same message, rather
+         * than a copy of its own. The view is only good until the
+         * callback returns. */
+
         /** Eventpp signal (callback list) for categories. */
-        typedef eventpp::CallbackList<void (std::string,
+        typedef eventpp::CallbackList<void (std::string_view,
             IOCat)> IOSignalCat;
 
         /** Eventpp signal (callback list) for verbosities. */
-        typedef eventpp::CallbackList<void (std::string,
+        typedef eventpp::CallbackList<void (std::string_view,
             IOVrb)> IOSignalVrb;
 
         /** Eventpp signal (callback list) for everything,
              * transmitting the message, the verbosity, and the category. */
-        typedef eventpp::CallbackList<void (std::string,
+        typedef eventpp::CallbackList<void (std::string_view,
             IOVrb, IOCat)> IOSignalFull;
 
         /** Eventpp signal (callback list) for everything,
              * transmitting only the message. */
-        typedef eventpp::CallbackList<void (std::string)> IOSignalAll;
+        typedef eventpp::CallbackList<void (std::string_view)> IOSignalAll;
+
+        /** Eventpp signal (callback list) for everything, as the channel
+             * has it, transmitting the message, the verbosity, the category,
+             * and the format string of a log() call. */
+        typedef eventpp::CallbackList<void (std::string_view,
+            IOVrb, IOCat, const IOFormatString*)> IOSignalRecord;
 
 
         /* NOTE: In the examples below, the verbosity-related signals must
             * transmit what category the message is (since verbosity is
             * inherent and assumed). The inverse is true of category-related
-            * signals. */
+            * signals.
+            *
+            * A callback may send to its own channel. Such a message waits
+            * until the one being broadcast has been to every callback, and
+            * then goes out on the same thread. */
 
         /** Emitted when a message with verbosity 0 (quiet) is broadcast.
-             * Callback must be of form 'void callback(string,
+             * Callback must be of form 'void callback(string_view,
              * IOCat){}'
              */
         IOSignalCat signal_v_quiet;
 
         /** Emitted when a message with verbosity <= 1 (normal) is broadcast.
-             * Callback must be of form 'void callback(string,
+             * Callback must be of form 'void callback(string_view,
              * IOCat){}'
              */
         IOSignalCat signal_v_normal;
 
         /** Emitted when a message with verbosity <=2 (chatty) is broadcast.
-             * Callback must be of form 'void callback(string,
+             * Callback must be of form 'void callback(string_view,
              * IOCat){}'
              */
         IOSignalCat signal_v_chatty;
 
         /** Emitted when a message with verbosity <=3 (tmi) is broadcast.
-             * Callback must be of form 'void callback(string,
+             * Callback must be of form 'void callback(string_view,
              * IOCat){}'
              */
         IOSignalCat signal_v_tmi;
 
         /** Emitted when a message with category "normal" is broadcast.
-             * Callback must be of form 'void callback(string,
+             * Callback must be of form 'void callback(string_view,
              * IOVrb){}'
              */
         IOSignalVrb signal_c_normal;
 
         /** Emitted when a message with category "warning" is broadcast.
-             * Callback must be of form 'void callback(string,
+             * Callback must be of form 'void callback(string_view,
              * IOVrb){}'
              */
         IOSignalVrb signal_c_warning;
 
         /** Emitted when a message with category "error" is broadcast.
-             * Callback must be of form 'void callback(string,
+             * Callback must be of form 'void callback(string_view,
              * IOVrb){}'
              */
         IOSignalVrb signal_c_error;
 
         /** Emitted when a message with category "debug" is broadcast.
-             * Callback must be of form 'void callback(string,
+             * Callback must be of form 'void callback(string_view,
              * IOVrb){}'
              */
         IOSignalVrb signal_c_debug;
 
         /** Emitted when a message with category "testing" is broadcast.
-             * Callback must be of form 'void callback(string,
+             * Callback must be of form 'void callback(string_view,
              * IOVrb){}'
              */
         IOSignalVrb signal_c_testing;
 
         /** Emitted when any message is broadcast.
-             * Callback must be of form 'void callback(string,
+             * Callback must be of form 'void callback(string_view,
              * IOVrb, IOCat){}'
              */
         IOSignalFull signal_full;
 
         /** Emitted when any message is broadcast, but only transmits the
              * message, and omits the verbosity and category.
-             * Callback must be of form 'void callback(string){}'
+             * Callback must be of form 'void callback(string_view){}'
              */
         IOSignalAll signal_all;
 
+        /** Emitted when any message is broadcast, before it is formatted.
+             * If the format string is null, the message is text. Otherwise,
+             * the message holds the arguments of a log() call, packed for
+             * iofmt::format_packed(). Messages from log() are only formatted
+             * if an echo or one of the other signals wants them.
+             * Callback must be of form 'void callback(string_view,
+             * IOVrb, IOCat, const IOFormatString*){}'
+             */
+        IOSignalRecord signal_record;
+
         // Overloaded stream insertion operators for IOChannel.
 
         //These need custom implementations.
@@ -674,6 +859,7 @@ class iochannel
         iochannel& operator<<(const std::string&);
         iochannel& operator<<(const onechar&);
         iochannel& operator<<(const onestring&);
+        iochannel& operator<<(const onestring_view&);
 
         inline iochannel& operator<<(const unsigned char& rhs){return resolve_integer(rhs);}
         inline iochannel& operator<<(const int& rhs){return resolve_integer(rhs);}
@@ -717,15 +903,17 @@ class iochannel
         template<const long unsigned int T>
         iochannel& operator<<(const std::bitset<T>& rhs)
         {
+            Staging& s = stage();
+
             // Store the old values for the two flags we use.
-            IOMemReadSize old_readsize = readsize;
-            IOFormatPtr old_ptr = fmt.fmt_ptr;
+            IOMemReadSize old_readsize = s.readsize;
+            IOFormatPtr old_ptr = s.fmt.fmt_ptr;
 
             /* The readsize (in bytes) is the bitset size (bits) divided
                 * by 8 and rounded to the nearest integer. */
-            readsize = static_cast<unsigned int>(ceil((T/8)));
+            s.readsize = static_cast<unsigned int>(ceil((T/8)));
             // We want a memory dump.
-            fmt << IOFormatPtr::memory;
+            s.fmt << IOFormatPtr::memory;
 
             // Remove the const-ness from the pointer.
             std::bitset<T>* rhs_ptr = const_cast<std::bitset<T>*>(&rhs);
@@ -735,8 +923,8 @@ class iochannel
             iochannel* r = &resolve_pointer(static_cast<void*>(rhs_ptr));
 
             // Restore our prior flag values.
-            fmt << old_ptr;
-            readsize = old_readsize;
+            s.fmt << old_ptr;
+            s.readsize = old_readsize;
 
             /* Return the value at the pointer, which will be implicitly
                 * converted to reference by the function return. */
@@ -756,7 +944,7 @@ class iochannel
         {
             if (process_fmt(rhs))
             {
-                dirty_attributes = true;
+                stage().dirty_attributes = true;
             }
             return *this;
         }
@@ -765,7 +953,7 @@ class iochannel
         {
             if (process_fmt(rhs))
             {
-                dirty_attributes = true;
+                stage().dirty_attributes = true;
             }
             return *this;
         }
@@ -774,7 +962,7 @@ class iochannel
         {
             if (process_fmt(rhs))
             {
-                dirty_attributes = true;
+                stage().dirty_attributes = true;
             }
             return *this;
         }
@@ -788,6 +976,88 @@ class iochannel
 
         void configure_echo(IOEchoMode, IOVrb = IOVrb::tmi, IOCat = IOCat::all);
 
+        /** Broadcast messages from a writer thread of the channel's own.
+             * Sending a message then only puts it on a queue, and the
+             * writer dispatches the signals and echoes to the terminal in
+             * batches, with one write per batch. Signal callbacks are
+             * called on the writer thread, so connect them beforehand.
+             * Other threads may keep sending while the channel switches
+             * modes, but must stop before the channel is destroyed.
+             * \param what to do when the queue is full
+             * \param the number of messages the queue holds
+             * \param for IOBackpressure::sample, keep one in this many
+             * messages when the queue is nearly full
+             */
+        void configure_async(IOBackpressure = IOBackpressure::block,
+                             size_t capacity = 4096,
+                             unsigned int sample_rate = 16);
+
+        /** Go back to broadcasting messages as they are sent, after
+             * writing out everything already queued. Messages sent in the
+             * meantime wait for the queue to be written out first. */
+        void configure_sync();
+
+        /** Have log() pack its arguments into the queue as they are, and
+             * leave the formatting to the writer thread. This only has an
+             * effect while the channel is asynchronous.
+             * \param whether to defer formatting */
+        void configure_deferred(bool defer = true)
+        {
+            deferred = defer;
+        }
+
+        /** Send a whole message, formatted from a format string made with
+             * IOFMT(), such as `ioc.log<IOVrb::chatty, IOCat::debug>(
+             * IOFMT("{} of {}"), done, total)`. The format string is checked
+             * against the arguments while compiling, and the message is
+             * checked against shutup() once, before anything is formatted.
+             * Messages that aren't compiled_in() compile to nothing, though
+             * their arguments are still evaluated; see IOLOG() to avoid that.
+             * This does not touch a message being built with <<, nor its
+             * formatting flags.
+             * \param the format string
+             * \param the arguments */
+        template <IOVrb V = IOVrb::normal, IOCat C = IOCat::normal, typename F, typename... Args>
+        void log(F, const Args&... args)
+        {
+            iofmt::check<F, Args...>();
+            if constexpr(compiled_in(V, C))
+            {
+                if(!permits(V, C)){return;}
+
+                const IOFormatString& fmt = iofmt::parsed<F>::string;
+                Staging& s = stage();
+                if(limited.load(std::memory_order_relaxed) & static_cast<uint8_t>(C))
+                {
+                    // IOLOG() has already asked admit().
+                    bool admitted = s.admitted;
+                    s.admitted = false;
+                    if(!admitted && !admit_limited(V, C, nullptr)){return;}
+                }
+                if((queue.load(std::memory_order_relaxed)
+                    && deferred.load(std::memory_order_relaxed))
+                   || !signal_record.empty())
+                {
+                    (iofmt::pack(s.line, args), ...);
+                    publish(s.line, V, C, &fmt);
+                }
+                else
+                {
+                    iofmt::format(s.line, fmt, args...);
+                    publish(s.line, V, C);
+                }
+                s.line.clear();
+            }
+        }
+
+        /** Wait until every message sent so far has been broadcast.
+             * Returns at once if the channel isn't asynchronous. */
+        void drain();
+
+        /// \return the number of messages thrown away for backpressure
+        size_t dropped() const { return dropped_count.load(std::memory_order_relaxed); }
+
+
         /** Suppress a category from broadcasting at all.
              * \param the category to suppress
              */
@@ -816,40 +1086,185 @@ class iochannel
              */
         void speakup();
 
+        /** Whether messages of a verbosity and category are compiled in,
+             * per PAWLIB_IOCHANNEL_MAX_VRB and PAWLIB_IOCHANNEL_CATS. */
+        static constexpr bool compiled_in(IOVrb vrb, IOCat cat)
+        {
+            return static_cast<int>(vrb) <= PAWLIB_IOCHANNEL_MAX_VRB
+                && (static_cast<int>(cat) & PAWLIB_IOCHANNEL_CATS) != 0;
+        }
+
+        /** Whether messages of a verbosity and category would be sent,
+             * both as compiled and per shutup() and speakup(). This is
+             * one load and one test, so it is cheap to call first.
+             * \param the message verbosity
+             * \param the message category */
+        bool permits(IOVrb vrb, IOCat cat) const
+        {
+            return (allowed.load(std::memory_order_relaxed) & allowed_bit(vrb, cat)) != 0;
+        }
+
+        /** Limit how often messages of some categories are sent, and/or
+             * sample them at random; see IORateLimit. This applies to every
+             * message, but only IOC() and IOLOG() skip building the message
+             * when it is turned away. The next message let through is
+             * preceded by a count of the ones that weren't.
+             * \param the categories to limit, each separately
+             * \param the messages to allow per second, or 0 for no limit
+             * \param the messages to allow at once
+             * \param keep one in this many messages at random; 1 keeps them all */
+        void configure_limit(IOCat, double per_second, double burst = 1,
+                             unsigned int sample = 1);
+
+        /** Remove any limit on some categories.
+             * \param the categories */
+        void remove_limit(IOCat cat)
+        {
+            configure_limit(cat, 0);
+        }
+
+        /** \param the category
+             * \return the messages of a category turned away by its limit
+             * and not yet counted in a message */
+        size_t suppressed(IOCat) const;
+
+        /** Whether a message of a verbosity and category would be sent,
+             * and its category's limit allows it, in which case it takes
+             * its place under the limit. Use this instead of permits() only
+             * just before sending the message.
+             * \param the message verbosity
+             * \param the message category
+             * \return true if the message should be sent */
+        bool admit(IOVrb vrb, IOCat cat)
+        {
+            if(!permits(vrb, cat)){return false;}
+            if(!(limited.load(std::memory_order_relaxed) & static_cast<uint8_t>(cat)))
+            {
+                return true;
+            }
+            if(!admit_limited(vrb, cat, nullptr)){return false;}
+            // So the message isn't counted against the limit again.
+            stage().admitted = true;
+            return true;
+        }
+
+        /** As admit(), but first checks a limit of the caller's own, such
+             * as one for a single line of code; see IOC_LIMIT().
+             * \param the message verbosity
+             * \param the message category
+             * \param the caller's limit
+             * \return true if the message should be sent */
+        bool admit(IOVrb vrb, IOCat cat, IORateLimit& limit)
+        {
+            if(!permits(vrb, cat) || !admit_limited(vrb, cat, &limit)){return false;}
+            if(limited.load(std::memory_order_relaxed) & static_cast<uint8_t>(cat))
+            {
+                stage().admitted = true;
+            }
+            return true;
+        }
+
         ~iochannel();
     protected:
-        std::string msg;
+        /* SETTINGS
+            * These are shared by every thread using the channel.
+            */
 
         // Which categories are permitted.
         IOCat process_cat = IOCat::all;
         // The maximum verbosity to permit.
         IOVrb process_vrb = IOVrb::tmi;
+        // Guards changes to the two settings above.
+        std::mutex settings_lock;
+
+        /* Which messages are permitted, both by the settings above and as
+            * compiled, with a bit for each category at each verbosity. */
+        std::atomic<uint32_t> allowed{0};
+
+        /// \return the bit for a category at a verbosity in `allowed`
+        static constexpr uint32_t allowed_bit(IOVrb vrb, IOCat cat)
+        {
+            return static_cast<uint32_t>(cat) << (static_cast<int>(vrb) * 8);
+        }
+
+        /**Work out `allowed` again after a change to the settings.
+        * Call with `settings_lock` held.*/
+        void update_allowed();
 
         // Which method should be used for IOChannel's default stdout echo?
-        IOEchoMode echo_mode = IOEchoMode::printf;
+        std::atomic<IOEchoMode> echo_mode{IOEchoMode::printf};
         // The category to echo.
-        IOCat echo_cat = IOCat::all;
+        std::atomic<IOCat> echo_cat{IOCat::all};
         // The maximum verbosity to echo.
-        IOVrb echo_vrb = IOVrb::tmi;
+        std::atomic<IOVrb> echo_vrb{IOVrb::tmi};
+
+        // The limit for each category, in the order of the category bits.
+        IORateLimit limits[5];
+        // Which categories have an active limit.
+        std::atomic<uint8_t> limited{0};
 
         /* MESSAGE ATTRIBUTES
             * These are set by enum and flags,
             * and should be reset after each message (unless
             * the user ends the message with an EoM stream
             * control with a "keep" flag.
+            *
+            * Each thread keeps its own, so threads can send on the
+            * same channel at once without mixing up their messages.
             */
+        struct Staging
+        {
+            // The message so far.
+            std::string msg;
+
+            // The message or packed arguments for log().
+            std::string line;
+
+            //The string containing the format.
+            std::string format;
+
+            IOFormat fmt;
+
+            // How many bytes of data to read from a pointer.
+            IOMemReadSize readsize = IOMemReadSize(1);
+
+            /* Message verbosity. */
+            IOVrb vrb = IOVrb::normal;
+            /* Message category. */
+            IOCat cat = IOCat::normal;
 
-        IOFormat fmt;
+            ///Dirty flag raised when attributes are changed and not yet applied.
+            bool dirty_attributes = false;
 
-        // How many bytes of data to read from a pointer.
-        IOMemReadSize readsize = IOMemReadSize(1);
+            // Raised when admit() has let the next message through its limit.
+            bool admitted = false;
+        };
 
-        /* Message verbosity. */
-        IOVrb vrb = IOVrb::normal;
-        /* Message category. */
-        IOCat cat = IOCat::normal;
-        /* Message parsable */
-        tril parse = maybe;
+        // Identifies the channel's staging in each thread; never reused.
+        const uint64_t id;
+
+        /**Get the calling thread's message attributes for this channel,
+        * creating them the first time the thread uses it.
+        */
+        Staging& stage();
+
+        /**Get the staging for a thread whose own is already gone, because
+        * it is ending. These belong to the channel, one per such thread.
+        */
+        Staging& late_staging();
+
+        // The stagings for threads that are ending, made when first needed.
+        std::unordered_map<std::thread::id, std::unique_ptr<Staging>> late;
+        // Guards `late`.
+        std::mutex late_lock;
+
+        // Guards broadcasting, so that whole messages go out one at a time.
+        std::mutex publish_lock;
+        // Packed messages are formatted into this while publishing.
+        std::string publish_text;
+        /* Messages that callbacks sent to this channel while it was
+         * broadcasting. Only the thread broadcasting touches it. */
+        std::vector<IORecord> reentered;
 
         template<typename T>
         bool process_fmt(T val)
@@ -857,7 +1272,7 @@ class iochannel
             //If we cannot parse because of `shutup()` settings, abort.
             if(!can_parse()){return false;}
 
-            fmt << val;
+            stage().fmt << val;
             return true;
         }
 
@@ -867,7 +1282,7 @@ class iochannel
             //If we cannot parse because of `shutup()` settings, abort.
             if(!can_parse()){return *this;}
 
-            switch(fmt.fmt_ptr)
+            switch(stage().fmt.fmt_ptr)
             {
                 //If we are to print as value...
                 case IOFormatPtr::value:
@@ -924,9 +1339,6 @@ class iochannel
         template <typename T>
         iochannel& resolve_float(const T&);
 
-        //The string containing the format.
-        std::string format = "";
-
         /**Flush the standard output.*/
         void flush();
 
@@ -961,8 +1373,119 @@ class iochannel
         */
         void transmit(bool=false);
 
-        ///Dirty flag raised when attributes are changed and not yet applied.
-        bool dirty_attributes = false;
+        /**Broadcast a whole message, or queue it for the writer.
+        * \param the message, which may be swapped for an empty buffer
+        * \param the message verbosity
+        * \param the message category
+        * \param if set, the format string whose packed arguments the
+        * message holds instead
+        */
+        void publish(std::string&, IOVrb, IOCat, const IOFormatString* = nullptr);
+
+        /* ASYNCHRONOUS OUTPUT
+            * These are only used after configure_async().
+            */
+
+        // Whether log() leaves formatting to the writer.
+        std::atomic<bool> deferred{false};
+        /* The queue of messages waiting for the writer, as senders see
+         * it, or null if synchronous. It is only freed once every sender
+         * that saw it is done with it. */
+        std::atomic<IORecordQueue*> queue{nullptr};
+        // The number of threads that may be using the queue.
+        std::atomic<size_t> senders{0};
+        // The writer's queue, which it owns until it stops.
+        std::unique_ptr<IORecordQueue> records;
+        // The writer thread.
+        std::thread writer;
+        // Guards starting and stopping the writer.
+        std::mutex switch_lock;
+        // What to do when the queue is full.
+        IOBackpressure backpressure = IOBackpressure::block;
+        // Under IOBackpressure::sample, keep one in this many messages.
+        unsigned int sample_rate = 16;
+        // Counts messages under IOBackpressure::sample, to pick which to keep.
+        std::atomic<size_t> sample_count{0};
+        // The number of messages thrown away.
+        std::atomic<size_t> dropped_count{0};
+        // The number of messages the writer has finished with.
+        std::atomic<size_t> written{0};
+        // Raised to tell the writer to finish up and stop.
+        std::atomic<bool> stopping{false};
+        // Raised while the writer is waiting for messages.
+        std::atomic<bool> sleeping{false};
+        // Guards the writer's sleeping and waking, and drain().
+        std::mutex wake_lock;
+        // Wakes the writer when messages arrive.
+        std::condition_variable wake;
+        // Wakes drain() when the writer has finished a batch.
+        std::condition_variable drained;
+
+        /**Render and dispatch a message, and echo it if the settings
+        * permit, then do the same for any messages the callbacks sent to
+        * this channel meanwhile.
+        * \param the message
+        * \param the message verbosity
+        * \param the message category
+        * \param the format string, if the message is packed
+        * \param the buffer to format into
+        * \param called as echo(text, category) for each message to echo
+        */
+        template <typename Echo>
+        void broadcast(std::string&, IOVrb, IOCat, const IOFormatString*,
+                       std::string&, Echo);
+
+        /**Dispatch the signals for a message, skipping any signal
+        * with nothing connected.
+        * \param the message
+        * \param the message verbosity
+        * \param the message category
+        */
+        void dispatch(std::string_view, IOVrb, IOCat);
+
+        /**Hand a message to signal_record, then format it if it came
+        * packed from log() and anything else wants the text.
+        * \param the message, which is pointed at the text
+        * \param the message verbosity
+        * \param the message category
+        * \param the format string, if the message is packed
+        * \param the buffer to format into
+        * \return false if nothing else wants the message
+        */
+        bool render(std::string_view&, IOVrb, IOCat, const IOFormatString*, std::string&);
+
+        /**Check a message against a caller's limit, if any, and then its
+        * category's. If it is let through, first send a count of the
+        * messages the limits turned away since the last one.
+        * \param the message verbosity
+        * \param the message category
+        * \param the caller's limit, or null
+        * \return true if the message should be sent
+        */
+        bool admit_limited(IOVrb, IOCat, IORateLimit*);
+
+        /**Whether the echo settings permit a message.
+        * \param the message verbosity
+        * \param the message category
+        */
+        bool echoes(IOVrb, IOCat) const;
+
+        /**Put a message on the queue, respecting the backpressure setting.
+        * \param the queue
+        * \param the record to push, which is left with a reusable buffer
+        */
+        void enqueue(IORecordQueue&, IORecord&);
+
+        /**Stop sending to the queue, and stop the writer once it has
+        * written out everything on it. Call with switch_lock held.
+        */
+        void stop_writer();
+
+        /**Wake the writer, if it is waiting.*/
+        void wake_writer();
+
+        /**The writer thread's loop.*/
+        void write_loop();
 
         /**Apply formatting attributes (usually ANSI) that are pending.
         * \param true if new attributes were applied
@@ -970,7 +1493,11 @@ class iochannel
         bool apply_attributes();
 
         /**Returns whether the vrb and cat match parsing (shutup) rules.*/
-        bool can_parse();
+        bool can_parse()
+        {
+            const Staging& s = stage();
+            return permits(s.vrb, s.cat);
+        }
 
         /**Clear the channel's message substring array.*/
         void clear_msg();
@@ -986,4 +1513,58 @@ class iochannel
 ///Global external (static) instance of iochannel.
 extern iochannel ioc;
 
+/**Start a message with the given verbosity and category, which is then
+ * built with << as usual:
+ *
+ *     IOC(ioc, IOVrb::tmi, IOCat::debug) << "Mesh: " << mesh.dump() << IOCtrl::end;
+ *
+ * Unlike plain <<, nothing else on the line is evaluated unless the
+ * message would be sent, and if it isn't compiled_in(), the line is
+ * optimized out. This is a statement, not an expression.*/
+#define IOC(channel, vrb, cat) \
+    if (!(iochannel::compiled_in(vrb, cat) && (channel).admit(vrb, cat))) {} \
+    else (channel) << (vrb) << (cat)
+
+/**As IOC(), but with a limit of its own, made the first time the line
+ * runs, so that one noisy line can't drown out the rest:
+ *
+ *     IOC_LIMIT(ioc, IOVrb::normal, IOCat::error, IORateLimit(10, 100))
+ *         << "Bad packet from " << peer << IOCtrl::end;
+ */
+#define IOC_LIMIT(channel, vrb, cat, limit) \
+    if (!(iochannel::compiled_in(vrb, cat) \
+          && (channel).admit(vrb, cat, \
+                [&]() -> IORateLimit& { static IORateLimit line_limit = limit; \
+                                        return line_limit; }()))) {} \
+    else (channel) << (vrb) << (cat)
+
+/**Send a message with log(), only evaluating the arguments if the
+ * message would be sent:
+ *
+ *     IOLOG(ioc, IOVrb::tmi, IOCat::debug, IOFMT("Mesh: {}"), mesh.dump());
+ */
+#define IOLOG(channel, vrb, cat, ...) \
+    do \
+    { \
+        if (iochannel::compiled_in(vrb, cat) && (channel).admit(vrb, cat)) \
+        { \
+            (channel).template log<vrb, cat>(__VA_ARGS__); \
+        } \
+    } while (0)
+
+/**As IOLOG(), but with a limit of its own; see IOC_LIMIT():
+ *
+ *     IOLOG_LIMIT(ioc, IOVrb::normal, IOCat::error, IORateLimit(10, 100),
+ *                 IOFMT("Bad packet from {}"), peer);
+ */
+#define IOLOG_LIMIT(channel, vrb, cat, limit, ...) \
+    do \
+    { \
+        static IORateLimit line_limit = limit; \
+        if (iochannel::compiled_in(vrb, cat) && (channel).admit(vrb, cat, line_limit)) \
+        { \
+            (channel).template log<vrb, cat>(__VA_ARGS__); \
+        } \
+    } while (0)
+
 #endif // PAWLIB_IOCHANNEL_HPP
@@ -0,0 +1,2085 @@
+/** Tests for IOChannel [PawLIB]
+  * Version: 0.1
+  *
+  * Author(s): Jason C. McDonald
+  */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2019 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+
+#ifndef PAWLIB_IOCHANNEL_TESTS_HPP
+#define PAWLIB_IOCHANNEL_TESTS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "pawlib/goldilocks.hpp"
+#include "pawlib/iobinary.hpp"
+#include "pawlib/iochannel.hpp"
+#include "pawlib/iosink.hpp"
+
+/// A temporary path for a sink test's file, unique to the process.
+inline std::string sink_test_path(const std::string& name)
+{
+    return std::string(P_tmpdir) + "/pawlib_" + name + "_" + std::to_string(getpid());
+}
+
+/// Read a whole file, or return an empty string if it can't be read.
+inline std::string sink_test_read(const std::string& path)
+{
+    std::string out;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) { return out; }
+    char chunk[4096];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        out.append(chunk, got);
+    }
+    fclose(file);
+    return out;
+}
+
+// P-tB2001
+class TestIOChannel_Signals : public Test
+{
+    public:
+        TestIOChannel_Signals(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Signals";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send messages on a channel of its own, and check which signals they arrive on.";
+        }
+
+        bool run() override
+        {
+            iochannel channel;
+            channel.configure_echo(IOEchoMode::none);
+
+            std::vector<std::string> all;
+            std::vector<std::string> errors;
+            size_t chatty = 0;
+            channel.signal_all.append([&all](std::string_view msg){ all.emplace_back(msg); });
+            channel.signal_c_error.append([&errors](std::string_view msg, IOVrb){ errors.emplace_back(msg); });
+            channel.signal_v_chatty.append([&chatty](std::string_view, IOCat){ ++chatty; });
+
+            channel << "Hello, " << 42 << IOCtrl::end;
+            channel << IOVrb::quiet << IOCat::error << "Oh no!" << IOCtrl::end;
+            channel << IOVrb::tmi << IOCat::debug << "Details" << IOCtrl::end;
+
+            PL_ASSERT_EQUAL(all.size(), 3u);
+            PL_ASSERT_EQUAL(all[0], "Hello, 42");
+            PL_ASSERT_EQUAL(errors.size(), 1u);
+            PL_ASSERT_EQUAL(errors[0], "Oh no!");
+            // Verbosity signals also get every message quieter than them.
+            PL_ASSERT_EQUAL(chatty, 2u);
+
+            // Silenced messages don't go anywhere.
+            channel.shutup(IOCat::debug);
+            channel << IOCat::debug << "Hidden" << IOCtrl::end;
+            PL_ASSERT_EQUAL(all.size(), 3u);
+            return true;
+        }
+};
+
+// P-tB2002
+class TestIOChannel_Async : public Test
+{
+    public:
+        TestIOChannel_Async(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Asynchronous Output";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send many messages through a small queue with blocking backpressure, and check that all arrive on the writer thread, in order.";
+        }
+
+        bool run() override
+        {
+            iochannel channel;
+            channel.configure_echo(IOEchoMode::none);
+
+            std::vector<std::string> received;
+            std::thread::id from;
+            channel.signal_all.append([&received, &from](std::string_view msg)
+            {
+                received.emplace_back(msg);
+                from = std::this_thread::get_id();
+            });
+
+            channel.configure_async(IOBackpressure::block, 64);
+            for (int i = 0; i < 10000; ++i)
+            {
+                channel << "Message " << i << IOCtrl::end;
+            }
+            channel.drain();
+
+            PL_ASSERT_EQUAL(received.size(), 10000u);
+            PL_ASSERT_EQUAL(received[0], "Message 0");
+            PL_ASSERT_EQUAL(received[9999], "Message 9999");
+            PL_ASSERT_TRUE(from != std::this_thread::get_id());
+            PL_ASSERT_EQUAL(channel.dropped(), 0u);
+
+            // Going back to synchronous writes out the rest first.
+            channel << "Last" << IOCtrl::end;
+            channel.configure_sync();
+            PL_ASSERT_EQUAL(received.size(), 10001u);
+            channel << "Now" << IOCtrl::end;
+            PL_ASSERT_EQUAL(received.back(), "Now");
+            PL_ASSERT_TRUE(from == std::this_thread::get_id());
+            return true;
+        }
+};
+
+// P-tB2003
+class TestIOChannel_Backpressure : public Test
+{
+    public:
+        TestIOChannel_Backpressure(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Drop When Full";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send messages faster than a slow output can take them, and check that every message is either received or counted as dropped.";
+        }
+
+        bool run() override
+        {
+            const size_t sent = 2000;
+            for (IOBackpressure mode : {IOBackpressure::drop, IOBackpressure::sample})
+            {
+                iochannel channel;
+                channel.configure_echo(IOEchoMode::none);
+
+                size_t received = 0;
+                channel.signal_all.append([&received](std::string_view)
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(20));
+                    ++received;
+                });
+
+                channel.configure_async(mode, 16, 4);
+                for (size_t i = 0; i < sent; ++i)
+                {
+                    channel << "Message " << i << IOCtrl::end;
+                }
+                channel.drain();
+
+                PL_ASSERT_GREATER(channel.dropped(), 0u);
+                PL_ASSERT_EQUAL(received + channel.dropped(), sent);
+            }
+            return true;
+        }
+};
+
+// P-tB2004*
+class TestIOChannel_SendSync : public Test
+{
+    protected:
+        iochannel channel;
+        iochannel::IOSignalFull::Handle output;
+        FILE* sink = nullptr;
+
+    public:
+        TestIOChannel_SendSync(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Send (Synchronous)";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send a short message to an output that writes each line to /dev/null, broadcasting it on the calling thread.";
+        }
+
+        bool pre() override
+        {
+            sink = fopen("/dev/null", "w");
+            if (sink == nullptr) { return false; }
+
+            channel.configure_echo(IOEchoMode::none);
+            output = channel.signal_full.append([this](std::string_view msg, IOVrb, IOCat)
+            {
+                fwrite(msg.data(), 1, msg.size(), sink);
+                fflush(sink);
+            });
+            return true;
+        }
+
+        bool post() override
+        {
+            channel.signal_full.remove(output);
+            fclose(sink);
+            return true;
+        }
+
+        bool run() override
+        {
+            channel << "Temperature: " << 21 << " degrees" << IOCtrl::end;
+            return true;
+        }
+};
+
+// P-tB2004
+class TestIOChannel_SendAsync : public TestIOChannel_SendSync
+{
+    public:
+        TestIOChannel_SendAsync(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Send (Asynchronous)";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send a short message to an output that writes each line to /dev/null, queueing it for the writer thread.";
+        }
+
+        bool pre() override
+        {
+            TestIOChannel_SendSync::pre();
+            channel.configure_async();
+            return true;
+        }
+
+        bool post() override
+        {
+            channel.configure_sync();
+            return TestIOChannel_SendSync::post();
+        }
+};
+
+// P-tB2005
+class TestIOChannel_SharedMessage : public Test
+{
+    public:
+        TestIOChannel_SharedMessage(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Shared Message";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Connect several outputs, and check that they are all handed the same message rather than copies.";
+        }
+
+        bool run() override
+        {
+            iochannel channel;
+            channel.configure_echo(IOEchoMode::none);
+
+            // With nothing connected, sending is harmless.
+            channel << IOCat::warning << "Nobody is listening." << IOCtrl::end;
+
+            std::vector<const char*> seen;
+            std::string text;
+            auto record = [&seen](std::string_view msg){ seen.push_back(msg.data()); };
+            channel.signal_all.append(record);
+            channel.signal_full.append([&](std::string_view msg, IOVrb, IOCat)
+            {
+                seen.push_back(msg.data());
+                text = std::string(msg);
+            });
+            channel.signal_c_warning.append([&](std::string_view msg, IOVrb){ record(msg); });
+            channel.signal_v_tmi.append([&](std::string_view msg, IOCat){ record(msg); });
+
+            channel << IOCat::warning << "Everybody is listening." << IOCtrl::end;
+
+            PL_ASSERT_EQUAL(seen.size(), 4u);
+            for (const char* data : seen)
+            {
+                PL_ASSERT_TRUE(data == seen[0]);
+            }
+            PL_ASSERT_EQUAL(text, "Everybody is listening.");
+            return true;
+        }
+};
+
+// P-tB2006
+class TestIOChannel_Threads : public Test
+{
+    protected:
+        static constexpr int THREADS = 4;
+        static constexpr int MESSAGES = 500;
+
+        /** Has several threads send multi-part messages to one channel,
+         * each with its own category, and checks every message arrives
+         * whole and with the category of the thread that sent it. */
+        bool send_from_threads(iochannel& channel)
+        {
+            const IOCat cats[THREADS] = {IOCat::normal, IOCat::warning,
+                IOCat::debug, IOCat::testing};
+
+            // Outputs are called one message at a time, so no lock is needed.
+            std::vector<std::string> received[THREADS];
+            bool mixed = false;
+            channel.signal_full.append([&](std::string_view msg, IOVrb, IOCat cat)
+            {
+                int t = msg[0] - '0';
+                if (t < 0 || t >= THREADS || cats[t] != cat)
+                {
+                    mixed = true;
+                    return;
+                }
+                received[t].emplace_back(msg);
+            });
+
+            std::vector<std::thread> threads;
+            for (int t = 0; t < THREADS; ++t)
+            {
+                threads.emplace_back([&channel, &cats, t]()
+                {
+                    for (int i = 0; i < MESSAGES; ++i)
+                    {
+                        channel << cats[t] << t << " sends " << i
+                                << " of " << MESSAGES << "." << IOCtrl::end;
+                    }
+                });
+            }
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+            channel.drain();
+
+            PL_ASSERT_FALSE(mixed);
+            for (int t = 0; t < THREADS; ++t)
+            {
+                PL_ASSERT_EQUAL(received[t].size(), static_cast<size_t>(MESSAGES));
+                for (int i = 0; i < MESSAGES; ++i)
+                {
+                    PL_ASSERT_EQUAL(received[t][i], std::to_string(t) + " sends "
+                        + std::to_string(i) + " of " + std::to_string(MESSAGES) + ".");
+                }
+            }
+            return true;
+        }
+
+    public:
+        TestIOChannel_Threads(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Threads";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send multi-part messages to one channel from several threads at once, both synchronously and asynchronously, and check that none are lost or mixed together.";
+        }
+
+        bool run() override
+        {
+            iochannel sync;
+            sync.configure_echo(IOEchoMode::none);
+            PL_ASSERT_TRUE(send_from_threads(sync));
+
+            iochannel async;
+            async.configure_echo(IOEchoMode::none);
+            async.configure_async(IOBackpressure::block, 64);
+            PL_ASSERT_TRUE(send_from_threads(async));
+            return true;
+        }
+};
+
+// P-tB2007
+class TestIOChannel_Numbers : public Test
+{
+    protected:
+        iochannel channel;
+        std::string last;
+
+    public:
+        TestIOChannel_Numbers(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Numbers";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send integers in several bases and floats in several formats, and check the text of each.";
+        }
+
+        bool pre() override
+        {
+            channel.configure_echo(IOEchoMode::none);
+            channel.signal_all.append([this](std::string_view msg){ last = std::string(msg); });
+            return true;
+        }
+
+        template <typename T>
+        std::string& send(const T& val)
+        {
+            channel << val << IOCtrl::end;
+            return last;
+        }
+
+        bool run() override
+        {
+            PL_ASSERT_EQUAL(send(0), "0");
+            PL_ASSERT_EQUAL(send(-42), "-42");
+            PL_ASSERT_EQUAL(send(1234567890), "1234567890");
+            PL_ASSERT_EQUAL(send(std::numeric_limits<long long>::min()), "-9223372036854775808");
+            PL_ASSERT_EQUAL(send(std::numeric_limits<unsigned long long>::max()), "18446744073709551615");
+            PL_ASSERT_EQUAL(send(static_cast<unsigned char>(200)), "200");
+            PL_ASSERT_EQUAL(send(static_cast<short>(-32768)), "-32768");
+
+            channel << IOFormatBase::hex << IOFormatNumCase::lower << 255 << " " << IOFormatNumCase::upper
+                    << 255 << " " << IOFormatBase::bin << -5 << IOCtrl::end;
+            PL_ASSERT_EQUAL(last, "ff FF -101");
+
+            PL_ASSERT_EQUAL(send(0.1), "0.1");
+            PL_ASSERT_EQUAL(send(-2.5), "-2.5");
+            PL_ASSERT_EQUAL(send(3.0), "3");
+            PL_ASSERT_EQUAL(send(1.0 / 3), "0.33333333333333");
+            PL_ASSERT_EQUAL(send(0.00123), "0.00123");
+            PL_ASSERT_EQUAL(send(1e20), "1e+20");
+            PL_ASSERT_EQUAL(send(-2.5e-12), "-2.5e-12");
+            PL_ASSERT_EQUAL(send(12345.12345678912345f), "12345.123");
+            PL_ASSERT_EQUAL(send(0.1L), "0.1");
+
+            channel << IOFormatSignificands(2) << 9.999 << " "
+                    << IOFormatSciNotation::on << 12345.678 << " "
+                    << IOFormatSciNotation::none << 1e20 << IOCtrl::end;
+            PL_ASSERT_EQUAL(last, "10 1.23e+4 100000000000000000000");
+
+            PL_ASSERT_EQUAL(send(std::numeric_limits<double>::infinity()), "Inf");
+            PL_ASSERT_EQUAL(send(-std::numeric_limits<double>::infinity()), "-Inf");
+            PL_ASSERT_EQUAL(send(std::numeric_limits<double>::quiet_NaN()), "NaN");
+            return true;
+        }
+};
+
+// P-tB2008*
+class TestIOChannel_TelemetrySnprintf : public Test
+{
+    protected:
+        std::string line;
+        int count = 0;
+
+    public:
+        TestIOChannel_TelemetrySnprintf(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Telemetry Line (snprintf)";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Format a line of eight integers and eight doubles with snprintf, appending each to a std::string.";
+        }
+
+        bool run() override
+        {
+            char buffer[64];
+            line.clear();
+            ++count;
+            for (int i = 0; i < 8; ++i)
+            {
+                line.append(buffer, snprintf(buffer, sizeof(buffer), "%d ", count * 7919 + i));
+                line.append(buffer, snprintf(buffer, sizeof(buffer), "%.14g ", count * 0.3125 + i / 3.0));
+            }
+            return true;
+        }
+};
+
+// P-tB2008
+class TestIOChannel_Telemetry : public Test
+{
+    protected:
+        iochannel channel;
+        int count = 0;
+
+    public:
+        TestIOChannel_Telemetry(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Telemetry Line";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send a line of eight integers and eight doubles through IOChannel.";
+        }
+
+        bool pre() override
+        {
+            channel.configure_echo(IOEchoMode::none);
+            return true;
+        }
+
+        bool run() override
+        {
+            ++count;
+            for (int i = 0; i < 8; ++i)
+            {
+                channel << count * 7919 + i << " " << count * 0.3125 + i / 3.0 << " ";
+            }
+            channel << IOCtrl::end;
+            return true;
+        }
+};
+
+// P-tB2009
+class TestIOChannel_Log : public Test
+{
+    public:
+        TestIOChannel_Log(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: log()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send messages with log() and format strings, checking the text, verbosity, and category of each, and that silenced ones are skipped.";
+        }
+
+        bool run() override
+        {
+            iochannel channel;
+            channel.configure_echo(IOEchoMode::none);
+
+            std::vector<std::string> seen;
+            IOVrb vrb = IOVrb::normal;
+            IOCat cat = IOCat::normal;
+            channel.signal_full.append([&](std::string_view msg, IOVrb v, IOCat c)
+            {
+                seen.emplace_back(msg);
+                vrb = v;
+                cat = c;
+            });
+
+            channel.log(IOFMT("Plain text."));
+            PL_ASSERT_EQUAL(seen.back(), "Plain text.");
+
+            channel.log<IOVrb::chatty, IOCat::warning>(IOFMT("{} of {} is {}%"), 3, 4u, 75.5);
+            PL_ASSERT_EQUAL(seen.back(), "3 of 4 is 75.5%");
+            PL_ASSERT_TRUE(vrb == IOVrb::chatty);
+            PL_ASSERT_TRUE(cat == IOCat::warning);
+
+            std::string name = "fox";
+            channel.log(IOFMT("{{{}}} {} {} {} {} {}}}"), "quick", name, std::string_view("brown"),
+                        onestring("🦊"), true, 'x');
+            PL_ASSERT_EQUAL(seen.back(), "{quick} fox brown 🦊 true x}");
+
+            channel.log(IOFMT("{:x} {:X} {:o} {:b} {:.2} {:e} {:.3e}"),
+                        255, 255ull, 8, -5, 3.14159, 1500.0, 0.000123456f);
+            PL_ASSERT_EQUAL(seen.back(), "ff FF 10 -101 3.14 1.5e+3 1.235e-4");
+
+            // A message being built with << is left alone.
+            channel << IOCat::error << "Half ";
+            channel.log(IOFMT("Between"));
+            channel << "done." << IOCtrl::end;
+            PL_ASSERT_EQUAL(seen[seen.size() - 2], "Between");
+            PL_ASSERT_EQUAL(seen.back(), "Half done.");
+            PL_ASSERT_TRUE(cat == IOCat::error);
+
+            size_t before = seen.size();
+            channel.shutup(IOCat::debug);
+            channel.shutup(IOVrb::chatty);
+            channel.log<IOVrb::normal, IOCat::debug>(IOFMT("{}"), 1);
+            channel.log<IOVrb::tmi, IOCat::normal>(IOFMT("{}"), 2);
+            PL_ASSERT_EQUAL(seen.size(), before);
+            channel.log<IOVrb::chatty, IOCat::normal>(IOFMT("{}"), 3);
+            PL_ASSERT_EQUAL(seen.back(), "3");
+            return true;
+        }
+};
+
+// P-tB2010
+class TestIOChannel_LogDeferred : public Test
+{
+    public:
+        TestIOChannel_LogDeferred(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: log() (Deferred)";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send messages with log() while the channel defers formatting to its writer thread, and check they come out the same as when formatted right away.";
+        }
+
+        void send(iochannel& channel)
+        {
+            std::string temp = "a temporary";
+            for (int i = 0; i < 100; ++i)
+            {
+                channel.log<IOVrb::normal, IOCat::debug>(IOFMT("#{} {:x} {:.2} {} {} {} {}"),
+                    i, static_cast<unsigned short>(i * 1000), i / 7.0, i % 2 == 0,
+                    static_cast<char>('a' + i % 26), temp + " string", 1.5L);
+            }
+        }
+
+        bool run() override
+        {
+            std::vector<std::string> expect;
+            std::vector<std::string> seen;
+
+            iochannel sync;
+            sync.configure_echo(IOEchoMode::none);
+            sync.signal_all.append([&](std::string_view msg){ expect.emplace_back(msg); });
+            send(sync);
+
+            iochannel deferred;
+            deferred.configure_echo(IOEchoMode::none);
+            deferred.signal_all.append([&](std::string_view msg){ seen.emplace_back(msg); });
+            deferred.configure_async();
+            deferred.configure_deferred();
+            send(deferred);
+            deferred.drain();
+
+            PL_ASSERT_EQUAL(expect.size(), 100u);
+            PL_ASSERT_EQUAL(expect[10], "#10 2710 1.43 true k a temporary string 1.5");
+            PL_ASSERT_TRUE(seen == expect);
+            return true;
+        }
+};
+
+// P-tB2011*
+class TestIOChannel_StreamLine : public TestIOChannel_SendSync
+{
+    public:
+        TestIOChannel_StreamLine(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Send with << (Asynchronous)";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send a message of four numbers and a string by chaining <<, queueing it for the writer thread.";
+        }
+
+        bool pre() override
+        {
+            TestIOChannel_SendSync::pre();
+            channel.configure_async();
+            return true;
+        }
+
+        bool post() override
+        {
+            channel.configure_sync();
+            return TestIOChannel_SendSync::post();
+        }
+
+        bool run() override
+        {
+            channel << IOVrb::chatty << IOCat::debug << "Frame " << 1234 << " took "
+                    << 16.667 << " ms, " << 42u << " draws, " << -7 << " " << "ok" << IOCtrl::end;
+            return true;
+        }
+};
+
+// P-tB2011
+class TestIOChannel_LogLine : public TestIOChannel_StreamLine
+{
+    public:
+        TestIOChannel_LogLine(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Send with log() (Deferred)";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send a message of four numbers and a string with log(), packing the arguments for the writer thread to format.";
+        }
+
+        bool pre() override
+        {
+            TestIOChannel_StreamLine::pre();
+            channel.configure_deferred();
+            return true;
+        }
+
+        bool run() override
+        {
+            channel.log<IOVrb::chatty, IOCat::debug>(IOFMT("Frame {} took {} ms, {} draws, {} {}"),
+                1234, 16.667, 42u, -7, "ok");
+            return true;
+        }
+};
+
+// P-tB2012
+class TestIOChannel_Elision : public Test
+{
+    protected:
+        int evaluated = 0;
+
+        int expensive()
+        {
+            ++evaluated;
+            return 42;
+        }
+
+    public:
+        TestIOChannel_Elision(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Skipping Silenced Messages";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send messages with IOC() and IOLOG(), and check that their arguments are only evaluated when the message would be sent.";
+        }
+
+        bool run() override
+        {
+            static_assert(iochannel::compiled_in(IOVrb::tmi, IOCat::debug),
+                          "Everything is compiled in by default.");
+            static_assert(!iochannel::compiled_in(IOVrb::tmi, IOCat::none),
+                          "No category is never compiled in.");
+
+            iochannel channel;
+            channel.configure_echo(IOEchoMode::none);
+            std::vector<std::string> seen;
+            channel.signal_all.append([&](std::string_view msg){ seen.emplace_back(msg); });
+
+            evaluated = 0;
+            IOC(channel, IOVrb::tmi, IOCat::debug) << "Value: " << expensive() << IOCtrl::end;
+            IOLOG(channel, IOVrb::tmi, IOCat::debug, IOFMT("Value: {}"), expensive());
+            PL_ASSERT_EQUAL(evaluated, 2);
+            PL_ASSERT_EQUAL(seen.size(), 2u);
+            PL_ASSERT_EQUAL(seen[0], "Value: 42");
+            PL_ASSERT_EQUAL(seen[1], "Value: 42");
+
+            channel.shutup(IOVrb::normal);
+            channel.shutup(IOCat::warning);
+            IOC(channel, IOVrb::tmi, IOCat::debug) << "Value: " << expensive() << IOCtrl::end;
+            IOLOG(channel, IOVrb::tmi, IOCat::debug, IOFMT("Value: {}"), expensive());
+            IOC(channel, IOVrb::normal, IOCat::warning) << expensive() << IOCtrl::end;
+            PL_ASSERT_EQUAL(evaluated, 2);
+            PL_ASSERT_EQUAL(seen.size(), 2u);
+
+            // IOC() is a whole statement, so an else can't attach to it.
+            bool toggle = true;
+            if (toggle)
+                IOC(channel, IOVrb::normal, IOCat::normal) << "Then" << IOCtrl::end;
+            else
+                IOC(channel, IOVrb::normal, IOCat::normal) << "Else" << IOCtrl::end;
+            PL_ASSERT_EQUAL(seen.back(), "Then");
+
+            channel.speakup(IOCat::warning);
+            channel.speakup(IOVrb::chatty);
+            PL_ASSERT_TRUE(channel.permits(IOVrb::chatty, IOCat::warning));
+            PL_ASSERT_FALSE(channel.permits(IOVrb::tmi, IOCat::warning));
+            channel.speakup();
+            PL_ASSERT_TRUE(channel.permits(IOVrb::tmi, IOCat::testing));
+            return true;
+        }
+};
+
+// P-tB2013*
+class TestIOChannel_SilencedStream : public Test
+{
+    protected:
+        iochannel channel;
+        std::vector<double> samples;
+
+        double mean() const
+        {
+            double total = 0;
+            for (double sample : samples)
+            {
+                total += sample;
+            }
+            return total / samples.size();
+        }
+
+    public:
+        TestIOChannel_SilencedStream(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Silenced Message with <<";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send a silenced TMI debug message with plain <<, which still works out the mean of 1024 samples to pass in.";
+        }
+
+        bool pre() override
+        {
+            channel.configure_echo(IOEchoMode::none);
+            channel.shutup(IOVrb::normal);
+            samples.assign(1024, 0.5);
+            return true;
+        }
+
+        bool run() override
+        {
+            channel << IOVrb::tmi << IOCat::debug << "Mean: " << mean()
+                    << " of " << samples.size() << IOCtrl::end;
+            return true;
+        }
+};
+
+// P-tB2013
+class TestIOChannel_SilencedIOC : public TestIOChannel_SilencedStream
+{
+    public:
+        TestIOChannel_SilencedIOC(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Silenced Message with IOC()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send a silenced TMI debug message with IOC(), which checks once and skips working out the mean.";
+        }
+
+        bool run() override
+        {
+            IOC(channel, IOVrb::tmi, IOCat::debug) << "Mean: " << mean()
+                << " of " << samples.size() << IOCtrl::end;
+            return true;
+        }
+};
+
+// P-tB2014
+class TestIOChannel_FileSink : public Test
+{
+    protected:
+        std::string path;
+
+        void remove_files()
+        {
+            std::remove(path.c_str());
+            for (int i = 1; i <= 3; ++i)
+            {
+                std::remove((path + "." + std::to_string(i)).c_str());
+            }
+        }
+
+    public:
+        TestIOChannel_FileSink()
+        : path(sink_test_path("filesink"))
+        {}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: File Sink";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Write lines to a file sink that rotates by size and keeps two old files, then rotate it by age.";
+        }
+
+        bool janitor() override
+        {
+            remove_files();
+            return true;
+        }
+
+        bool run() override
+        {
+            iochannel channel;
+            channel.configure_echo(IOEchoMode::none);
+            std::string expect;
+            {
+                IOFileSink sink(path);
+                sink.configure_rotation(200, std::chrono::steady_clock::duration::zero(), 2);
+                sink.attach(channel, IOVrb::normal);
+
+                for (int i = 0; i < 100; ++i)
+                {
+                    std::string line = "Line " + std::to_string(i) + "\n";
+                    channel << line << IOCtrl::end;
+                    expect.append(line);
+                }
+                // Too verbose for the sink.
+                channel << IOVrb::tmi << "Skipped\n" << IOCtrl::end;
+
+                // Nothing reaches the file until a batch is written.
+                PL_ASSERT_TRUE(sink_test_read(path).empty());
+                sink.flush();
+                PL_ASSERT_EQUAL(sink.errors(), 0u);
+            }
+
+            std::string current = sink_test_read(path);
+            std::string older = sink_test_read(path + ".1");
+            std::string oldest = sink_test_read(path + ".2");
+            PL_ASSERT_LESS_EQUAL(current.size(), 200u);
+            PL_ASSERT_LESS_EQUAL(older.size(), 200u);
+            PL_ASSERT_GREATER(oldest.size(), 0u);
+            PL_ASSERT_TRUE(sink_test_read(path + ".3").empty());
+
+            // The files are the last of the output, split between lines.
+            std::string kept = oldest + older + current;
+            PL_ASSERT_EQUAL(kept, expect.substr(expect.size() - kept.size()));
+            PL_ASSERT_EQUAL(older.back(), '\n');
+
+            IOFileSink aged(path);
+            aged.configure_rotation(0, std::chrono::milliseconds(20), 2);
+            aged.write("Before\n");
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+            aged.write("After\n");
+            aged.flush();
+            PL_ASSERT_EQUAL(sink_test_read(path), "After\n");
+            PL_ASSERT_EQUAL(sink_test_read(path + ".1"), current + "Before\n");
+            return true;
+        }
+
+        ~TestIOChannel_FileSink()
+        {
+            remove_files();
+        }
+};
+
+// P-tB2015
+class TestIOChannel_BlockSink : public Test
+{
+    protected:
+        std::string path;
+
+    public:
+        TestIOChannel_BlockSink()
+        : path(sink_test_path("blocksink"))
+        {}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Block Sink";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Write lines through a block sink with 8 KB blocks, flushing partway, and check the file matches at each point.";
+        }
+
+        bool run() override
+        {
+            iochannel channel;
+            channel.configure_echo(IOEchoMode::none);
+            std::string expect;
+            {
+                IOBlockSink sink(path, 8192);
+                sink.attach(channel);
+                for (int i = 0; i < 3000; ++i)
+                {
+                    channel << "Block line " << i << "\n" << IOCtrl::end;
+                    expect.append("Block line " + std::to_string(i) + "\n");
+
+                    // A flush pads out the partial block, then cuts it back.
+                    if (i == 1234)
+                    {
+                        sink.flush();
+                        PL_ASSERT_TRUE(sink_test_read(path) == expect);
+                    }
+                }
+                PL_ASSERT_EQUAL(sink.errors(), 0u);
+            }
+            PL_ASSERT_TRUE(sink_test_read(path) == expect);
+            return true;
+        }
+
+        ~TestIOChannel_BlockSink()
+        {
+            std::remove(path.c_str());
+        }
+};
+
+// P-tB2016
+class TestIOChannel_RingSink : public Test
+{
+    protected:
+        std::string path;
+
+    public:
+        TestIOChannel_RingSink()
+        : path(sink_test_path("ringsink"))
+        {}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Ring Sink";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Have a child process write to a 4 KB ring sink and die without flushing, then recover the last of its output.";
+        }
+
+        bool janitor() override
+        {
+            std::remove(path.c_str());
+            return true;
+        }
+
+        bool run() override
+        {
+            pid_t child = fork();
+            PL_ASSERT_NOT_EQUAL(child, -1);
+            if (child == 0)
+            {
+                iochannel channel;
+                channel.configure_echo(IOEchoMode::none);
+                IORingSink* sink = new IORingSink(path, 4096);
+                sink->attach(channel);
+                for (int i = 0; i < 1000; ++i)
+                {
+                    channel << "Ring line " << i << "\n" << IOCtrl::end;
+                }
+                // Die without cleaning up.
+                _exit(0);
+            }
+            int status;
+            waitpid(child, &status, 0);
+
+            std::string kept = IORingSink::recover(path);
+            PL_ASSERT_LESS_EQUAL(kept.size(), 4096u);
+            PL_ASSERT_GREATER(kept.size(), 4000u);
+            PL_ASSERT_EQUAL(kept.substr(0, 10), "Ring line ");
+            PL_ASSERT_EQUAL(kept.substr(kept.size() - 14), "Ring line 999\n");
+
+            // A new sink on the same file carries on after the old output.
+            {
+                IORingSink sink(path, 4096);
+                sink.write("Restarted\n");
+                sink.flush();
+            }
+            kept = IORingSink::recover(path);
+            PL_ASSERT_EQUAL(kept.substr(kept.size() - 24), "Ring line 999\nRestarted\n");
+            return true;
+        }
+
+        ~TestIOChannel_RingSink()
+        {
+            std::remove(path.c_str());
+        }
+};
+
+// P-tB2017*
+class TestIOChannel_LineWrites : public Test
+{
+    protected:
+        std::string path;
+        iochannel channel;
+        FILE* file = nullptr;
+        iochannel::IOSignalFull::Handle handle;
+        int frame = 0;
+
+    public:
+        TestIOChannel_LineWrites()
+        : path(sink_test_path("linewrites"))
+        {}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Log File with a Write per Line";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send a line to a log file through a signal_full callback that writes and flushes each one.";
+        }
+
+        bool pre() override
+        {
+            channel.configure_echo(IOEchoMode::none);
+            file = fopen(path.c_str(), "wb");
+            if (file == nullptr) { return false; }
+            handle = channel.signal_full.append([this](std::string_view msg, IOVrb, IOCat)
+            {
+                fwrite(msg.data(), 1, msg.size(), file);
+                fflush(file);
+            });
+            return true;
+        }
+
+        bool run() override
+        {
+            channel << "Frame " << ++frame << " rendered\n" << IOCtrl::end;
+            return true;
+        }
+
+        bool post() override
+        {
+            channel.signal_full.remove(handle);
+            fclose(file);
+            file = nullptr;
+            std::remove(path.c_str());
+            return true;
+        }
+};
+
+// P-tB2017
+class TestIOChannel_FileSinkWrites : public Test
+{
+    protected:
+        std::string path;
+        iochannel channel;
+        std::unique_ptr<IOFileSink> sink;
+        int frame = 0;
+
+    public:
+        TestIOChannel_FileSinkWrites()
+        : path(sink_test_path("sinkwrites"))
+        {}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Log File with a File Sink";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send a line to a log file through an IOFileSink, which writes 64 KB at a time.";
+        }
+
+        bool pre() override
+        {
+            channel.configure_echo(IOEchoMode::none);
+            sink.reset(new IOFileSink(path));
+            sink->attach(channel);
+            return true;
+        }
+
+        bool run() override
+        {
+            channel << "Frame " << ++frame << " rendered\n" << IOCtrl::end;
+            return true;
+        }
+
+        bool post() override
+        {
+            sink.reset();
+            std::remove(path.c_str());
+            return true;
+        }
+};
+
+// P-tB2018
+class TestIOChannel_BinaryLog : public Test
+{
+    protected:
+        struct Sent
+        {
+            std::string text;
+            IOVrb vrb;
+            IOCat cat;
+        };
+
+        std::string path;
+
+        void remove_files()
+        {
+            std::remove(path.c_str());
+            std::remove((path + ".1").c_str());
+            std::remove((path + ".2").c_str());
+        }
+
+    public:
+        TestIOChannel_BinaryLog()
+        : path(sink_test_path("binarylog"))
+        {}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Binary Log";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send log() and << messages to a binary sink, read them back as text and JSON, with and without filters, and check the log is smaller than the text, and that a malformed record leaves the rest readable.";
+        }
+
+        bool janitor() override
+        {
+            remove_files();
+            return true;
+        }
+
+        bool run() override
+        {
+            iochannel channel;
+            channel.configure_echo(IOEchoMode::none);
+            std::vector<Sent> sent;
+            channel.signal_full.append([&sent](std::string_view msg, IOVrb vrb, IOCat cat)
+            {
+                sent.push_back(Sent{std::string(msg), vrb, cat});
+            });
+
+            int64_t before = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            {
+                IOBinarySink sink(path);
+                sink.attach(channel);
+                for (int i = 0; i < 1000; ++i)
+                {
+                    channel.log(IOFMT("Frame {} took {:.2} ms\n"), i, 16.6667 + i);
+                    if (i % 100 == 0)
+                    {
+                        channel.log<IOVrb::chatty, IOCat::debug>(
+                            IOFMT("\"{}\" is {:x} ({}, {}, {}) {}\n"),
+                            "Node", 255u + i, true, 'c', -12345678901LL, 1.5L);
+                        channel << IOCat::warning << "Plain " << i << IOCtrl::endl;
+                    }
+                }
+                PL_ASSERT_EQUAL(sink.errors(), 0u);
+            }
+
+            std::string log = sink_test_read(path);
+            IOBinaryReader reader(log);
+            IOBinaryRecord rec;
+            std::string rendered;
+            size_t count = 0;
+            while (reader.next(rec))
+            {
+                PL_ASSERT_LESS(count, sent.size());
+                PL_ASSERT_TRUE(rec.text == sent[count].text && rec.vrb == sent[count].vrb
+                               && rec.cat == sent[count].cat && rec.time >= before);
+                IOBinaryReader::render_text(rec, rendered);
+                ++count;
+            }
+            PL_ASSERT_FALSE(reader.failed());
+            PL_ASSERT_EQUAL(count, sent.size());
+            PL_ASSERT_EQUAL(count, 1020u);
+
+            // Even against the text without timestamps, it's much smaller.
+            size_t text_size = 0;
+            for (const Sent& msg : sent)
+            {
+                text_size += msg.text.size();
+            }
+            PL_ASSERT_LESS(log.size() * 3, rendered.size());
+            PL_ASSERT_LESS(log.size(), text_size);
+
+            IOBinaryReader filtered(log, IOVrb::normal, IOCat::warning);
+            count = 0;
+            while (filtered.next(rec))
+            {
+                PL_ASSERT_TRUE(rec.cat == IOCat::warning);
+                ++count;
+            }
+            PL_ASSERT_EQUAL(count, 10u);
+
+            IOBinaryReader debug(log, IOVrb::tmi, IOCat::debug);
+            PL_ASSERT_TRUE(debug.next(rec));
+            std::string json;
+            IOBinaryReader::render_json(rec, json);
+            PL_ASSERT_NOT_EQUAL(json.find("\"vrb\":\"chatty\",\"cat\":\"debug\",\"msg\":\"\\\"Node\\\" is ff (true, c, -12345678901) 1.5\"}\n"),
+                                std::string::npos);
+
+            // Each rotated file has its own string table.
+            remove_files();
+            {
+                IOBinarySink sink(path);
+                sink.configure_rotation(100, std::chrono::steady_clock::duration::zero(), 2);
+                sink.attach(channel);
+                for (int i = 0; i < 30; ++i)
+                {
+                    channel.log(IOFMT("Rotated {}\n"), i);
+                }
+            }
+            std::string newer = sink_test_read(path);
+            std::string older = sink_test_read(path + ".1");
+            PL_ASSERT_LESS_EQUAL(newer.size(), 100u);
+            IOBinaryReader first(older);
+            PL_ASSERT_TRUE(first.next(rec));
+            IOBinaryReader last(newer);
+            std::string final_text;
+            while (last.next(rec))
+            {
+                final_text = rec.text;
+            }
+            PL_ASSERT_FALSE(last.failed());
+            PL_ASSERT_EQUAL(final_text, "Rotated 29\n");
+
+            /* A malformed record is skipped without a trace, even when it
+             * is the first to use its format string. */
+            auto send = [](iochannel& to, int i){ to.log(IOFMT("Kept {}\n"), i); };
+            const IOFormatString* kept = nullptr;
+            iochannel other;
+            other.configure_echo(IOEchoMode::none);
+            other.signal_record.append([&kept](std::string_view, IOVrb, IOCat,
+                                               const IOFormatString* format)
+            {
+                kept = format;
+            });
+            send(other, 0);
+            PL_ASSERT_TRUE(kept != nullptr);
+
+            remove_files();
+            {
+                IOBinarySink sink(path);
+                sink.attach(channel);
+                channel.signal_record(std::string_view("\x7f", 1), IOVrb::normal,
+                                      IOCat::normal, kept);
+                PL_ASSERT_EQUAL(sink.errors(), 1u);
+                send(channel, 1);
+                channel << "Plain" << IOCtrl::endl;
+            }
+            log = sink_test_read(path);
+            IOBinaryReader after(log);
+            PL_ASSERT_TRUE(after.next(rec));
+            PL_ASSERT_EQUAL(rec.text, "Kept 1\n");
+            PL_ASSERT_TRUE(rec.time >= before);
+            PL_ASSERT_TRUE(after.next(rec));
+            PL_ASSERT_EQUAL(rec.text, "Plain\n");
+            PL_ASSERT_FALSE(after.next(rec));
+            PL_ASSERT_FALSE(after.failed());
+            return true;
+        }
+
+        ~TestIOChannel_BinaryLog()
+        {
+            remove_files();
+        }
+};
+
+// P-tB2019*
+class TestIOChannel_TextLog : public Test
+{
+    protected:
+        std::string path;
+        iochannel channel;
+        std::unique_ptr<IOSink> sink;
+        int frame = 0;
+
+        virtual IOSink* make_sink()
+        {
+            return new IOFileSink(path);
+        }
+
+    public:
+        TestIOChannel_TextLog()
+        : path(sink_test_path("textlog"))
+        {}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: log() to a Text File Sink";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send a message with an integer, a float, and a string through log() to an IOFileSink, which formats it as text.";
+        }
+
+        bool pre() override
+        {
+            channel.configure_echo(IOEchoMode::none);
+            sink.reset(make_sink());
+            sink->attach(channel);
+            return true;
+        }
+
+        bool run() override
+        {
+            ++frame;
+            channel.log(IOFMT("Frame {} took {:.2} ms on {}\n"), frame, frame * 16.6667, "main");
+            return true;
+        }
+
+        bool post() override
+        {
+            sink.reset();
+            std::remove(path.c_str());
+            return true;
+        }
+};
+
+// P-tB2019
+class TestIOChannel_BinaryLogWrites : public TestIOChannel_TextLog
+{
+    protected:
+        IOSink* make_sink() override
+        {
+            return new IOBinarySink(path);
+        }
+
+    public:
+        TestIOChannel_BinaryLogWrites(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: log() to a Binary Sink";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send a message with an integer, a float, and a string through log() to an IOBinarySink, which records the arguments without formatting them.";
+        }
+};
+
+// P-tB2020
+class TestIOChannel_CategoryLimit : public Test
+{
+    public:
+        TestIOChannel_CategoryLimit(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Limiting a Category";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Limit the error category to a burst of three, flood it with IOC(), IOLOG(), and plain <<, and check that the rest are counted in a summary once the limit allows another.";
+        }
+
+        bool run() override
+        {
+            iochannel channel;
+            channel.configure_echo(IOEchoMode::none);
+            std::vector<std::string> seen;
+            channel.signal_all.append([&](std::string_view msg){ seen.emplace_back(msg); });
+
+            // Slow enough that nothing more is allowed during the test.
+            channel.configure_limit(IOCat::error, 0.001, 3);
+            int evaluated = 0;
+            for (int i = 0; i < 10; ++i)
+            {
+                IOC(channel, IOVrb::normal, IOCat::error) << "Error " << ++evaluated << IOCtrl::end;
+            }
+            PL_ASSERT_EQUAL(evaluated, 3);
+            PL_ASSERT_EQUAL(seen.size(), 3u);
+            PL_ASSERT_EQUAL(seen[2], "Error 3");
+
+            IOLOG(channel, IOVrb::normal, IOCat::error, IOFMT("Error {}"), ++evaluated);
+            channel.log<IOVrb::normal, IOCat::error>(IOFMT("Error"));
+            channel << IOCat::error << "Error" << IOCtrl::end;
+            PL_ASSERT_EQUAL(evaluated, 3);
+            PL_ASSERT_EQUAL(seen.size(), 3u);
+            PL_ASSERT_EQUAL(channel.suppressed(IOCat::error), 10u);
+
+            // Other categories are untouched.
+            IOC(channel, IOVrb::normal, IOCat::warning) << "Warning" << IOCtrl::end;
+            channel << IOCat::normal << "Normal" << IOCtrl::end;
+            PL_ASSERT_EQUAL(seen.size(), 5u);
+
+            // The next error let through owns up to the ones that weren't.
+            channel.configure_limit(IOCat::error, 1000, 1);
+            IOLOG(channel, IOVrb::normal, IOCat::error, IOFMT("Error {}"), 4);
+            PL_ASSERT_EQUAL(seen.size(), 7u);
+            PL_ASSERT_EQUAL(seen[5], "[Suppressed 10 error messages.]\n");
+            PL_ASSERT_EQUAL(seen[6], "Error 4");
+            PL_ASSERT_EQUAL(channel.suppressed(IOCat::error), 0u);
+
+            channel.remove_limit(IOCat::error);
+            for (int i = 0; i < 10; ++i)
+            {
+                IOC(channel, IOVrb::normal, IOCat::error) << "Error" << IOCtrl::end;
+            }
+            PL_ASSERT_EQUAL(seen.size(), 17u);
+            return true;
+        }
+};
+
+// P-tB2021
+class TestIOChannel_LineLimit : public Test
+{
+    protected:
+        iochannel channel;
+        std::vector<std::string> seen;
+        int evaluated = 0;
+
+        void noisy(int i)
+        {
+            IOC_LIMIT(channel, IOVrb::normal, IOCat::warning, IORateLimit(0.001, 2))
+                << "Noisy " << i << " " << ++evaluated << IOCtrl::end;
+        }
+
+        void quiet(int i)
+        {
+            IOLOG_LIMIT(channel, IOVrb::normal, IOCat::warning, IORateLimit(0.001, 5),
+                        IOFMT("Quiet {}"), i);
+        }
+
+    public:
+        TestIOChannel_LineLimit(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Limiting a Line";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Flood one line limited with IOC_LIMIT(), and check that another limited with IOLOG_LIMIT(), and the rest of the category, still get through.";
+        }
+
+        bool run() override
+        {
+            channel.configure_echo(IOEchoMode::none);
+            seen.clear();
+            channel.signal_all.append([this](std::string_view msg){ seen.emplace_back(msg); });
+
+            evaluated = 0;
+            for (int i = 0; i < 100; ++i)
+            {
+                noisy(i);
+            }
+            PL_ASSERT_EQUAL(evaluated, 2);
+            PL_ASSERT_EQUAL(seen.size(), 2u);
+
+            for (int i = 0; i < 5; ++i)
+            {
+                quiet(i);
+            }
+            IOC(channel, IOVrb::normal, IOCat::warning) << "Unlimited" << IOCtrl::end;
+            PL_ASSERT_EQUAL(seen.size(), 8u);
+            PL_ASSERT_EQUAL(seen[6], "Quiet 4");
+            PL_ASSERT_EQUAL(seen[7], "Unlimited");
+            quiet(5);
+            PL_ASSERT_EQUAL(seen.size(), 8u);
+            return true;
+        }
+};
+
+// P-tB2022
+class TestIOChannel_Sampling : public Test
+{
+    public:
+        TestIOChannel_Sampling(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Sampling a Category";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Sample the debug category one in four, send 8000 messages, and check that about a quarter get through and the rest are counted.";
+        }
+
+        bool run() override
+        {
+            iochannel channel;
+            channel.configure_echo(IOEchoMode::none);
+            size_t kept = 0;
+            size_t summarized = 0;
+            channel.signal_c_debug.append([&](std::string_view msg, IOVrb)
+            {
+                unsigned long count;
+                if (sscanf(std::string(msg).c_str(), "[Suppressed %lu", &count) == 1)
+                {
+                    summarized += count;
+                }
+                else
+                {
+                    ++kept;
+                }
+            });
+
+            channel.configure_limit(IOCat::debug, 0, 1, 4);
+            for (int i = 0; i < 8000; ++i)
+            {
+                IOLOG(channel, IOVrb::normal, IOCat::debug, IOFMT("Sample {}"), i);
+            }
+            PL_ASSERT_GREATER(kept, 1600u);
+            PL_ASSERT_LESS(kept, 2400u);
+            PL_ASSERT_EQUAL(kept + summarized + channel.suppressed(IOCat::debug), 8000u);
+
+            IORateLimit sample(0, 1, 4);
+            size_t admitted = 0;
+            for (int i = 0; i < 8000; ++i)
+            {
+                if (sample.admit()) { ++admitted; }
+            }
+            PL_ASSERT_EQUAL(admitted + sample.suppressed(), 8000u);
+            PL_ASSERT_GREATER(admitted, 1600u);
+            PL_ASSERT_LESS(admitted, 2400u);
+            return true;
+        }
+};
+
+// P-tB2023*
+class TestIOChannel_UnlimitedFlood : public Test
+{
+    protected:
+        iochannel channel;
+        std::string last;
+        int packet = 0;
+
+    public:
+        TestIOChannel_UnlimitedFlood(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Flooded Error with IOC()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send an error message with IOC() to a connected signal, with no limit on it.";
+        }
+
+        bool pre() override
+        {
+            channel.configure_echo(IOEchoMode::none);
+            channel.signal_c_error.append([this](std::string_view msg, IOVrb){ last = msg; });
+            return true;
+        }
+
+        bool run() override
+        {
+            ++packet;
+            IOC(channel, IOVrb::normal, IOCat::error) << "Bad packet " << packet
+                << " from " << "10.0.0.1" << IOCtrl::end;
+            return true;
+        }
+};
+
+// P-tB2023
+class TestIOChannel_LimitedFlood : public TestIOChannel_UnlimitedFlood
+{
+    public:
+        TestIOChannel_LimitedFlood(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Flooded Error with IOC_LIMIT()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send an error message with IOC_LIMIT(), limited to ten a second, so nearly every one is turned away before it is built.";
+        }
+
+        bool run() override
+        {
+            ++packet;
+            IOC_LIMIT(channel, IOVrb::normal, IOCat::error, IORateLimit(10, 10))
+                << "Bad packet " << packet << " from " << "10.0.0.1" << IOCtrl::end;
+            return true;
+        }
+};
+
+// P-tB2024
+class TestIOChannel_MemoryDump : public Test
+{
+    protected:
+        iochannel channel;
+        std::string last;
+
+        /// The dump memdump() always wrote, one byte at a time.
+        static std::string expected(const std::vector<uint8_t>& data, IOFormatMemSep sep)
+        {
+            bool bytespacing = static_cast<bool>(sep & IOFormatMemSep::byte);
+            bool wordspacing = static_cast<bool>(sep & IOFormatMemSep::word);
+            std::string out;
+            char pair[3];
+            for (size_t i = 0; i < data.size(); ++i)
+            {
+                snprintf(pair, sizeof(pair), "%02x", data[i]);
+                out += pair;
+                if (i == data.size() - 1) { break; }
+                if (bytespacing) { out += ' '; }
+                if (wordspacing && (i + 1) % 8 == 0)
+                {
+                    out += bytespacing ? "| " : "|";
+                }
+            }
+            return out;
+        }
+
+    public:
+        TestIOChannel_MemoryDump(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Memory Dumps";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Dump buffers of many sizes, up to several chunks, with each kind of separator, and check them against a dump made a byte at a time.";
+        }
+
+        bool pre() override
+        {
+            channel.configure_echo(IOEchoMode::none);
+            channel.signal_all.append([this](std::string_view msg){ last = std::string(msg); });
+            return true;
+        }
+
+        bool run() override
+        {
+            int foo = 12345;
+            channel << IOFormatPtr::memory << IOFormatMemSep::byte << &foo << IOCtrl::end;
+            PL_ASSERT_EQUAL(last, "39 30 00 00");
+
+            std::vector<uint8_t> data(200003);
+            for (size_t i = 0; i < data.size(); ++i)
+            {
+                data[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+            }
+
+            const IOFormatMemSep seps[] = {IOFormatMemSep::none, IOFormatMemSep::byte,
+                                           IOFormatMemSep::word, IOFormatMemSep::all};
+            const size_t sizes[] = {1, 7, 8, 9, 15, 16, 17, 31, 32, 33, 100, 65536, 200003};
+            for (IOFormatMemSep sep : seps)
+            {
+                for (size_t size : sizes)
+                {
+                    std::vector<uint8_t> part(data.begin(), data.begin() + size);
+                    channel << "<" << IOFormatPtr::memory << sep
+                            << IOMemReadSize(static_cast<unsigned int>(size))
+                            << static_cast<const void*>(part.data()) << IOCtrl::end;
+                    PL_ASSERT_TRUE(last == "<" + expected(part, sep));
+                    PL_ASSERT_EQUAL(stdutils::memdump_length(size, static_cast<char>(sep)),
+                                    last.size() - 1);
+                }
+            }
+
+            const uint8_t bytes[] = {0x00, 0x9f, 0xab, 0xff};
+            char hex[9] = {0};
+            stdutils::write_hex(hex, bytes, sizeof(bytes), true);
+            PL_ASSERT_EQUAL(std::string(hex), "009FABFF");
+
+            char dump[32] = "at ";
+            stdutils::memdump(dump, bytes, sizeof(bytes), false, 1);
+            PL_ASSERT_EQUAL(std::string(dump), "at 00 9f ab ff");
+
+            channel << IOFormatNumCase::lower << IOFormatBase::hex
+                    << std::numeric_limits<unsigned long long>::max() << " "
+                    << IOFormatBase::oct << 8 << " " << IOFormatBase::b32 << 1023 << " "
+                    << IOFormatBase::hex << 0 << IOCtrl::end;
+            PL_ASSERT_EQUAL(last, "ffffffffffffffff 10 vv 0");
+            return true;
+        }
+};
+
+// P-tB2025*
+class TestIOChannel_HexSnprintf : public Test
+{
+    protected:
+        std::vector<uint8_t> data;
+        std::string out;
+
+    public:
+        TestIOChannel_HexSnprintf(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Hex Dump of 64 KiB (snprintf)";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Write 64 KiB as hex with snprintf, a byte at a time, into a std::string.";
+        }
+
+        bool pre() override
+        {
+            data.assign(64 * 1024, 0);
+            for (size_t i = 0; i < data.size(); ++i)
+            {
+                data[i] = static_cast<uint8_t>(i * 31);
+            }
+            return true;
+        }
+
+        bool run() override
+        {
+            out.clear();
+            char pair[3];
+            for (uint8_t byte : data)
+            {
+                snprintf(pair, sizeof(pair), "%02x", byte);
+                out.append(pair, 2);
+            }
+            return true;
+        }
+};
+
+// P-tB2025
+class TestIOChannel_HexDump : public TestIOChannel_HexSnprintf
+{
+    protected:
+        iochannel channel;
+
+    public:
+        TestIOChannel_HexDump(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Hex Dump of 64 KiB";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send 64 KiB as a memory dump through IOChannel.";
+        }
+
+        bool pre() override
+        {
+            channel.configure_echo(IOEchoMode::none);
+            return TestIOChannel_HexSnprintf::pre();
+        }
+
+        bool run() override
+        {
+            channel << IOFormatPtr::memory << IOMemReadSize(static_cast<unsigned int>(data.size()))
+                    << static_cast<const void*>(data.data()) << IOCtrl::end;
+            return true;
+        }
+};
+
+/// Sends a message to a channel as the thread that made it ends.
+struct IOChannelFarewell
+{
+    iochannel* channel = nullptr;
+
+    ~IOChannelFarewell()
+    {
+        if (channel != nullptr)
+        {
+            *channel << "Farewell " << 42 << IOCtrl::end;
+        }
+    }
+};
+
+// P-tB2026
+class TestIOChannel_ThreadExit : public Test
+{
+    public:
+        TestIOChannel_ThreadExit(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Sending as a Thread Ends";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send from a thread-local destructor that runs after the thread's own message staging is freed, as a static destructor does on the main thread.";
+        }
+
+        bool run() override
+        {
+            iochannel channel;
+            channel.configure_echo(IOEchoMode::none);
+            std::vector<std::string> seen;
+            channel.signal_all.append([&](std::string_view msg){ seen.emplace_back(msg); });
+
+            std::thread ending([&channel]()
+            {
+                // Made before the staging, so it is destroyed after it.
+                thread_local IOChannelFarewell farewell;
+                farewell.channel = &channel;
+                channel << "Hello" << IOCtrl::end;
+            });
+            ending.join();
+
+            PL_ASSERT_EQUAL(seen.size(), 2u);
+            PL_ASSERT_EQUAL(seen[0], "Hello");
+            PL_ASSERT_EQUAL(seen[1], "Farewell 42");
+            return true;
+        }
+};
+
+// P-tB2027
+class TestIOChannel_SwitchModes : public Test
+{
+    public:
+        TestIOChannel_SwitchModes(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Switch Modes While Sending";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Switch between asynchronous and synchronous output over and over while several threads send, and check that every message arrives, in order per thread.";
+        }
+
+        bool run() override
+        {
+            const int THREADS = 4;
+            const int MESSAGES = 5000;
+
+            iochannel channel;
+            channel.configure_echo(IOEchoMode::none);
+            // Each sender's messages should arrive in the order sent.
+            std::vector<int> next(THREADS, 0);
+            bool ordered = true;
+            channel.signal_all.append([&next, &ordered](std::string_view msg)
+            {
+                int t = msg[0] - '0';
+                int n = std::stoi(std::string(msg.substr(2)));
+                ordered = ordered && (n == next[t]);
+                next[t] = n + 1;
+            });
+
+            std::atomic<int> running{THREADS};
+            std::vector<std::thread> senders;
+            for (int t = 0; t < THREADS; ++t)
+            {
+                senders.emplace_back([&channel, &running, t]()
+                {
+                    for (int i = 0; i < MESSAGES; ++i)
+                    {
+                        channel << t << " " << i << IOCtrl::end;
+                    }
+                    --running;
+                });
+            }
+
+            while (running.load() > 0)
+            {
+                channel.configure_async(IOBackpressure::block, 64);
+                std::this_thread::yield();
+                channel.configure_sync();
+            }
+            for (auto& sender : senders)
+            {
+                sender.join();
+            }
+
+            PL_ASSERT_TRUE(ordered);
+            for (int t = 0; t < THREADS; ++t)
+            {
+                PL_ASSERT_EQUAL(next[t], MESSAGES);
+            }
+            return true;
+        }
+};
+
+// P-tB2028
+class TestIOChannel_Reentry : public Test
+{
+    public:
+        TestIOChannel_Reentry(){}
+
+        testdoc_t get_title() override
+        {
+            return "IOChannel: Callbacks Sending to Their Own Channel";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Send to a channel from its own callbacks, synchronously and through a small blocking queue, and check that nothing deadlocks and every message arrives after the one that prompted it.";
+        }
+
+        bool run() override
+        {
+            iochannel channel;
+            channel.configure_echo(IOEchoMode::none);
+            std::vector<std::string> seen;
+            channel.signal_full.append([&](std::string_view msg, IOVrb, IOCat)
+            {
+                seen.emplace_back(msg);
+                // Answer each question, and the answers themselves log.
+                if(msg.substr(0, 3) == "Ask")
+                {
+                    channel << "Answer " << msg.substr(4) << IOCtrl::end;
+                    channel.log(IOFMT("Logged {}"), msg.substr(4));
+                }
+            });
+
+            channel << "Ask 1" << IOCtrl::end;
+            PL_ASSERT_EQUAL(seen.size(), 3u);
+            PL_ASSERT_EQUAL(seen[0], "Ask 1");
+            PL_ASSERT_EQUAL(seen[1], "Answer 1");
+            PL_ASSERT_EQUAL(seen[2], "Logged 1");
+
+            // The writer must not wait on a full queue only it can empty.
+            channel.configure_async(IOBackpressure::block, 4);
+            for(int i = 0; i < 100; ++i)
+            {
+                channel << "Ask " << i << IOCtrl::end;
+            }
+            channel.configure_sync();
+            PL_ASSERT_EQUAL(seen.size(), 303u);
+            PL_ASSERT_EQUAL(seen[300], "Ask 99");
+            PL_ASSERT_EQUAL(seen[301], "Answer 99");
+            PL_ASSERT_EQUAL(seen[302], "Logged 99");
+            return true;
+        }
+};
+
+class TestSuite_IOChannel : public TestSuite
+{
+    public:
+        explicit TestSuite_IOChannel(){}
+
+        void load_tests() override;
+
+        testdoc_t get_title() override
+        {
+            return "PawLIB: IOChannel Tests";
+        }
+};
+
+#endif // PAWLIB_IOCHANNEL_TESTS_HPP
@@ -0,0 +1,447 @@
+/** IOFormat Strings [PawLIB]
+  * Version: 0.1
+  *
+  * Format strings for IOChannel's log(), such as "{} of {:x}", which are
+  * parsed and checked against their arguments while compiling. A format
+  * string is written with the IOFMT() macro, which turns the literal into
+  * a type, so that its pieces can be worked out once as constants. The
+  * arguments can be formatted right away, or packed into a compact binary
+  * record and formatted later, on another thread or in another program.
+  *
+  * Author(s): Jason C. McDonald
+  */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2019 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+
+#ifndef PAWLIB_IOFMT_HPP
+#define PAWLIB_IOFMT_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "pawlib/onestring.hpp"
+#include "pawlib/onestring_view.hpp"
+
+/**Turn a string literal into a format string for iochannel::log().
+ * The literal becomes part of a type, so it can be checked while compiling.
+ * Use {} for each argument, and {{ or }} for a literal brace. An argument
+ * may be followed by a colon and a conversion:
+ * - {:x}, {:X}, {:o}, or {:b} prints an integer in hexadecimal (lowercase
+ *   or uppercase), octal, or binary.
+ * - {:.N} prints a float with at most N digits (0-99) after the point.
+ * - {:e} prints a float in scientific notation, as does {:.Ne}.
+ */
+#define IOFMT(text) \
+    ([]{ \
+        struct IOFMT_text \
+        { \
+            static constexpr std::string_view value() { return text; } \
+        }; \
+        return IOFMT_text{}; \
+    }())
+
+/**A run of literal text in a format string, and the argument after it,
+ * if there is one.*/
+struct IOFormatPiece
+{
+    /// Where the text starts in the format string
+    size_t at = 0;
+    /// The length of the text
+    size_t len = 0;
+    /// Whether an argument follows the text
+    bool arg = false;
+    /// The conversion, one of x X o b e, or 0 for the default
+    char spec = 0;
+    /// The most digits after the point for a float, or -1 for the default
+    int precision = -1;
+};
+
+/**A parsed format string. Each one is a constant, so a pointer to one
+ * stays good for the life of the program.*/
+struct IOFormatString
+{
+    /// The text of the format string
+    std::string_view text;
+    /// The pieces of the text, the last of which never has an argument
+    const IOFormatPiece* pieces;
+    /// The number of pieces
+    size_t count;
+};
+
+/**The kinds of arguments a format string can take, which are also the
+ * tags for arguments packed into a record.*/
+enum class IOArgType : uint8_t
+{
+    none = 0,
+    sint = 1,
+    uint = 2,
+    f32 = 3,
+    f64 = 4,
+    f80 = 5,
+    text = 6,
+    boolean = 7,
+    character = 8
+};
+
+class iofmt
+{
+    public:
+        /// What a format string's placeholders hold, as worked out by scan().
+        struct Summary
+        {
+            bool valid = true;
+            size_t args = 0;
+            size_t pieces = 0;
+        };
+
+        /**Walk a format string, checking it and optionally writing out
+         * its pieces.
+         * \param the format string
+         * \param where to write the pieces, or nullptr to only count them
+         * \return what was found */
+        static constexpr Summary scan(std::string_view text, IOFormatPiece* out = nullptr)
+        {
+            Summary found;
+            size_t start = 0;
+            size_t i = 0;
+            while (i < text.size())
+            {
+                char c = text[i];
+                if ((c == '{' || c == '}') && i + 1 < text.size() && text[i + 1] == c)
+                {
+                    // An escaped brace ends a piece, keeping one brace.
+                    add(out, found, start, i + 1 - start, false, 0, -1);
+                    i += 2;
+                    start = i;
+                }
+                else if (c == '}')
+                {
+                    found.valid = false;
+                    return found;
+                }
+                else if (c == '{')
+                {
+                    size_t close = text.find('}', i);
+                    if (close == std::string_view::npos)
+                    {
+                        found.valid = false;
+                        return found;
+                    }
+                    char spec = 0;
+                    int precision = -1;
+                    if (!parse_spec(text.substr(i + 1, close - i - 1), spec, precision))
+                    {
+                        found.valid = false;
+                        return found;
+                    }
+                    add(out, found, start, i - start, true, spec, precision);
+                    ++found.args;
+                    i = close + 1;
+                    start = i;
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+            add(out, found, start, text.size() - start, false, 0, -1);
+            return found;
+        }
+
+        /**Check each argument's conversion against its kind.
+         * \param the format string, which must be valid
+         * \param the kind of each argument
+         * \param the number of arguments
+         * \return true if every conversion fits its argument */
+        static constexpr bool fits(std::string_view text, const IOArgType* kinds, size_t count)
+        {
+            Summary found = scan(text);
+            if (!found.valid || found.args != count) { return false; }
+
+            // Walk it again, this time looking at each placeholder.
+            size_t arg = 0;
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                if (text[i] != '{') { continue; }
+                if (i + 1 < text.size() && text[i + 1] == '{')
+                {
+                    ++i;
+                    continue;
+                }
+                size_t close = text.find('}', i);
+                char spec = 0;
+                int precision = -1;
+                parse_spec(text.substr(i + 1, close - i - 1), spec, precision);
+                IOArgType kind = kinds[arg++];
+                bool integer = (kind == IOArgType::sint || kind == IOArgType::uint);
+                bool real = (kind == IOArgType::f32 || kind == IOArgType::f64
+                             || kind == IOArgType::f80);
+                if ((spec == 'x' || spec == 'X' || spec == 'o' || spec == 'b') && !integer)
+                {
+                    return false;
+                }
+                if ((spec == 'e' || precision >= 0) && !real)
+                {
+                    return false;
+                }
+                i = close;
+            }
+            return true;
+        }
+
+        /// \return the kind of argument a type is formatted as
+        template <typename T>
+        static constexpr IOArgType kind_of()
+        {
+            typedef typename std::decay<T>::type D;
+            if constexpr (std::is_same<D, bool>::value) { return IOArgType::boolean; }
+            else if constexpr (std::is_same<D, char>::value) { return IOArgType::character; }
+            else if constexpr (std::is_integral<D>::value && std::is_signed<D>::value) { return IOArgType::sint; }
+            else if constexpr (std::is_integral<D>::value) { return IOArgType::uint; }
+            else if constexpr (std::is_same<D, float>::value) { return IOArgType::f32; }
+            else if constexpr (std::is_same<D, double>::value) { return IOArgType::f64; }
+            else if constexpr (std::is_same<D, long double>::value) { return IOArgType::f80; }
+            else if constexpr (std::is_convertible<const D&, std::string_view>::value
+                               || std::is_convertible<const D&, onestring_view>::value)
+            {
+                return IOArgType::text;
+            }
+            else { return IOArgType::none; }
+        }
+
+        /// \return the pieces of a format string, which has N of them
+        template <size_t N>
+        static constexpr std::array<IOFormatPiece, N> layout(std::string_view text)
+        {
+            std::array<IOFormatPiece, N> out{};
+            scan(text, out.data());
+            return out;
+        }
+
+        /**The parsed form of a format string from IOFMT(). This is only
+         * worked out once per format string, while compiling.*/
+        template <typename F>
+        struct parsed
+        {
+            static constexpr std::string_view text = F::value();
+            static constexpr Summary summary = scan(text);
+
+            static constexpr std::array<IOFormatPiece, summary.pieces> pieces =
+                layout<summary.pieces>(text);
+            static constexpr IOFormatString string{text, pieces.data(), summary.pieces};
+        };
+
+        /**Check that a format string takes the given arguments. This
+         * fails to compile, with a message saying why, if it doesn't.*/
+        template <typename F, typename... Args>
+        static constexpr void check()
+        {
+            constexpr std::array<IOArgType, sizeof...(Args)> kinds{{kind_of<Args>()...}};
+            static_assert(parsed<F>::summary.valid,
+                "IOFMT: Bad format string. Use {} or {:spec} for arguments, and {{ or }} for braces.");
+            static_assert(parsed<F>::summary.args == sizeof...(Args),
+                "IOFMT: The number of {} does not match the number of arguments.");
+            static_assert(((kind_of<Args>() != IOArgType::none) && ... && true),
+                "IOFMT: An argument is not a number, bool, char, or string.");
+            static_assert(fits(parsed<F>::text, kinds.data(), sizeof...(Args)),
+                "IOFMT: A conversion does not fit its argument; x, X, o, and b are for integers, and e and .N are for floats.");
+        }
+
+        /**Append an argument to a message, as a piece of a format string
+         * says to.
+         * \param the message to append to
+         * \param the argument
+         * \param the piece the argument follows */
+        template <typename T>
+        static void append(std::string& out, const T& val, const IOFormatPiece& piece)
+        {
+            constexpr IOArgType kind = kind_of<T>();
+            if constexpr (kind == IOArgType::boolean) { out.append(val ? "true" : "false"); }
+            else if constexpr (kind == IOArgType::character) { out.push_back(val); }
+            else if constexpr (kind == IOArgType::sint) { append_int(out, static_cast<long long>(val), piece); }
+            else if constexpr (kind == IOArgType::uint) { append_int(out, static_cast<unsigned long long>(val), piece); }
+            else if constexpr (kind == IOArgType::f32 || kind == IOArgType::f64 || kind == IOArgType::f80)
+            {
+                append_float(out, val, piece);
+            }
+            else
+            {
+                std::string_view view = as_view(val);
+                out.append(view.data(), view.size());
+            }
+        }
+
+        /**Append an argument to a record, tagged with its kind, so it can
+         * be formatted later with format_packed().
+         * \param the record to append to
+         * \param the argument */
+        template <typename T>
+        static void pack(std::string& out, const T& val)
+        {
+            constexpr IOArgType kind = kind_of<T>();
+            out.push_back(static_cast<char>(kind));
+            if constexpr (kind == IOArgType::boolean) { out.push_back(val ? 1 : 0); }
+            else if constexpr (kind == IOArgType::character) { out.push_back(val); }
+            else if constexpr (kind == IOArgType::sint) { pack_raw(out, static_cast<long long>(val)); }
+            else if constexpr (kind == IOArgType::uint) { pack_raw(out, static_cast<unsigned long long>(val)); }
+            else if constexpr (kind == IOArgType::f32 || kind == IOArgType::f64 || kind == IOArgType::f80)
+            {
+                pack_raw(out, val);
+            }
+            else
+            {
+                std::string_view view = as_view(val);
+                pack_raw(out, view.size());
+                out.append(view.data(), view.size());
+            }
+        }
+
+        /**Format a message from a format string and its arguments.
+         * \param the message to append to
+         * \param the format string
+         * \param the arguments */
+        template <typename... Args>
+        static void format(std::string& out, const IOFormatString& fmt, const Args&... args)
+        {
+            size_t at = 0;
+            // Each argument is preceded by text, so take them in turn.
+            ((at = text_until_arg(out, fmt, at), append(out, args, fmt.pieces[at]), ++at), ...);
+            text_until_arg(out, fmt, at);
+        }
+
+        /**Format a message from a format string and a record of its
+         * arguments, made by pack(), as done on a writer thread or offline.
+         * \param the message to append to
+         * \param the format string
+         * \param the record of packed arguments
+         * \return false if the record is cut short or doesn't match */
+        static bool format_packed(std::string& out, const IOFormatString& fmt, std::string_view record);
+
+    protected:
+        static constexpr void add(IOFormatPiece* out, Summary& found, size_t at,
+                                  size_t len, bool arg, char spec, int precision)
+        {
+            if (out != nullptr)
+            {
+                IOFormatPiece& piece = out[found.pieces];
+                piece.at = at;
+                piece.len = len;
+                piece.arg = arg;
+                piece.spec = spec;
+                piece.precision = precision;
+            }
+            ++found.pieces;
+        }
+
+        /// Read what's between the braces of a placeholder.
+        static constexpr bool parse_spec(std::string_view spec, char& conv, int& precision)
+        {
+            if (spec.empty()) { return true; }
+            if (spec[0] != ':' || spec.size() == 1) { return false; }
+            size_t i = 1;
+            if (spec[i] == '.')
+            {
+                ++i;
+                precision = 0;
+                size_t digits = 0;
+                while (i < spec.size() && spec[i] >= '0' && spec[i] <= '9')
+                {
+                    precision = precision * 10 + (spec[i] - '0');
+                    ++i;
+                    ++digits;
+                }
+                if (digits == 0 || digits > 2) { return false; }
+            }
+            if (i < spec.size())
+            {
+                conv = spec[i++];
+                if (conv != 'x' && conv != 'X' && conv != 'o' && conv != 'b' && conv != 'e')
+                {
+                    return false;
+                }
+                // A precision only goes with floats.
+                if (precision >= 0 && conv != 'e') { return false; }
+            }
+            return i == spec.size();
+        }
+
+        /**Append the text pieces from the given one on, stopping at the
+         * first that is followed by an argument.
+         * \return the index of that piece */
+        static size_t text_until_arg(std::string& out, const IOFormatString& fmt, size_t at)
+        {
+            for (; at < fmt.count; ++at)
+            {
+                const IOFormatPiece& piece = fmt.pieces[at];
+                out.append(fmt.text.data() + piece.at, piece.len);
+                if (piece.arg) { break; }
+            }
+            return at;
+        }
+
+        template <typename T>
+        static std::string_view as_view(const T& val)
+        {
+            if constexpr (std::is_convertible<const T&, std::string_view>::value)
+            {
+                return std::string_view(val);
+            }
+            else
+            {
+                onestring_view view(val);
+                return std::string_view(view.data(), view.size());
+            }
+        }
+
+        template <typename T>
+        static void pack_raw(std::string& out, const T& val)
+        {
+            out.append(reinterpret_cast<const char*>(&val), sizeof(T));
+        }
+
+        static void append_int(std::string& out, long long val, const IOFormatPiece& piece);
+        static void append_int(std::string& out, unsigned long long val, const IOFormatPiece& piece);
+
+        template <typename T>
+        static void append_float(std::string& out, T val, const IOFormatPiece& piece);
+};
+
+#endif // PAWLIB_IOFMT_HPP
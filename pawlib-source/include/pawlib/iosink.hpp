@@ -0,0 +1,324 @@
+/** IOSinks [PawLIB]
+  * Version: 0.1
+  *
+  * Built-in outputs for IOChannel, which collect messages from its
+  * signal_full and write them out in batches, rather than a system call
+  * per message. IOFileSink is a buffered log file that can rotate by size
+  * and age, IOBlockSink writes in large aligned blocks (with O_DIRECT,
+  * where the system has it), and IORingSink keeps the most recent output
+  * in a memory-mapped file that survives the process dying.
+  *
+  * Author(s): Jason C. McDonald
+  */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2019 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef PAWLIB_IOSINK_HPP
+#define PAWLIB_IOSINK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "pawlib/iochannel.hpp"
+
+/**The base of the built-in outputs. A sink is attached to a channel's
+ * signal_full, and keeps what it is sent until it has enough to write
+ * out at once, or until flush() is called. Sending it messages and
+ * flushing it are safe from any thread.
+ */
+class IOSink
+{
+    public:
+        IOSink() = default;
+        IOSink(const IOSink&) = delete;
+        IOSink& operator=(const IOSink&) = delete;
+
+        virtual ~IOSink();
+
+        /** Start writing the messages a channel broadcasts. A sink can
+             * be attached to one channel at a time.
+             * \param the channel
+             * \param the most verbose messages to write
+             * \param the categories to write */
+        void attach(iochannel&, IOVrb = IOVrb::tmi, IOCat = IOCat::all);
+
+        /** Stop writing a channel's messages. If the channel is
+             * asynchronous, this waits for the writer to finish with
+             * everything already sent. */
+        void detach();
+
+        /** Take a message directly, without a channel.
+             * \param the message */
+        void write(std::string_view msg)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            store(msg);
+        }
+
+        /** Write out everything held so far. IOCtrl::flush does not reach
+             * sinks; this is the only way to push out a partial batch. */
+        void flush()
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            sync();
+        }
+
+        /// \return the number of writes that failed, losing their output
+        size_t errors() const { return error_count.load(std::memory_order_relaxed); }
+
+    protected:
+        /** Connect the sink to a channel's signals. By default, this
+             * connects it to signal_full.
+             * \param the channel
+             * \param the most verbose messages to write
+             * \param the categories to write */
+        virtual void hook(iochannel&, IOVrb, IOCat);
+
+        /** Disconnect the sink from what hook() connected it to.
+             * \param the channel */
+        virtual void unhook(iochannel&);
+
+        /** Keep a message, writing out a batch if one is ready. Called
+             * with the lock held.
+             * \param the message */
+        virtual void store(std::string_view) = 0;
+
+        /** Write out everything kept so far. Called with the lock held. */
+        virtual void sync() = 0;
+
+        /** Write a whole buffer to a file, retrying short writes.
+             * \param the file descriptor
+             * \param the data
+             * \param the number of bytes
+             * \param the file offset to write at, or -1 for the current one
+             * \return true if it was all written */
+        static bool write_all(int, const char*, size_t, int64_t = -1);
+
+        // Guards the sink's buffers against several senders at once.
+        std::mutex lock;
+        // The number of writes that failed.
+        std::atomic<size_t> error_count{0};
+
+    private:
+        // The channel the sink is attached to, if any.
+        iochannel* channel = nullptr;
+        // The sink's callback in the channel's signal_full.
+        iochannel::IOSignalFull::Handle handle;
+};
+
+/**A log file, written a buffer at a time. It can be rotated when it
+ * grows too large or too old: the file is renamed to "name.1", any
+ * older ones move up a number, and a fresh file is started.
+ */
+class IOFileSink : public IOSink
+{
+    public:
+        /** Open a file for appending, creating it if needed. Throws
+             * std::runtime_error if it can't be opened.
+             * \param the path of the file
+             * \param the number of bytes to gather before writing */
+        explicit IOFileSink(const std::string& path, size_t buffer = 64 * 1024);
+
+        ~IOFileSink() override;
+
+        /** Rotate the file when it grows past a size or age. A message is
+             * never split between two files.
+             * \param the largest the file may grow, in bytes, or 0 for no limit
+             * \param the longest a file may be written to, or 0 for no limit
+             * \param the number of old files to keep; older ones are deleted */
+        void configure_rotation(size_t max_bytes,
+                                std::chrono::steady_clock::duration max_age
+                                    = std::chrono::steady_clock::duration::zero(),
+                                unsigned int keep = 4);
+
+        /** Rotate the file now. */
+        void rotate();
+
+    protected:
+        void store(std::string_view) override;
+        void sync() override;
+
+        /** Called with the lock held whenever rotation starts a fresh
+             * file, for subclasses that begin each file with a header. */
+        virtual void started() {}
+
+        /** Whether the file is due to be rotated before adding to it.
+             * \param the number of bytes about to be added */
+        bool due(size_t) const;
+
+        /** Close the file, move it and its old copies up a number, and
+             * start a fresh one. Called with the lock held. */
+        void roll();
+
+        /** Add to the file, without checking for rotation. Called with
+             * the lock held.
+             * \param the bytes to add */
+        void put(std::string_view);
+
+    private:
+        /** Open the file, optionally throwing away what was in it.
+             * \return true if it opened */
+        bool open(bool truncate);
+
+        // The path of the current file.
+        std::string path;
+        // The file descriptor, or -1 if the file couldn't be opened.
+        int fd = -1;
+        // The messages waiting to be written.
+        std::string pending;
+        // The size at which pending is written out.
+        size_t capacity;
+        // The bytes already in the file.
+        size_t file_bytes = 0;
+        // When the current file was started.
+        std::chrono::steady_clock::time_point opened;
+        // Rotate past this many bytes, if not 0.
+        size_t max_bytes = 0;
+        // Rotate after this long, if not 0.
+        std::chrono::steady_clock::duration max_age{0};
+        // The number of rotated files to keep.
+        unsigned int keep = 4;
+};
+
+/**A file written in large blocks, aligned for O_DIRECT, which skips the
+ * page cache so that heavy logging doesn't push out other data. On
+ * systems or file systems without it, the blocks are written normally.
+ */
+class IOBlockSink : public IOSink
+{
+    public:
+        /// The alignment of block buffers, sizes, and offsets.
+        static const size_t ALIGN = 4096;
+
+        /** Create or truncate a file. Throws std::runtime_error if it
+             * can't be opened.
+             * \param the path of the file
+             * \param the block size, rounded up to a multiple of ALIGN
+             * \param whether to try O_DIRECT */
+        explicit IOBlockSink(const std::string& path, size_t block = 1 << 20,
+                             bool direct = true);
+
+        ~IOBlockSink() override;
+
+        /// \return true if the file is being written with O_DIRECT
+        bool direct() const { return is_direct; }
+
+    protected:
+        void store(std::string_view) override;
+        void sync() override;
+
+    private:
+        /** Write the block buffer out at the current offset.
+             * \param the number of bytes in it to write, a multiple of ALIGN */
+        bool write_block(size_t);
+
+        // The file descriptor.
+        int fd = -1;
+        // The block buffer, aligned to ALIGN.
+        char* buffer = nullptr;
+        // The size of the block buffer.
+        size_t block;
+        // The bytes in the block buffer.
+        size_t used = 0;
+        // The file offset the block buffer will be written to.
+        int64_t offset = 0;
+        // Whether O_DIRECT is in use.
+        bool is_direct = false;
+};
+
+/**A memory-mapped ring buffer holding the last part of the output. The
+ * mapping is shared with the file, so the output is in the file as soon
+ * as it is copied in, and outlives a crash of the process, though not of
+ * the system unless flush() is called. Read it back with recover().
+ */
+class IORingSink : public IOSink
+{
+    public:
+        /** Map a ring buffer file, creating it if needed. If the file
+             * already holds a ring of the same capacity, new output is
+             * added after what's there. Throws std::runtime_error if it
+             * can't be created or mapped.
+             * \param the path of the file
+             * \param the number of bytes of output to keep */
+        explicit IORingSink(const std::string& path, size_t capacity = 4 << 20);
+
+        ~IORingSink() override;
+
+        /** Read the output kept in a ring buffer file, oldest first. If
+             * the ring has wrapped around, the partial line at the start
+             * is left off.
+             * \param the path of the file
+             * \return the output, or an empty string if the file isn't a ring */
+        static std::string recover(const std::string& path);
+
+    protected:
+        void store(std::string_view) override;
+        void sync() override;
+
+    private:
+        /// The start of a ring buffer file.
+        struct Header
+        {
+            char magic[8];
+            uint64_t capacity;
+            // The bytes ever written, so the next goes at written % capacity.
+            uint64_t written;
+        };
+
+        /// Marks a file as a ring buffer.
+        static constexpr char MAGIC[8] = {'P', 'A', 'W', 'R', 'I', 'N', 'G', '1'};
+        /// The bytes before the ring itself.
+        static const size_t DATA_OFFSET = 64;
+
+        // The file descriptor.
+        int fd = -1;
+        // The mapped file.
+        char* map = nullptr;
+        // The size of the mapping.
+        size_t map_size = 0;
+        // The header at the start of the mapping.
+        Header* header = nullptr;
+        // The ring, following the header.
+        char* ring = nullptr;
+        // The size of the ring.
+        size_t capacity;
+};
+
+#endif // PAWLIB_IOSINK_HPP
@@ -0,0 +1,270 @@
+/** Oneatom [PawLIB]
+  * Version: 0.1
+  *
+  * Interned strings. Interning text stores one copy of it in a table and
+  * hands back a oneatom, a pointer-sized handle to that copy. Interning the
+  * same text again hands back the same handle, so atoms compare and hash
+  * in constant time. The copies live in arenas and never move, so an atom
+  * stays good for as long as its table does; the global table lasts for
+  * the life of the program.
+  *
+  * Author(s): Jason C. McDonald
+  */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2019 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef PAWLIB_ONEATOM_HPP
+#define PAWLIB_ONEATOM_HPP
+
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "pawlib/onestring.hpp"
+#include "pawlib/onestring_view.hpp"
+#include "pawlib/stdutils.hpp"
+
+class onestring_interner;
+
+class oneatom
+{
+    friend class onestring_interner;
+
+    public:
+        /** An interned string, as stored in its table's arena. The text
+         * follows this header directly, null-terminated. */
+        struct Entry
+        {
+            /// The hash of the text
+            size_t hash;
+
+            /// The number of bytes in the text, not counting the terminator
+            size_t bytes;
+
+            /// The number of characters in the text
+            size_t chars;
+
+            /// \return the text, which directly follows the header
+            const char* text() const
+            {
+                return reinterpret_cast<const char*>(this + 1);
+            }
+        };
+
+    private:
+        /// The interned text, or null for the empty string
+        const Entry* entry;
+
+        explicit oneatom(const Entry* e)
+        : entry(e)
+        {}
+
+    public:
+        /** Default Constructor, the empty string. This is the same atom
+        * that interning "" gives. */
+        oneatom()
+        : entry(nullptr)
+        {}
+
+        /** Interns text in the global table.
+        * \param the text to intern */
+        explicit oneatom(const onestring_view& text);
+
+        /// \return whether this is the empty string
+        bool empty() const { return (entry == nullptr); }
+
+        /// \return the null-terminated text, good for the life of the table
+        const char* c_str() const { return entry ? entry->text() : ""; }
+
+        /// \return the number of characters
+        size_t length() const { return entry ? entry->chars : 0; }
+
+        /** Like onestring_view::size(), this does not include the null
+             * terminator.
+             * \return the number of bytes */
+        size_t size() const { return entry ? entry->bytes : 0; }
+
+        /** \return the hash of the text, worked out when it was interned.
+             * This is the same as onestring_view::hash() for the text. */
+        size_t hash() const { return entry ? entry->hash : stdutils::hash(nullptr, 0); }
+
+        /// \return a view of the text, with its character count
+        onestring_view view() const
+        {
+            return entry ? onestring_view(entry->text(), entry->bytes, entry->chars)
+                         : onestring_view();
+        }
+
+        /// Atoms can be passed wherever text is taken as a view.
+        operator onestring_view() const { return view(); }
+
+        /// \return a new onestring holding a copy of the text
+        onestring str() const { return onestring(view()); }
+
+        /** Checks if the atom holds the given text. Comparing with
+             * another atom from the same table is faster.
+             * \param the text to compare against
+             * \return true if equal, else false */
+        bool equals(const onestring_view& other) const { return view().equals(other); }
+
+        /** Checks if two atoms from the same table are the same text.
+             * \param the atom to compare against
+             * \return true if equal, else false */
+        bool equals(const oneatom& other) const { return (entry == other.entry); }
+
+        /// Atoms from the same table are equal only if they are the same atom.
+        bool operator==(const oneatom& other) const { return (entry == other.entry); }
+        bool operator!=(const oneatom& other) const { return (entry != other.entry); }
+
+        /** Orders atoms by address, which is consistent for the life of
+         * the table but has nothing to do with their text. Use it for
+         * ordered containers; compare view()s to sort by text. */
+        bool operator<(const oneatom& other) const { return std::less<const Entry*>()(entry, other.entry); }
+
+        friend std::ostream& operator<<(std::ostream& os, const oneatom& atom)
+        {
+            os.write(atom.c_str(), atom.size());
+            return os;
+        }
+};
+
+namespace std
+{
+    template<>
+    struct hash<oneatom>
+    {
+        size_t operator()(const oneatom& atom) const
+        {
+            return atom.hash();
+        }
+    };
+}
+
+class onestring_interner
+{
+    private:
+        /// The number of shards, each with its own lock, index, and arena.
+        inline static const size_t SHARDS = 16;
+
+        /// The size of each arena block. Longer strings get their own.
+        inline static const size_t BLOCK_SIZE = 64 * 1024;
+
+        /// The number of index slots a shard starts with, a power of two.
+        inline static const size_t BASE_SLOTS = 64;
+
+        /** One part of the table. Each string goes to the shard picked by
+         * its hash, so threads interning different strings rarely wait on
+         * the same lock. */
+        struct Shard
+        {
+            std::mutex lock;
+
+            /// An open-addressed hash index of the entries
+            std::vector<const oneatom::Entry*> slots;
+
+            /// The number of entries in the index
+            size_t count = 0;
+
+            /// The arena blocks the entries are stored in
+            std::vector<std::unique_ptr<char[]>> blocks;
+
+            /// Where the next entry goes in the newest block
+            char* next = nullptr;
+
+            /// The bytes left in the newest block
+            size_t left = 0;
+
+            /// The total bytes allocated for blocks
+            size_t allocated = 0;
+        };
+
+        Shard shards[SHARDS];
+
+        /// \return the hash of some text
+        static size_t hash(const onestring_view& text);
+
+        /// \return the shard the given hash belongs to
+        Shard& shard(size_t hash)
+        {
+            // The low bits pick the slot within a shard, so use the high ones.
+            return shards[(hash >> (sizeof(size_t) * 8 - 4)) % SHARDS];
+        }
+
+        /** Finds where text is, or would go, in a shard's index.
+             * The shard must be locked.
+             * \return the index of the slot */
+        static size_t probe(const Shard& shard, size_t hash, const onestring_view& text);
+
+        /** Copies text into a shard's arena. The shard must be locked.
+             * \return the new entry */
+        static const oneatom::Entry* store(Shard& shard, size_t hash, const onestring_view& text);
+
+        /// Doubles a shard's index. The shard must be locked.
+        static void grow(Shard& shard);
+
+    public:
+        onestring_interner(){}
+
+        /** Tables own their text, and atoms point into it, so a table
+         * can be neither copied nor moved. */
+        onestring_interner(const onestring_interner&) = delete;
+        onestring_interner& operator=(const onestring_interner&) = delete;
+
+        /** Interns text, storing a copy the first time it is seen.
+             * Safe to call from several threads at once.
+             * \param the text to intern
+             * \return the atom for the text */
+        oneatom intern(const onestring_view& text);
+
+        /** Looks up text without interning it.
+             * \param the text to look for
+             * \param the atom to store the result in
+             * \return true if the text has been interned, else false */
+        bool lookup(const onestring_view& text, oneatom& atom);
+
+        /// \return the number of distinct strings interned
+        size_t size();
+
+        /// \return the number of bytes allocated for the interned text
+        size_t allocated();
+
+        /// \return the table used by oneatom's constructor
+        static onestring_interner& global();
+};
+
+#endif // PAWLIB_ONEATOM_HPP
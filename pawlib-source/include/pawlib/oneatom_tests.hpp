@@ -0,0 +1,294 @@
+/** Tests for oneatom [PawLIB]
+  * Version: 0.1
+  *
+  * Author(s): Jason C. McDonald
+  */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2019 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef PAWLIB_ONEATOM_TESTS_HPP
+#define PAWLIB_ONEATOM_TESTS_HPP
+
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "pawlib/goldilocks.hpp"
+#include "pawlib/oneatom.hpp"
+#include "pawlib/onestring.hpp"
+
+// P-tB4401
+class TestOneatom_Intern : public Test
+{
+    public:
+        TestOneatom_Intern(){}
+
+        testdoc_t get_title() override
+        {
+            return "Oneatom: Intern";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Intern the same text from different sources, and check that it gives back the same atom.";
+        }
+
+        bool run() override
+        {
+            onestring ostr = "ĉapelo 🎩";
+            std::string str = "ĉapelo 🎩";
+
+            oneatom a(ostr);
+            oneatom b(str);
+            oneatom c(onestring_view("ĉapelo 🎩"));
+            oneatom other(onestring_view("ĉapelo"));
+
+            PL_ASSERT_TRUE(a == b);
+            PL_ASSERT_TRUE(a == c);
+            PL_ASSERT_EQUAL(a.c_str(), c.c_str());
+            PL_ASSERT_TRUE(a != other);
+            PL_ASSERT_EQUAL(a.hash(), b.hash());
+
+            PL_ASSERT_EQUAL(a.length(), 8u);
+            PL_ASSERT_EQUAL(a.size(), str.size());
+            PL_ASSERT_TRUE(a.equals("ĉapelo 🎩"));
+            PL_ASSERT_EQUAL(a.str(), ostr);
+
+            PL_ASSERT_TRUE(oneatom(onestring_view("")) == oneatom());
+            PL_ASSERT_TRUE(oneatom().empty());
+            PL_ASSERT_EQUAL(oneatom().length(), 0u);
+            return true;
+        }
+};
+
+// P-tB4402
+class TestOneatom_Table : public Test
+{
+    public:
+        TestOneatom_Table(){}
+
+        testdoc_t get_title() override
+        {
+            return "Oneatom: Table";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Fill a table of its own past several index resizes, look strings up, and check that atoms don't move.";
+        }
+
+        bool run() override
+        {
+            onestring_interner table;
+            std::vector<oneatom> atoms;
+            for (int i = 0; i < 5000; ++i)
+            {
+                atoms.push_back(table.intern("tag_" + std::to_string(i)));
+            }
+            PL_ASSERT_EQUAL(table.size(), 5000u);
+
+            // Interning again finds the same atoms, text in place.
+            for (int i = 0; i < 5000; i += 7)
+            {
+                oneatom again = table.intern("tag_" + std::to_string(i));
+                PL_ASSERT_TRUE(again == atoms[i]);
+            }
+            PL_ASSERT_EQUAL(table.size(), 5000u);
+            PL_ASSERT_EQUAL(strcmp(atoms[1234].c_str(), "tag_1234"), 0);
+
+            oneatom found;
+            PL_ASSERT_TRUE(table.lookup("tag_42", found));
+            PL_ASSERT_TRUE(found == atoms[42]);
+            PL_ASSERT_FALSE(table.lookup("tag_5000", found));
+
+            // A long string gets a block of its own.
+            std::string longer(100000, 'x');
+            PL_ASSERT_EQUAL(table.intern(longer).size(), longer.size());
+            PL_ASSERT_GREATER(table.allocated(), longer.size());
+            return true;
+        }
+};
+
+// P-tB4403
+class TestOneatom_Threads : public Test
+{
+    public:
+        TestOneatom_Threads(){}
+
+        testdoc_t get_title() override
+        {
+            return "Oneatom: Intern From Several Threads";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Intern the same strings from four threads at once, and check that they all get the same atoms.";
+        }
+
+        bool run() override
+        {
+            onestring_interner table;
+            std::vector<std::vector<oneatom>> results(4);
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < results.size(); ++t)
+            {
+                threads.emplace_back([&table, &results, t]()
+                {
+                    for (int i = 0; i < 2000; ++i)
+                    {
+                        results[t].push_back(table.intern("key/" + std::to_string(i)));
+                    }
+                });
+            }
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+
+            PL_ASSERT_EQUAL(table.size(), 2000u);
+            for (size_t t = 1; t < results.size(); ++t)
+            {
+                PL_ASSERT_TRUE(results[t] == results[0]);
+            }
+            return true;
+        }
+};
+
+// P-tB4404*
+class TestStdString_MapLookup : public Test
+{
+    protected:
+        std::unordered_map<std::string, int> map;
+        std::vector<std::string> keys;
+
+    public:
+        TestStdString_MapLookup(){}
+
+        testdoc_t get_title() override
+        {
+            return "std::string: Map Lookup";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Look up 1000 long identifiers in an unordered_map keyed on std::string.";
+        }
+
+        bool janitor() override
+        {
+            map.clear();
+            keys.clear();
+            for (int i = 0; i < 1000; ++i)
+            {
+                keys.push_back("org.mousepawmedia.pawlib.component." + std::to_string(i));
+                map[keys.back()] = i;
+            }
+            return true;
+        }
+
+        bool run() override
+        {
+            int total = 0;
+            for (const std::string& key : keys)
+            {
+                total += map[key];
+            }
+            PL_ASSERT_EQUAL(total, 499500);
+            return true;
+        }
+};
+
+// P-tB4404
+class TestOneatom_MapLookup : public Test
+{
+    protected:
+        std::unordered_map<oneatom, int> map;
+        std::vector<oneatom> keys;
+
+    public:
+        TestOneatom_MapLookup(){}
+
+        testdoc_t get_title() override
+        {
+            return "Oneatom: Map Lookup";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Look up 1000 long identifiers in an unordered_map keyed on oneatom.";
+        }
+
+        bool janitor() override
+        {
+            map.clear();
+            keys.clear();
+            for (int i = 0; i < 1000; ++i)
+            {
+                std::string key = "org.mousepawmedia.pawlib.component." + std::to_string(i);
+                keys.push_back(oneatom(key));
+                map[keys.back()] = i;
+            }
+            return true;
+        }
+
+        bool run() override
+        {
+            int total = 0;
+            for (const oneatom& key : keys)
+            {
+                total += map[key];
+            }
+            PL_ASSERT_EQUAL(total, 499500);
+            return true;
+        }
+};
+
+class TestSuite_Oneatom : public TestSuite
+{
+    public:
+        explicit TestSuite_Oneatom(){}
+
+        void load_tests() override;
+
+        testdoc_t get_title() override
+        {
+            return "PawLIB: Oneatom Tests";
+        }
+};
+
+#endif // PAWLIB_ONEATOM_TESTS_HPP
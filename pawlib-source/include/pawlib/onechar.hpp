@@ -51,12 +51,16 @@
 #include <iomanip>
 #include <iostream>
 
+#include "pawlib/stdutils.hpp"
+
 class onestring;
+class onestring_view;
 
 /** Stores a single unicode character */
 class onechar
 {
     friend onestring;
+    friend onestring_view;
     private:
         /* We never store more than 4 bytes of meaningful data.
             * The null terminator is stored as an implementation detail, but
@@ -156,6 +160,11 @@ class onechar
              * \return true if equal, else false */
         bool equals(const onechar&) const;
 
+        /** Hashes the bytes of the character, the same as a onestring
+             * holding only this character would.
+             * \return the hash */
+        size_t hash() const { return stdutils::hash(internal, size); }
+
         /** Returns the c-string representation of the onechar.
              * Appends a null terminator.
              * \return c-string of the character */
@@ -326,4 +335,12 @@ class onechar
         }
 };
 
+namespace std
+{
+    template<> struct hash<onechar>
+    {
+        size_t operator()(const onechar& ochr) const { return ochr.hash(); }
+    };
+}
+
 #endif // PAWLIB_ONECHAR_HPP
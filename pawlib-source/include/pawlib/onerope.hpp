@@ -0,0 +1,337 @@
+/** Onerope [PawLIB]
+  * Version: 0.1
+  *
+  * A rope of UTF-8 text for large documents that are edited in place.
+  * The text is cut into chunks of up to a kilobyte, which are the leaves
+  * of a balanced tree, so inserting, erasing, and finding a character by
+  * index all take logarithmic time no matter where in the text they are.
+  * Nodes are never changed once made; an edit builds new nodes along one
+  * path and shares the rest. Copying a onerope is therefore a cheap
+  * snapshot, and old copies stay valid as the original is edited.
+  *
+  * Author(s): Jason C. McDonald
+  */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2019 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef PAWLIB_ONEROPE_HPP
+#define PAWLIB_ONEROPE_HPP
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pawlib/onechar.hpp"
+#include "pawlib/onestring.hpp"
+#include "pawlib/onestring_view.hpp"
+
+class onerope
+{
+    public:
+        /// The greatest possible value for an element.
+        inline static const size_t npos = -1;
+
+        /** The most bytes a chunk holds. Smaller edits are merged into
+         * their neighbors up to this size. */
+        inline static const size_t CHUNK_SIZE = 1024;
+
+    private:
+        struct Node;
+
+        /// Nodes are shared between ropes, so they are never modified.
+        typedef std::shared_ptr<const Node> node_t;
+
+        /** A leaf holds a chunk of text; any other node holds exactly two
+         * children and no text. Every node knows the totals below it. */
+        struct Node
+        {
+            /// The children, or null for a leaf
+            node_t left;
+            node_t right;
+
+            /// The chunk, for a leaf
+            std::string text;
+
+            /// The number of bytes in this subtree
+            size_t bytes;
+
+            /// The number of characters in this subtree
+            size_t chars;
+
+            /// The height of this subtree, where a leaf is 1
+            unsigned char height;
+
+            bool is_leaf() const { return !left; }
+        };
+
+        /// The root of the tree, or null if the rope is empty
+        node_t root;
+
+        explicit onerope(node_t node)
+        : root(std::move(node))
+        {}
+
+        /// \return the height of a subtree, 0 if it is empty
+        static unsigned char height(const node_t& node)
+        {
+            return node ? node->height : 0;
+        }
+
+        /// \return a new leaf holding the given chunk
+        static node_t leaf(std::string text, size_t chars);
+
+        /// \return a new node joining two non-empty subtrees as they are
+        static node_t node(node_t left, node_t right);
+
+        /** Joins two subtrees whose heights differ by at most two,
+             * rotating to keep the result balanced.
+             * \return the new subtree */
+        static node_t balance(node_t left, node_t right);
+
+        /** Concatenates two subtrees, keeping the tree balanced. Small
+             * leaves that meet are merged.
+             * \return the new subtree */
+        static node_t join(node_t left, node_t right);
+
+        /** Cuts a subtree in two.
+             * \param the subtree
+             * \param the number of characters to put in the first part
+             * \return the two parts, either of which may be empty */
+        static std::pair<node_t, node_t> split(const node_t& node, size_t pos);
+
+        /** Builds a balanced subtree holding the given text.
+             * \param the text to copy
+             * \return the new subtree, or null if the text is empty */
+        static node_t build(const onestring_view& text);
+
+        /// Builds a balanced subtree over a run of leaves.
+        static node_t build(const std::vector<node_t>& leaves, size_t from, size_t to);
+
+    public:
+        /** Walks the chunks of a rope in order. Each chunk is handed out
+         * as a onestring_view, which stays valid for as long as any rope
+         * holding that chunk does.
+         */
+        class chunk_iterator
+        {
+            friend class onerope;
+
+            private:
+                /// The nodes whose right subtrees are still to be visited
+                std::vector<const Node*> path;
+
+                /// The current leaf, or null at the end
+                const Node* current = nullptr;
+
+                /// Descends to the first leaf under a node.
+                void descend(const Node* node);
+
+            public:
+                chunk_iterator(){}
+
+                onestring_view operator*() const
+                {
+                    return onestring_view(current->text.data(),
+                        current->text.size(), current->chars);
+                }
+
+                chunk_iterator& operator++();
+
+                bool operator==(const chunk_iterator& rhs) const { return current == rhs.current; }
+                bool operator!=(const chunk_iterator& rhs) const { return current != rhs.current; }
+        };
+
+        /// The chunks of a rope, for use in a range-based for loop.
+        class chunk_range
+        {
+            private:
+                const onerope& rope;
+
+            public:
+                explicit chunk_range(const onerope& r)
+                : rope(r)
+                {}
+
+                chunk_iterator begin() const { return rope.chunk_begin(); }
+                chunk_iterator end() const { return chunk_iterator(); }
+        };
+
+        /*******************************************
+        * Constructors
+        *******************************************/
+
+        /**Default Constructor, an empty rope*/
+        onerope(){}
+
+        /**Create a rope from text
+        * \param the text to copy */
+        explicit onerope(const onestring_view& text)
+        : root(build(text))
+        {}
+
+        /** Copying a rope shares all of its chunks, so it takes constant
+        * time and no memory beyond the object itself.
+        * \param the rope to snapshot */
+        onerope(const onerope&) = default;
+        onerope(onerope&&) = default;
+        onerope& operator=(const onerope&) = default;
+        onerope& operator=(onerope&&) = default;
+
+        /*******************************************
+        * Accessors
+        ********************************************/
+
+        /** Gets a character in the rope.
+             * \param the index of the character
+             * \throws std::out_of_range if pos is past the end
+             * \return a copy of the character */
+        onechar at(size_t pos) const;
+
+        onechar operator[](size_t pos) const { return at(pos); }
+
+        /// \return whether the rope contains no characters
+        bool empty() const { return !root; }
+
+        /// \return the number of characters in the rope
+        size_t length() const { return root ? root->chars : 0; }
+
+        /** Like onestring_view::size(), this does not include a null
+             * terminator, since a rope does not have one.
+             * \return the number of bytes in the rope */
+        size_t size() const { return root ? root->bytes : 0; }
+
+        /** Copies part of the rope, sharing every chunk it can.
+             * \param the position of the first character
+             * \param the number of characters, optional
+             * \throws std::out_of_range if pos is past the end
+             * \return the new rope */
+        onerope substr(size_t pos, size_t len = npos) const;
+
+        /** Copies the text into a onestring, in one allocation.
+             * \return the new onestring */
+        onestring str() const;
+
+        /// \return the first chunk, or chunk_end() if the rope is empty
+        chunk_iterator chunk_begin() const;
+
+        /// \return the position past the last chunk
+        chunk_iterator chunk_end() const { return chunk_iterator(); }
+
+        /// \return the chunks, for use in a range-based for loop
+        chunk_range chunks() const { return chunk_range(*this); }
+
+        /*******************************************
+        * Comparison
+        ********************************************/
+
+        /** Checks if the rope holds the given text.
+             * \param the text to compare against
+             * \return true if equal, else false */
+        bool equals(const onestring_view& other) const;
+
+        /** Checks if two ropes hold the same text, however it is chunked.
+             * \param the rope to compare against
+             * \return true if equal, else false */
+        bool equals(const onerope& other) const;
+
+        bool operator==(const onestring_view& other) const { return equals(other); }
+        bool operator==(const onerope& other) const { return equals(other); }
+        bool operator!=(const onestring_view& other) const { return !equals(other); }
+        bool operator!=(const onerope& other) const { return !equals(other); }
+
+        /*******************************************
+        * Mutators
+        ********************************************/
+
+        /** Appends text to the end of the rope.
+             * \param the text to append
+             * \return a reference to the rope */
+        onerope& append(const onestring_view& text) { return insert(length(), text); }
+
+        /** Appends another rope, sharing its chunks.
+             * \param the rope to append
+             * \return a reference to the rope */
+        onerope& append(const onerope& other);
+
+        /// Removes all the text.
+        void clear() { root.reset(); }
+
+        /** Erases part of the rope.
+             * \param the first character to erase
+             * \param the number of characters to erase, optional
+             * \throws std::out_of_range if pos is past the end
+             * \return a reference to the rope */
+        onerope& erase(size_t pos, size_t len = npos);
+
+        /** Inserts text into the rope.
+             * \param the index to insert at
+             * \param the text to insert
+             * \throws std::out_of_range if pos is past the end
+             * \return a reference to the rope */
+        onerope& insert(size_t pos, const onestring_view& text);
+
+        /** Inserts another rope, sharing its chunks.
+             * \param the index to insert at
+             * \param the rope to insert
+             * \throws std::out_of_range if pos is past the end
+             * \return a reference to the rope */
+        onerope& insert(size_t pos, const onerope& other);
+
+        /** Replaces part of the rope with other text.
+             * \param the first character to replace
+             * \param the number of characters to replace
+             * \param the text to put in their place
+             * \throws std::out_of_range if pos is past the end
+             * \return a reference to the rope */
+        onerope& replace(size_t pos, size_t len, const onestring_view& text);
+
+        void operator+=(const onestring_view& text) { append(text); }
+        void operator+=(const onerope& other) { append(other); }
+
+        friend std::ostream& operator<<(std::ostream& os, const onerope& rope)
+        {
+            for (onestring_view chunk : rope.chunks())
+            {
+                os << chunk;
+            }
+            return os;
+        }
+};
+
+#endif // PAWLIB_ONEROPE_HPP
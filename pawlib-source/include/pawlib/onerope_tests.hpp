@@ -0,0 +1,385 @@
+/** Tests for onerope [PawLIB]
+  * Version: 0.1
+  *
+  * Author(s): Jason C. McDonald
+  */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2019 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef PAWLIB_ONEROPE_TESTS_HPP
+#define PAWLIB_ONEROPE_TESTS_HPP
+
+#include <string>
+
+#include "pawlib/goldilocks.hpp"
+#include "pawlib/onerope.hpp"
+#include "pawlib/onestring.hpp"
+
+// P-tB4301
+class TestOnerope_Construct : public Test
+{
+    public:
+        TestOnerope_Construct(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onerope: Construct";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Build ropes from short and long text, and copy them back out to a onestring.";
+        }
+
+        bool run() override
+        {
+            onerope empty;
+            PL_ASSERT_TRUE(empty.empty());
+            PL_ASSERT_EQUAL(empty.length(), 0u);
+
+            onerope shortrope(onestring_view("The quick brown 🦊"));
+            PL_ASSERT_EQUAL(shortrope.length(), 17u);
+            PL_ASSERT_EQUAL(shortrope.size(), strlen("The quick brown 🦊"));
+            PL_ASSERT_EQUAL(shortrope.str(), "The quick brown 🦊");
+
+            // Long enough to take many chunks, and multi-byte throughout.
+            onestring text;
+            for (int i = 0; i < 300; ++i)
+            {
+                text.append("The 🦊 jumped over the 🐶. ");
+            }
+            onerope longrope(text);
+            PL_ASSERT_EQUAL(longrope.length(), text.length());
+            PL_ASSERT_EQUAL(longrope.size(), text.size() - 1);
+            PL_ASSERT_EQUAL(longrope.str(), text);
+            PL_ASSERT_TRUE(longrope == text);
+            return true;
+        }
+};
+
+// P-tB4302
+class TestOnerope_At : public Test
+{
+    protected:
+        onestring text;
+        onerope test;
+
+    public:
+        TestOnerope_At(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onerope: at()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Read every character of a many-chunk rope by index, and check them against a onestring.";
+        }
+
+        bool janitor() override
+        {
+            text.clear();
+            for (int i = 0; i < 100; ++i)
+            {
+                text.append("Déjà vu ‽ 🐶 ");
+            }
+            test = onerope(text);
+            return true;
+        }
+
+        bool run() override
+        {
+            for (size_t i = 0; i < text.length(); ++i)
+            {
+                PL_ASSERT_EQUAL(test[i], text[i]);
+            }
+            try
+            {
+                test.at(test.length());
+            }
+            catch (const std::out_of_range&)
+            {
+                return true;
+            }
+            return false;
+        }
+};
+
+// P-tB4303
+class TestOnerope_Edit : public Test
+{
+    public:
+        TestOnerope_Edit(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onerope: insert(), erase(), and replace()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Make the same edits all over a onerope and a onestring, checking they agree after each.";
+        }
+
+        bool run() override
+        {
+            onestring expect;
+            for (int i = 0; i < 200; ++i)
+            {
+                expect.append("Ĉiu ĵaŭde 🦊. ");
+            }
+            onerope test(expect);
+
+            for (size_t i = 0; i < 150; ++i)
+            {
+                size_t pos = (i * 7919) % (expect.length() + 1);
+                switch (i % 3)
+                {
+                    case 0:
+                        expect.insert(pos, "→🐶←");
+                        test.insert(pos, "→🐶←");
+                        break;
+                    case 1:
+                        expect.erase(pos, 11);
+                        test.erase(pos, 11);
+                        break;
+                    default:
+                        expect.replace(pos, 4, "¡ŝ!");
+                        test.replace(pos, 4, "¡ŝ!");
+                        break;
+                }
+                PL_ASSERT_EQUAL(test.length(), expect.length());
+            }
+            PL_ASSERT_TRUE(test.equals(expect));
+
+            test.erase(0);
+            PL_ASSERT_TRUE(test.empty());
+            test.append("🐶");
+            test.insert(0, "a");
+            test += "b";
+            PL_ASSERT_EQUAL(test.str(), "a🐶b");
+            return true;
+        }
+};
+
+// P-tB4304
+class TestOnerope_Snapshot : public Test
+{
+    public:
+        TestOnerope_Snapshot(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onerope: Snapshots";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Copy a rope, edit the original, and check that the copy is unchanged and shares its chunks.";
+        }
+
+        bool run() override
+        {
+            onestring text;
+            for (int i = 0; i < 100; ++i)
+            {
+                text.append("The 🦊 jumped over the 🐶. ");
+            }
+            onerope original(text);
+            onerope snapshot = original;
+
+            original.insert(5, "quick brown ");
+            original.erase(original.length() - 10);
+            PL_ASSERT_TRUE(snapshot.equals(text));
+            PL_ASSERT_FALSE(snapshot.equals(original));
+
+            // Away from the edits, the two share chunks rather than copies.
+            size_t shared = 0;
+            for (onestring_view a : snapshot.chunks())
+            {
+                for (onestring_view b : original.chunks())
+                {
+                    shared += (a.data() == b.data());
+                }
+            }
+            PL_ASSERT_GREATER(shared, 0u);
+
+            onerope piece = snapshot.substr(4, 3);
+            PL_ASSERT_EQUAL(piece.str(), "🦊 j");
+            PL_ASSERT_TRUE(piece.substr(0, 1) == "🦊");
+            return true;
+        }
+};
+
+// P-tB4305
+class TestOnerope_Chunks : public Test
+{
+    public:
+        TestOnerope_Chunks(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onerope: Chunks";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Walk the chunks of a rope, checking that they are whole characters and together make up the text.";
+        }
+
+        bool run() override
+        {
+            onestring text;
+            for (int i = 0; i < 500; ++i)
+            {
+                text.append("‽🐶é");
+            }
+            onerope test(text);
+            test.insert(700, onerope(onestring_view("[inserted]")));
+
+            std::string joined;
+            size_t chars = 0;
+            size_t chunks = 0;
+            for (onestring_view chunk : test.chunks())
+            {
+                PL_ASSERT_LESS_EQUAL(chunk.size(), onerope::CHUNK_SIZE);
+                joined.append(chunk.data(), chunk.size());
+                chars += chunk.length();
+                ++chunks;
+            }
+            PL_ASSERT_GREATER(chunks, 1u);
+            PL_ASSERT_EQUAL(chars, test.length());
+            PL_ASSERT_TRUE(test.equals(joined));
+            return true;
+        }
+};
+
+// P-tB4306*
+class TestOnestring_EditFront : public Test
+{
+    protected:
+        onestring test;
+
+    public:
+        TestOnestring_EditFront(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: Edit the front of a long string";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Insert and erase a character near the front of a 1 MB onestring.";
+        }
+
+        bool janitor() override
+        {
+            test.clear();
+            for (int i = 0; i < 16384; ++i)
+            {
+                test.append("The 🦊 jumped over the 🐶, and the 🐶 slept. ");
+            }
+            return true;
+        }
+
+        bool run() override
+        {
+            for (size_t i = 0; i < 32; ++i)
+            {
+                test.insert(i, 'x');
+                test.erase(i + 1, 1);
+            }
+            return true;
+        }
+};
+
+// P-tB4306
+class TestOnerope_EditFront : public Test
+{
+    protected:
+        onerope test;
+
+    public:
+        TestOnerope_EditFront(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onerope: Edit the front of a long rope";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Insert and erase a character near the front of a 1 MB onerope.";
+        }
+
+        bool janitor() override
+        {
+            onestring text;
+            for (int i = 0; i < 16384; ++i)
+            {
+                text.append("The 🦊 jumped over the 🐶, and the 🐶 slept. ");
+            }
+            test = onerope(text);
+            return true;
+        }
+
+        bool run() override
+        {
+            for (size_t i = 0; i < 32; ++i)
+            {
+                test.insert(i, "x");
+                test.erase(i + 1, 1);
+            }
+            return true;
+        }
+};
+
+class TestSuite_Onerope : public TestSuite
+{
+    public:
+        explicit TestSuite_Onerope(){}
+
+        void load_tests() override;
+
+        testdoc_t get_title() override
+        {
+            return "PawLIB: Onerope Tests";
+        }
+};
+
+#endif // PAWLIB_ONEROPE_TESTS_HPP
@@ -4,7 +4,8 @@
   * Onestring is a multi-sized, Unicode-compatible (UTF-8) replacement for
   * std::string. Onestring contains all the functionality found in std::string,
   * and then some! It is fully compatible with c-strings, std::string, and the
-  * atomic char data type. To handle Unicode, each Onestring is composed of
+  * atomic char data type. To handle Unicode, Onestring stores its text as
+  * contiguous UTF-8 and counts, indexes, and hands out its characters as
   * Onechars, an enhanced UTF-8 character class.
   *
   * Author(s): Jason C. McDonald, Scott Taylor, Jarek Thomas, Bowen Volwiler
@@ -49,13 +50,22 @@
 #define PAWLIB_ONESTRING_HPP
 
 #include <algorithm>
+#include <atomic>
 #include <cctype> // isspace()
 #include <cstring>
 #include <iomanip>
+#include <initializer_list>
 #include <iostream>
 #include <istream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "pawlib/onechar.hpp"
+#include "pawlib/onestring_view.hpp"
+#include "pawlib/stdutils.hpp"
+#include "pawlib/utf8.hpp"
 
 class onestring
 {
@@ -72,17 +82,72 @@ class onestring
     private:
         inline static const float RESIZE_LIMIT = npos / RESIZE_FACTOR;
 
-        /// The maximum number of elements that can be stored without resize
+        /// How many characters apart the entries in the sparse index are.
+        inline static const size_t INDEX_STRIDE = 64;
+
+        /** The number of characters space has been reserved for. This is
+         * exact for ASCII; the byte buffer grows past it as needed for
+         * multi-byte characters. */
         size_t _capacity;
 
         /// The number of elements currently stored
         size_t _elements;
 
-        /// The array of onechars
-        onechar* internal;
+        /// The number of bytes currently stored
+        size_t _bytes;
+
+        /** How many bytes fit in the object itself, without allocating,
+         * including the null terminator. */
+        inline static const size_t LOCAL_SIZE = 24;
+
+        /// The number of bytes the buffer has room for, besides the terminator
+        size_t _byte_capacity;
+
+        /** The characters, as contiguous null-terminated UTF-8, which
+         * c_str() hands out as is. This points at _local for short
+         * strings, and to the heap otherwise. */
+        char* internal;
+
+        /// The buffer for short strings.
+        char _local[LOCAL_SIZE];
+
+        /// A character handed out by reference, and what the buffer held.
+        struct Ref
+        {
+            onechar ochr;
+            onechar stored;
+        };
 
-        /// The cached c-string. We store this pointer to ensure it is cleaned up properly.
-        mutable char* _c_str;
+        /** What only some strings ever need, kept out of the object so
+         * that every onestring stays small. */
+        struct Extras
+        {
+            /** The byte offset of every INDEX_STRIDE-th character, so
+             * that at() only has to walk a short way through a non-ASCII
+             * string. It is built as needed, and cut short by any change
+             * before its end. ASCII strings never need it. */
+            std::vector<size_t> index;
+
+            /** Guards index, which const readers on several threads may
+             * all want to extend at once. */
+            std::atomic_flag index_lock = ATOMIC_FLAG_INIT;
+
+            /** The characters handed out by reference from the non-const
+             * at(), front(), back() and [], by position. Anything written
+             * through those references is copied back into the buffer
+             * before the string is next read as a whole, and the
+             * references stay valid until the string is next modified. */
+            std::unordered_map<size_t, Ref> refs;
+        };
+
+        /** The sparse index and references, made the first time either
+         * is needed, or null. Const readers may make it, so it is set
+         * atomically. */
+        mutable std::atomic<Extras*> _extras{nullptr};
+
+        /** The hash of the text, worked out the first time hash() is
+         * called after a change, or 0 if it hasn't been yet. */
+        mutable std::atomic<size_t> _hash{0};
 
     public:
         /*******************************************
@@ -106,6 +171,11 @@ class onestring
         * \param the onestring to be copied */
         onestring(const onestring& str);
 
+        /**Create a onestring from a temporary onestring, taking over its
+        * buffer instead of copying. The other onestring is left empty.
+        * \param the onestring to be moved */
+        onestring(onestring&& str) noexcept;
+
         /**Create a onestring from a char
          *  \param the char to be added */
         // cppcheck-suppress noExplicitConstructor
@@ -116,6 +186,10 @@ class onestring
         // cppcheck-suppress noExplicitConstructor
         onestring(const onechar& ch);
 
+        /**Create a onestring from a onestring_view
+         *  \param the text to be copied */
+        explicit onestring(const onestring_view& view);
+
         /**Destructor*/
         ~onestring();
 
@@ -129,13 +203,109 @@ class onestring
              * \param the number of elements to allocate space for */
         void allocate(size_t capacity);
 
-        /** Shifts the contents of the onestring efficiently.
-             * WARNING: Does not check for validity of shift, nor perform
-             * expansions or shrinks. That is the responsibility of the caller.
-             * \param the first index to shift
-             * \param how much to shift by, and in what direction.
-             * Negative values shift back, positive shift forward. */
-        void shift(size_t fromIndex, int offset);
+        /** Moves the contents to a buffer of the given size, which is
+             * _local if it fits there.
+             * \param the number of bytes the new buffer must hold */
+        void rebuffer(size_t bytes);
+
+        /// \return whether the characters are stored in the object itself
+        bool is_local() const { return internal == _local; }
+
+        /** \param the address of some bytes
+             * \return whether they are in this string's buffer, which
+             * moves whenever the string grows */
+        bool owns(const char* bytes) const
+        {
+            return (bytes >= internal && bytes < internal + _byte_capacity);
+        }
+
+        /** Ensures the buffer can hold the given number of bytes,
+             * growing it by RESIZE_FACTOR if it can't.
+             * \param the number of bytes needed */
+        void reserve_bytes(size_t bytes);
+
+        /** Grows the character capacity and the buffer together, so
+             * that text of a known size can go in with one allocation.
+             * Never shrinks anything.
+             * \param the number of characters needed
+             * \param the number of bytes needed */
+        void make_room(size_t elements, size_t bytes);
+
+        /** Takes over another onestring's contents, leaving it empty.
+             * WARNING: Anything this onestring held on the heap must have
+             * been freed already.
+             * \param the onestring to take from */
+        void take(onestring& ostr) noexcept;
+
+        /** Replaces a range of characters with the given bytes, and
+             * recounts the characters. This is the primary function
+             * responsible for changing the contents; everything else is
+             * built on it.
+             * WARNING: Does not validate pos or len, nor update the
+             * character capacity. That is the responsibility of the caller.
+             * \param the first character to replace
+             * \param the number of characters to replace
+             * \param the UTF-8 bytes to insert in their place
+             * \param the number of bytes to insert
+             * \param how many times to insert them, default 1 */
+        void splice(size_t pos, size_t len, const char* src, size_t n,
+                    size_t repeat = 1);
+
+        /** Gets the sparse index and references, making them if needed.
+             * \return the extras */
+        Extras& extras() const;
+
+        /** Cuts the sparse index short, after a change.
+             * \param the number of entries that are still good */
+        void cut_index(size_t entries) const;
+
+        /** Finds where a character starts in the buffer.
+             * \param the index of the character. The length of the
+             * string gives the end of the buffer.
+             * \return the byte offset of the character */
+        size_t offset(size_t pos) const;
+
+        /** Walks forward through the buffer by whole characters.
+             * \param the byte offset to start from
+             * \param the number of characters to step over
+             * \return the byte offset reached */
+        size_t advance(size_t from, size_t count) const;
+
+        /** Copies a character out of the buffer.
+             * \param the index of the character
+             * \return the character, or a null onechar if pos is out
+             * of range */
+        onechar char_at(size_t pos) const;
+
+        /** Hands out a character by reference, as at() does.
+             * \param the index of the character
+             * \return a reference to the character */
+        onechar& checkout(size_t pos);
+
+        /** Reads a character, including any change written through a
+             * reference from at() that hasn't been copied back yet.
+             * \param the index of the character
+             * \return the character */
+        onechar peek(size_t pos) const;
+
+        /** Copies changes made through references from at() and the
+             * like back into the buffer. */
+        void sync() const
+        {
+            const Extras* extras = _extras.load(std::memory_order_acquire);
+            if (extras != nullptr && !extras->refs.empty())
+            {
+                // Only a non-const onestring has references out.
+                const_cast<onestring*>(this)->write_back();
+            }
+        }
+
+        /// The work of sync(), for when there are references out.
+        void write_back();
+
+        /** Syncs and then drops all references from at() and the like,
+             * before the string is modified. */
+        void release();
 
     public:
 
@@ -160,16 +330,15 @@ class onestring
              * \return the character count */
         static size_t characterCount(const char* cstr)
         {
-            size_t index = 0;
-            size_t count = 0;
-            while (cstr[index] != '\0')
-            {
-                index += onechar::evaluateLength(cstr + index);
-                ++count;
-            }
-            return count;
+            return characterCount(cstr, strlen(cstr));
         }
 
+        /** Evaluate the number of Unicode characters in a UTF-8 buffer
+             * \param the buffer to evaluate
+             * \param the number of bytes in the buffer
+             * \return the character count */
+        static size_t characterCount(const char* str, size_t bytes);
+
         /*******************************************
         * Accessors
         *******************************************/
@@ -178,7 +347,7 @@ class onestring
              * \param the index of the onechar to return
              * \return a reference to the corresponding onechar */
         onechar& at(size_t pos);
-        const onechar& at(size_t pos) const;
+        onechar at(size_t pos) const;
 
         /** Gets the last onechar in the string.
              * If the string is empty, this has undefined behavior
@@ -186,7 +355,7 @@ class onestring
              * \return a reference to the last onechar in the string.
              */
         onechar& back();
-        const onechar& back() const;
+        onechar back() const;
 
         /** Gets the current capacity of the onestring.
              * Used primarily internally for resizing purposes.
@@ -206,13 +375,17 @@ class onestring
              * \return the number of char elements copied to the array*/
         size_t copy(char* arr, size_t max, size_t len = 0, size_t pos = 0) const;
 
-        /** Returns a c-string equivalent of a onestring
-             * \return the c-string (remember to free[]) */
+        /** Returns a c-string equivalent of a onestring, without copying.
+             * \return the onestring's own null-terminated UTF-8 buffer,
+             * which stays valid until the onestring is next modified.
+             * Do not free it. */
         const char* c_str() const;
 
-        /** Returns a c-string equivalent of a onestring
-             * Alias for onestring::c_str()
-             * \return the c-string (remember to free[]) */
+        /** Returns the UTF-8 bytes of a onestring, without copying.
+             * Alias for onestring::c_str(). There are size() - 1 bytes
+             * before the terminator, so this can be passed straight to
+             * write() or std::string_view.
+             * \return the onestring's own buffer (do not free) */
         const char* data() const { return c_str(); }
 
         /**Checks to see if a onestring contains any data
@@ -225,7 +398,7 @@ class onestring
              * \return a reference to the first onechar in the string.
              */
         onechar& front();
-        const onechar& front() const;
+        onechar front() const;
 
         /**Gets the current number of elements in the onestring
          * \return the number of elements */
@@ -257,6 +430,59 @@ class onestring
              */
         size_t size(size_t, size_t = 0) const;
 
+        /** Hashes the text, the same as onestring_view::hash() would.
+             * The result is kept until the string is next modified, so
+             * hashing the same key over and over costs nothing.
+             * \return the hash */
+        size_t hash() const
+        {
+            sync();
+            // Threads reading at once may both work it out, to the same value.
+            size_t h = _hash.load(std::memory_order_relaxed);
+            if (h == 0)
+            {
+                h = stdutils::hash(internal, _bytes);
+                _hash.store(h, std::memory_order_relaxed);
+            }
+            return h;
+        }
+
+        /** Converts the onestring to UTF-16. Malformed characters
+             * become U+FFFD.
+             * \return the UTF-16 text */
+        std::u16string to_utf16() const
+        {
+            sync();
+            return utf8::to_utf16(internal, _bytes);
+        }
+
+        /** Converts the onestring to UTF-32, one code point per
+             * character. Malformed characters become U+FFFD.
+             * \return the UTF-32 text */
+        std::u32string to_utf32() const
+        {
+            sync();
+            return utf8::to_utf32(internal, _bytes);
+        }
+
+        /** Creates a onestring from UTF-16 text.
+             * Unpaired surrogates become U+FFFD.
+             * \param the UTF-16 text
+             * \return the new onestring */
+        static onestring from_utf16(const std::u16string& str)
+        {
+            return onestring(utf8::from_utf16(str.data(), str.size()));
+        }
+
+        /** Creates a onestring from UTF-32 text. Surrogates and values
+             * past U+10FFFF become U+FFFD.
+             * \param the UTF-32 text
+             * \return the new onestring */
+        static onestring from_utf32(const std::u32string& str)
+        {
+            return onestring(utf8::from_utf32(str.data(), str.size()));
+        }
+
 
         /*******************************************
         * Comparison
@@ -307,6 +533,15 @@ class onestring
              * OR the same length and higher in value */
         int compare(const onestring&) const;
 
+        /** Compares the onestring against a onestring_view.
+             * \return an integer representing the result.
+             * Returns a negative integer IF this onestring is shorter
+             * OR the same length and lower in value
+             * Returns zero if the values are the same
+             * Returns a positive integer IF this onestring is longer
+             * OR the same length and higher in value */
+        int compare(const onestring_view&) const;
+
         /** Tests if the onestring value is equivalent to a single char.
              * \param the char to compare against
              * \return true if equal, else false */
@@ -332,11 +567,96 @@ class onestring
              * \return true if equal, else false */
         bool equals(const onestring&) const;
 
+        /** Tests if the onestring value is equivalent to a onestring_view.
+             * \param the onestring_view to compare against
+             * \return true if equal, else false */
+        bool equals(const onestring_view&) const;
+
         /*******************************************
-        * Mutators
+        * Search
         ********************************************/
 
-        // TODO How many need rvalue versions?
+        /** Finds the first occurrence of text in the onestring.
+             * \param the text to find
+             * \param the character to start searching from, optional
+             * \return the index of the first character of the match,
+             * or npos if there isn't one */
+        size_t find(const onestring_view& needle, size_t pos = 0) const
+        {
+            return onestring_view(*this).find(needle, pos);
+        }
+
+        size_t find(char ch, size_t pos = 0) const
+        {
+            return find(onestring_view(&ch, 1, 1), pos);
+        }
+
+        /** Finds the last occurrence of text in the onestring.
+             * \param the text to find
+             * \param the last character a match may start at, optional
+             * \return the index of the first character of the match,
+             * or npos if there isn't one */
+        size_t rfind(const onestring_view& needle, size_t pos = npos) const
+        {
+            return onestring_view(*this).rfind(needle, pos);
+        }
+
+        size_t rfind(char ch, size_t pos = npos) const
+        {
+            return rfind(onestring_view(&ch, 1, 1), pos);
+        }
+
+        /** Checks whether text occurs in the onestring.
+             * \param the text to find
+             * \return true if found, else false */
+        bool contains(const onestring_view& needle) const
+        {
+            return (find(needle) != npos);
+        }
+
+        bool contains(char ch) const { return (find(ch) != npos); }
+
+        /** Finds the first character that is one of a set of characters.
+             * \param the set of characters
+             * \param the character to start searching from, optional
+             * \return the index of the character, or npos if none match */
+        size_t find_first_of(const onestring_view& chars, size_t pos = 0) const
+        {
+            return onestring_view(*this).find_first_of(chars, pos);
+        }
+
+        /** Finds the first character that is not one of a set of
+             * characters.
+             * \param the set of characters
+             * \param the character to start searching from, optional
+             * \return the index of the character, or npos if all match */
+        size_t find_first_not_of(const onestring_view& chars, size_t pos = 0) const
+        {
+            return onestring_view(*this).find_first_not_of(chars, pos);
+        }
+
+        /** Finds the last character that is one of a set of characters.
+             * \param the set of characters
+             * \param the last character to search, optional
+             * \return the index of the character, or npos if none match */
+        size_t find_last_of(const onestring_view& chars, size_t pos = npos) const
+        {
+            return onestring_view(*this).find_last_of(chars, pos);
+        }
+
+        /** Finds the last character that is not one of a set of
+             * characters.
+             * \param the set of characters
+             * \param the last character to search, optional
+             * \return the index of the character, or npos if all match */
+        size_t find_last_not_of(const onestring_view& chars, size_t pos = npos) const
+        {
+            return onestring_view(*this).find_last_not_of(chars, pos);
+        }
+
+        /*******************************************
+        * Mutators
+        ********************************************/
 
         /** Appends a character to the end of the onestring.
              * \param the char to append
@@ -368,6 +688,12 @@ class onestring
              * \return a reference to the onestring */
         onestring& append(const onestring&, size_t repeat = 1);
 
+        /** Appends characters to the end of the onestring.
+             * \param the onestring_view to append from
+             * \param how many times to repeat the append, default 1
+             * \return a reference to the onestring */
+        onestring& append(const onestring_view&, size_t repeat = 1);
+
 
         /** Assigns a character to the onestring.
              * \param the char to copy
@@ -394,6 +720,17 @@ class onestring
              * \return a reference to the onestring */
         onestring& assign(const onestring&);
 
+        /** Assigns characters to the onestring, taking over the other
+             * onestring's buffer. The other onestring is left empty.
+             * \param the onestring to move from
+             * \return a reference to the onestring */
+        onestring& assign(onestring&&) noexcept;
+
+        /** Assigns characters to the onestring.
+             * \param the onestring_view to copy from
+             * \return a reference to the onestring */
+        onestring& assign(const onestring_view&);
+
 
         /** Clears a onestring and reallocates it back to BASE_SIZE */
         void clear();
@@ -432,21 +769,21 @@ class onestring
              * If this is greater than the string length, it throws out_of_range
              * \param the onechar to insert
              * \return a reference to the onestring */
-        onestring& insert(size_t pos, onechar& ochr);
+        onestring& insert(size_t pos, const onechar& ochr);
 
         /** Inserts characters in the onestring at the given position.
              * \param the index to insert at.
              * If this is greater than the string length, it throws out_of_range
              * \param the c-string to insert
              * \return a reference to the onestring */
-        onestring& insert(size_t pos, char* cstr);
+        onestring& insert(size_t pos, const char* cstr);
 
         /** Inserts characters in the onestring at the given position.
              * \param the index to insert at.
              * If this is greater than the string length, it throws out_of_range
              * \param the std::string to insert
              * \return a reference to the onestring */
-        onestring& insert(size_t pos, std::string& str);
+        onestring& insert(size_t pos, const std::string& str);
 
         /** Inserts characters in the onestring at the given position.
              * \param the index to insert at.
@@ -455,6 +792,13 @@ class onestring
              * \return a reference to the onestring */
         onestring& insert(size_t pos, const onestring& ostr);
 
+        /** Inserts characters in the onestring at the given position.
+             * \param the index to insert at.
+             * If this is greater than the string length, it throws out_of_range
+             * \param the onestring_view to insert
+             * \return a reference to the onestring */
+        onestring& insert(size_t pos, const onestring_view& view);
+
 
         /**Removes the last element in a onestring */
         void pop_back();
@@ -479,18 +823,9 @@ class onestring
              * \param the onestring to append from */
         void push_back(const onestring& ostr) { append(ostr); }
 
-        // TODO: Implement rvalue versions of most of the above
-
-    protected:
-        /** Modifies the internal data structure in preparation for a
-             * replacement of characters. Intended ONLY to be used by
-             * replace()! DOES NOT validate pos, len, or sublen! If used
-             * improperly, can cause undefined behavior or memory errors.
-             * \param the first index of the range to replace in the onestring
-             * \param the number of characters in the range to replace
-             * \param the number of characters that will be substituted in
-             * place of the given range */
-        inline void replace_setup(size_t pos, size_t len, size_t sublen);
+        /** Appends characters to the end of the onestring.
+             * \param the onestring_view to append from */
+        void push_back(const onestring_view& view) { append(view); }
 
     public:
         /** Replaces characters in the onestring.
@@ -533,6 +868,14 @@ class onestring
              * \return a reference to the onestring */
         onestring& replace(size_t pos, size_t len, const onestring& ostr);
 
+        /** Replaces characters in the onestring.
+             * \param the first position to replace.
+             * If this is greater than the string length, it throws out_of_range.
+             * \param the number of characters to replace.
+             * \param the onestring_view to replace from.
+             * \return a reference to the onestring */
+        onestring& replace(size_t pos, size_t len, const onestring_view& view);
+
         /** Replaces characters in the onestring.
              * \param the first position to replace.
              * If this is greater than the string length, it throws out_of_range.
@@ -603,19 +946,22 @@ class onestring
         ********************************************/
 
         onechar& operator[](size_t pos) { return at(pos); }
-        const onechar& operator[](size_t pos) const { return at(pos); }
+        onechar operator[](size_t pos) const { return at(pos); }
 
         onestring& operator=(char ch) { assign(ch); return *this; }
         onestring& operator=(const onechar& ochr) { assign(ochr); return *this; }
         onestring& operator=(const char* cstr) { assign(cstr); return *this; }
         onestring& operator=(const std::string& str) { assign(str); return *this; }
         onestring& operator=(const onestring& ostr) { assign(ostr); return *this; }
+        onestring& operator=(onestring&& ostr) noexcept { return assign(std::move(ostr)); }
+        onestring& operator=(const onestring_view& view) { assign(view); return *this; }
 
         void operator+=(const char ch) { append(ch); }
         void operator+=(const onechar& ochr) { append(ochr); }
         void operator+=(const char* cstr) { append(cstr); }
         void operator+=(const std::string& str) { append(str); }
         void operator+=(const onestring& ostr) { append(ostr); }
+        void operator+=(const onestring_view& view) { append(view); }
 
      /** Combines a onestring and a char.
       * \param lhs: the operand on the left of the operator 
@@ -642,6 +988,21 @@ class onestring
      // Combine a onestring and a onestring.
         friend onestring operator+(const onestring& lhs, const onestring& rhs);
 
+     /* When the left operand is a temporary, as it is for every + after
+      * the first in a chain, the right is appended to it in place. */
+        friend onestring operator+(onestring&& lhs, const char& rhs);
+        friend onestring operator+(onestring&& lhs, const std::string& rhs);
+        friend onestring operator+(onestring&& lhs, const char* rhs);
+        friend onestring operator+(onestring&& lhs, const onestring& rhs);
+
+        /** Joins any number of pieces of text into a new onestring.
+             * The total size is worked out first, so this allocates at
+             * most once, unlike a chain of +.
+             * \param the pieces, in order, such as
+             * onestring::concat({name, ": ", value})
+             * \return the new onestring */
+        static onestring concat(std::initializer_list<onestring_view> parts);
+
         bool operator==(const char ch) const { return equals(ch); }
         bool operator==(const onechar& ochr) const { return equals(ochr); }
         bool operator==(const char* cstr) const { return equals(cstr); }
@@ -724,11 +1085,22 @@ class onestring
 
         friend std::ostream& operator<<(std::ostream& os, const onestring& ostr)
         {
-            os << ostr.c_str();
+            ostr.sync();
+            os.write(ostr.internal, ostr._bytes);
             return os;
         }
 };
 
+// The short string buffer, and seven words besides.
+static_assert(sizeof(onestring) <= 24 + 7 * sizeof(void*),
+              "onestring has grown; keep rarely used members in Extras.");
 
+namespace std
+{
+    template<> struct hash<onestring>
+    {
+        size_t operator()(const onestring& ostr) const { return ostr.hash(); }
+    };
+}
 
 #endif // PAWLIB_ONESTRING_HPP
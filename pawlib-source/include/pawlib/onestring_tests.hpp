@@ -42,7 +42,11 @@
 #ifndef PAWLIB_ONESTRING_TESTS_HPP
 #define PAWLIB_ONESTRING_TESTS_HPP
 
+#include <atomic>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
 
 #include "pawlib/goldilocks.hpp"
 #include "pawlib/onestring.hpp"
@@ -3108,6 +3112,776 @@ class TestOnestring_OpPlus : public TestOnestring
         }
 };
 
+// P-tB4041
+class TestOnestring_Index : public Test
+{
+    protected:
+        const char* pattern[4] = {"a", "é", "‽", "🐉"};
+        onestring test;
+    public:
+        TestOnestring_Index(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: Indexing Mixed-Width Text";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Read characters by index from a long string of mixed byte widths, before and after editing it near the front.";
+        }
+
+        bool janitor() override
+        {
+            test.clear();
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                test.append(pattern[i % 4]);
+            }
+            return (test.length() == 1000);
+        }
+
+        bool run() override
+        {
+            for (size_t i = 0; i < 1000; i += 7)
+            {
+                PL_ASSERT_EQUAL(test[i], pattern[i % 4]);
+            }
+
+            // Shift every character after the front by one place.
+            test.erase(0, 1);
+            for (size_t i = 999; i > 0; i -= 9)
+            {
+                PL_ASSERT_EQUAL(test[i - 1], pattern[i % 4]);
+            }
+
+            // Writing through a reference changes the byte width in place.
+            test[1] = "a";
+            PL_ASSERT_EQUAL(test[1], "a");
+            PL_ASSERT_EQUAL(test[2], "🐉");
+            PL_ASSERT_EQUAL(test[998], "🐉");
+            PL_ASSERT_EQUAL(test.length(), 999u);
+            PL_ASSERT_EQUAL(onestring::characterCount(test.c_str()), 999u);
+            return true;
+        }
+};
+
+// P-tB4042*
+class TestStdString_ShortCopy : public Test
+{
+    protected:
+        std::string source = "user_id→🔑";
+    public:
+        TestStdString_ShortCopy(){}
+
+        testdoc_t get_title() override
+        {
+            return "std::string: Copy Short Strings";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Copy and append to a short string many times, using std::string's small string optimization.";
+        }
+
+        bool run() override
+        {
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                std::string copy(source);
+                copy.push_back('!');
+                PL_ASSERT_EQUAL(copy.length(), source.length() + 1);
+            }
+            return true;
+        }
+};
+
+// P-tB4042
+class TestOnestring_ShortCopy : public Test
+{
+    protected:
+        onestring source = "user_id→🔑";
+    public:
+        TestOnestring_ShortCopy(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: Copy Short Strings";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Copy and append to a short string many times. Short strings are stored in the object itself, without allocating.";
+        }
+
+        bool run() override
+        {
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                onestring copy(source);
+                copy.append('!');
+                PL_ASSERT_EQUAL(copy.length(), source.length() + 1);
+            }
+            return true;
+        }
+};
+
+// P-tB4043
+class TestOnestring_Data : public Test
+{
+    public:
+        TestOnestring_Data(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: data()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Test that c_str() and data() hand out the string's own buffer, kept current as it changes.";
+        }
+
+        bool run() override
+        {
+            onestring test = "The quick brown 🦊 jumped over the lazy 🐶.";
+            PL_ASSERT_EQUAL(test.c_str(), test.data());
+            PL_ASSERT_EQUAL(test.c_str(), test.c_str());
+
+            test[16] = "🐺";
+            std::string_view view(test.data(), test.size() - 1);
+            PL_ASSERT_TRUE(view == "The quick brown 🐺 jumped over the lazy 🐶.");
+
+            test.erase(9);
+            PL_ASSERT_EQUAL(strcmp(test.data(), "The quick"), 0);
+            return true;
+        }
+};
+
+// P-tB4044
+class TestOnestring_Validate : public Test
+{
+    protected:
+        std::string text;
+    public:
+        TestOnestring_Validate(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: Validate and Count UTF-8";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Validate and count long runs of mixed-width UTF-8, then break the text in several ways and count it again.";
+        }
+
+        bool janitor() override
+        {
+            text.clear();
+            for (size_t i = 0; i < 250; ++i)
+            {
+                text += "a‽é🐉";
+            }
+            return (text.size() == 2500);
+        }
+
+        bool run() override
+        {
+            PL_ASSERT_TRUE(utf8::validate(text.data(), text.size()));
+            PL_ASSERT_EQUAL(utf8::count_if_valid(text.data(), text.size()), 1000u);
+            PL_ASSERT_EQUAL(onestring::characterCount(text.c_str()), 1000u);
+
+            // Cut the last character short.
+            PL_ASSERT_FALSE(utf8::validate(text.data(), text.size() - 1));
+            PL_ASSERT_EQUAL(utf8::count(text.data(), text.size() - 1), 1000u);
+
+            // An overlong encoding, a surrogate, and a stray continuation
+            const char* broken[3] = {"\xC0\xAF", "\xED\xA0\x80", "\x80"};
+            for (const char* bytes : broken)
+            {
+                std::string bad = text;
+                bad.insert(1200, bytes);
+                PL_ASSERT_FALSE(utf8::validate(bad.data(), bad.size()));
+                PL_ASSERT_EQUAL(onestring(bad).length(), utf8::count(bad.data(), bad.size()));
+            }
+            return true;
+        }
+};
+
+// P-tB4045
+class TestOnestring_Transcode : public Test
+{
+    public:
+        TestOnestring_Transcode(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: Convert to and from UTF-16 and UTF-32";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Convert mixed-width text to UTF-16 and UTF-32 and back, and check that malformed characters become U+FFFD.";
+        }
+
+        bool run() override
+        {
+            onestring test = "The quick brown 🦊 jumped over the lazy 🐶, ‽é.";
+            std::u16string utf16 = test.to_utf16();
+            std::u32string utf32 = test.to_utf32();
+            PL_ASSERT_TRUE(utf16 == u"The quick brown 🦊 jumped over the lazy 🐶, ‽é.");
+            PL_ASSERT_TRUE(utf32 == U"The quick brown 🦊 jumped over the lazy 🐶, ‽é.");
+            PL_ASSERT_EQUAL(utf32.size(), test.length());
+            PL_ASSERT_EQUAL(onestring::from_utf16(utf16), test);
+            PL_ASSERT_EQUAL(onestring::from_utf32(utf32), test);
+
+            onestring bad = "a\xED\xA0\x80" "b";
+            PL_ASSERT_TRUE(bad.to_utf32() == U"a�b");
+            PL_ASSERT_EQUAL(onestring::from_utf16(u"\xD800z"), "�z");
+            return true;
+        }
+};
+
+// P-tB4035*
+class TestStdString_Find : public Test
+{
+    protected:
+        std::string test;
+    public:
+        TestStdString_Find(){}
+
+        testdoc_t get_title() override
+        {
+            return "std::string: find()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Find a long needle near the end of a long, repetitive string.";
+        }
+
+        bool janitor() override
+        {
+            test.clear();
+            for (size_t i = 0; i < 500; ++i)
+            {
+                test += "INFO: request served; ";
+            }
+            test += "ERROR: request failed; ";
+            return true;
+        }
+
+        bool run() override
+        {
+            PL_ASSERT_EQUAL(test.find("ERROR: request failed"), 11000u);
+            PL_ASSERT_EQUAL(test.find("WARN: request"), std::string::npos);
+            return true;
+        }
+};
+
+// P-tB4035
+class TestOnestring_Find : public Test
+{
+    protected:
+        onestring test;
+    public:
+        TestOnestring_Find(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: find()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Find text in a onestring, counting the result in characters, and find a long needle near the end of a long, repetitive string.";
+        }
+
+        bool janitor() override
+        {
+            test.clear();
+            for (size_t i = 0; i < 500; ++i)
+            {
+                test += "INFO: request served; ";
+            }
+            test += "ERROR: request failed; ";
+            return true;
+        }
+
+        bool run() override
+        {
+            PL_ASSERT_EQUAL(test.find("ERROR: request failed"), 11000u);
+            PL_ASSERT_EQUAL(test.find("WARN: request"), onestring::npos);
+
+            onestring mixed = "The 🦊 jumped over the 🐶, and the 🐶 slept.";
+            PL_ASSERT_EQUAL(mixed.find("🐶"), 22u);
+            PL_ASSERT_EQUAL(mixed.find("🐶", 23), 33u);
+            PL_ASSERT_EQUAL(mixed.find('.'), 40u);
+            PL_ASSERT_EQUAL(mixed.find(""), 0u);
+            PL_ASSERT_EQUAL(mixed.find("🐺"), onestring::npos);
+            PL_ASSERT_EQUAL(mixed.find("the", 100), onestring::npos);
+            PL_ASSERT_TRUE(mixed.contains("jumped"));
+            PL_ASSERT_FALSE(mixed.contains("🐺"));
+            return true;
+        }
+};
+
+// P-tB4036
+class TestOnestring_FindFirstNotOf : public Test
+{
+    public:
+        TestOnestring_FindFirstNotOf(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: find_first_not_of()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Find the first character not in a set of mixed-width characters.";
+        }
+
+        bool run() override
+        {
+            onestring test = "‽‽ é‽ hello";
+            PL_ASSERT_EQUAL(test.find_first_not_of("‽ "), 3u);
+            PL_ASSERT_EQUAL(test.find_first_not_of("‽ é"), 6u);
+            PL_ASSERT_EQUAL(test.find_first_not_of("‽ é", 7), 7u);
+            PL_ASSERT_EQUAL(test.find_first_not_of("‽ éhelo"), onestring::npos);
+            PL_ASSERT_EQUAL(test.find_first_not_of(""), 0u);
+            return true;
+        }
+};
+
+// P-tB4037
+class TestOnestring_FindFirstOf : public Test
+{
+    public:
+        TestOnestring_FindFirstOf(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: find_first_of()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Find the first character in a set of mixed-width characters.";
+        }
+
+        bool run() override
+        {
+            onestring test = "key→value; 🔑→🔒";
+            PL_ASSERT_EQUAL(test.find_first_of("→;"), 3u);
+            PL_ASSERT_EQUAL(test.find_first_of(";🔒"), 9u);
+            PL_ASSERT_EQUAL(test.find_first_of("→", 4), 12u);
+            PL_ASSERT_EQUAL(test.find_first_of("🔒"), 13u);
+            PL_ASSERT_EQUAL(test.find_first_of("xqz"), onestring::npos);
+            PL_ASSERT_EQUAL(test.find_first_of(""), onestring::npos);
+            return true;
+        }
+};
+
+// P-tB4038
+class TestOnestring_FindLastNotOf : public Test
+{
+    public:
+        TestOnestring_FindLastNotOf(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: find_last_not_of()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Find the last character not in a set, in ASCII and mixed-width strings.";
+        }
+
+        bool run() override
+        {
+            onestring ascii = "trim me   \t\n";
+            PL_ASSERT_EQUAL(ascii.find_last_not_of(" \t\n"), 6u);
+            PL_ASSERT_EQUAL(ascii.find_last_not_of(" \t\n", 3), 3u);
+            PL_ASSERT_EQUAL(ascii.find_last_not_of(" \t\n", 4), 3u);
+
+            onestring mixed = "¡hola! ‽‽ ";
+            PL_ASSERT_EQUAL(mixed.find_last_not_of("‽ "), 5u);
+            PL_ASSERT_EQUAL(mixed.find_last_not_of("‽ !"), 4u);
+            PL_ASSERT_EQUAL(mixed.find_last_not_of("‽ !¡hola"), onestring::npos);
+            PL_ASSERT_EQUAL(mixed.find_last_of("¡"), 0u);
+            return true;
+        }
+};
+
+// P-tB4039
+class TestOnestring_RFind : public Test
+{
+    public:
+        TestOnestring_RFind(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: rfind()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Find the last occurrence of text in a onestring, counting the result in characters.";
+        }
+
+        bool run() override
+        {
+            onestring test = "The 🦊 jumped over the 🐶, and the 🐶 slept.";
+            PL_ASSERT_EQUAL(test.rfind("🐶"), 33u);
+            PL_ASSERT_EQUAL(test.rfind("🐶", 32), 22u);
+            PL_ASSERT_EQUAL(test.rfind("the"), 29u);
+            PL_ASSERT_EQUAL(test.rfind('T'), 0u);
+            PL_ASSERT_EQUAL(test.rfind(""), test.length());
+            PL_ASSERT_EQUAL(test.rfind("🐺"), onestring::npos);
+            return true;
+        }
+};
+
+// P-tB4046
+class TestOnestring_Move : public Test
+{
+    public:
+        TestOnestring_Move(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: Move and Reuse Buffers";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Move onestrings, checking that long ones hand over their buffers, and that concat(), shrink_to_fit(), and assignment don't reallocate needlessly.";
+        }
+
+        bool run() override
+        {
+            onestring source = "The quick brown 🦊 jumped over the lazy 🐶.";
+            const char* buffer = source.c_str();
+
+            onestring moved(std::move(source));
+            PL_ASSERT_EQUAL(moved.c_str(), buffer);
+            PL_ASSERT_EQUAL(moved, "The quick brown 🦊 jumped over the lazy 🐶.");
+            PL_ASSERT_TRUE(source.empty());
+            PL_ASSERT_EQUAL(source, "");
+
+            onestring target = "🐉";
+            target = std::move(moved);
+            PL_ASSERT_EQUAL(target.c_str(), buffer);
+            PL_ASSERT_EQUAL(target.length(), 41u);
+            PL_ASSERT_TRUE(moved.empty());
+
+            // Short strings are copied out of the object they live in.
+            onestring small = "Déjà vu";
+            onestring small_moved(std::move(small));
+            PL_ASSERT_EQUAL(small_moved, "Déjà vu");
+            PL_ASSERT_NOT_EQUAL(small_moved.c_str(), small.c_str());
+
+            // A moved-from onestring can be used again.
+            source = "reused";
+            PL_ASSERT_EQUAL(source, "reused");
+
+            onestring line = onestring::concat({"temperature", ": ", "21.5 °C"});
+            PL_ASSERT_EQUAL(line, "temperature: 21.5 °C");
+
+            // Exact-sized strings don't move when shrunk again.
+            line.shrink_to_fit();
+            const char* kept = line.c_str();
+            line.shrink_to_fit();
+            PL_ASSERT_EQUAL(line.c_str(), kept);
+
+            // Assigning something no bigger reuses the buffer.
+            line = "humidity: n/a";
+            PL_ASSERT_EQUAL(line.c_str(), kept);
+            return true;
+        }
+};
+
+// P-tB4047*
+class TestStdString_Concat : public Test
+{
+    protected:
+        std::string name = "temperature";
+        std::string value = "21.5";
+        std::string unit = "°C";
+
+    public:
+        TestStdString_Concat(){}
+
+        testdoc_t get_title() override
+        {
+            return "std::string: Concatenate with +";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Build a line from several pieces with a chain of +.";
+        }
+
+        bool run() override
+        {
+            std::string line = name + ": " + value + " " + unit + " (sensor 🌡️ #4)";
+            PL_ASSERT_EQUAL(line.size(), 41u);
+            return true;
+        }
+};
+
+// P-tB4047
+class TestOnestring_Concat : public Test
+{
+    protected:
+        onestring name = "temperature";
+        onestring value = "21.5";
+        onestring unit = "°C";
+
+    public:
+        TestOnestring_Concat(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: Concatenate with +";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Build a line from several pieces with a chain of +.";
+        }
+
+        bool run() override
+        {
+            onestring line = name + ": " + value + " " + unit + " (sensor 🌡️ #4)";
+            PL_ASSERT_EQUAL(line.size(), 42u);
+            return true;
+        }
+};
+
+// P-tB4048
+class TestOnestring_Hash : public Test
+{
+    public:
+        TestOnestring_Hash(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: hash()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Check that equal text hashes the same in every type, that edits change the cached hash, and that onestring works as an unordered_set key.";
+        }
+
+        bool run() override
+        {
+            onestring test = "Ĉiu ĵaŭde 🦊";
+            onestring_view view("Ĉiu ĵaŭde 🦊");
+            PL_ASSERT_EQUAL(test.hash(), view.hash());
+            PL_ASSERT_EQUAL(std::hash<onestring>()(test), std::hash<onestring_view>()(view));
+            PL_ASSERT_EQUAL(onestring().hash(), onestring_view().hash());
+            PL_ASSERT_EQUAL(onechar("🦊").hash(), onestring("🦊").hash());
+            PL_ASSERT_EQUAL(std::hash<onechar>()(onechar('a')), onestring('a').hash());
+
+            // Every length through the short and long paths must agree.
+            std::string text;
+            for (size_t i = 0; i < 100; ++i)
+            {
+                PL_ASSERT_EQUAL(onestring(text).hash(), onestring_view(text).hash());
+                text += static_cast<char>('a' + (i % 26));
+            }
+
+            size_t before = test.hash();
+            test.append("!");
+            PL_ASSERT_NOT_EQUAL(test.hash(), before);
+            test.erase(test.length() - 1);
+            PL_ASSERT_EQUAL(test.hash(), before);
+
+            // Writing through a reference from [] counts as an edit.
+            test[0] = "C";
+            PL_ASSERT_EQUAL(test.hash(), onestring_view("Ciu ĵaŭde 🦊").hash());
+            test.reverse();
+            PL_ASSERT_EQUAL(test.hash(), onestring_view("🦊 edŭaĵ uiC").hash());
+
+            onestring other;
+            other.swap(test);
+            PL_ASSERT_EQUAL(other.hash(), onestring_view("🦊 edŭaĵ uiC").hash());
+            PL_ASSERT_EQUAL(test.hash(), onestring_view().hash());
+
+            std::unordered_set<onestring> words;
+            words.insert("ĉiu");
+            words.insert("ĵaŭde");
+            words.insert("ĉiu");
+            PL_ASSERT_EQUAL(words.size(), 2u);
+            PL_ASSERT_EQUAL(words.count("ĵaŭde"), 1u);
+            PL_ASSERT_EQUAL(words.count("jaude"), 0u);
+            return true;
+        }
+};
+
+// P-tB4049*
+class TestStdString_Hash : public Test
+{
+    protected:
+        std::string test = "The quick brown fox jumped over the lazy dog.";
+
+    public:
+        TestStdString_Hash(){}
+
+        testdoc_t get_title() override
+        {
+            return "std::string: Hash";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Hash a 45-byte string with std::hash.";
+        }
+
+        bool run() override
+        {
+            std::hash<std::string_view>()(test);
+            return true;
+        }
+};
+
+// P-tB4049
+class TestOnestring_HashView : public Test
+{
+    protected:
+        onestring_view test = onestring_view("The quick brown fox jumped over the lazy dog.");
+
+    public:
+        TestOnestring_HashView(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: Hash a view";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Hash a 45-byte onestring_view, which is never cached.";
+        }
+
+        bool run() override
+        {
+            test.hash();
+            return true;
+        }
+};
+
+// P-tB4050
+class TestOnestring_ElementAccess : public Test
+{
+    protected:
+        const char* pattern[4] = {"a", "é", "‽", "🐉"};
+
+    public:
+        TestOnestring_ElementAccess(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: Element Access";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Write through references from [], read the changes back through a const onestring, and read one const onestring from four threads at once.";
+        }
+
+        bool run() override
+        {
+            onestring test;
+            for (size_t i = 0; i < 20000; ++i)
+            {
+                test.append(pattern[i % 4]);
+            }
+            const onestring& view = test;
+
+            // A write waiting in a reference shows through const reads.
+            onechar& first = test[0];
+            onechar& second = test[1];
+            std::swap(first, second);
+            PL_ASSERT_EQUAL(view[0], "é");
+            PL_ASSERT_EQUAL(view.front(), "é");
+            PL_ASSERT_EQUAL(view[1], "a");
+            PL_ASSERT_EQUAL(view[2], "‽");
+            PL_ASSERT_EQUAL(view.back(), "🐉");
+            PL_ASSERT_EQUAL(onestring_view(test).substr(0, 3), "éa‽");
+
+            // Touching every character, then reading the whole, writes none back.
+            size_t dragons = 0;
+            for (size_t i = 0; i < test.length(); ++i)
+            {
+                if (test[i] == "🐉") { ++dragons; }
+            }
+            PL_ASSERT_EQUAL(dragons, 5000u);
+            PL_ASSERT_EQUAL(onestring::characterCount(test.c_str()), 20000u);
+
+            std::atomic<size_t> mismatches(0);
+            std::vector<std::thread> readers;
+            for (size_t t = 0; t < 4; ++t)
+            {
+                readers.emplace_back([&view, &mismatches, this, t]()
+                {
+                    for (size_t i = 2 + t; i < view.length(); i += 3)
+                    {
+                        if (view[i] != pattern[i % 4]) { ++mismatches; }
+                    }
+                });
+            }
+            for (std::thread& reader : readers)
+            {
+                reader.join();
+            }
+            PL_ASSERT_EQUAL(mismatches.load(), 0u);
+            return true;
+        }
+};
+
+// P-tB4051
+class TestOnestring_ReferenceLifetime : public Test
+{
+    public:
+        TestOnestring_ReferenceLifetime(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: References Outlive Reads";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Hold references from [], front() and back() across whole-string reads such as == and c_str(), then write through them.";
+        }
+
+        bool run() override
+        {
+            onestring test = "hello world";
+            onechar& first = test[0];
+            onechar& last = test.back();
+            PL_ASSERT_TRUE(test == "hello world");
+            PL_ASSERT_EQUAL(strcmp(test.c_str(), "hello world"), 0);
+            PL_ASSERT_NOT_EQUAL(test.hash(), 0u);
+            first = 'J';
+            PL_ASSERT_EQUAL(test, "Jello world");
+
+            // A reference that was written through stays good, too.
+            PL_ASSERT_EQUAL(strcmp(test.c_str(), "Jello world"), 0);
+            last = "🐉";
+            first = "é";
+            PL_ASSERT_EQUAL(test, "éello worl🐉");
+            PL_ASSERT_TRUE(test.front() == "é");
+            return true;
+        }
+};
+
 class TestSuite_Onestring : public TestSuite
 {
     public:
@@ -0,0 +1,318 @@
+/** Onestring View [PawLIB]
+  * Version: 0.1
+  *
+  * A non-owning, read-only view of UTF-8 text: a pointer, a byte length,
+  * and a character count that is worked out once and then cached. Views
+  * can be made from onestrings, std::strings, and c-strings, and cut
+  * down with substr() and searched with find() and its relatives, all
+  * without allocating.
+  *
+  * Author(s): Jason C. McDonald
+  */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2019 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef PAWLIB_ONESTRING_VIEW_HPP
+#define PAWLIB_ONESTRING_VIEW_HPP
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "pawlib/onechar.hpp"
+#include "pawlib/stdutils.hpp"
+
+class onestring;
+
+class onestring_view
+{
+    public:
+        /// The greatest possible value for an element.
+        inline static const size_t npos = -1;
+
+    private:
+        /// The first byte of the text, which is not null-terminated
+        const char* _data;
+
+        /// The number of bytes in the view
+        size_t _bytes;
+
+        /// The number of characters in the view, or npos until counted
+        mutable size_t _elements;
+
+        /** Finds where a character starts in the view.
+             * \param the index of the character; anything past the end
+             * gives the end of the view
+             * \return the byte offset of the character */
+        size_t offset(size_t pos) const;
+
+        /** Counts the characters in the first bytes of the view.
+             * \param the number of bytes to count through
+             * \return the number of characters */
+        size_t count(size_t bytes) const;
+
+        /** Finds the character that starts at a byte offset.
+             * \param the byte offset, at most size()
+             * \return the index of the character, or npos if the offset
+             * falls inside a character */
+        size_t index_at(size_t byte) const;
+
+        /** Finds the first character at or after pos that is (or isn't)
+             * one of a set of characters.
+             * \param the set of characters
+             * \param the character to start searching from
+             * \param true to find a character in the set, false to find
+             * one that isn't
+             * \return the index of the character, or npos */
+        size_t find_of(const onestring_view& chars, size_t pos, bool in) const;
+
+        /** Finds the last character at or before pos that is (or isn't)
+             * one of a set of characters.
+             * \param the set of characters
+             * \param the last character to search
+             * \param true to find a character in the set, false to find
+             * one that isn't
+             * \return the index of the character, or npos */
+        size_t rfind_of(const onestring_view& chars, size_t pos, bool in) const;
+
+    public:
+        /*******************************************
+        * Constructors
+        *******************************************/
+
+        /**Default Constructor, an empty view*/
+        onestring_view()
+        : _data(""), _bytes(0), _elements(0)
+        {}
+
+        /**View a c-string (string literal)
+        * \param the null-terminated c-string to view */
+        // cppcheck-suppress noExplicitConstructor
+        onestring_view(const char* cstr)
+        : _data(cstr), _bytes(strlen(cstr)), _elements(npos)
+        {}
+
+        /**View a number of bytes of UTF-8
+        * \param the first byte to view
+        * \param the number of bytes
+        * \param the number of characters in those bytes, if known */
+        onestring_view(const char* data, size_t bytes, size_t elements = npos)
+        : _data(data), _bytes(bytes), _elements(elements)
+        {}
+
+        /**View a std::string
+        * \param the string to view */
+        // cppcheck-suppress noExplicitConstructor
+        onestring_view(const std::string& str)
+        : _data(str.data()), _bytes(str.size()), _elements(npos)
+        {}
+
+        /**View a std::string_view
+        * \param the string_view to view */
+        // cppcheck-suppress noExplicitConstructor
+        onestring_view(std::string_view str)
+        : _data(str.data()), _bytes(str.size()), _elements(npos)
+        {}
+
+        /**View a onestring. The view is good until the onestring is
+        * next modified.
+        * \param the onestring to view */
+        // cppcheck-suppress noExplicitConstructor
+        onestring_view(const onestring& ostr);
+
+        /*******************************************
+        * Accessors
+        ********************************************/
+
+        /** Gets a character in the view.
+             * \param the index of the character
+             * \throws std::out_of_range if pos is past the end
+             * \return a copy of the character */
+        onechar at(size_t pos) const;
+
+        /// \return a copy of the first character, or a null onechar if empty
+        onechar front() const { return empty() ? onechar() : at(0); }
+
+        /// \return a copy of the last character, or a null onechar if empty
+        onechar back() const { return empty() ? onechar() : at(length() - 1); }
+
+        /// \return the first byte in the view, which is NOT null-terminated
+        const char* data() const { return _data; }
+
+        /// \return whether the view contains no characters
+        bool empty() const { return (_bytes == 0); }
+
+        /// \return the number of characters in the view
+        size_t length() const;
+
+        /** Unlike onestring::size(), this does not include a null
+             * terminator, since a view does not have one.
+             * \return the number of bytes in the view */
+        size_t size() const { return _bytes; }
+
+        /** Hashes the bytes of the view. Equal text hashes the same in a
+             * onestring_view, onestring, onechar, or oneatom.
+             * \return the hash */
+        size_t hash() const { return stdutils::hash(_data, _bytes); }
+
+        /** Views part of the view.
+             * \param the position of the first character
+             * \param the number of characters, optional
+             * \throws std::out_of_range if pos is past the end
+             * \return the new view */
+        onestring_view substr(size_t pos, size_t len = npos) const;
+
+        /** Drops characters from the front of the view.
+             * \param the number of characters to drop */
+        void remove_prefix(size_t n);
+
+        /** Drops characters from the back of the view.
+             * \param the number of characters to drop */
+        void remove_suffix(size_t n);
+
+        /** Finds the first occurrence of other text in the view.
+             * \param the text to find
+             * \param the character to start searching from, optional
+             * \return the index of the first character of the match,
+             * or npos if there isn't one */
+        size_t find(const onestring_view& needle, size_t pos = 0) const;
+
+        /** Finds the last occurrence of other text in the view.
+             * \param the text to find
+             * \param the last character a match may start at, optional
+             * \return the index of the first character of the match,
+             * or npos if there isn't one */
+        size_t rfind(const onestring_view& needle, size_t pos = npos) const;
+
+        /** Checks whether other text occurs in the view.
+             * \param the text to find
+             * \return true if found, else false */
+        bool contains(const onestring_view& needle) const
+        {
+            return (find(needle) != npos);
+        }
+
+        /** Finds the first character that is one of a set of characters.
+             * \param the set of characters
+             * \param the character to start searching from, optional
+             * \return the index of the character, or npos if none match */
+        size_t find_first_of(const onestring_view& chars, size_t pos = 0) const
+        {
+            return find_of(chars, pos, true);
+        }
+
+        /** Finds the first character that is not one of a set of
+             * characters.
+             * \param the set of characters
+             * \param the character to start searching from, optional
+             * \return the index of the character, or npos if all match */
+        size_t find_first_not_of(const onestring_view& chars, size_t pos = 0) const
+        {
+            return find_of(chars, pos, false);
+        }
+
+        /** Finds the last character that is one of a set of characters.
+             * \param the set of characters
+             * \param the last character to search, optional
+             * \return the index of the character, or npos if none match */
+        size_t find_last_of(const onestring_view& chars, size_t pos = npos) const
+        {
+            return rfind_of(chars, pos, true);
+        }
+
+        /** Finds the last character that is not one of a set of
+             * characters.
+             * \param the set of characters
+             * \param the last character to search, optional
+             * \return the index of the character, or npos if all match */
+        size_t find_last_not_of(const onestring_view& chars, size_t pos = npos) const
+        {
+            return rfind_of(chars, pos, false);
+        }
+
+        /// \return the same bytes as a std::string_view
+        explicit operator std::string_view() const
+        {
+            return std::string_view(_data, _bytes);
+        }
+
+        /*******************************************
+        * Comparison
+        ********************************************/
+
+        /** Compares two pieces of text. As with onestring, the one with
+             * fewer characters sorts first, and then the first differing
+             * character decides it.
+             * \param the text to compare against
+             * \return 0 if equal, negative if lesser, positive if greater */
+        int compare(const onestring_view& other) const;
+
+        /** Checks if two pieces of text are the same.
+             * \param the text to compare against
+             * \return true if equal, else false */
+        bool equals(const onestring_view& other) const
+        {
+            return (_bytes == other._bytes
+                    && memcmp(_data, other._data, _bytes) == 0);
+        }
+
+        onechar operator[](size_t pos) const { return at(pos); }
+
+        friend bool operator==(const onestring_view& lhs, const onestring_view& rhs) { return lhs.equals(rhs); }
+        friend bool operator!=(const onestring_view& lhs, const onestring_view& rhs) { return !lhs.equals(rhs); }
+        friend bool operator<(const onestring_view& lhs, const onestring_view& rhs) { return (lhs.compare(rhs) < 0); }
+        friend bool operator<=(const onestring_view& lhs, const onestring_view& rhs) { return (lhs.compare(rhs) <= 0); }
+        friend bool operator>(const onestring_view& lhs, const onestring_view& rhs) { return (lhs.compare(rhs) > 0); }
+        friend bool operator>=(const onestring_view& lhs, const onestring_view& rhs) { return (lhs.compare(rhs) >= 0); }
+
+        friend std::ostream& operator<<(std::ostream& os, const onestring_view& view)
+        {
+            os.write(view._data, view._bytes);
+            return os;
+        }
+};
+
+namespace std
+{
+    template<> struct hash<onestring_view>
+    {
+        size_t operator()(const onestring_view& view) const { return view.hash(); }
+    };
+}
+
+#endif // PAWLIB_ONESTRING_VIEW_HPP
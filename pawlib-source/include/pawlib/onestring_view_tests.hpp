@@ -0,0 +1,372 @@
+/** Tests for onestring_view [PawLIB]
+  * Version: 0.1
+  *
+  * Author(s): Jason C. McDonald
+  */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2019 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef PAWLIB_ONESTRING_VIEW_TESTS_HPP
+#define PAWLIB_ONESTRING_VIEW_TESTS_HPP
+
+#include <string>
+
+#include "pawlib/goldilocks.hpp"
+#include "pawlib/onestring.hpp"
+#include "pawlib/onestring_view.hpp"
+
+// P-tB4201
+class TestOnestringView_Construct : public Test
+{
+    public:
+        TestOnestringView_Construct(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring View: Construct";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "View a c-string, std::string, and onestring, and check their lengths.";
+        }
+
+        bool run() override
+        {
+            const char* cstr = "The quick brown 🦊";
+            std::string str = cstr;
+            onestring ostr = cstr;
+
+            onestring_view from_cstr = cstr;
+            onestring_view from_str = str;
+            onestring_view from_ostr = ostr;
+
+            PL_ASSERT_EQUAL(from_cstr.length(), 17u);
+            PL_ASSERT_EQUAL(from_str.length(), 17u);
+            PL_ASSERT_EQUAL(from_ostr.length(), 17u);
+            PL_ASSERT_EQUAL(from_cstr.size(), strlen(cstr));
+            PL_ASSERT_EQUAL(from_str.data(), str.data());
+            PL_ASSERT_EQUAL(from_ostr.data(), ostr.c_str());
+            PL_ASSERT_TRUE(onestring_view().empty());
+            return true;
+        }
+};
+
+// P-tB4202
+class TestOnestringView_At : public Test
+{
+    protected:
+        onestring_view test = "The quick brown 🦊 jumped over the lazy 🐶.";
+
+    public:
+        TestOnestringView_At(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring View: at()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Read characters from a view with at(), [], front(), and back().";
+        }
+
+        bool run() override
+        {
+            PL_ASSERT_EQUAL(test.at(16), "🦊");
+            PL_ASSERT_EQUAL(test[17], " ");
+            PL_ASSERT_EQUAL(test.front(), "T");
+            PL_ASSERT_EQUAL(test.back(), ".");
+            try
+            {
+                test.at(test.length());
+            }
+            catch (const std::out_of_range&)
+            {
+                return true;
+            }
+            return false;
+        }
+};
+
+// P-tB4203
+class TestOnestringView_Substr : public Test
+{
+    protected:
+        onestring source = "The quick brown 🦊 jumped over the lazy 🐶.";
+
+    public:
+        TestOnestringView_Substr(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring View: substr()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Cut down a view with substr(), remove_prefix(), and remove_suffix().";
+        }
+
+        bool run() override
+        {
+            onestring_view test = source;
+            onestring_view fox = test.substr(16, 8);
+            PL_ASSERT_EQUAL(fox, "🦊 jumped");
+            PL_ASSERT_EQUAL(fox.length(), 8u);
+            PL_ASSERT_EQUAL(test.substr(39), "🐶.");
+            PL_ASSERT_TRUE(test.substr(41).empty());
+
+            test.remove_prefix(4);
+            test.remove_suffix(3);
+            PL_ASSERT_EQUAL(test, "quick brown 🦊 jumped over the lazy");
+            return true;
+        }
+};
+
+// P-tB4204
+class TestOnestringView_Find : public Test
+{
+    protected:
+        onestring_view test = "🐶 the 🐶 the 🐶";
+
+    public:
+        TestOnestringView_Find(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring View: find()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Find text in a view, by character position.";
+        }
+
+        bool run() override
+        {
+            PL_ASSERT_EQUAL(test.find("the"), 2u);
+            PL_ASSERT_EQUAL(test.find("🐶", 1), 6u);
+            PL_ASSERT_EQUAL(test.find("the 🐶", 3), 8u);
+            PL_ASSERT_EQUAL(test.find(""), 0u);
+            PL_ASSERT_EQUAL(test.find("cat"), onestring_view::npos);
+            PL_ASSERT_EQUAL(test.find("🐶", 13), onestring_view::npos);
+            return true;
+        }
+};
+
+// P-tB4205
+class TestOnestringView_Compare : public Test
+{
+    public:
+        TestOnestringView_Compare(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring View: compare()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Compare views, and check they order the same way onestrings do.";
+        }
+
+        bool run() override
+        {
+            onestring_view lhs = "abc🐶";
+            onestring rhs = "abc🦊";
+            PL_ASSERT_TRUE(lhs < rhs);
+            PL_ASSERT_EQUAL(rhs.compare(lhs) > 0, onestring(lhs) < rhs);
+            PL_ASSERT_TRUE(onestring_view("abc") < "abcd");
+            PL_ASSERT_TRUE(onestring_view("é") > "z");
+            PL_ASSERT_TRUE(rhs == onestring_view("abc🦊"));
+            PL_ASSERT_TRUE(onestring_view("abc🦊") == rhs);
+            PL_ASSERT_EQUAL(lhs.compare(std::string("abc🐶")), 0);
+            return true;
+        }
+};
+
+// P-tB4206
+class TestOnestringView_Onestring : public Test
+{
+    protected:
+        onestring test;
+
+    public:
+        TestOnestringView_Onestring(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring View: Onestring Functions";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Append, insert, replace, and assign from views, including views of the same onestring.";
+        }
+
+        bool janitor() override
+        {
+            test = "🐶 🦊";
+            return true;
+        }
+
+        bool run() override
+        {
+            onestring_view words = "the quick brown fox";
+            test.append(words.substr(3, 6));
+            PL_ASSERT_EQUAL(test, "🐶 🦊 quick");
+            test.insert(2, words.substr(10, 6));
+            PL_ASSERT_EQUAL(test, "🐶 brown 🦊 quick");
+            test.replace(0, 1, words.substr(16));
+            PL_ASSERT_EQUAL(test, "fox brown 🦊 quick");
+
+            // Views of the string itself outlive it growing.
+            test.append(onestring_view(test).substr(3, 6));
+            PL_ASSERT_EQUAL(test, "fox brown 🦊 quick brown");
+            test = onestring_view(test).substr(10, 7);
+            PL_ASSERT_EQUAL(test, "🦊 quick");
+            return true;
+        }
+};
+
+// P-tB4207*
+class TestOnestring_Tokenize : public Test
+{
+    protected:
+        onestring text;
+
+    public:
+        TestOnestring_Tokenize(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring: Tokenize with substr()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Split a sentence into words with onestring::substr().";
+        }
+
+        bool pre() override
+        {
+            text = "";
+            for (int i = 0; i < 20; ++i)
+            {
+                text.append("The quick brown 🦊 jumped over the lazy 🐶. ");
+            }
+            return true;
+        }
+
+        bool run() override
+        {
+            size_t words = 0;
+            size_t start = 0;
+            for (size_t i = 0; i < text.length(); ++i)
+            {
+                if (text[i] == ' ')
+                {
+                    onestring word = text.substr(start, i - start);
+                    words += (word.length() > 0);
+                    start = i + 1;
+                }
+            }
+            PL_ASSERT_EQUAL(words, 180u);
+            return true;
+        }
+};
+
+// P-tB4207
+class TestOnestringView_Tokenize : public Test
+{
+    protected:
+        onestring text;
+
+    public:
+        TestOnestringView_Tokenize(){}
+
+        testdoc_t get_title() override
+        {
+            return "Onestring View: Tokenize with substr()";
+        }
+
+        testdoc_t get_docs() override
+        {
+            return "Split a sentence into words with onestring_view::substr() and find().";
+        }
+
+        bool pre() override
+        {
+            text = "";
+            for (int i = 0; i < 20; ++i)
+            {
+                text.append("The quick brown 🦊 jumped over the lazy 🐶. ");
+            }
+            return true;
+        }
+
+        bool run() override
+        {
+            size_t words = 0;
+            onestring_view rest = text;
+            size_t space = rest.find(" ");
+            while (space != onestring_view::npos)
+            {
+                onestring_view word = rest.substr(0, space);
+                words += (word.length() > 0);
+                rest.remove_prefix(space + 1);
+                space = rest.find(" ");
+            }
+            PL_ASSERT_EQUAL(words, 180u);
+            return true;
+        }
+};
+
+class TestSuite_OnestringView : public TestSuite
+{
+    public:
+        explicit TestSuite_OnestringView(){}
+
+        void load_tests() override;
+
+        testdoc_t get_title() override
+        {
+            return "PawLIB: Onestring View Tests";
+        }
+};
+
+#endif // PAWLIB_ONESTRING_VIEW_TESTS_HPP
@@ -45,11 +45,55 @@
 #ifndef PAWLIB_PAWSORT_HPP
 #define PAWLIB_PAWSORT_HPP
 
+#include <algorithm>
+#include <climits>
 #include <cmath>
+#include <cstddef>
+#include <functional>
 #include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace pawsort
 {
+    /* Several of the algorithms below call one another, so they must be
+     * declared before any of them are defined, or else the calls will not
+     * resolve when the templates are instantiated. */
+    template<typename T> static void sift_down(T arr[], int left, int right);
+
+    template<class RandomIt>
+    static void dual_pivot_quick_sort(RandomIt first, RandomIt last);
+
+    template<class RandomIt, class Compare>
+    static void insertion_sort(RandomIt first, RandomIt last, Compare comp);
+
+    template<class RandomIt, class Compare>
+    static void heap_sort(RandomIt first, RandomIt last, Compare comp);
+
+    template<class RandomIt, class Compare>
+    static void introsort(RandomIt first, RandomIt last, Compare comp,
+                          int maxdepth = -1);
+
+    template<class RandomIt, class Compare>
+    static void sort(RandomIt first, RandomIt last, Compare comp);
+
+    template<class RandomIt, class Compare>
+    static bool sort_runs(RandomIt first, RandomIt last, Compare comp);
+
+    template<class RandomIt, class Compare>
+    static bool partial_insertion_sort(RandomIt first, RandomIt last,
+                                       Compare comp, size_t limit);
+
+    template<class RandomIt, class Compare>
+    static void three_way_sort(RandomIt first, RandomIt last, Compare comp);
+
+    template<class RandomIt>
+    static void radix_sort(RandomIt first, RandomIt last);
+
+    template<class RandomIt, class Compare> struct sort_profile;
+
     /** An implementation of the selection sort algorithm.
      * Seriously, why would you even want to use this?
      * Consider `insertion_sort` instead.
@@ -285,11 +329,22 @@ namespace pawsort
      */
     template<class RandomIt> static void sort(RandomIt first, RandomIt last)
     {
-        introsort(first, last - 1, std::less<>());
+        pawsort::sort(first, last, std::less<>());
     }
 
-    /** Sorting using introspective sort algorithm.
-     * Sorts the elements in range [first; last) in ascending order.
+    /** Sorts the elements in range [first; last) in ascending order,
+     * choosing the algorithm to use by sampling the input.
+     *
+     * - Tiny ranges use insertion sort.
+     * - Input with many duplicates uses three-way partitioning.
+     * - Nearly sorted input uses insertion sort, which gives up
+     *   (cheaply) if the input turns out to be less sorted than sampled.
+     * - A few long ascending or descending runs are merged directly,
+     *   in linear time for a single run.
+     * - Integers compared with std::less use radix sort.
+     * - Anything else uses introsort.
+     *
+     * The thresholds were calibrated with the pawsort corpus benchmark.
      * \param the first element
      * \param the last element, excluded in sorting.
      *\param comparison function.
@@ -297,6 +352,49 @@ namespace pawsort
     template<class RandomIt, class Compare>
     static void sort(RandomIt first, RandomIt last, Compare comp)
     {
+        using T = typename std::iterator_traits<RandomIt>::value_type;
+        using profile = sort_profile<RandomIt, Compare>;
+
+        const size_t len = static_cast<size_t>(last - first);
+        if (len < 2)
+        {
+            return;
+        }
+        if (len <= profile::tiny)
+        {
+            insertion_sort(first, last - 1, comp);
+            return;
+        }
+        profile sample(first, last, comp);
+        if (sample.descents == 0 && std::is_sorted(first, last, comp))
+        {
+            return;
+        }
+        if (sample.many_duplicates())
+        {
+            three_way_sort(first, last, comp);
+            return;
+        }
+        if (sample.nearly_sorted()
+            && partial_insertion_sort(first, last, comp, len * 2))
+        {
+            return;
+        }
+        if (sort_runs(first, last, comp))
+        {
+            return;
+        }
+        if constexpr (std::is_integral<T>::value
+                      && !std::is_same<T, bool>::value
+                      && (std::is_same<Compare, std::less<>>::value
+                          || std::is_same<Compare, std::less<T>>::value))
+        {
+            if (len >= profile::radix_min)
+            {
+                radix_sort(first, last);
+                return;
+            }
+        }
         introsort(first, last - 1, comp);
     }
 
@@ -339,7 +437,7 @@ namespace pawsort
             /*Be sure value in x is greater than that in y*/
             if (comp(x, y))
             {
-                swap(x, y);
+                std::swap(x, y);
             }
 
             /*find insertion point for x
@@ -653,7 +751,7 @@ namespace pawsort
                                int maxdepth = -1)
     {
         // threshold, if reached end recursive algo with insertion sort
-        const int TINY_SIZE = 100;
+        const int TINY_SIZE = 32;
 
         const int LEN = last - first + 1;
 
@@ -809,7 +907,7 @@ namespace pawsort
      */
     template<class RandomIt, class Compare>
     static void introsort(RandomIt first, RandomIt last, Compare comp,
-                          int maxdepth = -1)
+                          int maxdepth)
     {
         /* If the right index is smaller than the left,
         no matter, swap the indexes.*/
@@ -877,6 +975,844 @@ namespace pawsort
             }
         }
     }
+
+    /** A tournament tree of losers, for repeatedly selecting the least
+     * of k sorted sources in O(log k) comparisons per element. This is
+     * the engine behind pawsort's k-way merges.
+     *
+     * Each source is identified by its index, and offers one value (its
+     * current head) at a time. Internal nodes remember the loser of each
+     * match, so replacing the winner only replays the matches along its
+     * own path to the root. Ties are broken by source index, so merging
+     * with a loser tree is stable.
+     */
+    template<typename T, class Compare = std::less<>> class loser_tree
+    {
+    public:
+        /** Create a loser tree for the given number of sources.
+         * \param the number of sources
+         * \param the comparison function */
+        explicit loser_tree(size_t k, Compare comp = Compare())
+        : sources(k), compare(comp), losers(k, k), heads(k), live(k, false)
+        {
+        }
+
+        /** Offer the first value of a source. Must be called before
+         * build(); sources that are never set are treated as exhausted.
+         * \param the index of the source
+         * \param the source's first value */
+        void set(size_t source, const T& value)
+        {
+            heads[source] = value;
+            live[source] = true;
+        }
+
+        /** Play the initial tournament. Call once after all sources
+         * have been set. */
+        void build()
+        {
+            std::fill(losers.begin(), losers.end(), sources);
+            for (size_t i = sources; i-- > 0;)
+            {
+                replay(i);
+            }
+        }
+
+        /** Check whether every source is exhausted.
+         * \return true if there are no more values, else false */
+        bool empty() const { return sources == 0 || !live[losers[0]]; }
+
+        /** Get the index of the source holding the least value.
+         * \return the winning source */
+        size_t top() const { return losers[0]; }
+
+        /** Get the least value among all of the sources.
+         * \return a reference to the winning value */
+        const T& value() const { return heads[losers[0]]; }
+
+        /** Replace the winning value with the next value from the
+         * same source, and find the new winner.
+         * \param the next value from the winning source */
+        void replace(const T& value)
+        {
+            heads[losers[0]] = value;
+            replay(losers[0]);
+        }
+
+        /** Mark the winning source as exhausted, and find the new
+         * winner. */
+        void pop()
+        {
+            live[losers[0]] = false;
+            replay(losers[0]);
+        }
+
+    private:
+        /// The number of sources, also used as the "unplayed" marker.
+        size_t sources;
+        /// The comparison function.
+        Compare compare;
+        /// The loser of each match; the overall winner is stored at 0.
+        std::vector<size_t> losers;
+        /// The current value offered by each source.
+        std::vector<T> heads;
+        /// Whether each source still has a value to offer.
+        std::vector<bool> live;
+
+        /** Decide whether source a wins a match against source b.
+         * An unplayed slot always wins, so that every source is carried
+         * up to the root while the tree is being built. */
+        bool beats(size_t a, size_t b) const
+        {
+            if (a == sources) { return true; }
+            if (b == sources) { return false; }
+            if (!live[a]) { return false; }
+            if (!live[b]) { return true; }
+            if (compare(heads[a], heads[b])) { return true; }
+            if (compare(heads[b], heads[a])) { return false; }
+            return a < b;
+        }
+
+        /** Replay the matches on the path from a source to the root.
+         * \param the source whose value changed */
+        void replay(size_t source)
+        {
+            for (size_t node = (source + sources) / 2; node > 0; node /= 2)
+            {
+                if (beats(losers[node], source))
+                {
+                    std::swap(losers[node], source);
+                }
+            }
+            losers[0] = source;
+        }
+    };
+
+    /** Find the order in which to visit a range so that it would be
+     * sorted, without moving any of its elements. Equal elements keep
+     * their original relative order.
+     * \param the first element
+     * \param the last element, excluded in sorting
+     * \param comparison function
+     * \return the permutation, where the i-th entry is the original index
+     * of the element that belongs at position i
+     */
+    template<class RandomIt, class Compare>
+    static std::vector<size_t> argsort(RandomIt first, RandomIt last,
+                                       Compare comp)
+    {
+        std::vector<size_t> perm(static_cast<size_t>(last - first));
+        for (size_t i = 0; i < perm.size(); ++i)
+        {
+            perm[i] = i;
+        }
+        if (perm.size() > 1)
+        {
+            pawsort::sort(perm.begin(), perm.end(), [&](size_t a, size_t b) {
+                if (comp(first[a], first[b])) { return true; }
+                if (comp(first[b], first[a])) { return false; }
+                return a < b;
+            });
+        }
+        return perm;
+    }
+
+    /** Find the order in which to visit a range so that it would be
+     * sorted in ascending order, without moving any of its elements.
+     * \param the first element
+     * \param the last element, excluded in sorting
+     * \return the permutation
+     */
+    template<class RandomIt>
+    static std::vector<size_t> argsort(RandomIt first, RandomIt last)
+    {
+        return argsort(first, last, std::less<>());
+    }
+
+    /** Reorder a range in place according to a permutation, such as one
+     * produced by argsort(). Every element is moved exactly once, plus
+     * once more for each cycle in the permutation, which makes this far
+     * cheaper than sorting the elements themselves when they are large.
+     * \param the first element
+     * \param the last element, excluded
+     * \param the permutation, where the i-th entry is the current index
+     * of the element that belongs at position i
+     */
+    template<class RandomIt>
+    static void apply_permutation(RandomIt first, RandomIt last,
+                                  const std::vector<size_t>& perm)
+    {
+        const size_t len = static_cast<size_t>(last - first);
+        // Track visited positions separately, so the permutation is kept.
+        std::vector<bool> done(len, false);
+
+        for (size_t start = 0; start < len; ++start)
+        {
+            if (done[start] || perm[start] == start)
+            {
+                continue;
+            }
+
+            // Rotate the whole cycle, carrying only its first element.
+            auto carry = std::move(first[start]);
+            size_t i = start;
+            while (true)
+            {
+                done[i] = true;
+                size_t next = perm[i];
+                if (next == start)
+                {
+                    break;
+                }
+                first[i] = std::move(first[next]);
+                i = next;
+            }
+            first[i] = std::move(carry);
+        }
+    }
+
+    /** Sort a range by a key extracted from each element. The keys are
+     * extracted once and sorted alongside their indices, and then the
+     * elements are moved into place in a single pass, so large records
+     * are never swapped. Equal keys keep their original relative order.
+     * \param the first element
+     * \param the last element, excluded in sorting
+     * \param a function returning the key of an element
+     * \param comparison function for the keys
+     */
+    template<class RandomIt, class KeyFn, class Compare>
+    static void sort_by_key(RandomIt first, RandomIt last, KeyFn key,
+                            Compare comp)
+    {
+        using Key = std::decay_t<decltype(key(*first))>;
+
+        const size_t len = static_cast<size_t>(last - first);
+        if (len < 2)
+        {
+            return;
+        }
+
+        std::vector<std::pair<Key, size_t>> keys;
+        keys.reserve(len);
+        for (size_t i = 0; i < len; ++i)
+        {
+            keys.emplace_back(key(first[i]), i);
+        }
+
+        pawsort::sort(keys.begin(), keys.end(),
+                      [&](const std::pair<Key, size_t>& a,
+                          const std::pair<Key, size_t>& b) {
+                          if (comp(a.first, b.first)) { return true; }
+                          if (comp(b.first, a.first)) { return false; }
+                          return a.second < b.second;
+                      });
+
+        std::vector<size_t> perm(len);
+        for (size_t i = 0; i < len; ++i)
+        {
+            perm[i] = keys[i].second;
+        }
+        // The keys may be large too, so release them before moving records.
+        std::vector<std::pair<Key, size_t>>().swap(keys);
+
+        apply_permutation(first, last, perm);
+    }
+
+    /** Sort a range in ascending order by a key extracted from each
+     * element.
+     * \param the first element
+     * \param the last element, excluded in sorting
+     * \param a function returning the key of an element
+     */
+    template<class RandomIt, class KeyFn>
+    static void sort_by_key(RandomIt first, RandomIt last, KeyFn key)
+    {
+        sort_by_key(first, last, key, std::less<>());
+    }
+
+    /** Merge k sorted ranges into one, using a loser tree to select each
+     * element in O(log k) comparisons. The merge is stable: equal elements
+     * are taken from earlier ranges first.
+     * \param the ranges to merge, as (first, last) pairs
+     * \param the start of the destination, which must not overlap any
+     * of the ranges
+     * \param comparison function
+     * \return an iterator past the last element written
+     */
+    template<class InputIt, class OutputIt, class Compare>
+    static OutputIt merge_k(
+        const std::vector<std::pair<InputIt, InputIt>>& ranges, OutputIt out,
+        Compare comp)
+    {
+        const size_t k = ranges.size();
+        if (k == 0)
+        {
+            return out;
+        }
+        if (k == 1)
+        {
+            return std::copy(ranges[0].first, ranges[0].second, out);
+        }
+        if (k == 2)
+        {
+            return std::merge(ranges[0].first, ranges[0].second,
+                              ranges[1].first, ranges[1].second, out, comp);
+        }
+
+        // The tree holds each range's current position, not a copy of it.
+        auto by_value = [&comp](const InputIt& a, const InputIt& b) {
+            return comp(*a, *b);
+        };
+        loser_tree<InputIt, decltype(by_value)> tree(k, by_value);
+        for (size_t i = 0; i < k; ++i)
+        {
+            if (ranges[i].first != ranges[i].second)
+            {
+                tree.set(i, ranges[i].first);
+            }
+        }
+        tree.build();
+
+        while (!tree.empty())
+        {
+            InputIt it = tree.value();
+            *out = *it;
+            ++out;
+            if (++it != ranges[tree.top()].second)
+            {
+                tree.replace(it);
+            }
+            else
+            {
+                tree.pop();
+            }
+        }
+        return out;
+    }
+
+    /** Merge k sorted ranges into one, in ascending order.
+     * \param the ranges to merge, as (first, last) pairs
+     * \param the start of the destination
+     * \return an iterator past the last element written
+     */
+    template<class InputIt, class OutputIt>
+    static OutputIt merge_k(
+        const std::vector<std::pair<InputIt, InputIt>>& ranges, OutputIt out)
+    {
+        return merge_k(ranges, out, std::less<>());
+    }
+
+    /** Merge k sorted ranges into one, using several threads.
+     *
+     * The output is divided into independent jobs by co-ranking: a set of
+     * splitter values is sampled from the ranges, and each range is cut at
+     * the first element not less than each splitter. Every job then merges
+     * its slice of every range into its own slice of the output, so the
+     * jobs never touch each other's data. The result is identical to that
+     * of merge_k(), including its stability.
+     *
+     * The comparison function must not throw. If the destination is not
+     * random access, such as a std::back_inserter, this is just merge_k().
+     * \param the ranges to merge, as (first, last) pairs
+     * \param the start of the destination
+     * \param comparison function
+     * \param the number of threads to use, or 0 to use every core
+     * \return an iterator past the last element written
+     */
+    template<class RandomIt, class OutputIt, class Compare>
+    static OutputIt parallel_merge_k(
+        const std::vector<std::pair<RandomIt, RandomIt>>& ranges,
+        OutputIt out, Compare comp, unsigned int threads = 0)
+    {
+        using OutputTag =
+            typename std::iterator_traits<OutputIt>::iterator_category;
+        if constexpr (!std::is_base_of<std::random_access_iterator_tag,
+                                       OutputTag>::value)
+        {
+            // Jobs write to their own slices of the output, so need to jump.
+            return merge_k(ranges, out, comp);
+        }
+        else
+        {
+            // Below this size, starting threads costs more than it saves.
+            const size_t min_job = 1 << 14;
+
+            size_t total = 0;
+            for (auto& range : ranges)
+            {
+                total += static_cast<size_t>(range.second - range.first);
+            }
+
+            if (threads == 0)
+            {
+                threads = std::thread::hardware_concurrency();
+            }
+            size_t jobs = std::min<size_t>(threads, total / min_job);
+            if (jobs < 2 || ranges.size() < 2)
+            {
+                return merge_k(ranges, out, comp);
+            }
+
+            /* Sample each range in proportion to its length, so the splitters
+             * approximate the quantiles of the merged output. */
+            const size_t stride = std::max<size_t>(1, total / (jobs * 16));
+            std::vector<RandomIt> samples;
+            for (auto& range : ranges)
+            {
+                for (RandomIt it = range.first; it < range.second;)
+                {
+                    samples.push_back(it);
+                    if (static_cast<size_t>(range.second - it) <= stride)
+                    {
+                        break;
+                    }
+                    it += stride;
+                }
+            }
+            pawsort::sort(samples.begin(), samples.end(),
+                          [&comp](const RandomIt& a, const RandomIt& b) {
+                              return comp(*a, *b);
+                          });
+
+            // Cut points: cuts[j][i] is where job j starts in range i.
+            const size_t k = ranges.size();
+            std::vector<std::vector<RandomIt>> cuts(jobs + 1,
+                                                    std::vector<RandomIt>(k));
+            for (size_t i = 0; i < k; ++i)
+            {
+                cuts[0][i] = ranges[i].first;
+                cuts[jobs][i] = ranges[i].second;
+            }
+            for (size_t j = 1; j < jobs; ++j)
+            {
+                const RandomIt splitter = samples[j * samples.size() / jobs];
+                for (size_t i = 0; i < k; ++i)
+                {
+                    cuts[j][i] = std::lower_bound(cuts[j - 1][i],
+                                                  ranges[i].second,
+                                                  *splitter, comp);
+                }
+            }
+
+            std::vector<std::thread> workers;
+            workers.reserve(jobs - 1);
+            OutputIt job_out = out;
+            try
+            {
+                for (size_t j = 0; j < jobs; ++j)
+                {
+                    std::vector<std::pair<RandomIt, RandomIt>> slice(k);
+                    size_t len = 0;
+                    for (size_t i = 0; i < k; ++i)
+                    {
+                        slice[i] = std::make_pair(cuts[j][i], cuts[j + 1][i]);
+                        len += static_cast<size_t>(cuts[j + 1][i] - cuts[j][i]);
+                    }
+
+                    if (j + 1 < jobs)
+                    {
+                        workers.emplace_back([slice, job_out, &comp]() {
+                            merge_k(slice, job_out, comp);
+                        });
+                    }
+                    else
+                    {
+                        // Do the last job on this thread.
+                        merge_k(slice, job_out, comp);
+                    }
+                    std::advance(job_out, len);
+                }
+            }
+            catch (...)
+            {
+                /* If a thread couldn't be started, the ones that were
+                 * still have to finish before they can be destroyed. */
+                for (auto& worker : workers)
+                {
+                    worker.join();
+                }
+                throw;
+            }
+
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+            return job_out;
+        }
+    }
+
+    /** Merge k sorted ranges into one in ascending order, using several
+     * threads.
+     * \param the ranges to merge, as (first, last) pairs
+     * \param the start of the destination
+     * \return an iterator past the last element written
+     */
+    template<class RandomIt, class OutputIt>
+    static OutputIt parallel_merge_k(
+        const std::vector<std::pair<RandomIt, RandomIt>>& ranges,
+        OutputIt out)
+    {
+        return parallel_merge_k(ranges, out, std::less<>());
+    }
+
+    /** Split a range into its natural runs, TimSort-style. Ascending runs
+     * are kept as they are, and strictly descending runs are reversed in
+     * place (strictly, so that equal elements never trade places).
+     * Detection stops early once the runs are too short to be worth
+     * merging.
+     * \param the first element
+     * \param the last element, excluded
+     * \param comparison function
+     * \param the most runs to accept before giving up
+     * \return the start of each run, followed by last; or an empty
+     * vector if there were more than the allowed number of runs
+     */
+    template<class RandomIt, class Compare>
+    static std::vector<RandomIt> find_runs(RandomIt first, RandomIt last,
+                                           Compare comp, size_t max_runs)
+    {
+        std::vector<RandomIt> runs;
+        RandomIt start = first;
+        while (start != last)
+        {
+            if (runs.size() == max_runs)
+            {
+                return std::vector<RandomIt>();
+            }
+            runs.push_back(start);
+
+            RandomIt end = start + 1;
+            if (end != last && comp(*end, *start))
+            {
+                // Strictly descending: extend, then flip it over.
+                while (end != last && comp(*end, *(end - 1)))
+                {
+                    ++end;
+                }
+                std::reverse(start, end);
+            }
+            else
+            {
+                while (end != last && !comp(*end, *(end - 1)))
+                {
+                    ++end;
+                }
+            }
+            start = end;
+        }
+        runs.push_back(last);
+        return runs;
+    }
+
+    /** Sort a range by merging its natural runs, if it has few enough of
+     * them that this beats sorting from scratch.
+     * \param the first element
+     * \param the last element, excluded
+     * \param comparison function
+     * \return true if the range was sorted, else false
+     */
+    template<class RandomIt, class Compare>
+    static bool sort_runs(RandomIt first, RandomIt last, Compare comp)
+    {
+        // Runs must average at least this long to be worth merging.
+        const size_t min_run = 32;
+
+        const size_t len = static_cast<size_t>(last - first);
+        std::vector<RandomIt> runs =
+            find_runs(first, last, comp, std::max<size_t>(1, len / min_run));
+        if (runs.empty())
+        {
+            return false;
+        }
+        if (runs.size() == 2)
+        {
+            // A single run, which is now sorted.
+            return true;
+        }
+
+        /* Merge neighbouring runs pairwise, so that each element moves
+         * once per level instead of being copied through a k-way merge
+         * and back again. */
+        for (size_t width = 1; width + 1 < runs.size(); width *= 2)
+        {
+            for (size_t i = 0; i + width + 1 < runs.size(); i += width * 2)
+            {
+                const size_t end = std::min(i + width * 2, runs.size() - 1);
+                std::inplace_merge(runs[i], runs[i + width], runs[end], comp);
+            }
+        }
+        return true;
+    }
+
+    /** Insertion sort which gives up once it has moved too many elements,
+     * for input that is probably, but not certainly, nearly sorted. If it
+     * gives up, the range is left partly sorted, but otherwise intact.
+     * \param the first element
+     * \param the last element, excluded
+     * \param comparison function
+     * \param the most element moves to make before giving up
+     * \return true if the range was sorted, else false
+     */
+    template<class RandomIt, class Compare>
+    static bool partial_insertion_sort(RandomIt first, RandomIt last,
+                                       Compare comp, size_t limit)
+    {
+        size_t moves = 0;
+        for (RandomIt i = first + 1; i < last; ++i)
+        {
+            if (!comp(*i, *(i - 1)))
+            {
+                continue;
+            }
+
+            auto carry = std::move(*i);
+            RandomIt j = i;
+            do
+            {
+                *j = std::move(*(j - 1));
+                --j;
+                ++moves;
+            } while (j != first && comp(carry, *(j - 1)));
+            *j = std::move(carry);
+
+            if (moves > limit)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Loop for three_way_sort. Range is from "first" to "last", excluded.
+     * \param first element to be sorted
+     * \param last element, excluded
+     * \param comparison function
+     * \param how many more levels to recurse before using heap sort
+     * \param whether the range is at the very start of the input, and
+     * so has no element before it
+     */
+    template<class RandomIt, class Compare>
+    static void three_way_loop(RandomIt first, RandomIt last, Compare comp,
+                               int maxdepth, bool leftmost)
+    {
+        // Below this size, insertion sort is faster.
+        const int TINY_SIZE = 32;
+
+        while (last - first > TINY_SIZE)
+        {
+            if (maxdepth-- == 0)
+            {
+                heap_sort(first, last - 1, comp);
+                return;
+            }
+
+            std::iter_swap(first, median_of_three(
+                first, first + (last - first) / 2, last - 1, comp));
+            const auto& pivot = *first;
+
+            /* Everything here is at least the element just before the
+             * range. If the pivot is no greater than that, it is equal to
+             * it, and so is everything not greater than the pivot: move
+             * those to the front and never look at them again. */
+            if (!leftmost && !comp(*(first - 1), pivot))
+            {
+                first = std::partition(first + 1, last,
+                    [&](const auto& x) { return !comp(pivot, x); });
+                continue;
+            }
+
+            RandomIt mid = std::partition(first + 1, last,
+                [&](const auto& x) { return comp(x, pivot); });
+            std::iter_swap(first, mid - 1);
+            RandomIt split = mid - 1;
+
+            // Recurse into the smaller side, and loop on the larger.
+            if (split - first < last - mid)
+            {
+                three_way_loop(first, split, comp, maxdepth, leftmost);
+                first = mid;
+                leftmost = false;
+            }
+            else
+            {
+                three_way_loop(mid, last, comp, maxdepth, false);
+                last = split;
+            }
+        }
+
+        if (last - first > 1)
+        {
+            insertion_sort(first, last - 1, comp);
+        }
+    }
+
+    /** Quicksort that handles duplicates in linear time per distinct
+     * value. A partition whose pivot equals the element just before it
+     * can only hold that value and larger ones, so all copies of the
+     * pivot are split off at once and never touched again. Otherwise it
+     * is an ordinary two-way quicksort, so there is little to lose when
+     * there are no duplicates after all. Falls back to heap sort if the
+     * recursion gets too deep, like introsort.
+     * \param the first element
+     * \param the last element, excluded in sorting
+     * \param comparison function
+     */
+    template<class RandomIt, class Compare>
+    static void three_way_sort(RandomIt first, RandomIt last, Compare comp)
+    {
+        if (last - first < 2)
+        {
+            return;
+        }
+        three_way_loop(first, last, comp,
+                       2 * static_cast<int>(std::log2(last - first)), true);
+    }
+
+    /** An LSD radix sort for integers, in ascending order. It sorts one
+     * byte per pass, skipping any byte that is the same in every element,
+     * and needs a buffer as large as the range.
+     * \param the first element
+     * \param the last element, excluded in sorting
+     */
+    template<class RandomIt>
+    static void radix_sort(RandomIt first, RandomIt last)
+    {
+        using T = typename std::iterator_traits<RandomIt>::value_type;
+        static_assert(std::is_integral<T>::value
+                      && !std::is_same<T, bool>::value,
+                      "pawsort::radix_sort() can only sort integers.");
+        using U = typename std::make_unsigned<T>::type;
+
+        const size_t len = static_cast<size_t>(last - first);
+        if (len < 2)
+        {
+            return;
+        }
+
+        // Flip the sign bit of signed types, so negatives sort first.
+        const U flip = std::is_signed<T>::value
+            ? static_cast<U>(U(1) << (sizeof(T) * CHAR_BIT - 1))
+            : U(0);
+
+        // Count every byte of every element in a single read.
+        std::vector<size_t> counts(sizeof(T) * 256, 0);
+        for (RandomIt it = first; it != last; ++it)
+        {
+            U key = static_cast<U>(*it) ^ flip;
+            for (size_t b = 0; b < sizeof(T); ++b)
+            {
+                ++counts[b * 256 + ((key >> (b * CHAR_BIT)) & 0xFF)];
+            }
+        }
+
+        std::vector<T> buffer(len);
+        std::vector<T> source(first, last);
+        bool moved = false;
+        for (size_t b = 0; b < sizeof(T); ++b)
+        {
+            size_t* count = &counts[b * 256];
+            // If every element has the same byte here, this pass is a no-op.
+            bool trivial = false;
+            for (size_t v = 0; v < 256; ++v)
+            {
+                if (count[v] == len)
+                {
+                    trivial = true;
+                }
+            }
+            if (trivial)
+            {
+                continue;
+            }
+
+            size_t offset = 0;
+            for (size_t v = 0; v < 256; ++v)
+            {
+                size_t n = count[v];
+                count[v] = offset;
+                offset += n;
+            }
+            for (const T& value : source)
+            {
+                U key = static_cast<U>(value) ^ flip;
+                buffer[count[(key >> (b * CHAR_BIT)) & 0xFF]++] = value;
+            }
+            source.swap(buffer);
+            moved = true;
+        }
+
+        if (moved)
+        {
+            std::copy(source.begin(), source.end(), first);
+        }
+    }
+
+    /** A cheap statistical sample of a range, used by sort() to choose
+     * an algorithm. The thresholds here were calibrated with the pawsort
+     * corpus benchmark (P-tB3201).
+     */
+    template<class RandomIt, class Compare> struct sort_profile
+    {
+        /// Ranges this small always use insertion sort.
+        static constexpr size_t tiny = 32;
+        /// Integer ranges at least this large use radix sort.
+        static constexpr size_t radix_min = 1024;
+        /// The most elements to sample; small ranges sample one in eight.
+        static constexpr size_t samples = 64;
+
+        /** Sample the range. It must have more than `tiny` elements.
+         * \param the first element
+         * \param the last element, excluded
+         * \param comparison function */
+        sort_profile(RandomIt first, RandomIt last, Compare comp)
+        : count(0), descents(0), distinct(1)
+        {
+            const size_t len = static_cast<size_t>(last - first);
+            count = std::min(samples, std::max<size_t>(8, len / 8));
+            RandomIt picks[samples];
+            for (size_t i = 0; i < count; ++i)
+            {
+                picks[i] = first + (i * (len - 1)) / (count - 1);
+            }
+
+            /* Samples far apart tell us about the global order, and are
+             * not fooled by local disorder, which insertion sort handles
+             * well anyway. */
+            for (size_t i = 1; i < count; ++i)
+            {
+                if (comp(*picks[i], *picks[i - 1]))
+                {
+                    ++descents;
+                }
+            }
+
+            insertion_sort(picks, picks + count - 1,
+                           [&comp](const RandomIt& a, const RandomIt& b) {
+                               return comp(*a, *b);
+                           });
+            for (size_t i = 1; i < count; ++i)
+            {
+                if (comp(*picks[i - 1], *picks[i]))
+                {
+                    ++distinct;
+                }
+            }
+        }
+
+        /// Whether the sample suggests the range is nearly sorted.
+        bool nearly_sorted() const { return descents <= count / 16; }
+
+        /// Whether the sample suggests the range has many duplicates.
+        bool many_duplicates() const { return distinct <= count / 4; }
+
+        /// The number of elements sampled.
+        size_t count;
+        /// The number of samples smaller than the one before them.
+        size_t descents;
+        /// The number of distinct values among the samples.
+        size_t distinct;
+    };
 }
 
 #endif // PAWLIB_PAWSORT_HPP
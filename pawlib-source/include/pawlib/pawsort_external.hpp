@@ -0,0 +1,490 @@
+/** External Sort [PawLIB]
+ * Version: 0.1
+ *
+ * Sorts datasets that are larger than the available memory by sorting
+ * memory-sized runs with pawsort, spilling them to temporary files, and
+ * merging them back together with a loser tree.
+ *
+ * Author(s): Jason C. McDonald
+ */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2019 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef PAWLIB_PAWSORT_EXTERNAL_HPP
+#define PAWLIB_PAWSORT_EXTERNAL_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <unistd.h>
+
+#include "pawlib/iochannel.hpp"
+#include "pawlib/pawsort.hpp"
+
+namespace pawsort
+{
+    /// Tuning options for external_sort().
+    struct external_config
+    {
+        /** The maximum number of bytes of element data to hold in memory
+         * at once. This sets the length of each sorted run, and (together
+         * with io_block) how many runs are merged in a single pass. */
+        size_t memory_budget = 256 * 1024 * 1024;
+
+        /** The number of bytes to read or write to a file at a time.
+         * Larger blocks mean fewer, more sequential system calls, but
+         * fewer runs can be merged at once within the memory budget. */
+        size_t io_block = 1024 * 1024;
+
+        /** The directory in which to store temporary run files. If empty,
+         * the system's default temporary directory is used. */
+        std::string temp_dir = "";
+
+        /** Whether to report progress on IOChannel, at IOVrb::chatty. */
+        bool progress = false;
+    };
+
+    /** Sorts a binary file of fixed-size records that may be much
+     * larger than memory. Use the external_sort() functions instead of
+     * using this class directly.
+     */
+    template<typename T, class Compare> class external_sorter
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "pawsort::external_sort() can only sort trivially "
+                      "copyable types.");
+
+    public:
+        external_sorter(Compare comp, const external_config& cfg)
+        : compare(comp), config(cfg)
+        {
+            if (config.io_block < sizeof(T))
+            {
+                config.io_block = sizeof(T);
+            }
+            if (config.memory_budget < config.io_block * 2)
+            {
+                config.memory_budget = config.io_block * 2;
+            }
+        }
+
+        external_sorter(const external_sorter&) = delete;
+        external_sorter& operator=(const external_sorter&) = delete;
+
+        ~external_sorter()
+        {
+            for (auto& run : runs)
+            {
+                close_run(run);
+            }
+            for (auto& run : merged)
+            {
+                close_run(run);
+            }
+        }
+
+        /** Sort the records in one file, writing them to another.
+         * \param the file to read from, positioned at the first record
+         * \param the file to write to */
+        void sort(FILE* in, FILE* out)
+        {
+            if (in == nullptr || out == nullptr)
+            {
+                throw std::runtime_error(
+                    "pawsort::external_sort(): Invalid file.");
+            }
+
+            const size_t run_length = config.memory_budget / sizeof(T);
+            std::vector<T> chunk(run_length);
+            size_t total = 0;
+
+            // Phase one: produce sorted runs, each as large as memory allows.
+            while (true)
+            {
+                size_t count = fread(chunk.data(), sizeof(T), run_length, in);
+                if (ferror(in))
+                {
+                    throw std::runtime_error(
+                        "pawsort::external_sort(): Could not read input.");
+                }
+                if (count == 0)
+                {
+                    break;
+                }
+                total += count;
+
+                if (count > 1)
+                {
+                    pawsort::sort(chunk.begin(), chunk.begin() + count,
+                                  compare);
+                }
+
+                /* If everything fit in one chunk, there's nothing to merge,
+                 * so skip the temporary file entirely. */
+                if (runs.empty() && count < run_length)
+                {
+                    write_all(out, chunk.data(), count);
+                    report(total, 0);
+                    return;
+                }
+
+                runs.push_back(open_run());
+                write_all(runs.back().file, chunk.data(), count);
+                runs.back().count = count;
+                report(total, runs.size());
+
+                if (count < run_length)
+                {
+                    break;
+                }
+            }
+
+            // Free the chunk before merging, so the budget goes to buffers.
+            std::vector<T>().swap(chunk);
+
+            if (runs.empty())
+            {
+                return;
+            }
+
+            /* Phase two: merge the runs. Each run being merged needs a read
+             * buffer, and the output needs one more, all within budget. */
+            size_t fan_in = config.memory_budget / config.io_block;
+            fan_in = (fan_in > 3) ? fan_in - 1 : 2;
+
+            while (runs.size() > fan_in)
+            {
+                merged.reserve((runs.size() + fan_in - 1) / fan_in);
+                for (size_t i = 0; i < runs.size(); i += fan_in)
+                {
+                    size_t k = std::min(fan_in, runs.size() - i);
+                    if (k == 1)
+                    {
+                        merged.push_back(runs[i]);
+                        runs[i] = run_file();
+                        continue;
+                    }
+                    /* Keep the new run where the destructor will find it
+                     * before writing to it, in case the merge throws. */
+                    merged.push_back(open_run());
+                    run_file& dest = merged.back();
+                    dest.count = merge(runs.begin() + i, k, dest.file);
+                    for (size_t j = i; j < i + k; ++j)
+                    {
+                        close_run(runs[j]);
+                    }
+                }
+                runs.swap(merged);
+                merged.clear();
+                report(total, runs.size());
+            }
+
+            merge(runs.begin(), runs.size(), out);
+            for (auto& run : runs)
+            {
+                close_run(run);
+            }
+            runs.clear();
+            report(total, 0);
+        }
+
+    private:
+        /// A temporary file holding one sorted run.
+        struct run_file
+        {
+            FILE* file = nullptr;
+            std::string path = "";
+            size_t count = 0;
+        };
+
+        /// Buffered sequential reader over one run, for merging.
+        struct run_reader
+        {
+            FILE* file = nullptr;
+            std::vector<T> buffer;
+            size_t pos = 0;
+            size_t len = 0;
+
+            bool next(T& value)
+            {
+                if (pos == len)
+                {
+                    len = fread(buffer.data(), sizeof(T), buffer.size(), file);
+                    pos = 0;
+                    if (len == 0)
+                    {
+                        if (ferror(file))
+                        {
+                            throw std::runtime_error(
+                                "pawsort::external_sort(): Could not read "
+                                "temporary file.");
+                        }
+                        return false;
+                    }
+                }
+                value = buffer[pos++];
+                return true;
+            }
+        };
+
+        Compare compare;
+        external_config config;
+        std::vector<run_file> runs;
+        // The runs written by the merge pass in progress.
+        std::vector<run_file> merged;
+
+        run_file open_run()
+        {
+            run_file run;
+            if (config.temp_dir.empty())
+            {
+                run.file = std::tmpfile();
+            }
+            else
+            {
+                run.path = config.temp_dir + "/pawsort_XXXXXX";
+                int fd = mkstemp(&run.path[0]);
+                if (fd != -1)
+                {
+                    run.file = fdopen(fd, "w+b");
+                    if (run.file == nullptr)
+                    {
+                        close(fd);
+                    }
+                }
+            }
+
+            if (run.file == nullptr)
+            {
+                if (!run.path.empty())
+                {
+                    remove(run.path.c_str());
+                }
+                throw std::runtime_error(
+                    "pawsort::external_sort(): Could not create temporary "
+                    "file.");
+            }
+            return run;
+        }
+
+        void close_run(run_file& run)
+        {
+            if (run.file != nullptr)
+            {
+                fclose(run.file);
+                run.file = nullptr;
+            }
+            if (!run.path.empty())
+            {
+                remove(run.path.c_str());
+                run.path.clear();
+            }
+        }
+
+        void write_all(FILE* file, const T* data, size_t count)
+        {
+            if (fwrite(data, sizeof(T), count, file) != count)
+            {
+                throw std::runtime_error(
+                    "pawsort::external_sort(): Could not write output.");
+            }
+        }
+
+        /** Merge k consecutive runs into a single file.
+         * \param iterator to the first run to merge
+         * \param the number of runs to merge
+         * \param the file to write the merged records to
+         * \return the number of records written */
+        size_t merge(typename std::vector<run_file>::iterator first, size_t k,
+                     FILE* out)
+        {
+            const size_t block = config.io_block / sizeof(T);
+
+            std::vector<run_reader> readers(k);
+            loser_tree<T, Compare> tree(k, compare);
+            for (size_t i = 0; i < k; ++i)
+            {
+                rewind(first[i].file);
+                readers[i].file = first[i].file;
+                readers[i].buffer.resize(block);
+                T value;
+                if (readers[i].next(value))
+                {
+                    tree.set(i, value);
+                }
+            }
+            tree.build();
+
+            std::vector<T> output;
+            output.reserve(block);
+            size_t written = 0;
+            while (!tree.empty())
+            {
+                output.push_back(tree.value());
+                if (output.size() == block)
+                {
+                    write_all(out, output.data(), output.size());
+                    written += output.size();
+                    output.clear();
+                }
+
+                T value;
+                if (readers[tree.top()].next(value))
+                {
+                    tree.replace(value);
+                }
+                else
+                {
+                    tree.pop();
+                }
+            }
+            write_all(out, output.data(), output.size());
+            written += output.size();
+            return written;
+        }
+
+        void report(size_t records, size_t run_count)
+        {
+            if (!config.progress)
+            {
+                return;
+            }
+            if (run_count > 0)
+            {
+                ioc << IOVrb::chatty << IOCat::normal
+                    << "pawsort::external_sort(): " << records
+                    << " records, " << run_count << " runs" << IOCtrl::endl;
+            }
+            else
+            {
+                ioc << IOVrb::chatty << IOCat::normal
+                    << "pawsort::external_sort(): sorted " << records
+                    << " records" << IOCtrl::endl;
+            }
+        }
+    };
+
+    /** Sort a binary file of fixed-size records that may be larger than
+     * the available memory. Records are read from the current position
+     * of the input file until its end, and written to the output file.
+     * \param the file to read records from
+     * \param the file to write sorted records to
+     * \param the comparison function
+     * \param the tuning options */
+    template<typename T, class Compare>
+    static void external_sort(FILE* in, FILE* out, Compare comp,
+                              const external_config& config = external_config())
+    {
+        external_sorter<T, Compare> sorter(comp, config);
+        sorter.sort(in, out);
+    }
+
+    /** Sort a binary file of fixed-size records that may be larger than
+     * the available memory, in ascending order.
+     * \param the file to read records from
+     * \param the file to write sorted records to
+     * \param the tuning options */
+    template<typename T>
+    static void external_sort(FILE* in, FILE* out,
+                              const external_config& config = external_config())
+    {
+        external_sort<T>(in, out, std::less<T>(), config);
+    }
+
+    /** Sort a binary file of fixed-size records that may be larger than
+     * the available memory. The input and output paths must differ.
+     * \param the path of the file to read records from
+     * \param the path of the file to write sorted records to
+     * \param the comparison function
+     * \param the tuning options */
+    template<typename T, class Compare>
+    static void external_sort(const std::string& in_path,
+                              const std::string& out_path, Compare comp,
+                              const external_config& config = external_config())
+    {
+        FILE* in = fopen(in_path.c_str(), "rb");
+        if (in == nullptr)
+        {
+            throw std::runtime_error(
+                "pawsort::external_sort(): Could not open input file.");
+        }
+        FILE* out = fopen(out_path.c_str(), "wb");
+        if (out == nullptr)
+        {
+            fclose(in);
+            throw std::runtime_error(
+                "pawsort::external_sort(): Could not open output file.");
+        }
+
+        try
+        {
+            external_sort<T>(in, out, comp, config);
+        }
+        catch (...)
+        {
+            fclose(in);
+            fclose(out);
+            throw;
+        }
+
+        fclose(in);
+        if (fclose(out) != 0)
+        {
+            throw std::runtime_error(
+                "pawsort::external_sort(): Could not write output file.");
+        }
+    }
+
+    /** Sort a binary file of fixed-size records that may be larger than
+     * the available memory, in ascending order.
+     * \param the path of the file to read records from
+     * \param the path of the file to write sorted records to
+     * \param the tuning options */
+    template<typename T>
+    static void external_sort(const std::string& in_path,
+                              const std::string& out_path,
+                              const external_config& config = external_config())
+    {
+        external_sort<T>(in_path, out_path, std::less<T>(), config);
+    }
+}
+
+#endif // PAWLIB_PAWSORT_EXTERNAL_HPP
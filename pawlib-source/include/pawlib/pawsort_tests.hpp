@@ -43,9 +43,21 @@
 #define PAWLIB_PAWSORT_TESTS_HPP
 
 #include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
 
 #include "pawlib/goldilocks.hpp"
+#include "pawlib/onestring.hpp"
 #include "pawlib/pawsort.hpp"
+#include "pawlib/pawsort_external.hpp"
 
 class TestSort : public Test
 {
@@ -257,46 +269,66 @@ unique values. Really, this is just evil incarnate.";
             return false;
         }
 
-        switch (arrayType)
+        if (!generate(arrayType, start_arr, test_size))
+        {
+            return false;
+        }
+
+        for (int i = 0; i < test_size; ++i)
+        {
+            test_arr[i] = start_arr[i];
+        }
+
+        return true;
+    }
+
+    /** Fill an array with one of the test array shapes.
+     * \param the shape to generate
+     * \param the array to fill
+     * \param the size of the array, which must be a multiple of 10
+     * \return true if the array was generated, else false */
+    static bool generate(TestArrayType type, int arr[], int size)
+    {
+        switch (type)
         {
             case TestArrayType::ARRAY_RANDOM:
             {
-                for (int i = 0; i < test_size; ++i)
+                for (int i = 0; i < size; ++i)
                 {
-                    start_arr[i] = (rand() % 100 + 1);
+                    arr[i] = (rand() % 100 + 1);
                 }
                 break;
             }
             case TestArrayType::ARRAY_SORTED:
             {
-                for (int i = 0; i < test_size; ++i)
+                for (int i = 0; i < size; ++i)
                 {
-                    start_arr[i] = i;
+                    arr[i] = i;
                 }
                 break;
             }
             case TestArrayType::ARRAY_REVERSED:
             {
-                for (int i = 0; i < test_size; ++i)
+                for (int i = 0; i < size; ++i)
                 {
-                    start_arr[i] = test_size - i;
+                    arr[i] = size - i;
                 }
                 break;
             }
             case TestArrayType::ARRAY_NEARLY_2:
             {
-                for (int i = 0; i < test_size; i += 2)
+                for (int i = 0; i < size; i += 2)
                 {
                     // The first number in the pair has a higher value.
-                    start_arr[i] = i + 1;
+                    arr[i] = i + 1;
                     // The second number in the pair has the lower value.
-                    start_arr[i + 1] = i;
+                    arr[i + 1] = i;
                 }
                 break;
             }
             case TestArrayType::ARRAY_NEARLY_5:
             {
-                for (int i = 0; i < test_size; i += 5)
+                for (int i = 0; i < size; i += 5)
                 {
                     // Loop through five indices...
                     for (int j = 0; j < 5; ++j)
@@ -306,7 +338,7 @@ unique values. Really, this is just evil incarnate.";
                          * For example, if i=6, we'd be looping
                          * 6, 7, 8, 9, 10, and writing the values
                          * 10, 9, 8, 7, 6. */
-                        start_arr[i + j] = i + (4 - j);
+                        arr[i + j] = i + (4 - j);
                     }
                 }
                 break;
@@ -314,19 +346,19 @@ unique values. Really, this is just evil incarnate.";
             case TestArrayType::ARRAY_FEW_UNIQUE:
             {
                 // Only have 6 unique values.
-                int jump = test_size / 6;
+                int jump = size / 6;
                 // Start with 22 for our first value.
                 int value = 22;
                 // Calculate half.
-                int half = test_size / 2;
+                int half = size / 2;
                 for (int i = 0; i < half; i += jump)
                 {
                     // Loop through (jump) number of indices...
                     for (int j = 0; j < jump; ++j)
                     {
                         // Use the value for this set.
-                        start_arr[i + j] = value;
-                        start_arr[(test_size - 1) - (i + j)] = value + 2;
+                        arr[i + j] = value;
+                        arr[(size - 1) - (i + j)] = value + 2;
                     }
                     /* Decrement value before making the next jump.*/
                     value -= 5;
@@ -336,119 +368,121 @@ unique values. Really, this is just evil incarnate.";
             case TestArrayType::ARRAY_BLACK_SHEEP:
             {
                 // First, generate an already-sorted array.
-                for (int i = 0; i < test_size; ++i)
+                for (int i = 0; i < size; ++i)
                 {
-                    start_arr[i] = i;
+                    arr[i] = i;
                 }
                 // Swap the 1/3 and 2/3 indices.
-                int third = test_size / 3;
-                int tmp = start_arr[third];
-                start_arr[third] = start_arr[third + third];
-                start_arr[third + third] = tmp;
+                int third = size / 3;
+                int tmp = arr[third];
+                arr[third] = arr[third + third];
+                arr[third + third] = tmp;
                 break;
             }
             case TestArrayType::ARRAY_DOUBLE_CLIMB:
             {
-                int half = test_size / 2;
+                int half = size / 2;
                 for (int i = 0; i < half; ++i)
                 {
-                    start_arr[i] = i;
-                    start_arr[i + half] = i;
+                    arr[i] = i;
+                    arr[i + half] = i;
                 }
                 break;
             }
             case TestArrayType::ARRAY_DOUBLE_DROP:
             {
-                int half = test_size / 2;
+                int half = size / 2;
                 for (int i = 0; i < half; ++i)
                 {
-                    start_arr[i] = half - i;
-                    start_arr[i + half] = half - i;
+                    arr[i] = half - i;
+                    arr[i + half] = half - i;
                 }
                 break;
             }
             case TestArrayType::ARRAY_STAIRS:
             {
-                int half = test_size / 2;
-                int maxI = test_size - 1;
+                int half = size / 2;
+                int maxI = size - 1;
                 int jump = 5;
                 for (int i = 0; i < half; i += jump)
                 {
                     for (int j = 0; j < jump; ++j)
                     {
-                        start_arr[i + j] = i;
-                        start_arr[maxI - (i + j)] = i;
+                        arr[i + j] = i;
+                        arr[maxI - (i + j)] = i;
                     }
                 }
                 break;
             }
             case TestArrayType::ARRAY_MOUNTAIN:
             {
-                int half = test_size / 2;
-                int maxI = test_size - 1;
+                int half = size / 2;
+                int maxI = size - 1;
                 for (int i = 0; i < half; ++i)
                 {
-                    start_arr[i] = i;
-                    start_arr[maxI - i] = i;
+                    arr[i] = i;
+                    arr[maxI - i] = i;
                 }
                 break;
             }
             case TestArrayType::ARRAY_DOUBLE_MOUNTAIN:
             {
-                int half = test_size / 2;
+                int half = size / 2;
                 int qtr = half / 2;
                 int value = 0;
                 for (int i = 0; i < half; ++i)
                 {
-                    start_arr[i] = value;
-                    start_arr[i + half] = value;
+                    arr[i] = value;
+                    arr[i + half] = value;
                     (i > qtr) ? --value : ++value;
                 }
                 break;
             }
             case TestArrayType::ARRAY_EVEREST:
             {
-                int half = test_size / 2;
-                int maxI = test_size - 1;
+                int half = size / 2;
+                int maxI = size - 1;
                 int value = 0;
+                // Keep the summit within range on very large arrays.
+                int jump = std::min(size / 6, INT_MAX / half);
                 for (int i = 0; i < half; ++i)
                 {
-                    start_arr[i] = value;
-                    start_arr[maxI - i] = value;
-                    value += (test_size / 6);
+                    arr[i] = value;
+                    arr[maxI - i] = value;
+                    value += jump;
                 }
                 break;
             }
             case TestArrayType::ARRAY_CLIFF:
             {
-                int dropoff = test_size - (test_size / 10);
+                int dropoff = size - (size / 10);
                 for (int i = 0; i < dropoff; ++i)
                 {
-                    start_arr[i] = i;
+                    arr[i] = i;
                 }
-                int value = test_size - dropoff;
-                for (int i = dropoff; i < test_size; ++i)
+                int value = size - dropoff;
+                for (int i = dropoff; i < size; ++i)
                 {
-                    start_arr[i] = value--;
+                    arr[i] = value--;
                 }
                 break;
             }
             case TestArrayType::ARRAY_SPIKE:
             {
-                int half = test_size / 2;
-                int maxI = test_size - 1;
+                int half = size / 2;
+                int maxI = size - 1;
                 int value = 0;
                 for (int i = 0; i < half - 4; ++i)
                 {
-                    start_arr[i] = value;
-                    start_arr[maxI - i] = value;
+                    arr[i] = value;
+                    arr[maxI - i] = value;
                     ++value;
                 }
                 for (int i = half - 4; i < half; ++i)
                 {
-                    value += (test_size / 6);
-                    start_arr[i] = value;
-                    start_arr[maxI - i] = value;
+                    value += (size / 6);
+                    arr[i] = value;
+                    arr[maxI - i] = value;
                 }
                 break;
             }
@@ -456,30 +490,30 @@ unique values. Really, this is just evil incarnate.";
             {
                 // Increments from 0 to half.
                 int low = 0;
-                // Decrements from test_size-1 to half.
-                int high = test_size - 1;
-                for (int i = 0; i < test_size; i += 2)
+                // Decrements from size-1 to half.
+                int high = size - 1;
+                for (int i = 0; i < size; i += 2)
                 {
                     // The first number in the pair is the low value.
-                    start_arr[i] = low++;
+                    arr[i] = low++;
                     // The second number in the pair is the high value.
-                    start_arr[i + 1] = high--;
+                    arr[i + 1] = high--;
                 }
                 break;
             }
             case TestArrayType::ARRAY_NIGHTMARE:
             {
                 // Only have 5 unique values.
-                int jump = test_size / 5;
+                int jump = size / 5;
                 // Use values 5-9
                 int value = 9;
-                for (int i = 0; i < test_size; i += jump)
+                for (int i = 0; i < size; i += jump)
                 {
                     // Loop through (jump) number of indices...
                     for (int j = 0; j < jump; ++j)
                     {
                         // Use the value for this set.
-                        start_arr[i + j] = value;
+                        arr[i + j] = value;
                     }
                     /* Decrement the value, to preserve the "reverse sorted"
                      * property of the array.*/
@@ -490,10 +524,10 @@ unique values. Really, this is just evil incarnate.";
                  * indices, which are used for median-of-three, with
                  * the lowest value. This also breaks the sequence and
                  * forces PawSort to attempt a sort.*/
-                start_arr[0] = value;
-                start_arr[(test_size / 2) - 1] = value;
-                start_arr[(test_size / 2)] = value;
-                start_arr[test_size - 1] = value;
+                arr[0] = value;
+                arr[(size / 2) - 1] = value;
+                arr[(size / 2)] = value;
+                arr[size - 1] = value;
 
                 break;
             }
@@ -503,13 +537,37 @@ unique values. Really, this is just evil incarnate.";
             }
         }
 
-        for (int i = 0; i < test_size; ++i)
+        return true;
+    }
+
+    /** Get a short, machine-friendly name for an array shape.
+     * \param the shape
+     * \return the name of the shape */
+    static const char* shape_name(TestArrayType type)
+    {
+        switch (type)
         {
-            test_arr[i] = start_arr[i];
+            case TestArrayType::ARRAY_RANDOM: return "random";
+            case TestArrayType::ARRAY_SORTED: return "sorted";
+            case TestArrayType::ARRAY_REVERSED: return "reversed";
+            case TestArrayType::ARRAY_NEARLY_2: return "nearly_2";
+            case TestArrayType::ARRAY_NEARLY_5: return "nearly_5";
+            case TestArrayType::ARRAY_FEW_UNIQUE: return "few_unique";
+            case TestArrayType::ARRAY_BLACK_SHEEP: return "black_sheep";
+            case TestArrayType::ARRAY_DOUBLE_CLIMB: return "double_climb";
+            case TestArrayType::ARRAY_DOUBLE_DROP: return "double_drop";
+            case TestArrayType::ARRAY_STAIRS: return "stairs";
+            case TestArrayType::ARRAY_MOUNTAIN: return "mountain";
+            case TestArrayType::ARRAY_DOUBLE_MOUNTAIN: return "double_mountain";
+            case TestArrayType::ARRAY_EVEREST: return "everest";
+            case TestArrayType::ARRAY_CLIFF: return "cliff";
+            case TestArrayType::ARRAY_SPIKE: return "spike";
+            case TestArrayType::ARRAY_CHICKEN: return "chicken";
+            case TestArrayType::ARRAY_NIGHTMARE: return "nightmare";
         }
-
-        return true;
+        return "unknown";
     }
+
     bool janitor() override
     {
         for (int i = 0; i < test_size; ++i)
@@ -715,6 +773,879 @@ private:
     const int INDEX = 100;
 };
 
+class TestPawSortExternal : public TestSort
+{
+public:
+    explicit TestPawSortExternal(TestArrayType type) : TestSort(type)
+    {
+        /* Use a tiny memory budget, so the sort is forced to spill many
+         * runs and to merge them in more than one pass. */
+        config.memory_budget = 2048;
+        config.io_block = 512;
+    }
+
+    testdoc_t get_title() override { return title + " (external_sort)"; }
+
+    bool run() override
+    {
+        FILE* in = std::tmpfile();
+        FILE* out = std::tmpfile();
+        if (in == nullptr || out == nullptr)
+        {
+            return false;
+        }
+
+        fwrite(test_arr, sizeof(int), test_size, in);
+        rewind(in);
+        pawsort::external_sort<int>(in, out, config);
+        fclose(in);
+
+        rewind(out);
+        size_t count = fread(test_arr, sizeof(int), test_size, out);
+        fclose(out);
+        if (count != static_cast<size_t>(test_size))
+        {
+            return false;
+        }
+
+        // Verify sorting.
+        for (int i = 1; i < test_size; ++i)
+        {
+            // If the item is less than the previous item.
+            if (test_arr[i] < test_arr[i - 1])
+            {
+                // Out of order. Fail.
+                return false;
+            }
+        }
+        // If we make it this far, validation passed.
+        return true;
+    }
+
+    ~TestPawSortExternal() {}
+
+private:
+    pawsort::external_config config;
+};
+
+// P-tB3253
+class TestPawSortExternalCleanup : public Test
+{
+public:
+    TestPawSortExternalCleanup() {}
+
+    testdoc_t get_title() override
+    {
+        return "Pawsort: external_sort() Cleans Up When It Throws";
+    }
+
+    testdoc_t get_docs() override
+    {
+        return "Throw from the comparison at many points in an external sort "
+               "of several merge passes, and check that no temporary files "
+               "are left behind.";
+    }
+
+    bool pre() override
+    {
+        char path[] = "/tmp/pawsort_test_XXXXXX";
+        if (mkdtemp(path) == nullptr)
+        {
+            return false;
+        }
+        dir = path;
+        return true;
+    }
+
+    bool run() override
+    {
+        std::vector<int> data;
+        for (int i = 0; i < 20000; ++i)
+        {
+            data.push_back((i * 7919) % 20011);
+        }
+
+        pawsort::external_config config;
+        config.memory_budget = 2048;
+        config.io_block = 512;
+        config.temp_dir = dir;
+
+        // Count the comparisons in a whole sort, to spread the throws over.
+        size_t total = 0;
+        PL_ASSERT_TRUE(sort_until(data, config, SIZE_MAX, total));
+        PL_ASSERT_EQUAL(leftovers(), 0);
+
+        for (size_t limit = total / 20; limit < total; limit += total / 20)
+        {
+            size_t count = 0;
+            PL_ASSERT_FALSE(sort_until(data, config, limit, count));
+            PL_ASSERT_EQUAL(leftovers(), 0);
+        }
+        return true;
+    }
+
+    bool post() override
+    {
+        rmdir(dir.c_str());
+        return true;
+    }
+
+    ~TestPawSortExternalCleanup() {}
+
+private:
+    std::string dir;
+
+    /** Sort, with a comparison that throws after a number of calls.
+     * \param the records to sort
+     * \param the tuning options
+     * \param the number of comparisons to allow
+     * \param the comparisons made
+     * \return true if the sort finished, else false */
+    static bool sort_until(const std::vector<int>& data,
+                           const pawsort::external_config& config,
+                           size_t limit, size_t& count)
+    {
+        FILE* in = std::tmpfile();
+        FILE* out = std::tmpfile();
+        if (in == nullptr || out == nullptr)
+        {
+            return false;
+        }
+        fwrite(data.data(), sizeof(int), data.size(), in);
+        rewind(in);
+
+        bool finished = true;
+        try
+        {
+            pawsort::external_sort<int>(in, out,
+                [&count, limit](int a, int b) {
+                    if (++count > limit)
+                    {
+                        throw std::runtime_error("Comparison limit.");
+                    }
+                    return a < b;
+                },
+                config);
+        }
+        catch (const std::runtime_error&)
+        {
+            finished = false;
+        }
+        fclose(in);
+        fclose(out);
+        return finished;
+    }
+
+    /// \return the number of files left in the temporary directory
+    int leftovers()
+    {
+        int found = 0;
+        DIR* listing = opendir(dir.c_str());
+        if (listing == nullptr)
+        {
+            return -1;
+        }
+        while (dirent* entry = readdir(listing))
+        {
+            if (entry->d_name[0] != '.')
+            {
+                ++found;
+            }
+        }
+        closedir(listing);
+        return found;
+    }
+};
+
+class TestPawArgsort : public TestSort
+{
+public:
+    explicit TestPawArgsort(TestArrayType type) : TestSort(type) {}
+
+    testdoc_t get_title() override { return title + " (argsort)"; }
+
+    bool run() override
+    {
+        std::vector<size_t> perm =
+            pawsort::argsort(std::begin(test_arr), std::end(test_arr));
+
+        // The original array must not have been touched.
+        for (int i = 0; i < test_size; ++i)
+        {
+            if (test_arr[i] != start_arr[i])
+            {
+                return false;
+            }
+        }
+
+        // Visiting the array in permutation order must be sorted and stable.
+        for (int i = 1; i < test_size; ++i)
+        {
+            if (test_arr[perm[i]] < test_arr[perm[i - 1]])
+            {
+                return false;
+            }
+            if (test_arr[perm[i]] == test_arr[perm[i - 1]]
+                && perm[i] < perm[i - 1])
+            {
+                return false;
+            }
+        }
+
+        pawsort::apply_permutation(std::begin(test_arr), std::end(test_arr),
+                                   perm);
+
+        // Verify sorting.
+        for (int i = 1; i < test_size; ++i)
+        {
+            // If the item is less than the previous item.
+            if (test_arr[i] < test_arr[i - 1])
+            {
+                // Out of order. Fail.
+                return false;
+            }
+        }
+        // If we make it this far, validation passed.
+        return true;
+    }
+
+    ~TestPawArgsort() {}
+};
+
+class TestPawSortByKey : public TestSort
+{
+public:
+    explicit TestPawSortByKey(TestArrayType type) : TestSort(type) {}
+
+    testdoc_t get_title() override { return title + " (sort_by_key)"; }
+
+    bool pre() override
+    {
+        records.resize(test_size);
+        return TestSort::pre() && janitor();
+    }
+
+    bool janitor() override
+    {
+        for (int i = 0; i < test_size; ++i)
+        {
+            records[i].key = start_arr[i];
+            records[i].index = i;
+        }
+        return true;
+    }
+
+    bool run() override
+    {
+        pawsort::sort_by_key(records.begin(), records.end(),
+                             [](const Record& r) { return r.key; });
+
+        // Verify sorting.
+        for (int i = 1; i < test_size; ++i)
+        {
+            // If the item is less than the previous item.
+            if (records[i].key < records[i - 1].key)
+            {
+                // Out of order. Fail.
+                return false;
+            }
+            // Equal keys must keep their original order.
+            if (records[i].key == records[i - 1].key
+                && records[i].index < records[i - 1].index)
+            {
+                return false;
+            }
+        }
+        // Every record must have moved as a whole.
+        for (int i = 0; i < test_size; ++i)
+        {
+            if (start_arr[records[i].index] != records[i].key)
+            {
+                return false;
+            }
+        }
+        // If we make it this far, validation passed.
+        return true;
+    }
+
+    ~TestPawSortByKey() {}
+
+private:
+    /// A large record, which is expensive to swap.
+    struct Record
+    {
+        int key;
+        int index;
+        char payload[248];
+    };
+
+    std::vector<Record> records;
+};
+
+class TestPawMergeK : public TestSort
+{
+public:
+    /** \param the array type to generate
+     * \param whether to use parallel_merge_k() instead of merge_k() */
+    TestPawMergeK(TestArrayType type, bool parallel)
+    : TestSort(type), parallel(parallel)
+    {
+    }
+
+    testdoc_t get_title() override
+    {
+        return title + (parallel ? " (parallel_merge_k)" : " (merge_k)");
+    }
+
+    bool pre() override
+    {
+        if (!TestSort::pre())
+        {
+            return false;
+        }
+
+        /* Build many sorted runs of uneven length out of copies of the
+         * test array, so the parallel merge has enough work to split. */
+        const int copies = parallel ? 16 : 1;
+        input.clear();
+        for (int c = 0; c < copies; ++c)
+        {
+            for (int i = 0; i < test_size; ++i)
+            {
+                input.push_back(start_arr[i] * copies + c);
+            }
+        }
+
+        bounds.clear();
+        size_t step = input.size() / 7;
+        for (size_t i = 0; i < input.size(); i += step)
+        {
+            bounds.push_back(i);
+            step += step / 3;
+        }
+        bounds.push_back(input.size());
+        for (size_t i = 0; i + 1 < bounds.size(); ++i)
+        {
+            std::sort(input.begin() + bounds[i], input.begin() + bounds[i + 1]);
+        }
+
+        expected = input;
+        std::sort(expected.begin(), expected.end());
+        return true;
+    }
+
+    bool run() override
+    {
+        using iter = std::vector<int>::const_iterator;
+        std::vector<std::pair<iter, iter>> ranges;
+        for (size_t i = 0; i + 1 < bounds.size(); ++i)
+        {
+            ranges.emplace_back(input.cbegin() + bounds[i],
+                                input.cbegin() + bounds[i + 1]);
+        }
+
+        std::vector<int> output(input.size());
+        auto end = parallel
+            ? pawsort::parallel_merge_k(ranges, output.begin(),
+                                        std::less<int>(), 4)
+            : pawsort::merge_k(ranges, output.begin());
+
+        return end == output.end() && output == expected;
+    }
+
+    ~TestPawMergeK() {}
+
+private:
+    bool parallel;
+    std::vector<int> input;
+    std::vector<size_t> bounds;
+    std::vector<int> expected;
+};
+
+// P-tB3252
+class TestPawMergeKInserter : public Test
+{
+public:
+    TestPawMergeKInserter() {}
+
+    testdoc_t get_title() override
+    {
+        return "Pawsort: parallel_merge_k() to a std::back_inserter";
+    }
+
+    testdoc_t get_docs() override
+    {
+        return "Merge enough runs for several jobs into a destination that "
+               "is not random access, which must be merged on one thread.";
+    }
+
+    bool run() override
+    {
+        std::vector<std::vector<int>> runs(4);
+        std::vector<int> expected;
+        for (size_t r = 0; r < runs.size(); ++r)
+        {
+            for (int i = 0; i < 50000; ++i)
+            {
+                runs[r].push_back(i * 3 + static_cast<int>(r));
+                expected.push_back(runs[r].back());
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+
+        using iter = std::vector<int>::const_iterator;
+        std::vector<std::pair<iter, iter>> ranges;
+        for (auto& run : runs)
+        {
+            ranges.emplace_back(run.cbegin(), run.cend());
+        }
+
+        std::vector<int> output;
+        pawsort::parallel_merge_k(ranges, std::back_inserter(output),
+                                  std::less<int>(), 4);
+
+        PL_ASSERT_EQUAL(output.size(), expected.size());
+        PL_ASSERT_TRUE(output == expected);
+        return true;
+    }
+
+    ~TestPawMergeKInserter() {}
+};
+
+/// A 64-byte record, for benchmarking sorts of large elements.
+struct SortRecord64
+{
+    int64_t key;
+    char payload[56];
+
+    bool operator<(const SortRecord64& rhs) const { return key < rhs.key; }
+    bool operator>(const SortRecord64& rhs) const { return key > rhs.key; }
+    bool operator==(const SortRecord64& rhs) const { return key == rhs.key; }
+    bool operator!=(const SortRecord64& rhs) const { return key != rhs.key; }
+};
+
+/** Converts the integers of a generated test array into another element
+ * type, preserving their order, for the sort corpus benchmark. */
+template<typename T> struct SortElement;
+
+template<> struct SortElement<int>
+{
+    static const char* name() { return "int"; }
+    static int make(int value) { return value; }
+};
+
+template<> struct SortElement<double>
+{
+    static const char* name() { return "double"; }
+    static double make(int value) { return value + 0.5; }
+};
+
+template<> struct SortElement<std::string>
+{
+    static const char* name() { return "std::string"; }
+    static std::string make(int value)
+    {
+        // Offset and zero-pad, so the strings sort like the integers.
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "%011lld",
+                 static_cast<long long>(value) + 2147483648LL);
+        return std::string(buffer);
+    }
+};
+
+template<> struct SortElement<onestring>
+{
+    static const char* name() { return "onestring"; }
+    static onestring make(int value)
+    {
+        return onestring(SortElement<std::string>::make(value));
+    }
+};
+
+template<> struct SortElement<SortRecord64>
+{
+    static const char* name() { return "record64"; }
+    static SortRecord64 make(int value)
+    {
+        SortRecord64 record;
+        record.key = value;
+        memset(record.payload, value & 0xFF, sizeof(record.payload));
+        return record;
+    }
+};
+
+/// The sorting algorithms measured by the sort corpus benchmark.
+enum class SortAlgorithm
+{
+    STD_SORT,
+    PAWSORT,
+    INTROSORT,
+    DUAL_PIVOT,
+    HEAP_SORT,
+    INSERTION_SORT,
+    THREE_WAY_SORT,
+    RADIX_SORT
+};
+
+/** Sorts one generated array with one algorithm. This is a single
+ * measurement in the sort corpus benchmark, and is not registered
+ * on its own. */
+template<typename T> class TestSortBench : public Test
+{
+public:
+    TestSortBench(SortAlgorithm algorithm, TestSort::TestArrayType type,
+                  int size)
+    : algorithm(algorithm), arrayType(type), size(size)
+    {
+    }
+
+    static const char* algorithm_name(SortAlgorithm algorithm)
+    {
+        switch (algorithm)
+        {
+            case SortAlgorithm::STD_SORT: return "std::sort";
+            case SortAlgorithm::PAWSORT: return "pawsort::sort";
+            case SortAlgorithm::INTROSORT: return "introsort";
+            case SortAlgorithm::DUAL_PIVOT: return "dual_pivot_quick_sort";
+            case SortAlgorithm::HEAP_SORT: return "heap_sort";
+            case SortAlgorithm::INSERTION_SORT: return "insertion_sort";
+            case SortAlgorithm::THREE_WAY_SORT: return "three_way_sort";
+            case SortAlgorithm::RADIX_SORT: return "radix_sort";
+        }
+        return "unknown";
+    }
+
+    testdoc_t get_title() override
+    {
+        return testdoc_t("Sort Benchmark: ") + algorithm_name(algorithm) + ", "
+               + SortElement<T>::name() + ", "
+               + TestSort::shape_name(arrayType) + ", "
+               + std::to_string(size);
+    }
+
+    testdoc_t get_docs() override
+    {
+        return "Sort one generated array, as part of the sort corpus "
+               "benchmark.";
+    }
+
+    bool pre() override
+    {
+        std::vector<int> shape(size);
+        if (!TestSort::generate(arrayType, shape.data(), size))
+        {
+            return false;
+        }
+        start.clear();
+        start.reserve(size);
+        for (int value : shape)
+        {
+            start.push_back(SortElement<T>::make(value));
+        }
+        return janitor();
+    }
+
+    bool janitor() override
+    {
+        work = start;
+        return true;
+    }
+
+    bool run() override
+    {
+        switch (algorithm)
+        {
+            case SortAlgorithm::STD_SORT:
+            {
+                std::sort(work.begin(), work.end());
+                break;
+            }
+            case SortAlgorithm::PAWSORT:
+            {
+                pawsort::sort(work.begin(), work.end());
+                break;
+            }
+            case SortAlgorithm::INTROSORT:
+            {
+                pawsort::introsort(work.begin(), work.end() - 1,
+                                   std::less<>());
+                break;
+            }
+            case SortAlgorithm::DUAL_PIVOT:
+            {
+                pawsort::dual_pivot_quick_sort(work.begin(), work.end() - 1);
+                break;
+            }
+            case SortAlgorithm::HEAP_SORT:
+            {
+                pawsort::heap_sort(work.begin(), work.end() - 1,
+                                   std::less<>());
+                break;
+            }
+            case SortAlgorithm::INSERTION_SORT:
+            {
+                pawsort::insertion_sort(work.begin(), work.end() - 1,
+                                        std::less<>());
+                break;
+            }
+            case SortAlgorithm::THREE_WAY_SORT:
+            {
+                pawsort::three_way_sort(work.begin(), work.end(),
+                                        std::less<>());
+                break;
+            }
+            case SortAlgorithm::RADIX_SORT:
+            {
+                if constexpr (std::is_integral<T>::value)
+                {
+                    pawsort::radix_sort(work.begin(), work.end());
+                }
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool verify() override { return std::is_sorted(work.begin(), work.end()); }
+
+    bool post() override
+    {
+        // Release the arrays, which may be very large.
+        std::vector<T>().swap(start);
+        std::vector<T>().swap(work);
+        return true;
+    }
+
+    ~TestSortBench() {}
+
+private:
+    SortAlgorithm algorithm;
+    TestSort::TestArrayType arrayType;
+    int size;
+    std::vector<T> start;
+    std::vector<T> work;
+};
+
+class TestPawSortEngine : public TestSort
+{
+public:
+    TestPawSortEngine(TestArrayType type, SortAlgorithm algorithm)
+    : TestSort(type), algorithm(algorithm)
+    {
+    }
+
+    testdoc_t get_title() override
+    {
+        return title + " (" + TestSortBench<int>::algorithm_name(algorithm)
+               + ")";
+    }
+
+    bool run() override
+    {
+        int* first = std::begin(test_arr);
+        int* last = std::begin(test_arr) + test_size;
+        switch (algorithm)
+        {
+            case SortAlgorithm::PAWSORT:
+            {
+                pawsort::sort(first, last);
+                break;
+            }
+            case SortAlgorithm::THREE_WAY_SORT:
+            {
+                pawsort::three_way_sort(first, last, std::less<int>());
+                break;
+            }
+            case SortAlgorithm::RADIX_SORT:
+            {
+                pawsort::radix_sort(first, last);
+                break;
+            }
+            default:
+            {
+                return false;
+            }
+        }
+        // Verify sorting.
+        return std::is_sorted(first, last);
+    }
+
+    ~TestPawSortEngine() {}
+
+private:
+    SortAlgorithm algorithm;
+};
+
+// P-tB3251
+class TestPawSortBool : public Test
+{
+public:
+    TestPawSortBool() {}
+
+    testdoc_t get_title() override { return "Pawsort: Sort Bools"; }
+
+    testdoc_t get_docs() override
+    {
+        return "Sort an array of bools, which are integral but must not be "
+               "radix sorted.";
+    }
+
+    bool run() override
+    {
+        bool arr[2000];
+        int trues = 0;
+        for (int i = 0; i < 2000; ++i)
+        {
+            arr[i] = (i * 7919) % 3 == 0;
+            trues += arr[i];
+        }
+        pawsort::sort(arr, arr + 2000);
+
+        PL_ASSERT_TRUE(std::is_sorted(arr, arr + 2000));
+        PL_ASSERT_EQUAL(std::count(arr, arr + 2000, true), trues);
+        return true;
+    }
+
+    ~TestPawSortBool() {}
+};
+
+/** Measures every sorting algorithm on every array shape, across a range
+ * of array sizes and element types, and writes the results as a
+ * machine-readable BenchmarkReport. This is used for choosing algorithms
+ * per workload, and for catching performance regressions between
+ * releases. It is far too slow to run with the rest of the suite.
+ */
+class TestSortCorpus : public Test
+{
+public:
+    /** \param the largest array size to measure, as a power of ten
+     * \param the path of the file to write the report to
+     * \param the format of the report */
+    TestSortCorpus(int max_exponent, const testdoc_t& path,
+                   BenchmarkReport::Format format)
+    : max_exponent(max_exponent), path(path), format(format)
+    {
+    }
+
+    testdoc_t get_title() override
+    {
+        return "PawSort: Corpus Benchmark (up to 10^"
+               + std::to_string(max_exponent) + ", "
+               + (format == BenchmarkReport::Format::csv ? "CSV" : "JSON")
+               + ")";
+    }
+
+    testdoc_t get_docs() override
+    {
+        return "Measures every sorting algorithm on every array shape, for "
+               "sizes from 10^1 to 10^" + std::to_string(max_exponent)
+               + ", with int, double, std::string, onestring, and 64-byte "
+               "record elements. Writes the results to " + path + ".";
+    }
+
+    bool run() override
+    {
+        TestManager manager;
+        BenchmarkReport report({"algorithm", "type", "shape", "size"});
+
+        bool status = sweep<int>(manager, report)
+                      && sweep<double>(manager, report)
+                      && sweep<std::string>(manager, report)
+                      && sweep<onestring>(manager, report)
+                      && sweep<SortRecord64>(manager, report);
+
+        if (!report.write(path, format))
+        {
+            ioc << IOCat::error << "Could not write the report to " << path
+                << IOCtrl::endl;
+            return false;
+        }
+        ioc << IOCat::normal << "Wrote " << report.size() << " results to "
+            << path << IOCtrl::endl;
+        return status;
+    }
+
+    ~TestSortCorpus() {}
+
+private:
+    /// Skip any array whose two working copies would exceed this many bytes.
+    static const uint64_t memory_limit = 4ULL * 1024 * 1024 * 1024;
+    /// Skip quadratic algorithms on arrays larger than this.
+    static const int quadratic_limit = 1000;
+
+    int max_exponent;
+    testdoc_t path;
+    BenchmarkReport::Format format;
+
+    template<typename T>
+    bool sweep(TestManager& manager, BenchmarkReport& report)
+    {
+        const SortAlgorithm algorithms[] = {
+            SortAlgorithm::STD_SORT,       SortAlgorithm::PAWSORT,
+            SortAlgorithm::INTROSORT,      SortAlgorithm::DUAL_PIVOT,
+            SortAlgorithm::HEAP_SORT,      SortAlgorithm::INSERTION_SORT,
+            SortAlgorithm::THREE_WAY_SORT, SortAlgorithm::RADIX_SORT};
+
+        int size = 1;
+        for (int exponent = 1; exponent <= max_exponent; ++exponent)
+        {
+            size *= 10;
+            if (static_cast<uint64_t>(size) * sizeof(T) * 2 > memory_limit)
+            {
+                ioc << IOCat::warning << "Skipping " << SortElement<T>::name()
+                    << " arrays of " << size << " elements: too large."
+                    << IOCtrl::endl;
+                continue;
+            }
+
+            // Measure small arrays many times, and huge ones just enough.
+            unsigned int repeat = static_cast<unsigned int>(
+                std::max(10, std::min(100, 100000 / size)));
+
+            /* Skip the random shape, whose results are inconsistent, by
+             * starting just after it. */
+            for (int t = static_cast<int>(TestSort::TestArrayType::ARRAY_SORTED);
+                 t <= static_cast<int>(TestSort::TestArrayType::ARRAY_NIGHTMARE);
+                 ++t)
+            {
+                auto type = static_cast<TestSort::TestArrayType>(t);
+                for (SortAlgorithm algorithm : algorithms)
+                {
+                    if (algorithm == SortAlgorithm::INSERTION_SORT
+                        && size > quadratic_limit)
+                    {
+                        continue;
+                    }
+                    if (algorithm == SortAlgorithm::RADIX_SORT
+                        && !std::is_integral<T>::value)
+                    {
+                        continue;
+                    }
+
+                    TestSortBench<T> bench(algorithm, type, size);
+                    ioc << IOCat::normal << bench.get_title() << "    "
+                        << IOCtrl::endc;
+
+                    TestManager::BenchmarkResult result;
+                    if (!manager.measure(&bench, result, repeat))
+                    {
+                        ioc << IOCtrl::endl << IOCat::error << "FAILED: "
+                            << bench.get_title() << IOCtrl::endl;
+                        return false;
+                    }
+                    report.add({TestSortBench<T>::algorithm_name(algorithm),
+                                SortElement<T>::name(),
+                                TestSort::shape_name(type),
+                                std::to_string(size)},
+                               result);
+                }
+            }
+        }
+        ioc << IOCtrl::endl;
+        return true;
+    }
+};
+
 class TestSuite_Pawsort : public TestSuite
 {
 public:
@@ -154,6 +154,34 @@ class stdutils
         template <typename T>
         static void ftoa(char*, T, int=14, int=1);
 
+        /// The most characters write_int() will write, for any integer type.
+        inline static const int INT_CHARS = 65;
+
+        /**Write an integer as text, without a null terminator and without
+         * allocating. Base 10 is written two digits at a time.
+         * \param the buffer to write to, with room for INT_CHARS characters
+         * \param the integer to convert
+         * \param the base to convert in, default 10
+         * \param whether to use capital letters for base > 10
+         * \return the number of characters written*/
+        template <typename T>
+        static int write_int(char*, T, int=10, bool=false);
+
+        /**Write a floating point number as text, without a null terminator
+         * and without allocating. This writes the shortest digits that
+         * read back as the same number, rounded to the given number of
+         * digits after the decimal point.
+         * \param the buffer to write to
+         * \param the size of the buffer
+         * \param the number to convert
+         * \param the most digits after the decimal point
+         * \param whether to use scientific notation. 0=none, 1=automatic,
+         * 2=force scientific notation.
+         * \return the number of characters written. If they would not fit,
+         * nothing is written, and this returns a size that will fit.*/
+        template <typename T>
+        static size_t write_float(char*, size_t, T, int=14, int=1);
+
         /**Convert an unsigned pointer integer to a Cstring.
          * Does not presently export the flag value, just the
          * memory address.
@@ -186,8 +214,54 @@ class stdutils
         //static std::string ptrtos(uintptr_t);
         static std::string ptrtos(uintptr_t, bool=false);
 
+        /**Dump memory as hex onto the end of a C-string, which must have
+         * room for memdump_length() more characters and a null terminator.
+         * \param the C-string to append to
+         * \param the memory to dump
+         * \param the number of bytes to dump
+         * \param whether to use capital letters
+         * \param the separators, as IOFormatMemSep: 1 for spaces between
+         * bytes, 2 for bars between words (8 bytes), or 3 for both*/
         static void memdump(char*, const void*, unsigned int, bool=false, char=0);
 
+        /**Dump memory as hex, as memdump(), but without a null terminator,
+         * so it can be written straight into a larger buffer. A long dump
+         * can be written in pieces, each a multiple of 8 bytes but the last.
+         * \param the buffer, with room for memdump_length() characters
+         * \param the memory to dump
+         * \param the number of bytes to dump
+         * \param whether to use capital letters
+         * \param the separators, as for memdump()
+         * \param whether these are the last bytes, or the separator after
+         * them should be written too
+         * \return the number of characters written*/
+        static size_t write_memdump(char*, const void*, size_t, bool=false, char=0,
+                                    bool=true);
+
+        /**\param the number of bytes to dump
+         * \param the separators, as for memdump()
+         * \param whether these are the last bytes, as for write_memdump()
+         * \return the number of characters write_memdump() writes for them*/
+        static size_t memdump_length(size_t, char=0, bool=true);
+
+        /**Write bytes as hex, two digits each, in the order they are in
+         * memory and without a null terminator or separators. Uses SSSE3
+         * or AVX2 where the processor has them.
+         * \param the buffer, with room for two characters per byte
+         * \param the bytes to write
+         * \param the number of bytes
+         * \param whether to use capital letters*/
+        static void write_hex(char*, const void*, size_t, bool=false);
+
+        /**Hash a run of bytes, with a wyhash-style multiply-and-fold.
+         * The result is the same for the same bytes and seed within a
+         * build, but may differ between platforms, so don't store it.
+         * \param the first byte to hash
+         * \param the number of bytes
+         * \param the seed, optional
+         * \return the hash */
+        static uint64_t hash(const void*, size_t, uint64_t=0);
+
         ~stdutils();
     protected:
     private:
@@ -0,0 +1,145 @@
+/** UTF-8 Utilities [PawLIB]
+  * Version: 0.1
+  *
+  * Bulk UTF-8 validation, counting, and transcoding for onestring and
+  * onestring_view, with SSSE3 and AVX2 kernels picked at runtime on x86
+  * and a scalar fallback everywhere else.
+  *
+  * Author(s): Jason C. McDonald
+  */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2019 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+
+#ifndef PAWLIB_UTF8_HPP
+#define PAWLIB_UTF8_HPP
+
+#include <cstddef>
+#include <string>
+
+#include "pawlib/onechar.hpp"
+
+class utf8
+{
+    public:
+        /// Returned by count_if_valid() for text that isn't valid UTF-8.
+        inline static const size_t npos = -1;
+
+        /** Checks that text is well-formed UTF-8: no stray or missing
+         * continuation bytes, overlong encodings, surrogates, or code
+         * points past U+10FFFF.
+         * \param the first byte of the text
+         * \param the number of bytes
+         * \return true if valid, else false */
+        static bool validate(const char* str, size_t bytes)
+        {
+            return (count_if_valid(str, bytes) != npos);
+        }
+
+        /** Counts the characters in valid UTF-8, checking it as it goes.
+         * \param the first byte of the text
+         * \param the number of bytes
+         * \return the number of characters, or npos if the text is not
+         * valid UTF-8 (including a character cut short at the end) */
+        static size_t count_if_valid(const char* str, size_t bytes);
+
+        /** Counts the characters in text the way onechar reads them,
+         * which for valid UTF-8 is one per code point. Malformed bytes
+         * are counted the same way onestring stores them.
+         * \param the first byte of the text
+         * \param the number of bytes
+         * \return the number of characters */
+        static size_t count(const char* str, size_t bytes);
+
+        /** Steps forward through text by whole characters.
+         * \param the first byte of the text
+         * \param the number of bytes
+         * \param the number of characters to step over
+         * \return the byte offset reached, at most bytes */
+        static size_t advance(const char* str, size_t bytes, size_t n);
+
+        /** Converts UTF-8 to UTF-16. Each malformed character becomes
+         * U+FFFD, so the result has one code point per character.
+         * \param the first byte of the text
+         * \param the number of bytes
+         * \return the UTF-16 text */
+        static std::u16string to_utf16(const char* str, size_t bytes);
+
+        /** Converts UTF-8 to UTF-32. Each malformed character becomes
+         * U+FFFD, so the result has one code point per character.
+         * \param the first byte of the text
+         * \param the number of bytes
+         * \return the UTF-32 text */
+        static std::u32string to_utf32(const char* str, size_t bytes);
+
+        /** Converts UTF-16 to UTF-8. Unpaired surrogates become U+FFFD.
+         * \param the first code unit of the text
+         * \param the number of code units
+         * \return the UTF-8 text */
+        static std::string from_utf16(const char16_t* str, size_t units);
+
+        /** Converts UTF-32 to UTF-8. Surrogates and values past U+10FFFF
+         * become U+FFFD.
+         * \param the first code point of the text
+         * \param the number of code points
+         * \return the UTF-8 text */
+        static std::string from_utf32(const char32_t* str, size_t units);
+
+        /** The byte length of the character at the given address, as
+         * onechar reads it, without running past the end of the text.
+         * \param the address of the first byte of the character
+         * \param the number of bytes left, at least 1
+         * \return the number of bytes in the character */
+        static size_t char_length(const char* str, size_t avail)
+        {
+            size_t len = onechar::evaluateLength(str);
+            return (len < avail) ? len : avail;
+        }
+
+    private:
+        /** Decodes one character.
+         * \param the first byte of the character
+         * \param its length, from char_length()
+         * \return the code point, or U+FFFD if it is malformed */
+        static char32_t decode(const char* str, size_t len);
+
+        /** Encodes one code point, replacing invalid ones with U+FFFD.
+         * \param the code point
+         * \param the string to append the bytes to */
+        static void encode(char32_t cp, std::string& out);
+};
+
+#endif // PAWLIB_UTF8_HPP
@@ -1,5 +1,8 @@
 #include "pawlib/goldilocks.hpp"
 
+#include <cmath>
+#include <sstream>
+
 // MACRO IF we are using a GCC-style compiler.
 // NOTE: We're assuming Intel/AMD. What about PowerPC and ARM?
 #if defined __GNUC__ || __MINGW32__ || __MINGW64__
@@ -1192,6 +1195,79 @@ bool TestManager::run_compare(Test* test1, Test* test2, unsigned int repeat,
     return false;
 }
 
+bool TestManager::measure(Test* test, BenchmarkResult& result,
+    unsigned int repeat)
+{
+    if(test == nullptr)
+    {
+        return false;
+    }
+
+    // The statistics need at least this many measurements to be sound.
+    if(repeat < 10)
+    {
+        repeat = 10;
+    }
+    else if(repeat > 10000)
+    {
+        repeat = 10000;
+    }
+
+    // Set up the test, just as we would for an ordinary run.
+    if(!test->pre())
+    {
+        test->prefail();
+        return false;
+    }
+
+    // Ensure the test succeeds before measuring it.
+    if(!test->run() || !test->verify())
+    {
+        test->postmortem();
+        return false;
+    }
+
+    uint64_t* results = new uint64_t[repeat];
+
+    // Measure the measurement functions, so we can offset them out.
+    calibrate();
+    for(unsigned int i=0; i<repeat; ++i)
+    {
+        results[i] = clock();
+    }
+    BenchmarkResult baseR;
+    resultFromArray(baseR, results, repeat);
+    uint64_t base = baseR.mean;
+
+    bool status = true;
+    for(unsigned int i=0; i<repeat; ++i)
+    {
+        test->janitor();
+        uint64_t cycles = clock(test);
+        // An out-of-order measurement can dip below the baseline.
+        results[i] = (cycles > base) ? cycles - base : 0;
+        if(!test->verify())
+        {
+            status = false;
+            break;
+        }
+    }
+
+    if(status)
+    {
+        result = BenchmarkResult();
+        resultFromArray(result, results, repeat);
+        test->post();
+    }
+    else
+    {
+        test->postmortem();
+    }
+
+    delete[] results;
+    return status;
+}
+
 void TestManager::resultFromArray(BenchmarkResult& result, uint64_t arr[], int repeat)
 {
     // Sort the array.
@@ -1619,3 +1695,169 @@ void TestSuite::backregister(TestManager* tm)
 {
     testmanager = tm;
 }
+
+namespace
+{
+    /** Quote a field for CSV output, if it needs it.
+     * \param the field to quote
+     * \return the quoted field */
+    std::string csv_field(const std::string& field)
+    {
+        if(field.find_first_of(",\"\n") == std::string::npos)
+        {
+            return field;
+        }
+        std::string quoted = "\"";
+        for(char ch : field)
+        {
+            if(ch == '"')
+            {
+                quoted += '"';
+            }
+            quoted += ch;
+        }
+        return quoted + "\"";
+    }
+
+    /** Quote a string for JSON output.
+     * \param the string to quote
+     * \return the quoted string */
+    std::string json_string(const std::string& str)
+    {
+        std::string quoted = "\"";
+        for(char ch : str)
+        {
+            switch(ch)
+            {
+                case '"':
+                    quoted += "\\\"";
+                    break;
+                case '\\':
+                    quoted += "\\\\";
+                    break;
+                case '\n':
+                    quoted += "\\n";
+                    break;
+                case '\t':
+                    quoted += "\\t";
+                    break;
+                default:
+                    // Any other control character must be escaped as hex.
+                    if(static_cast<unsigned char>(ch) < 0x20)
+                    {
+                        const char* hex = "0123456789abcdef";
+                        quoted += "\\u00";
+                        quoted += hex[(ch >> 4) & 0xF];
+                        quoted += hex[ch & 0xF];
+                    }
+                    else
+                    {
+                        quoted += ch;
+                    }
+            }
+        }
+        return quoted + "\"";
+    }
+
+    /** Write a number for JSON output, which has no NaN or infinity.
+     * \param the number
+     * \return the number as text, or null if it isn't finite */
+    std::string json_number(double num)
+    {
+        if(!std::isfinite(num))
+        {
+            return "null";
+        }
+        std::ostringstream text;
+        text << num;
+        return text.str();
+    }
+
+    /// The names of the statistics columns in every report.
+    const char* const stat_columns[] = {
+        "repeat", "mean", "mean_adj", "median", "q1", "q3", "min", "max",
+        "std_dev", "rsd"
+    };
+    const size_t stat_count = sizeof(stat_columns) / sizeof(stat_columns[0]);
+}
+
+void BenchmarkReport::add(const std::vector<testdoc_t>& labels,
+    const TestManager::BenchmarkResult& result)
+{
+    Row row;
+    row.labels = labels;
+    // Pad or trim the labels to match the columns.
+    row.labels.resize(columns.size());
+    row.result = result;
+    rows.push_back(row);
+}
+
+void BenchmarkReport::write(std::ostream& out, Format format) const
+{
+    switch(format)
+    {
+        case Format::csv:
+        {
+            for(auto& column : columns)
+            {
+                out << csv_field(column) << ",";
+            }
+            for(size_t i = 0; i < stat_count; ++i)
+            {
+                out << stat_columns[i] << (i + 1 < stat_count ? "," : "\n");
+            }
+
+            for(auto& row : rows)
+            {
+                for(auto& label : row.labels)
+                {
+                    out << csv_field(label) << ",";
+                }
+                const TestManager::BenchmarkResult& r = row.result;
+                out << r.repeat << "," << r.mean << "," << r.mean_adj << ","
+                    << r.median << "," << r.q1 << "," << r.q3 << ","
+                    << r.min_val << "," << r.max_val << "," << r.std_dev
+                    << "," << static_cast<int>(r.rsd) << "\n";
+            }
+            break;
+        }
+        case Format::json:
+        {
+            out << "[";
+            for(size_t i = 0; i < rows.size(); ++i)
+            {
+                out << (i ? ",\n  {" : "\n  {");
+                for(size_t c = 0; c < columns.size(); ++c)
+                {
+                    out << json_string(columns[c]) << ": "
+                        << json_string(rows[i].labels[c]) << ", ";
+                }
+                const TestManager::BenchmarkResult& r = rows[i].result;
+                out << "\"repeat\": " << r.repeat
+                    << ", \"mean\": " << r.mean
+                    << ", \"mean_adj\": " << r.mean_adj
+                    << ", \"median\": " << r.median
+                    << ", \"q1\": " << r.q1
+                    << ", \"q3\": " << r.q3
+                    << ", \"min\": " << r.min_val
+                    << ", \"max\": " << r.max_val
+                    << ", \"std_dev\": " << json_number(r.std_dev)
+                    << ", \"rsd\": " << static_cast<int>(r.rsd) << "}";
+            }
+            out << (rows.empty() ? "]\n" : "\n]\n");
+            break;
+        }
+    }
+}
+
+bool BenchmarkReport::write(const std::string& path, Format format) const
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if(!file)
+    {
+        return false;
+    }
+    write(file, format);
+    file.close();
+    return !file.fail();
+}
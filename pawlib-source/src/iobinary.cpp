@@ -0,0 +1,511 @@
+#include "pawlib/iobinary.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+namespace
+{
+    void put_varint(std::string& out, uint64_t val)
+    {
+        while (val >= 0x80)
+        {
+            out.push_back(static_cast<char>((val & 0x7F) | 0x80));
+            val >>= 7;
+        }
+        out.push_back(static_cast<char>(val));
+    }
+
+    uint64_t zigzag(int64_t val)
+    {
+        return (static_cast<uint64_t>(val) << 1) ^ static_cast<uint64_t>(val >> 63);
+    }
+
+    int64_t unzigzag(uint64_t val)
+    {
+        return static_cast<int64_t>(val >> 1) ^ -static_cast<int64_t>(val & 1);
+    }
+
+    int64_t now_micros()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    /// Reads a value packed by iofmt::pack(), moving past it.
+    template <typename T>
+    bool unpack(std::string_view& record, T& val)
+    {
+        if (record.size() < sizeof(T)) { return false; }
+        memcpy(&val, record.data(), sizeof(T));
+        record.remove_prefix(sizeof(T));
+        return true;
+    }
+
+    template <typename T>
+    void pack(std::string& out, const T& val)
+    {
+        out.append(reinterpret_cast<const char*>(&val), sizeof(T));
+    }
+
+    const char* vrb_name(IOVrb vrb)
+    {
+        switch (vrb)
+        {
+            case IOVrb::quiet:
+                return "quiet";
+            case IOVrb::normal:
+                return "normal";
+            case IOVrb::chatty:
+                return "chatty";
+            default:
+                return "tmi";
+        }
+    }
+
+    void append_cat(std::string& out, IOCat cat)
+    {
+        static const char* names[] = {"normal", "warning", "error", "debug", "testing"};
+        size_t at = out.size();
+        for (int i = 0; i < 5; ++i)
+        {
+            if (!(static_cast<int>(cat) & (1 << i))) { continue; }
+            if (out.size() > at) { out.push_back('|'); }
+            out.append(names[i]);
+        }
+        if (out.size() == at) { out.append("none"); }
+    }
+
+    void append_time(std::string& out, int64_t micros)
+    {
+        int64_t seconds = micros / 1000000;
+        int64_t part = micros % 1000000;
+        if (part < 0)
+        {
+            part += 1000000;
+            --seconds;
+        }
+        time_t when = static_cast<time_t>(seconds);
+        struct tm parts;
+        gmtime_r(&when, &parts);
+        char buffer[40];
+        size_t len = strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &parts);
+        snprintf(buffer + len, sizeof(buffer) - len, ".%06dZ", static_cast<int>(part));
+        out.append(buffer);
+    }
+
+    /// The message without its final newline, which the renderers supply.
+    std::string_view trimmed(const std::string& text)
+    {
+        std::string_view view = text;
+        if (!view.empty() && view.back() == '\n') { view.remove_suffix(1); }
+        return view;
+    }
+}
+
+IOBinarySink::IOBinarySink(const std::string& path, size_t buffer)
+: IOFileSink(path, buffer)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    started();
+}
+
+IOBinarySink::~IOBinarySink()
+{
+    detach();
+}
+
+void IOBinarySink::hook(iochannel& ioc, IOVrb vrb, IOCat cat)
+{
+    record_handle = ioc.signal_record.append(
+        [this, vrb, cat](std::string_view msg, IOVrb msg_vrb, IOCat msg_cat,
+                         const IOFormatString* format)
+        {
+            if(msg_vrb > vrb || !static_cast<bool>(msg_cat & cat)){return;}
+            std::lock_guard<std::mutex> guard(lock);
+            record(msg, msg_vrb, msg_cat, format);
+        });
+}
+
+void IOBinarySink::unhook(iochannel& ioc)
+{
+    ioc.signal_record.remove(record_handle);
+}
+
+void IOBinarySink::store(std::string_view msg)
+{
+    record(msg, IOVrb::normal, IOCat::normal, nullptr);
+}
+
+void IOBinarySink::started()
+{
+    ids.clear();
+    last_format = nullptr;
+    last_time = now_micros();
+    encoded.assign(MAGIC.data(), MAGIC.size());
+    put_varint(encoded, static_cast<uint64_t>(last_time));
+    put(encoded);
+}
+
+void IOBinarySink::record(std::string_view msg, IOVrb vrb, IOCat cat,
+                          const IOFormatString* format)
+{
+    if(!encode(msg, vrb, cat, format))
+    {
+        error_count.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // A rotated file needs its own string table, so encode it again.
+    if(due(encoded.size()))
+    {
+        roll();
+        encode(msg, vrb, cat, format);
+    }
+    put(encoded);
+}
+
+bool IOBinarySink::encode(std::string_view msg, IOVrb vrb, IOCat cat,
+                          const IOFormatString* format)
+{
+    encoded.clear();
+
+    /* Nothing here changes until the record is whole, since a record
+     * that fails is never written, and later ones must not refer to it. */
+    uint64_t id = last_id;
+    bool defined = false;
+    if(format && format != last_format)
+    {
+        auto found = ids.find(format);
+        if(found == ids.end())
+        {
+            id = ids.size();
+            defined = true;
+            encoded.push_back(static_cast<char>(IOBinaryTag::define));
+            put_varint(encoded, id);
+            put_varint(encoded, format->text.size());
+            encoded.append(format->text.data(), format->text.size());
+        }
+        else
+        {
+            id = found->second;
+        }
+    }
+
+    encoded.push_back(static_cast<char>(format ? IOBinaryTag::log : IOBinaryTag::text));
+    encoded.push_back(static_cast<char>((static_cast<int>(vrb) << 5)
+                                        | (static_cast<int>(cat) & 0x1F)));
+    int64_t now = now_micros();
+    put_varint(encoded, zigzag(now - last_time));
+
+    if(!format)
+    {
+        put_varint(encoded, msg.size());
+        encoded.append(msg.data(), msg.size());
+        last_time = now;
+        return true;
+    }
+
+    put_varint(encoded, id);
+    while(!msg.empty())
+    {
+        IOArgType kind = static_cast<IOArgType>(msg[0]);
+        msg.remove_prefix(1);
+        switch(kind)
+        {
+            case IOArgType::sint:
+            {
+                long long val;
+                if(!unpack(msg, val)){return false;}
+                encoded.push_back(static_cast<char>(kind));
+                put_varint(encoded, zigzag(val));
+                break;
+            }
+            case IOArgType::uint:
+            {
+                unsigned long long val;
+                if(!unpack(msg, val)){return false;}
+                encoded.push_back(static_cast<char>(kind));
+                put_varint(encoded, val);
+                break;
+            }
+            case IOArgType::f32:
+            {
+                float val;
+                if(!unpack(msg, val)){return false;}
+                encoded.push_back(static_cast<char>(kind));
+                pack(encoded, val);
+                break;
+            }
+            case IOArgType::f64:
+            case IOArgType::f80:
+            {
+                double val;
+                if(kind == IOArgType::f80)
+                {
+                    long double wide;
+                    if(!unpack(msg, wide)){return false;}
+                    val = static_cast<double>(wide);
+                }
+                else if(!unpack(msg, val)){return false;}
+                encoded.push_back(static_cast<char>(IOArgType::f64));
+                pack(encoded, val);
+                break;
+            }
+            case IOArgType::text:
+            {
+                size_t len;
+                if(!unpack(msg, len) || msg.size() < len){return false;}
+                encoded.push_back(static_cast<char>(kind));
+                put_varint(encoded, len);
+                encoded.append(msg.data(), len);
+                msg.remove_prefix(len);
+                break;
+            }
+            case IOArgType::boolean:
+            case IOArgType::character:
+            {
+                if(msg.empty()){return false;}
+                encoded.push_back(static_cast<char>(kind));
+                encoded.push_back(msg[0]);
+                msg.remove_prefix(1);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+
+    if(defined)
+    {
+        ids.emplace(format, id);
+    }
+    last_format = format;
+    last_id = id;
+    last_time = now;
+    return true;
+}
+
+IOBinaryReader::IOBinaryReader(std::string_view log, IOVrb vrb, IOCat cat)
+: data(log), max_vrb(vrb), cats(cat)
+{}
+
+bool IOBinaryReader::read_varint(uint64_t& val)
+{
+    val = 0;
+    for (int shift = 0; shift < 64 && at < data.size(); shift += 7)
+    {
+        uint8_t byte = static_cast<uint8_t>(data[at++]);
+        val |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) { return true; }
+    }
+    return false;
+}
+
+bool IOBinaryReader::read_header(IOBinaryRecord& rec)
+{
+    if (at >= data.size()) { return false; }
+    uint8_t tags = static_cast<uint8_t>(data[at++]);
+    rec.vrb = static_cast<IOVrb>(tags >> 5);
+    rec.cat = static_cast<IOCat>(tags & 0x1F);
+
+    uint64_t delta;
+    if (!read_varint(delta)) { return false; }
+    time += unzigzag(delta);
+    rec.time = time;
+    return true;
+}
+
+bool IOBinaryReader::read_define()
+{
+    uint64_t id;
+    uint64_t len;
+    if (!read_varint(id) || id != formats.size() || !read_varint(len)
+        || len > data.size() - at)
+    {
+        return false;
+    }
+
+    Format format;
+    format.text.assign(data.data() + at, static_cast<size_t>(len));
+    at += static_cast<size_t>(len);
+
+    iofmt::Summary found = iofmt::scan(format.text);
+    if (!found.valid) { return false; }
+    format.pieces.resize(found.pieces);
+    iofmt::scan(format.text, format.pieces.data());
+    formats.push_back(std::move(format));
+    return true;
+}
+
+bool IOBinaryReader::read_args(const Format& format)
+{
+    packed.clear();
+    for (const IOFormatPiece& piece : format.pieces)
+    {
+        if (!piece.arg) { continue; }
+        if (at >= data.size()) { return false; }
+        IOArgType kind = static_cast<IOArgType>(data[at++]);
+        packed.push_back(static_cast<char>(kind));
+
+        uint64_t val;
+        switch (kind)
+        {
+            case IOArgType::sint:
+            {
+                if (!read_varint(val)) { return false; }
+                pack(packed, static_cast<long long>(unzigzag(val)));
+                break;
+            }
+            case IOArgType::uint:
+            {
+                if (!read_varint(val)) { return false; }
+                pack(packed, static_cast<unsigned long long>(val));
+                break;
+            }
+            case IOArgType::f32:
+            case IOArgType::f64:
+            {
+                size_t len = (kind == IOArgType::f32) ? sizeof(float) : sizeof(double);
+                if (data.size() - at < len) { return false; }
+                packed.append(data.data() + at, len);
+                at += len;
+                break;
+            }
+            case IOArgType::text:
+            {
+                if (!read_varint(val) || val > data.size() - at) { return false; }
+                pack(packed, static_cast<size_t>(val));
+                packed.append(data.data() + at, static_cast<size_t>(val));
+                at += static_cast<size_t>(val);
+                break;
+            }
+            case IOArgType::boolean:
+            case IOArgType::character:
+            {
+                if (at >= data.size()) { return false; }
+                packed.push_back(data[at++]);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+bool IOBinaryReader::next(IOBinaryRecord& rec)
+{
+    while (at < data.size() && !bad)
+    {
+        if (data.substr(at, IOBinarySink::MAGIC.size()) == IOBinarySink::MAGIC)
+        {
+            // A new session, with a string table of its own.
+            at += IOBinarySink::MAGIC.size();
+            uint64_t start;
+            if (!read_varint(start)) { return fail(); }
+            time = static_cast<int64_t>(start);
+            formats.clear();
+            continue;
+        }
+
+        IOBinaryTag tag = static_cast<IOBinaryTag>(data[at++]);
+        switch (tag)
+        {
+            case IOBinaryTag::define:
+            {
+                if (!read_define()) { return fail(); }
+                break;
+            }
+            case IOBinaryTag::log:
+            {
+                uint64_t id;
+                if (!read_header(rec) || !read_varint(id) || id >= formats.size()
+                    || !read_args(formats[id]))
+                {
+                    return fail();
+                }
+                if (rec.vrb > max_vrb || !static_cast<bool>(rec.cat & cats)) { break; }
+
+                const Format& format = formats[id];
+                IOFormatString fmt{format.text, format.pieces.data(), format.pieces.size()};
+                rec.text.clear();
+                if (!iofmt::format_packed(rec.text, fmt, packed)) { return fail(); }
+                return true;
+            }
+            case IOBinaryTag::text:
+            {
+                uint64_t len;
+                if (!read_header(rec) || !read_varint(len) || len > data.size() - at)
+                {
+                    return fail();
+                }
+                size_t from = at;
+                at += static_cast<size_t>(len);
+                if (rec.vrb > max_vrb || !static_cast<bool>(rec.cat & cats)) { break; }
+
+                rec.text.assign(data.data() + from, static_cast<size_t>(len));
+                return true;
+            }
+            default:
+                return fail();
+        }
+    }
+    return false;
+}
+
+void IOBinaryReader::render_text(const IOBinaryRecord& rec, std::string& out)
+{
+    append_time(out, rec.time);
+    out.append(" [");
+    out.append(vrb_name(rec.vrb));
+    out.append("] [");
+    append_cat(out, rec.cat);
+    out.append("] ");
+    std::string_view text = trimmed(rec.text);
+    out.append(text.data(), text.size());
+    out.push_back('\n');
+}
+
+void IOBinaryReader::render_json(const IOBinaryRecord& rec, std::string& out)
+{
+    out.append("{\"time\":\"");
+    append_time(out, rec.time);
+    out.append("\",\"vrb\":\"");
+    out.append(vrb_name(rec.vrb));
+    out.append("\",\"cat\":\"");
+    append_cat(out, rec.cat);
+    out.append("\",\"msg\":\"");
+    for (char c : trimmed(rec.text))
+    {
+        switch (c)
+        {
+            case '"':
+                out.append("\\\"");
+                break;
+            case '\\':
+                out.append("\\\\");
+                break;
+            case '\n':
+                out.append("\\n");
+                break;
+            case '\t':
+                out.append("\\t");
+                break;
+            case '\r':
+                out.append("\\r");
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escape[8];
+                    snprintf(escape, sizeof(escape), "\\u%04x", c);
+                    out.append(escape);
+                }
+                else
+                {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.append("\"}\n");
+}
@@ -1,22 +1,238 @@
 #include "pawlib/iochannel.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+
+#include <time.h>
+
+IORecordQueue::IORecordQueue(size_t capacity)
+: mask(0), head(0), tail(0)
+{
+    size_t size = 2;
+    while(size < capacity)
+    {
+        size <<= 1;
+    }
+    mask = size - 1;
+
+    cells.reset(new Cell[size]);
+    for(size_t i = 0; i < size; ++i)
+    {
+        cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool IORecordQueue::try_push(IORecord& record)
+{
+    size_t pos = head.load(std::memory_order_relaxed);
+    Cell* cell;
+    while(true)
+    {
+        cell = &cells[pos & mask];
+        size_t seq = cell->seq.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if(diff == 0)
+        {
+            // The cell is free; claim it, unless another thread beat us.
+            if(head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if(diff < 0)
+        {
+            // The cell hasn't been popped since the last lap: we're full.
+            return false;
+        }
+        else
+        {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->record.msg.swap(record.msg);
+    cell->record.vrb = record.vrb;
+    cell->record.cat = record.cat;
+    cell->record.format = record.format;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    record.msg.clear();
+    return true;
+}
+
+bool IORecordQueue::try_pop(IORecord& record)
+{
+    size_t pos = tail.load(std::memory_order_relaxed);
+    Cell& cell = cells[pos & mask];
+    if(cell.seq.load(std::memory_order_acquire) != pos + 1)
+    {
+        return false;
+    }
+
+    record.msg.swap(cell.record.msg);
+    record.vrb = cell.record.vrb;
+    record.cat = cell.record.cat;
+    record.format = cell.record.format;
+    cell.record.msg.clear();
+
+    // Free the cell for the push one lap from now.
+    cell.seq.store(pos + mask + 1, std::memory_order_release);
+    tail.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+namespace
+{
+    /// \return a steady time in nanoseconds, cheaply rather than precisely
+    int64_t coarse_now()
+    {
+#ifdef CLOCK_MONOTONIC_COARSE
+        // A few milliseconds out at most, but a fraction of the cost.
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+        return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /// \return a fast, thread-local random number, for sampling
+    uint64_t sample_random()
+    {
+        thread_local uint64_t state = 0;
+        if(state == 0)
+        {
+            // Seed each thread differently, and never with 0.
+            state = reinterpret_cast<uintptr_t>(&state) ^ 0x9E3779B97F4A7C15ull;
+        }
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+}
+
+void IORateLimit::configure(double per_second, double burst, unsigned int sample)
+{
+    int64_t step = (per_second > 0) ? static_cast<int64_t>(1e9 / per_second) : 0;
+    interval.store(step, std::memory_order_relaxed);
+    tolerance.store(static_cast<int64_t>(step * std::max(burst, 1.0)),
+                    std::memory_order_relaxed);
+    sample_rate.store(std::max(sample, 1u), std::memory_order_relaxed);
+    next_slot.store(0, std::memory_order_relaxed);
+}
+
+bool IORateLimit::admit()
+{
+    unsigned int sample = sample_rate.load(std::memory_order_relaxed);
+    if(sample > 1 && sample_random() % sample != 0)
+    {
+        suppressed_count.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    int64_t step = interval.load(std::memory_order_relaxed);
+    if(step == 0){return true;}
+
+    /* Rather than counting tokens, keep the time the bucket would next be
+     * full if messages went at the steady rate; a message may go as long
+     * as that is no more than a burst ahead of now. */
+    int64_t now = coarse_now();
+    int64_t limit = tolerance.load(std::memory_order_relaxed);
+    int64_t slot = next_slot.load(std::memory_order_relaxed);
+    while(true)
+    {
+        int64_t next = std::max(slot, now) + step;
+        if(next - now > limit)
+        {
+            suppressed_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if(next_slot.compare_exchange_weak(slot, next, std::memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+}
+
 //Declaring global instance of ic.
 iochannel ioc;
 
+namespace
+{
+    // Hands out channel ids, starting from 1, so 0 can mean "none".
+    std::atomic<uint64_t> next_channel_id(1);
+}
+
 iochannel::iochannel()
-: msg(""),
-    process_cat(IOCat::all),
+: process_cat(IOCat::all),
     process_vrb(IOVrb::tmi),
     echo_mode(IOEchoMode::cout),
     echo_cat(IOCat::all),
     echo_vrb(IOVrb::tmi),
-    fmt(IOFormat()),
-    readsize(IOMemReadSize(1)),
-    vrb(IOVrb::normal),
-    cat(IOCat::normal),
-    parse(maybe),
-    dirty_attributes(false)
-{}
+    id(next_channel_id.fetch_add(1))
+{
+    update_allowed();
+}
+
+iochannel::Staging& iochannel::stage()
+{
+    // Most threads only ever use one channel, so remember the last one.
+    thread_local uint64_t last_id = 0;
+    thread_local Staging* last = nullptr;
+    // Raised once the thread's stagings are gone; it has no destructor of its own.
+    thread_local bool gone = false;
+    if(last_id == id)
+    {
+        return *last;
+    }
+    if(gone)
+    {
+        return late_staging();
+    }
+
+    /* Ids are never reused, so a destroyed channel's staging can never be
+     * picked up by a new one. They are freed when the thread ends, after
+     * which anything sent from the thread, such as from a static
+     * destructor, uses the channel's own. */
+    struct Stages
+    {
+        std::unordered_map<uint64_t, std::unique_ptr<Staging>> map;
+
+        ~Stages()
+        {
+            last_id = 0;
+            last = nullptr;
+            gone = true;
+        }
+    };
+    thread_local Stages stages;
+    if(gone)
+    {
+        return late_staging();
+    }
+
+    std::unique_ptr<Staging>& found = stages.map[id];
+    if(!found)
+    {
+        found.reset(new Staging());
+    }
+    last_id = id;
+    last = found.get();
+    return *last;
+}
+
+iochannel::Staging& iochannel::late_staging()
+{
+    std::lock_guard<std::mutex> guard(late_lock);
+    std::unique_ptr<Staging>& found = late[std::this_thread::get_id()];
+    if(!found)
+    {
+        found.reset(new Staging());
+    }
+    return *found;
+}
 
 //------------ DATA TYPES ------------//
 
@@ -24,7 +240,7 @@ iochannel& iochannel::operator<<(const bool& rhs)
 {
     //If we cannot parse because of `shutup()` settings, abort.
     if(!can_parse()){return *this;}
-    switch(fmt.fmt_bool)
+    switch(stage().fmt.fmt_bool)
     {
         case IOFormatBool::lower:
         {
@@ -60,7 +276,7 @@ iochannel& iochannel::operator<<(const tril& rhs)
 {
     //If we cannot parse because of `shutup()` settings, abort.
     if(!can_parse()){return *this;}
-    switch(fmt.fmt_bool)
+    switch(stage().fmt.fmt_bool)
     {
         case IOFormatBool::lower:
         {
@@ -101,7 +317,7 @@ iochannel& iochannel::operator<<(const char& rhs)
     //If we cannot parse because of `shutup()` settings, abort.
     if(!can_parse()){return *this;}
 
-    switch(fmt.fmt_char_value)
+    switch(stage().fmt.fmt_char_value)
     {
         //Output as character.
         case IOFormatCharValue::as_char:
@@ -150,6 +366,21 @@ iochannel& iochannel::operator<<(const onestring& rhs)
     return *this;
 }
 
+iochannel& iochannel::operator<<(const onestring_view& rhs)
+{
+    //If we cannot parse because of `shutup()` settings, abort.
+    if(!can_parse()){return *this;}
+
+    //A view is not null-terminated, so append its bytes directly.
+    Staging& s = stage();
+    if(apply_attributes())
+    {
+        inject(s.format.c_str());
+    }
+    s.msg.append(rhs.data(), rhs.size());
+    return *this;
+}
+
 iochannel& iochannel::operator<<(const std::exception& rhs)
 {
     //If we cannot parse because of `shutup()` settings, abort.
@@ -163,7 +394,7 @@ iochannel& iochannel::operator<<(const std::exception& rhs)
 
 iochannel& iochannel::operator<<(const IOFormat& rhs)
 {
-    fmt = rhs;
+    stage().fmt = rhs;
     return *this;
 }
 
@@ -182,26 +413,24 @@ iochannel& iochannel::operator<<(const IOMemReadSize& rhs)
     //If we cannot parse because of `shutup()` settings, abort.
     if(!can_parse()){return *this;}
 
-    readsize = rhs;
+    stage().readsize = rhs;
 
     return *this;
 }
 
 iochannel& iochannel::operator<<(const IOVrb& rhs)
 {
+    Staging& s = stage();
     //Set the verbosity.
-    vrb = rhs;
-    //Revalidate parsing.
-    parse = maybe;
+    s.vrb = rhs;
     return *this;
 }
 
 iochannel& iochannel::operator<<(const IOCat& rhs)
 {
+    Staging& s = stage();
     //Set the category.
-    cat = rhs;
-    //Revalidate parsing.
-    parse = maybe;
+    s.cat = rhs;
     return *this;
 }
 
@@ -265,7 +494,7 @@ iochannel& iochannel::resolve_pointer(const char* rhs)
     //If we cannot parse because of `shutup()` settings, abort.
     if(!can_parse()){return *this;}
 
-    switch(fmt.fmt_ptr)
+    switch(stage().fmt.fmt_ptr)
     {
         //If we are to print as value...
         case IOFormatPtr::value:
@@ -297,7 +526,7 @@ iochannel& iochannel::resolve_pointer(const void* rhs)
     //If we cannot parse because of `shutup()` settings, abort.
     if(!can_parse()){return *this;}
 
-    switch(fmt.fmt_ptr)
+    switch(stage().fmt.fmt_ptr)
     {
         //If we are to print as value...
         case IOFormatPtr::value:
@@ -316,7 +545,7 @@ iochannel& iochannel::resolve_pointer(const void* rhs)
         case IOFormatPtr::memory:
         {
             //Inject raw address with the read_size() given by the user.
-            inject(rhs, readsize.readsize, true);
+            inject(rhs, stage().readsize.readsize, true);
             break;
         }
     }
@@ -329,7 +558,7 @@ iochannel& iochannel::resolve_pointer(const T* rhs)
     //If we cannot parse because of `shutup()` settings, abort.
     if(!can_parse()){return *this;}
 
-    switch(fmt.fmt_ptr)
+    switch(stage().fmt.fmt_ptr)
     {
         //If we are to print as value...
         case IOFormatPtr::value:
@@ -348,7 +577,7 @@ iochannel& iochannel::resolve_pointer(const T* rhs)
         case IOFormatPtr::memory:
         {
             //Inject address for memory dump.
-            inject(rhs, sizeof(typeid(*rhs)), true);
+            inject(rhs, sizeof(*rhs), true);
             break;
         }
     }
@@ -377,16 +606,19 @@ iochannel& iochannel::resolve_integer(const T& rhs)
     //If we cannot parse because of `shutup()` settings, abort.
     if(!can_parse()){return *this;}
 
-    int len = stdutils::intlen(rhs, static_cast<int>(fmt.fmt_base), true) + 1;
-
-    // Accepting defeat on VLAs - we'll just have to dynamically allocate.
-    char* cstr = new char[len];
-    std::fill_n(cstr, len, '\0');
-
-    stdutils::itoa(cstr, rhs, static_cast<int>(fmt.fmt_base), len, static_cast<bool>(fmt.fmt_numeral_case));
-    inject(cstr);
+    Staging& s = stage();
+    //If we just applied attributes, push them now.
+    if(apply_attributes())
+    {
+        inject(s.format.c_str());
+    }
 
-    delete[] cstr;
+    // Write the digits straight onto the end of the message.
+    size_t at = s.msg.size();
+    s.msg.resize(at + stdutils::INT_CHARS);
+    int len = stdutils::write_int(&s.msg[at], rhs, static_cast<int>(s.fmt.fmt_base),
+                                  static_cast<bool>(s.fmt.fmt_numeral_case));
+    s.msg.resize(at + static_cast<size_t>(len));
 
     return *this;
 }
@@ -407,20 +639,29 @@ iochannel& iochannel::resolve_float(const T& rhs)
     //If we cannot parse because of `shutup()` settings, abort.
     if(!can_parse()){return *this;}
 
-    /*char cstr[stdutils::floatlen(rhs, significands, sci, true) + 1];
-    cstr[0] = '\0';*/
-
-    // Accepting defeat on VLAs - we'll just have to dynamically allocate.
-    uint32_t len = stdutils::floatlen(rhs, fmt.fmt_significands.significands,
-                                        static_cast<bool>(fmt.fmt_sci_notation), true) + 1;
-    char* cstr = new char[len];
-    std::fill_n(cstr, len, '\0');
+    Staging& s = stage();
+    //If we just applied attributes, push them now.
+    if(apply_attributes())
+    {
+        inject(s.format.c_str());
+    }
 
-    //Convert the float to a cstring, and dump into cstr.
-    stdutils::ftoa(cstr, rhs, fmt.fmt_significands.significands, static_cast<bool>(fmt.fmt_sci_notation));
-    inject(cstr);
+    int significands = s.fmt.fmt_significands.significands;
+    int sci = static_cast<int>(s.fmt.fmt_sci_notation);
 
-    delete[] cstr;
+    /* Write the number straight onto the end of the message. Nearly
+     * every number fits in the first try. */
+    size_t at = s.msg.size();
+    size_t room = 64;
+    size_t len;
+    while(true)
+    {
+        s.msg.resize(at + room);
+        len = stdutils::write_float(&s.msg[at], room, rhs, significands, sci);
+        if(len <= room){break;}
+        room = len;
+    }
+    s.msg.resize(at + len);
 
     return *this;
 }
@@ -430,51 +671,39 @@ template iochannel& iochannel::resolve_float<long double>(const long double&);
 
 bool iochannel::apply_attributes()
 {
+    Staging& s = stage();
     bool r = false;
     //If we have unapplied attributes.
-    if(dirty_attributes)
+    if(s.dirty_attributes)
     {
         //TODO: We will need to switch formats. For now, just ANSI.
-        format = "\033[";
-        format.append(stdutils::itos(static_cast<int>(fmt.fmt_text_attr)));
+        s.format = "\033[";
+        s.format.append(stdutils::itos(static_cast<int>(s.fmt.fmt_text_attr)));
 
-        if(fmt.fmt_text_bg != IOFormatTextBG::none)
+        if(s.fmt.fmt_text_bg != IOFormatTextBG::none)
         {
-            format.append(";");
-            format.append(stdutils::itos(static_cast<int>(fmt.fmt_text_bg)));
+            s.format.append(";");
+            s.format.append(stdutils::itos(static_cast<int>(s.fmt.fmt_text_bg)));
         }
 
-        if(fmt.fmt_text_fg != IOFormatTextFG::none)
+        if(s.fmt.fmt_text_fg != IOFormatTextFG::none)
         {
-            format.append(";");
-            format.append(stdutils::itos(static_cast<int>(fmt.fmt_text_fg)));
+            s.format.append(";");
+            s.format.append(stdutils::itos(static_cast<int>(s.fmt.fmt_text_fg)));
         }
 
-        format.append("m");
+        s.format.append("m");
 
         //We took care of the attributes. Lower the dirty flag.
-        dirty_attributes = false;
+        s.dirty_attributes = false;
         r = true;
     }
     return r;
 }
 
-bool iochannel::can_parse()
-{
-    /* If we aren't sure about the parsing condition... */
-    if(~parse)
-    {
-        /* If the verbosity is in range or the category is set to parse,
-            * then set false. Otherwise, set true. */
-        parse = ((vrb <= process_vrb) && static_cast<bool>(process_cat & cat)) ? true : false;
-    }
-    return parse;
-}
-
 void iochannel::clear_msg()
 {
-    msg.clear();
-    msg = "";
+    stage().msg.clear();
 }
 
 void iochannel::configure_echo(IOEchoMode mode, IOVrb vrb, IOCat cat)
@@ -486,6 +715,9 @@ void iochannel::configure_echo(IOEchoMode mode, IOVrb vrb, IOCat cat)
 
 void iochannel::flush()
 {
+    //The writer thread flushes after every batch itself.
+    if(queue.load()){return;}
+
     /* TODO: For non-standard outputs, this should attach a bytecode to
         * tell external outputs to flush.*/
 
@@ -511,134 +743,216 @@ void iochannel::flush()
 
 void iochannel::inject(char ch)
 {
+    Staging& s = stage();
     //If we just applied attributes, push them now.
     if(apply_attributes())
     {
-        inject(format.c_str());
+        inject(s.format.c_str());
     }
 
-    msg.push_back(ch);
+    s.msg.push_back(ch);
 }
 
 void iochannel::inject(const char* str, bool recursive)
 {
+    Staging& s = stage();
     //If we just applied attributes, push them now.
     if(!recursive && apply_attributes())
     {
-        inject(format.c_str());
+        inject(s.format.c_str());
     }
 
     //Append to the message.
-    msg.append(str);
+    s.msg.append(str);
 }
 
 void iochannel::inject(const void* ptr, unsigned int len, bool dump)
 {
+    Staging& s = stage();
+    const IOFormat& fmt = s.fmt;
     if(!dump)
     {
         uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
         inject(stdutils::ptrtos(address, static_cast<bool>(fmt.fmt_numeral_case)).c_str());
     }
-    else if(dump)
+    else
     {
-        unsigned int memsize = (len * 2) + 1;
-        bool bytespacing = static_cast<bool>(fmt.fmt_mem_sep & IOFormatMemSep::byte);
-        bool wordspacing = static_cast<bool>(fmt.fmt_mem_sep & IOFormatMemSep::word);
-        if(bytespacing)
+        //If we just applied attributes, push them now.
+        if(apply_attributes())
         {
-            //Add a space for each byte except the last.
-            memsize += len-1;
+            inject(s.format.c_str());
         }
-        if(wordspacing)
-        {
-            //Add a bar for each word.
-            memsize += (len / 8);
-
-            if(bytespacing)
-            {
-                memsize += (len / 8);
-            }
 
-            if(len % 8 == 0)
-            {
-                //Remove one bar.
-                memsize--;
-
-                if(bytespacing)
-                {
-                    //Remove one space.
-                    memsize--;
-                }
-            }
+        /* Dump straight onto the end of the message, a piece at a time,
+         * so a large dump is written while its part of the message is
+         * still in cache. Each piece but the last is whole words. */
+        const unsigned int CHUNK = 64 * 1024;
+        char memformat = static_cast<char>(fmt.fmt_mem_sep);
+        const char* bytes = static_cast<const char*>(ptr);
+        s.msg.reserve(s.msg.size() + stdutils::memdump_length(len, memformat));
+        for(unsigned int from = 0; from < len; from += CHUNK)
+        {
+            unsigned int n = std::min(CHUNK, len - from);
+            bool last = (from + n == len);
+            size_t at = s.msg.size();
+            s.msg.resize(at + stdutils::memdump_length(n, memformat, last));
+            stdutils::write_memdump(&s.msg[at], bytes + from, n, false, memformat, last);
         }
-
-        /*char mem[memsize];
-        mem[0] = '\0';*/
-        // Accepting defeat on VLAs - we'll just have to dynamically allocate.
-        char* mem = new char[memsize];
-        std::fill_n(mem, memsize, '\0');
-
-        stdutils::memdump(mem, ptr, len, false, static_cast<int>(fmt.fmt_mem_sep));
-        inject(mem);
     }
 }
 
 void iochannel::shutup(IOCat cat)
 {
+    std::lock_guard<std::mutex> guard(settings_lock);
     process_cat = process_cat & ~cat;
     if(process_cat == IOCat::none)
     {
         printf("WARNING: All message categories have been turned off!\n");
     }
-    //Revalidate parsing.
-    parse = maybe;
+    update_allowed();
 }
 
 void iochannel::shutup(IOVrb vrb)
 {
+    std::lock_guard<std::mutex> guard(settings_lock);
     //Set the processing verbosity.
     process_vrb = vrb;
-    //Revalidate parsing.
-    parse = maybe;
+    update_allowed();
 }
 
 void iochannel::speakup()
 {
+    std::lock_guard<std::mutex> guard(settings_lock);
     process_vrb = IOVrb::tmi;
     process_cat = IOCat::all;
-    //Revalidate parsing.
-    parse = maybe;
+    update_allowed();
 }
 
 void iochannel::speakup(IOCat cat)
 {
+    std::lock_guard<std::mutex> guard(settings_lock);
     //Allow the category through by turning on its bit.
     process_cat = process_cat | cat;
-    //Revalidate parsing.
-    parse = maybe;
+    update_allowed();
 }
 
 void iochannel::speakup(IOVrb vrb)
 {
-    //Allow verbosity through by turning on its bit.
+    std::lock_guard<std::mutex> guard(settings_lock);
+    //Allow verbosity through, if it wasn't already.
     if(process_vrb < vrb)
     {
         process_vrb = vrb;
     }
-    //Revalidate parsing.
-    parse = maybe;
+    update_allowed();
+}
+
+namespace
+{
+    /// \return the index of a single category bit, from 0 for normal
+    int category_index(IOCat cat)
+    {
+        int index = 0;
+        for(int c = static_cast<int>(cat); c > 1; c >>= 1)
+        {
+            ++index;
+        }
+        return index;
+    }
+
+    /// \return the lowercase name of a single category
+    const char* category_name(IOCat cat)
+    {
+        switch(cat)
+        {
+            case IOCat::warning: return "warning";
+            case IOCat::error: return "error";
+            case IOCat::debug: return "debug";
+            case IOCat::testing: return "testing";
+            default: return "normal";
+        }
+    }
+}
+
+void iochannel::configure_limit(IOCat cat, double per_second, double burst,
+                                unsigned int sample)
+{
+    std::lock_guard<std::mutex> guard(settings_lock);
+    uint8_t active = limited.load(std::memory_order_relaxed);
+    for(int c = 1; c <= static_cast<int>(IOCat::testing); c <<= 1)
+    {
+        if(!(static_cast<int>(cat) & c)){continue;}
+        IORateLimit& limit = limits[category_index(static_cast<IOCat>(c))];
+        limit.configure(per_second, burst, sample);
+        if(limit.active()){active |= c;}
+        else{active &= ~c;}
+    }
+    limited.store(active, std::memory_order_relaxed);
+}
+
+size_t iochannel::suppressed(IOCat cat) const
+{
+    return limits[category_index(cat)].suppressed();
+}
+
+bool iochannel::admit_limited(IOVrb vrb, IOCat cat, IORateLimit* line)
+{
+    bool by_category = limited.load(std::memory_order_relaxed) & static_cast<uint8_t>(cat);
+    IORateLimit& limit = limits[category_index(cat)];
+    if((line != nullptr && !line->admit()) || (by_category && !limit.admit()))
+    {
+        return false;
+    }
+
+    // Own up to what was turned away before this message goes out.
+    size_t line_count = (line != nullptr) ? line->take_suppressed() : 0;
+    size_t cat_count = by_category ? limit.take_suppressed() : 0;
+    if(line_count == 0 && cat_count == 0){return true;}
+
+    std::string summary;
+    if(line_count > 0)
+    {
+        summary = "[Suppressed " + std::to_string(line_count) + " similar messages.]\n";
+    }
+    if(cat_count > 0)
+    {
+        summary += "[Suppressed " + std::to_string(cat_count) + " "
+                   + category_name(cat) + " messages.]\n";
+    }
+    publish(summary, vrb, cat);
+    return true;
+}
+
+void iochannel::update_allowed()
+{
+    uint32_t bits = 0;
+    for(int v = 0; v <= static_cast<int>(IOVrb::tmi); ++v)
+    {
+        IOVrb vrb = static_cast<IOVrb>(v);
+        if(vrb > process_vrb){break;}
+        for(int c = 1; c <= static_cast<int>(IOCat::testing); c <<= 1)
+        {
+            IOCat cat = static_cast<IOCat>(c);
+            if(static_cast<bool>(process_cat & cat) && compiled_in(vrb, cat))
+            {
+                bits |= allowed_bit(vrb, cat);
+            }
+        }
+    }
+    allowed.store(bits, std::memory_order_relaxed);
 }
 
 void iochannel::reset_attributes()
 {
-    if(fmt.fmt_text_attr != IOFormatTextAttr::none
-        || fmt.fmt_text_fg != IOFormatTextFG::none
-        || fmt.fmt_text_bg != IOFormatTextBG::none)
+    Staging& s = stage();
+    if(s.fmt.fmt_text_attr != IOFormatTextAttr::none
+        || s.fmt.fmt_text_fg != IOFormatTextFG::none
+        || s.fmt.fmt_text_bg != IOFormatTextBG::none)
     {
-        fmt << IOFormatTextAttr::none;
-        fmt << IOFormatTextFG::none;
-        fmt << IOFormatTextBG::none;
-        dirty_attributes = true;
+        s.fmt << IOFormatTextAttr::none;
+        s.fmt << IOFormatTextFG::none;
+        s.fmt << IOFormatTextBG::none;
+        s.dirty_attributes = true;
         /* We must leave calling `apply_attributes()` to `inject()`,
             * otherwise the reset attributes will never get injected
             * into the broadcast stream.
@@ -649,146 +963,442 @@ void iochannel::reset_attributes()
 
 void iochannel::reset_flags()
 {
+    Staging& s = stage();
     //Reset all the flags.
-    fmt = IOFormat();
-    readsize = IOMemReadSize(1);
+    s.fmt = IOFormat();
+    s.readsize = IOMemReadSize(1);
 
     //We reset the verbosity and category.
-    vrb = IOVrb::normal;
-    cat = IOCat::normal;
+    s.vrb = IOVrb::normal;
+    s.cat = IOCat::normal;
+}
+
+void iochannel::dispatch(std::string_view msg, IOVrb vrb, IOCat cat)
+{
+    /* Every signal gets a view of the same message. A signal with nothing
+     * connected is skipped, which leaves a channel with no outputs doing
+     * no more than these checks. */
+    switch(vrb)
+    {
+        case IOVrb::quiet:
+        {
+            // Dispatch the "quiet" verbosity signal.
+            if(!signal_v_quiet.empty()){signal_v_quiet(msg, cat);}
+            /* Fall through, so the lower signals get emitted to.
+                * This allows outputs to connect to the HIGHEST
+                * verbosity they will allow, and get the rest regardless.
+                */
+            [[fallthrough]];
+        }
+        case IOVrb::normal:
+        {
+            // Dispatch the "normal" verbosity signal.
+            if(!signal_v_normal.empty()){signal_v_normal(msg, cat);}
+            [[fallthrough]];
+        }
+        case IOVrb::chatty:
+        {
+            // Dispatch the "chatty" verbosity signal.
+            if(!signal_v_chatty.empty()){signal_v_chatty(msg, cat);}
+            [[fallthrough]];
+        }
+        case IOVrb::tmi:
+        {
+            // Dispatch the "TMI" verbosity signal.
+            if(!signal_v_tmi.empty()){signal_v_tmi(msg, cat);}
+            break;
+        }
+    }
+
+    if(static_cast<bool>(cat & IOCat::normal) && !signal_c_normal.empty())
+    {
+        // Dispatch the "normal" category signal.
+        signal_c_normal(msg, vrb);
+    }
+    if(static_cast<bool>(cat & IOCat::debug) && !signal_c_debug.empty())
+    {
+        // Dispatch the "debug" category signal.
+        signal_c_debug(msg, vrb);
+    }
+    if(static_cast<bool>(cat & IOCat::warning) && !signal_c_warning.empty())
+    {
+        // Dispatch the "warning" category signal.
+        signal_c_warning(msg, vrb);
+    }
+    if(static_cast<bool>(cat & IOCat::error) && !signal_c_error.empty())
+    {
+        // Dispatch the "error" category signal.
+        signal_c_error(msg, vrb);
+    }
+    if(static_cast<bool>(cat & IOCat::testing) && !signal_c_testing.empty())
+    {
+        // Dispatch the "testing" category signal.
+        signal_c_testing(msg, vrb);
+    }
+
+    // Dispatch the general purpose signals.
+    if(!signal_full.empty()){signal_full(msg, vrb, cat);}
+    if(!signal_all.empty()){signal_all(msg);}
+}
+
+bool iochannel::render(std::string_view& msg, IOVrb vrb, IOCat cat,
+                       const IOFormatString* format, std::string& text)
+{
+    if(!signal_record.empty()){signal_record(msg, vrb, cat, format);}
+    if(!format){return true;}
+
+    // Skip formatting when nothing would see the text.
+    if(!echoes(vrb, cat) && signal_full.empty() && signal_all.empty()
+       && signal_v_quiet.empty() && signal_v_normal.empty()
+       && signal_v_chatty.empty() && signal_v_tmi.empty()
+       && signal_c_normal.empty() && signal_c_warning.empty()
+       && signal_c_error.empty() && signal_c_debug.empty()
+       && signal_c_testing.empty())
+    {
+        return false;
+    }
+
+    text.clear();
+    iofmt::format_packed(text, *format, msg);
+    msg = text;
+    return true;
+}
+
+bool iochannel::echoes(IOVrb vrb, IOCat cat) const
+{
+    return echo_mode.load(std::memory_order_relaxed) != IOEchoMode::none
+        && vrb <= echo_vrb.load(std::memory_order_relaxed)
+        && static_cast<bool>(cat & echo_cat.load(std::memory_order_relaxed));
 }
 
 void iochannel::transmit(bool keep)
 {
-    if(msg != "")
+    Staging& s = stage();
+    bool admitted = s.admitted;
+    s.admitted = false;
+    if(!s.msg.empty())
     {
-        switch(vrb)
+        // IOC() has already asked admit(), and so skipped building it if not.
+        if(admitted || !(limited.load(std::memory_order_relaxed) & static_cast<uint8_t>(s.cat))
+           || admit_limited(s.vrb, s.cat, nullptr))
         {
-            case IOVrb::quiet:
-            {
-                // Dispatch the "quiet" verbosity signal.
-                signal_v_quiet(msg, cat);
-                /* Fall through, so the lower signals get emitted to.
-                    * This allows outputs to connect to the HIGHEST
-                    * verbosity they will allow, and get the rest regardless.
-                    */
-                [[fallthrough]];
-            }
-            case IOVrb::normal:
+            publish(s.msg, s.vrb, s.cat);
+        }
+
+        /* If we aren't flagged to keep formatting,
+            * reset the system in prep for the next message. */
+        if(!keep)
+        {
+            reset_flags();
+        }
+
+        // Clear the message out in preparation for the next.
+        clear_msg();
+
+    }
+}
+
+namespace
+{
+    // The channel the calling thread is broadcasting a message on, if any.
+    thread_local const iochannel* broadcasting = nullptr;
+}
+
+template <typename Echo>
+void iochannel::broadcast(std::string& msg, IOVrb vrb, IOCat cat,
+                          const IOFormatString* format, std::string& text,
+                          Echo echo)
+{
+    // Anything the callbacks send to this channel waits in `reentered`.
+    struct Mark
+    {
+        const iochannel* outer;
+        explicit Mark(const iochannel* channel)
+        : outer(broadcasting)
+        {
+            broadcasting = channel;
+        }
+        ~Mark(){ broadcasting = outer; }
+    } mark(this);
+
+    std::string_view view = msg;
+    if(render(view, vrb, cat, format, text))
+    {
+        dispatch(view, vrb, cat);
+        if(echoes(vrb, cat)){ echo(view, cat); }
+    }
+
+    // Callbacks for these may send still more, which go on the end.
+    for(size_t i = 0; i < reentered.size(); ++i)
+    {
+        IORecord record = std::move(reentered[i]);
+        view = record.msg;
+        if(!render(view, record.vrb, record.cat, record.format, text)){continue;}
+        dispatch(view, record.vrb, record.cat);
+        if(echoes(record.vrb, record.cat)){ echo(view, record.cat); }
+    }
+    reentered.clear();
+}
+
+void iochannel::publish(std::string& msg, IOVrb vrb, IOCat cat, const IOFormatString* format)
+{
+    /* A callback sending to its own channel would wait on itself, for the
+     * lock or for the queue to drain, so hold the message until the one
+     * being broadcast is done. */
+    if(broadcasting == this)
+    {
+        IORecord record;
+        record.msg = msg;
+        record.vrb = vrb;
+        record.cat = cat;
+        record.format = format;
+        reentered.push_back(std::move(record));
+        return;
+    }
+
+    /* Count ourselves before looking, so that configure_sync() either
+     * hides the queue from us or waits for us to finish with it. */
+    senders.fetch_add(1);
+    IORecordQueue* waiting = queue.load();
+    if(waiting)
+    {
+        // The writer thread broadcasts it, so just hand it over.
+        IORecord record;
+        record.msg.swap(msg);
+        record.vrb = vrb;
+        record.cat = cat;
+        record.format = format;
+        enqueue(*waiting, record);
+        senders.fetch_sub(1);
+        // Keep whichever buffer came back, for the next message.
+        msg.swap(record.msg);
+        return;
+    }
+    senders.fetch_sub(1);
+
+    // Only one whole message goes out at a time.
+    std::unique_lock<std::mutex> guard(publish_lock);
+    // The channel may have gone asynchronous while we waited.
+    if(queue.load())
+    {
+        guard.unlock();
+        publish(msg, vrb, cat, format);
+        return;
+    }
+    /* Callbacks may send to this channel, which builds into the message
+     * we were given, so broadcast it from a buffer of our own. */
+    std::string sent;
+    sent.swap(msg);
+    broadcast(sent, vrb, cat, format, publish_text,
+              [this](std::string_view text, IOCat cat)
+    {
+        bool error = static_cast<bool>(cat & IOCat::error);
+        switch(echo_mode.load(std::memory_order_relaxed))
+        {
+            // If we're supposed to use `printf`...
+            case IOEchoMode::printf:
             {
-                // Dispatch the "normal" verbosity signal.
-                signal_v_normal(msg, cat);
-                [[fallthrough]];
+                /* Route errors through stderr, and everything
+                    * else through stdout. */
+                fwrite(text.data(), 1, text.size(), error ? stderr : stdout);
+                break;
             }
-            case IOVrb::chatty:
+            // If we're supposed to use `std::cout`...
+            case IOEchoMode::cout:
             {
-                // Dispatch the "chatty" verbosity signal.
-                signal_v_chatty(msg, cat);
-                [[fallthrough]];
+                /* Route errors through stderr, and everything
+                    * else through stdout. */
+                (error ? std::cerr : std::cout).write(text.data(), text.size());
+                break;
             }
-            case IOVrb::tmi:
+            // This case is here for completeness...
+            case IOEchoMode::none:
             {
-                // Dispatch the "TMI" verbosity signal.
-                signal_v_tmi(msg, cat);
+                // ...we should never reach this point!
                 break;
             }
         }
+    });
+    // Keep the buffer, for the next message.
+    if(msg.empty()){ msg.swap(sent); }
+}
 
-        if(static_cast<bool>(cat & IOCat::normal))
-        {
-            // Dispatch the "normal" category signal.
-            signal_c_normal(msg, vrb);
-        }
-        if(static_cast<bool>(cat & IOCat::debug))
-        {
-            // Dispatch the "debug" category signal.
-            signal_c_debug(msg, vrb);
-        }
-        if(static_cast<bool>(cat & IOCat::warning))
-        {
-            // Dispatch the "warning" category signal.
-            signal_c_warning(msg, vrb);
-        }
-        if(static_cast<bool>(cat & IOCat::error))
+void iochannel::configure_async(IOBackpressure mode, size_t capacity, unsigned int rate)
+{
+    std::lock_guard<std::mutex> guard(switch_lock);
+    // Let the old writer finish before changing anything it reads.
+    stop_writer();
+
+    backpressure = mode;
+    sample_rate = (rate > 0) ? rate : 1;
+    records.reset(new IORecordQueue(capacity));
+    written.store(0);
+    stopping.store(false);
+    writer = std::thread(&iochannel::write_loop, this);
+    // Only now let senders see it, once any broadcasting directly are done.
+    std::lock_guard<std::mutex> published(publish_lock);
+    queue.store(records.get());
+}
+
+void iochannel::configure_sync()
+{
+    std::lock_guard<std::mutex> guard(switch_lock);
+    stop_writer();
+}
+
+void iochannel::stop_writer()
+{
+    if(!records) { return; }
+
+    /* Messages sent from here on are broadcast directly, but only once
+     * the queue is written out, so they stay in order. */
+    std::lock_guard<std::mutex> guard(publish_lock);
+    queue.store(nullptr);
+    // Let anyone who already has the queue finish pushing to it.
+    while(senders.load() > 0)
+    {
+        wake_writer();
+        std::this_thread::yield();
+    }
+
+    // The writer drains the queue before it stops.
+    stopping.store(true);
+    wake_writer();
+    writer.join();
+    records.reset();
+}
+
+void iochannel::drain()
+{
+    // Hold on to the queue while waiting, as publish() does.
+    senders.fetch_add(1);
+    IORecordQueue* waiting = queue.load();
+    if(waiting)
+    {
+        size_t target = waiting->pushed();
+        wake_writer();
+        std::unique_lock<std::mutex> lock(wake_lock);
+        drained.wait(lock, [&]{ return written.load() >= target; });
+    }
+    senders.fetch_sub(1);
+}
+
+void iochannel::enqueue(IORecordQueue& waiting, IORecord& record)
+{
+    if(backpressure == IOBackpressure::sample
+        && waiting.size() * 4 >= waiting.capacity() * 3
+        && sample_count.fetch_add(1, std::memory_order_relaxed) % sample_rate != 0)
+    {
+        dropped_count.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    while(!waiting.try_push(record))
+    {
+        if(backpressure != IOBackpressure::block)
         {
-            // Dispatch the "error" category signal.
-            signal_c_error(msg, vrb);
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return;
         }
-        if(static_cast<bool>(cat & IOCat::testing))
+        // Make sure the writer is emptying the queue, and give it a turn.
+        wake_writer();
+        std::this_thread::yield();
+    }
+    wake_writer();
+}
+
+void iochannel::wake_writer()
+{
+    /* The writer raises this flag before its last look at the queue, so
+     * either it sees what we just pushed, or we see it is sleeping. */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(sleeping.load())
+    {
+        std::lock_guard<std::mutex> guard(wake_lock);
+        wake.notify_one();
+    }
+}
+
+void iochannel::write_loop()
+{
+    // Pop at most this many messages before writing them out.
+    const size_t BATCH = 256;
+
+    /* Look this many times before going to sleep on an empty queue.
+     * Waking a sleeping writer costs the sender a system call, so it
+     * pays to stay up through short gaps between messages. */
+    const unsigned int PATIENCE = 2000;
+
+    IORecord record;
+    std::string out;
+    std::string err;
+    // Messages from log() in deferred mode are formatted into this.
+    std::string text;
+    unsigned int idle = 0;
+    while(true)
+    {
+        size_t count = 0;
+        while(count < BATCH && records->try_pop(record))
         {
-            // Dispatch the "testing" category signal.
-            signal_c_testing(msg, vrb);
+            ++count;
+            broadcast(record.msg, record.vrb, record.cat, record.format, text,
+                      [&out, &err](std::string_view msg, IOCat cat)
+            {
+                (static_cast<bool>(cat & IOCat::error) ? err : out).append(msg);
+            });
         }
 
-        // Dispatch the general purpose signals.
-        signal_full(msg, vrb, cat);
-        signal_all(msg);
-
-        //If we are supposed to be echoing
-        if(echo_mode != IOEchoMode::none)
+        // Write the whole batch out at once for each stream.
+        if(!out.empty() || !err.empty())
         {
-            //If the verbosity and category is correct...
-            if(vrb <= echo_vrb && static_cast<bool>(cat | echo_cat))
+            if(echo_mode == IOEchoMode::printf)
+            {
+                fwrite(err.data(), 1, err.size(), stderr);
+                fwrite(out.data(), 1, out.size(), stdout);
+                fflush(stdout);
+            }
+            else
             {
-                switch(echo_mode)
-                {
-                    // If we're supposed to use `printf`...
-                    case IOEchoMode::printf:
-                    {
-                        if(static_cast<bool>(cat & IOCat::error))
-                        {
-                            /* Route the message through stderr
-                                * instead of stdout.*/
-                            fprintf(stderr, "%s", msg.c_str());
-                        }
-                        else
-                        {
-                            /* Route the message through stdout. */
-                            printf("%s", msg.c_str());
-                        }
-                        break;
-                    }
-                    // If we're supposed to use `std::cout`...
-                    case IOEchoMode::cout:
-                    {
-                        if(static_cast<bool>(cat & IOCat::error))
-                        {
-                            /* Route the message through stderr
-                                * instead of stdout.*/
-                            std::cerr << msg.c_str();
-                        }
-                        else
-                        {
-                            /* Route the message through stdout. */
-                            std::cout << msg.c_str();
-                        }
-
-                        break;
-                    }
-                    // This case is here for completeness...
-                    case IOEchoMode::none:
-                    {
-                        // ...we should never reach this point!
-                        break;
-                    }
-                }
+                std::cerr.write(err.data(), err.size());
+                std::cout.write(out.data(), out.size());
+                std::cout.flush();
             }
+            out.clear();
+            err.clear();
         }
 
-        /* If we aren't flagged to keep formatting,
-            * reset the system in prep for the next message. */
-        if(!keep)
+        if(count > 0)
         {
-            reset_flags();
+            written.store(records->popped());
+            std::lock_guard<std::mutex> guard(wake_lock);
+            drained.notify_all();
+            idle = 0;
+            continue;
         }
 
-        // Clear the message out in preparation for the next.
-        clear_msg();
+        if(++idle < PATIENCE && !stopping.load())
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        idle = 0;
 
+        // The queue is empty. Stop if asked to, or else wait for more.
+        std::unique_lock<std::mutex> lock(wake_lock);
+        sleeping.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(records->size() == 0)
+        {
+            if(stopping.load()) { break; }
+            wake.wait(lock, [&]{ return records->size() > 0 || stopping.load(); });
+        }
+        sleeping.store(false);
     }
+    sleeping.store(false);
 }
 
 iochannel::~iochannel()
 {
-    //Destructor
+    //Write out anything still queued.
+    configure_sync();
 }
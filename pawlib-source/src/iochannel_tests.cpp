@@ -0,0 +1,33 @@
+#include "pawlib/iochannel_tests.hpp"
+
+void TestSuite_IOChannel::load_tests()
+{
+    register_test("P-tB2001", new TestIOChannel_Signals());
+    register_test("P-tB2002", new TestIOChannel_Async());
+    register_test("P-tB2003", new TestIOChannel_Backpressure());
+    register_test("P-tB2004", new TestIOChannel_SendAsync(), true, new TestIOChannel_SendSync());
+    register_test("P-tB2005", new TestIOChannel_SharedMessage());
+    register_test("P-tB2006", new TestIOChannel_Threads());
+    register_test("P-tB2007", new TestIOChannel_Numbers());
+    register_test("P-tB2008", new TestIOChannel_Telemetry(), true, new TestIOChannel_TelemetrySnprintf());
+    register_test("P-tB2009", new TestIOChannel_Log());
+    register_test("P-tB2010", new TestIOChannel_LogDeferred());
+    register_test("P-tB2011", new TestIOChannel_LogLine(), true, new TestIOChannel_StreamLine());
+    register_test("P-tB2012", new TestIOChannel_Elision());
+    register_test("P-tB2013", new TestIOChannel_SilencedIOC(), true, new TestIOChannel_SilencedStream());
+    register_test("P-tB2014", new TestIOChannel_FileSink());
+    register_test("P-tB2015", new TestIOChannel_BlockSink());
+    register_test("P-tB2016", new TestIOChannel_RingSink());
+    register_test("P-tB2017", new TestIOChannel_FileSinkWrites(), true, new TestIOChannel_LineWrites());
+    register_test("P-tB2018", new TestIOChannel_BinaryLog());
+    register_test("P-tB2019", new TestIOChannel_BinaryLogWrites(), true, new TestIOChannel_TextLog());
+    register_test("P-tB2020", new TestIOChannel_CategoryLimit());
+    register_test("P-tB2021", new TestIOChannel_LineLimit());
+    register_test("P-tB2022", new TestIOChannel_Sampling());
+    register_test("P-tB2023", new TestIOChannel_LimitedFlood(), true, new TestIOChannel_UnlimitedFlood());
+    register_test("P-tB2024", new TestIOChannel_MemoryDump());
+    register_test("P-tB2025", new TestIOChannel_HexDump(), true, new TestIOChannel_HexSnprintf());
+    register_test("P-tB2026", new TestIOChannel_ThreadExit());
+    register_test("P-tB2027", new TestIOChannel_SwitchModes());
+    register_test("P-tB2028", new TestIOChannel_Reentry());
+}
@@ -0,0 +1,146 @@
+#include "pawlib/iofmt.hpp"
+#include "pawlib/stdutils.hpp"
+
+namespace
+{
+    int base_of(char spec)
+    {
+        switch (spec)
+        {
+            case 'x':
+            case 'X':
+                return 16;
+            case 'o':
+                return 8;
+            case 'b':
+                return 2;
+            default:
+                return 10;
+        }
+    }
+
+    template <typename T>
+    void write_int(std::string& out, T val, char spec)
+    {
+        size_t at = out.size();
+        out.resize(at + stdutils::INT_CHARS);
+        int len = stdutils::write_int(&out[at], val, base_of(spec), spec == 'X');
+        out.resize(at + static_cast<size_t>(len));
+    }
+
+    /// Reads a packed value, moving past it, or returns false if it's cut short.
+    template <typename T>
+    bool unpack(std::string_view& record, T& val)
+    {
+        if (record.size() < sizeof(T)) { return false; }
+        memcpy(&val, record.data(), sizeof(T));
+        record.remove_prefix(sizeof(T));
+        return true;
+    }
+}
+
+void iofmt::append_int(std::string& out, long long val, const IOFormatPiece& piece)
+{
+    write_int(out, val, piece.spec);
+}
+
+void iofmt::append_int(std::string& out, unsigned long long val, const IOFormatPiece& piece)
+{
+    write_int(out, val, piece.spec);
+}
+
+template <typename T>
+void iofmt::append_float(std::string& out, T val, const IOFormatPiece& piece)
+{
+    int significands = (piece.precision >= 0) ? piece.precision : 14;
+    int sci = (piece.spec == 'e') ? 2 : 1;
+
+    size_t at = out.size();
+    size_t room = 64;
+    size_t len;
+    while (true)
+    {
+        out.resize(at + room);
+        len = stdutils::write_float(&out[at], room, val, significands, sci);
+        if (len <= room) { break; }
+        room = len;
+    }
+    out.resize(at + len);
+}
+
+template void iofmt::append_float<float>(std::string&, float, const IOFormatPiece&);
+template void iofmt::append_float<double>(std::string&, double, const IOFormatPiece&);
+template void iofmt::append_float<long double>(std::string&, long double, const IOFormatPiece&);
+
+bool iofmt::format_packed(std::string& out, const IOFormatString& fmt, std::string_view record)
+{
+    size_t at = 0;
+    while (true)
+    {
+        at = text_until_arg(out, fmt, at);
+        if (at == fmt.count) { break; }
+        const IOFormatPiece& piece = fmt.pieces[at++];
+
+        if (record.empty()) { return false; }
+        IOArgType kind = static_cast<IOArgType>(record[0]);
+        record.remove_prefix(1);
+        switch (kind)
+        {
+            case IOArgType::sint:
+            {
+                long long val;
+                if (!unpack(record, val)) { return false; }
+                append_int(out, val, piece);
+                break;
+            }
+            case IOArgType::uint:
+            {
+                unsigned long long val;
+                if (!unpack(record, val)) { return false; }
+                append_int(out, val, piece);
+                break;
+            }
+            case IOArgType::f32:
+            {
+                float val;
+                if (!unpack(record, val)) { return false; }
+                append_float(out, val, piece);
+                break;
+            }
+            case IOArgType::f64:
+            {
+                double val;
+                if (!unpack(record, val)) { return false; }
+                append_float(out, val, piece);
+                break;
+            }
+            case IOArgType::f80:
+            {
+                long double val;
+                if (!unpack(record, val)) { return false; }
+                append_float(out, val, piece);
+                break;
+            }
+            case IOArgType::text:
+            {
+                size_t len;
+                if (!unpack(record, len) || record.size() < len) { return false; }
+                out.append(record.data(), len);
+                record.remove_prefix(len);
+                break;
+            }
+            case IOArgType::boolean:
+            case IOArgType::character:
+            {
+                char val;
+                if (!unpack(record, val)) { return false; }
+                if (kind == IOArgType::boolean) { out.append(val ? "true" : "false"); }
+                else { out.push_back(val); }
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return record.empty();
+}
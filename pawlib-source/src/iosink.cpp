@@ -0,0 +1,380 @@
+#include "pawlib/iosink.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+IOSink::~IOSink()
+{
+    detach();
+}
+
+void IOSink::attach(iochannel& ioc, IOVrb vrb, IOCat cat)
+{
+    detach();
+    channel = &ioc;
+    hook(ioc, vrb, cat);
+}
+
+void IOSink::hook(iochannel& ioc, IOVrb vrb, IOCat cat)
+{
+    handle = ioc.signal_full.append(
+        [this, vrb, cat](std::string_view msg, IOVrb msg_vrb, IOCat msg_cat)
+        {
+            if(msg_vrb > vrb || !static_cast<bool>(msg_cat & cat)){return;}
+            write(msg);
+        });
+}
+
+void IOSink::unhook(iochannel& ioc)
+{
+    ioc.signal_full.remove(handle);
+}
+
+void IOSink::detach()
+{
+    if(channel == nullptr){return;}
+    unhook(*channel);
+    channel->drain();
+    channel = nullptr;
+    // Wait out a message that was being written as the callback came off.
+    std::lock_guard<std::mutex> guard(lock);
+}
+
+bool IOSink::write_all(int fd, const char* data, size_t len, int64_t at)
+{
+    while(len > 0)
+    {
+        ssize_t done = (at < 0) ? ::write(fd, data, len)
+                                : ::pwrite(fd, data, len, static_cast<off_t>(at));
+        if(done < 0)
+        {
+            if(errno == EINTR){continue;}
+            return false;
+        }
+        data += done;
+        len -= static_cast<size_t>(done);
+        if(at >= 0){at += done;}
+    }
+    return true;
+}
+
+IOFileSink::IOFileSink(const std::string& path, size_t buffer)
+: path(path), capacity(buffer)
+{
+    if(!open(false))
+    {
+        throw std::runtime_error("IOFileSink: Cannot open " + path + ": "
+                                 + strerror(errno));
+    }
+    pending.reserve(capacity);
+}
+
+IOFileSink::~IOFileSink()
+{
+    detach();
+    sync();
+    if(fd >= 0){::close(fd);}
+}
+
+bool IOFileSink::open(bool truncate)
+{
+    int flags = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+    fd = ::open(path.c_str(), flags, 0644);
+    if(fd < 0){return false;}
+
+    struct stat info;
+    file_bytes = (fstat(fd, &info) == 0) ? static_cast<size_t>(info.st_size) : 0;
+    opened = std::chrono::steady_clock::now();
+    return true;
+}
+
+void IOFileSink::configure_rotation(size_t bytes,
+                                    std::chrono::steady_clock::duration age,
+                                    unsigned int old_files)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    max_bytes = bytes;
+    max_age = age;
+    keep = old_files;
+}
+
+void IOFileSink::rotate()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    roll();
+}
+
+void IOFileSink::roll()
+{
+    sync();
+    if(fd >= 0){::close(fd);}
+
+    if(keep == 0)
+    {
+        ::unlink(path.c_str());
+    }
+    else
+    {
+        // The oldest falls off the end when the rest move over it.
+        for(unsigned int i = keep - 1; i > 0; --i)
+        {
+            std::string from = path + "." + std::to_string(i);
+            std::string to = path + "." + std::to_string(i + 1);
+            ::rename(from.c_str(), to.c_str());
+        }
+        ::rename(path.c_str(), (path + ".1").c_str());
+    }
+
+    if(!open(true)){error_count.fetch_add(1, std::memory_order_relaxed);}
+    started();
+}
+
+bool IOFileSink::due(size_t len) const
+{
+    size_t total = file_bytes + pending.size();
+    return total > 0
+        && ((max_bytes > 0 && total + len > max_bytes)
+            || (max_age.count() > 0
+                && std::chrono::steady_clock::now() - opened >= max_age));
+}
+
+void IOFileSink::store(std::string_view msg)
+{
+    if(due(msg.size())){roll();}
+    put(msg);
+}
+
+void IOFileSink::put(std::string_view msg)
+{
+    if(pending.size() + msg.size() > capacity){sync();}
+    if(msg.size() >= capacity)
+    {
+        // Too big to be worth copying; send it on its own.
+        if(fd < 0 || !write_all(fd, msg.data(), msg.size()))
+        {
+            error_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        file_bytes += msg.size();
+        return;
+    }
+    pending.append(msg.data(), msg.size());
+}
+
+void IOFileSink::sync()
+{
+    if(pending.empty()){return;}
+    if(fd < 0 || !write_all(fd, pending.data(), pending.size()))
+    {
+        error_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        file_bytes += pending.size();
+    }
+    pending.clear();
+}
+
+IOBlockSink::IOBlockSink(const std::string& path, size_t block_size, bool direct)
+: block((block_size + ALIGN - 1) / ALIGN * ALIGN)
+{
+    if(block == 0){block = ALIGN;}
+
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+#ifdef O_DIRECT
+    if(direct)
+    {
+        fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        is_direct = (fd >= 0);
+    }
+#else
+    (void)direct;
+#endif
+    // Some file systems, such as tmpfs, refuse O_DIRECT outright.
+    if(fd < 0){fd = ::open(path.c_str(), flags, 0644);}
+    if(fd < 0)
+    {
+        throw std::runtime_error("IOBlockSink: Cannot open " + path + ": "
+                                 + strerror(errno));
+    }
+
+    buffer = static_cast<char*>(std::aligned_alloc(ALIGN, block));
+    if(buffer == nullptr)
+    {
+        ::close(fd);
+        throw std::bad_alloc();
+    }
+}
+
+IOBlockSink::~IOBlockSink()
+{
+    detach();
+    sync();
+    ::close(fd);
+    std::free(buffer);
+}
+
+bool IOBlockSink::write_block(size_t len)
+{
+    if(write_all(fd, buffer, len, offset)){return true;}
+#ifdef O_DIRECT
+    // O_DIRECT can also be refused at the first write; go without it.
+    if(is_direct && errno == EINVAL)
+    {
+        is_direct = false;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+        return write_all(fd, buffer, len, offset);
+    }
+#endif
+    return false;
+}
+
+void IOBlockSink::store(std::string_view msg)
+{
+    while(!msg.empty())
+    {
+        size_t n = std::min(msg.size(), block - used);
+        memcpy(buffer + used, msg.data(), n);
+        used += n;
+        msg.remove_prefix(n);
+
+        if(used == block)
+        {
+            if(!write_block(block)){error_count.fetch_add(1, std::memory_order_relaxed);}
+            offset += static_cast<int64_t>(block);
+            used = 0;
+        }
+    }
+}
+
+void IOBlockSink::sync()
+{
+    if(used == 0){return;}
+
+    /* Write the partial block padded out to the alignment, then cut the
+     * file back to its real length. The partial block stays in the buffer,
+     * and is written over in place once it fills up. */
+    size_t padded = (used + ALIGN - 1) / ALIGN * ALIGN;
+    memset(buffer + used, 0, padded - used);
+    if(!write_block(padded)
+       || ftruncate(fd, static_cast<off_t>(offset + static_cast<int64_t>(used))) != 0)
+    {
+        error_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+IORingSink::IORingSink(const std::string& path, size_t size)
+: capacity(size)
+{
+    if(capacity == 0)
+    {
+        throw std::invalid_argument("IORingSink: Capacity must be more than 0.");
+    }
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if(fd < 0)
+    {
+        throw std::runtime_error("IORingSink: Cannot open " + path + ": "
+                                 + strerror(errno));
+    }
+
+    map_size = DATA_OFFSET + capacity;
+    struct stat info;
+    bool fresh = (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) != map_size);
+    if((fresh && ftruncate(fd, static_cast<off_t>(map_size)) != 0)
+       || (map = static_cast<char*>(mmap(nullptr, map_size, PROT_READ | PROT_WRITE,
+                                         MAP_SHARED, fd, 0))) == MAP_FAILED)
+    {
+        int err = errno;
+        ::close(fd);
+        throw std::runtime_error("IORingSink: Cannot map " + path + ": "
+                                 + strerror(err));
+    }
+
+    header = reinterpret_cast<Header*>(map);
+    ring = map + DATA_OFFSET;
+    if(fresh || memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0
+       || header->capacity != capacity)
+    {
+        header->capacity = capacity;
+        header->written = 0;
+        memcpy(header->magic, MAGIC, sizeof(MAGIC));
+    }
+}
+
+IORingSink::~IORingSink()
+{
+    detach();
+    munmap(map, map_size);
+    ::close(fd);
+}
+
+void IORingSink::store(std::string_view msg)
+{
+    // Only the end of a message larger than the whole ring can be kept.
+    if(msg.size() > capacity)
+    {
+        header->written += msg.size() - capacity;
+        msg.remove_prefix(msg.size() - capacity);
+    }
+
+    size_t at = static_cast<size_t>(header->written % capacity);
+    size_t first = std::min(msg.size(), capacity - at);
+    memcpy(ring + at, msg.data(), first);
+    memcpy(ring, msg.data() + first, msg.size() - first);
+    header->written += msg.size();
+}
+
+void IORingSink::sync()
+{
+    if(msync(map, map_size, MS_SYNC) != 0)
+    {
+        error_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::string IORingSink::recover(const std::string& path)
+{
+    std::string out;
+    FILE* file = fopen(path.c_str(), "rb");
+    if(file == nullptr){return out;}
+
+    Header head;
+    if(fread(&head, sizeof(head), 1, file) != 1
+       || memcmp(head.magic, MAGIC, sizeof(MAGIC)) != 0 || head.capacity == 0
+       || fseek(file, DATA_OFFSET, SEEK_SET) != 0)
+    {
+        fclose(file);
+        return out;
+    }
+
+    std::string data(static_cast<size_t>(head.capacity), '\0');
+    size_t got = fread(&data[0], 1, data.size(), file);
+    fclose(file);
+    if(got != data.size()){return out;}
+
+    if(head.written <= head.capacity)
+    {
+        out.assign(data, 0, static_cast<size_t>(head.written));
+        return out;
+    }
+
+    size_t at = static_cast<size_t>(head.written % head.capacity);
+    out.reserve(data.size());
+    out.append(data, at, std::string::npos);
+    out.append(data, 0, at);
+
+    // The oldest line was partly written over.
+    size_t cut = out.find('\n');
+    out.erase(0, (cut == std::string::npos) ? 0 : cut + 1);
+    return out;
+}
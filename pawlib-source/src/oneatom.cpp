@@ -0,0 +1,168 @@
+#include "pawlib/oneatom.hpp"
+
+#include <new>
+
+oneatom::oneatom(const onestring_view& text)
+: entry(onestring_interner::global().intern(text).entry)
+{}
+
+size_t onestring_interner::hash(const onestring_view& text)
+{
+    return text.hash();
+}
+
+size_t onestring_interner::probe(const Shard& shard, size_t hash, const onestring_view& text)
+{
+    size_t mask = shard.slots.size() - 1;
+    size_t i = hash & mask;
+    while (shard.slots[i] != nullptr)
+    {
+        const oneatom::Entry* entry = shard.slots[i];
+        if (entry->hash == hash && entry->bytes == text.size()
+            && memcmp(entry->text(), text.data(), text.size()) == 0)
+        {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+const oneatom::Entry* onestring_interner::store(Shard& shard, size_t hash, const onestring_view& text)
+{
+    // Keep every entry aligned for the header that starts it.
+    size_t align = alignof(oneatom::Entry);
+    size_t need = sizeof(oneatom::Entry) + text.size() + 1;
+    need = (need + align - 1) / align * align;
+
+    char* at;
+    if (need > BLOCK_SIZE / 4)
+    {
+        // Long strings get a block of their own, leaving the current one be.
+        shard.blocks.emplace_back(new char[need]);
+        shard.allocated += need;
+        at = shard.blocks.back().get();
+    }
+    else
+    {
+        if (need > shard.left)
+        {
+            shard.blocks.emplace_back(new char[BLOCK_SIZE]);
+            shard.allocated += BLOCK_SIZE;
+            shard.next = shard.blocks.back().get();
+            shard.left = BLOCK_SIZE;
+        }
+        at = shard.next;
+        shard.next += need;
+        shard.left -= need;
+    }
+
+    oneatom::Entry* entry = new (at) oneatom::Entry;
+    entry->hash = hash;
+    entry->bytes = text.size();
+    entry->chars = text.length();
+    char* copy = at + sizeof(oneatom::Entry);
+    memcpy(copy, text.data(), text.size());
+    copy[text.size()] = '\0';
+    return entry;
+}
+
+void onestring_interner::grow(Shard& shard)
+{
+    std::vector<const oneatom::Entry*> old = std::move(shard.slots);
+    shard.slots.assign(old.size() * 2, nullptr);
+
+    size_t mask = shard.slots.size() - 1;
+    for (const oneatom::Entry* entry : old)
+    {
+        if (entry == nullptr) { continue; }
+        size_t i = entry->hash & mask;
+        while (shard.slots[i] != nullptr)
+        {
+            i = (i + 1) & mask;
+        }
+        shard.slots[i] = entry;
+    }
+}
+
+oneatom onestring_interner::intern(const onestring_view& text)
+{
+    if (text.empty()) { return oneatom(); }
+
+    size_t h = hash(text);
+    Shard& s = shard(h);
+    std::lock_guard<std::mutex> guard(s.lock);
+
+    if (s.slots.empty())
+    {
+        s.slots.resize(BASE_SLOTS, nullptr);
+    }
+
+    size_t i = probe(s, h, text);
+    if (s.slots[i] != nullptr)
+    {
+        return oneatom(s.slots[i]);
+    }
+
+    // Keep the index at most three-quarters full.
+    if ((s.count + 1) * 4 > s.slots.size() * 3)
+    {
+        grow(s);
+        i = probe(s, h, text);
+    }
+
+    s.slots[i] = store(s, h, text);
+    ++s.count;
+    return oneatom(s.slots[i]);
+}
+
+bool onestring_interner::lookup(const onestring_view& text, oneatom& atom)
+{
+    if (text.empty())
+    {
+        atom = oneatom();
+        return true;
+    }
+
+    size_t h = hash(text);
+    Shard& s = shard(h);
+    std::lock_guard<std::mutex> guard(s.lock);
+
+    if (s.slots.empty()) { return false; }
+
+    size_t i = probe(s, h, text);
+    if (s.slots[i] == nullptr) { return false; }
+
+    atom = oneatom(s.slots[i]);
+    return true;
+}
+
+size_t onestring_interner::size()
+{
+    size_t total = 0;
+    for (Shard& s : shards)
+    {
+        std::lock_guard<std::mutex> guard(s.lock);
+        total += s.count;
+    }
+    return total;
+}
+
+size_t onestring_interner::allocated()
+{
+    size_t total = 0;
+    for (Shard& s : shards)
+    {
+        std::lock_guard<std::mutex> guard(s.lock);
+        total += s.allocated;
+    }
+    return total;
+}
+
+onestring_interner& onestring_interner::global()
+{
+    /* This is never freed, so that atoms stay good even in the
+     * destructors of other statics. */
+    static onestring_interner* table = new onestring_interner();
+    return *table;
+}
@@ -0,0 +1,9 @@
+#include "pawlib/oneatom_tests.hpp"
+
+void TestSuite_Oneatom::load_tests()
+{
+    register_test("P-tB4401", new TestOneatom_Intern());
+    register_test("P-tB4402", new TestOneatom_Table());
+    register_test("P-tB4403", new TestOneatom_Threads());
+    register_test("P-tB4404", new TestOneatom_MapLookup(), true, new TestStdString_MapLookup());
+}
@@ -35,7 +35,7 @@ onechar::onechar(const onechar& cpy)
 }
 
 onechar::onechar(onechar&& mov)
-: size(mov.size)
+: size(mov.size), internal{'\0', '\0', '\0', '\0', '\0'}
 {
     // Directly copy the contents of the internal array
     // TODO: Is there a way just to steal the pointer?
@@ -48,6 +48,7 @@ onechar& onechar::operator=(const onechar& cpy)
     {
         this->size = cpy.size;
         memcpy(this->internal, cpy.internal, cpy.size);
+        this->internal[this->size] = '\0';
     }
     return *this;
 }
@@ -58,7 +59,7 @@ onechar& onechar::operator=(onechar&& mov)
     {
         this->size = mov.size;
         memcpy(this->internal, mov.internal, mov.size);
-
+        this->internal[this->size] = '\0';
     }
     return *this;
 }
@@ -69,6 +70,7 @@ void onechar::parse(const char ch)
     this->size = 1;
     // Store the character
     this->internal[0] = ch;
+    this->internal[1] = '\0';
 }
 
 void onechar::parse(const char* cstr)
@@ -76,8 +78,11 @@ void onechar::parse(const char* cstr)
     /* Determine the bytesize of the Unicode character
         * at the start of the c-string */
     this->size = evaluateLength(cstr);
+    // A malformed lead byte must not carry us past the terminator.
+    this->size = strnlen(cstr + 1, this->size - 1) + 1;
     // Store the character via direct copy to internal array
     memcpy(this->internal, cstr, sizeof(char) * this->size);
+    this->internal[this->size] = '\0';
 }
 
 void onechar::parse(const std::string& str)
@@ -91,8 +96,11 @@ size_t onechar::parseFromString(const char* cstr, size_t index)
     /* Determine the bytesize of the Unicode character
         * at the target location in the c-string */
     this->size = evaluateLength(cstr + index);
+    // A malformed lead byte must not carry us past the terminator.
+    this->size = strnlen(cstr + index + 1, this->size - 1) + 1;
     // Store the character via direct copy to internal array
     memcpy(this->internal, cstr + index, sizeof(char) * this->size);
+    this->internal[this->size] = '\0';
     // Return the number of characters we parsed in the c-string
     return this->size;
 }
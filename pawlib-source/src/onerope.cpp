@@ -0,0 +1,314 @@
+#include "pawlib/onerope.hpp"
+#include "pawlib/utf8.hpp"
+
+onerope::node_t onerope::leaf(std::string text, size_t chars)
+{
+    std::shared_ptr<Node> made = std::make_shared<Node>();
+    made->bytes = text.size();
+    made->chars = chars;
+    made->height = 1;
+    made->text = std::move(text);
+    return made;
+}
+
+onerope::node_t onerope::node(node_t left, node_t right)
+{
+    std::shared_ptr<Node> made = std::make_shared<Node>();
+    made->bytes = left->bytes + right->bytes;
+    made->chars = left->chars + right->chars;
+    made->height = std::max(left->height, right->height) + 1;
+    made->left = std::move(left);
+    made->right = std::move(right);
+    return made;
+}
+
+onerope::node_t onerope::balance(node_t left, node_t right)
+{
+    if (left->height > right->height + 1)
+    {
+        if (height(left->left) >= height(left->right))
+        {
+            return node(left->left, node(left->right, std::move(right)));
+        }
+        const node_t& mid = left->right;
+        return node(node(left->left, mid->left), node(mid->right, std::move(right)));
+    }
+    if (right->height > left->height + 1)
+    {
+        if (height(right->right) >= height(right->left))
+        {
+            return node(node(std::move(left), right->left), right->right);
+        }
+        const node_t& mid = right->left;
+        return node(node(std::move(left), mid->left), node(mid->right, right->right));
+    }
+    return node(std::move(left), std::move(right));
+}
+
+onerope::node_t onerope::join(node_t left, node_t right)
+{
+    if (!left) { return right; }
+    if (!right) { return left; }
+
+    if (left->is_leaf() && right->is_leaf())
+    {
+        if (left->bytes + right->bytes <= CHUNK_SIZE)
+        {
+            return leaf(left->text + right->text, left->chars + right->chars);
+        }
+        return node(std::move(left), std::move(right));
+    }
+
+    /* Go down the taller side until the heights meet. A lone leaf is
+     * carried all the way down to its neighbor, so that a run of small
+     * edits in one place keeps merging into the same chunk. */
+    if (left->height > right->height + 1 || right->is_leaf())
+    {
+        return balance(left->left, join(left->right, std::move(right)));
+    }
+    if (right->height > left->height + 1 || left->is_leaf())
+    {
+        return balance(join(std::move(left), right->left), right->right);
+    }
+    return node(std::move(left), std::move(right));
+}
+
+std::pair<onerope::node_t, onerope::node_t> onerope::split(const node_t& node, size_t pos)
+{
+    if (!node || pos == 0) { return {nullptr, node}; }
+    if (pos >= node->chars) { return {node, nullptr}; }
+
+    if (node->is_leaf())
+    {
+        const std::string& text = node->text;
+        size_t cut = (node->chars == node->bytes) ? pos
+                   : utf8::advance(text.data(), text.size(), pos);
+        return {leaf(text.substr(0, cut), pos),
+                leaf(text.substr(cut), node->chars - pos)};
+    }
+
+    size_t before = node->left->chars;
+    if (pos <= before)
+    {
+        std::pair<node_t, node_t> parts = split(node->left, pos);
+        return {parts.first, join(parts.second, node->right)};
+    }
+    std::pair<node_t, node_t> parts = split(node->right, pos - before);
+    return {join(node->left, parts.first), parts.second};
+}
+
+onerope::node_t onerope::build(const onestring_view& text)
+{
+    const char* data = text.data();
+    size_t bytes = text.size();
+
+    std::vector<node_t> leaves;
+    leaves.reserve(bytes / CHUNK_SIZE + 1);
+    for (size_t from = 0; from < bytes;)
+    {
+        // Cut before a lead byte, which in valid UTF-8 starts a character.
+        size_t cut = bytes - from;
+        if (cut > CHUNK_SIZE)
+        {
+            cut = CHUNK_SIZE;
+            while (cut > 1 && (data[from + cut] & 0xC0) == 0x80) { --cut; }
+        }
+
+        size_t chars = utf8::count_if_valid(data + from, cut);
+        if (chars == utf8::npos)
+        {
+            // Malformed text has to be walked the way onechar reads it.
+            cut = 0;
+            chars = 0;
+            while (from + cut < bytes)
+            {
+                size_t len = utf8::char_length(data + from + cut, bytes - from - cut);
+                if (cut + len > CHUNK_SIZE) { break; }
+                cut += len;
+                ++chars;
+            }
+        }
+
+        leaves.push_back(leaf(std::string(data + from, cut), chars));
+        from += cut;
+    }
+    return build(leaves, 0, leaves.size());
+}
+
+onerope::node_t onerope::build(const std::vector<node_t>& leaves, size_t from, size_t to)
+{
+    if (from == to) { return nullptr; }
+    if (to - from == 1) { return leaves[from]; }
+
+    size_t mid = from + (to - from) / 2;
+    return node(build(leaves, from, mid), build(leaves, mid, to));
+}
+
+void onerope::chunk_iterator::descend(const Node* node)
+{
+    while (!node->is_leaf())
+    {
+        path.push_back(node);
+        node = node->left.get();
+    }
+    current = node;
+}
+
+onerope::chunk_iterator& onerope::chunk_iterator::operator++()
+{
+    if (path.empty())
+    {
+        current = nullptr;
+        return *this;
+    }
+    const Node* parent = path.back();
+    path.pop_back();
+    descend(parent->right.get());
+    return *this;
+}
+
+onerope::chunk_iterator onerope::chunk_begin() const
+{
+    chunk_iterator it;
+    if (root)
+    {
+        it.descend(root.get());
+    }
+    return it;
+}
+
+onechar onerope::at(size_t pos) const
+{
+    if (pos >= length())
+    {
+        throw std::out_of_range("Onerope::at(): Index out of bounds.");
+    }
+
+    const Node* node = root.get();
+    while (!node->is_leaf())
+    {
+        size_t before = node->left->chars;
+        if (pos < before)
+        {
+            node = node->left.get();
+        }
+        else
+        {
+            pos -= before;
+            node = node->right.get();
+        }
+    }
+    return onestring_view(node->text.data(), node->bytes, node->chars).at(pos);
+}
+
+onerope onerope::substr(size_t pos, size_t len) const
+{
+    if (pos > length())
+    {
+        throw std::out_of_range("Onerope::substr(): specified pos out of range");
+    }
+    node_t rest = split(root, pos).second;
+    return onerope(split(rest, len).first);
+}
+
+onestring onerope::str() const
+{
+    onestring ostr;
+    ostr.reserve(length());
+    for (onestring_view chunk : chunks())
+    {
+        ostr.append(chunk);
+    }
+    return ostr;
+}
+
+bool onerope::equals(const onestring_view& other) const
+{
+    if (size() != other.size()) { return false; }
+
+    const char* data = other.data();
+    for (onestring_view chunk : chunks())
+    {
+        if (memcmp(chunk.data(), data, chunk.size()) != 0) { return false; }
+        data += chunk.size();
+    }
+    return true;
+}
+
+bool onerope::equals(const onerope& other) const
+{
+    if (root == other.root) { return true; }
+    if (size() != other.size()) { return false; }
+
+    // The two may be chunked differently, so compare the overlaps.
+    chunk_iterator lhs = chunk_begin();
+    chunk_iterator rhs = other.chunk_begin();
+    size_t lhs_at = 0;
+    size_t rhs_at = 0;
+    while (lhs != chunk_end())
+    {
+        onestring_view l = *lhs;
+        onestring_view r = *rhs;
+        size_t n = std::min(l.size() - lhs_at, r.size() - rhs_at);
+        if (memcmp(l.data() + lhs_at, r.data() + rhs_at, n) != 0) { return false; }
+
+        lhs_at += n;
+        rhs_at += n;
+        if (lhs_at == l.size()) { ++lhs; lhs_at = 0; }
+        if (rhs_at == r.size()) { ++rhs; rhs_at = 0; }
+    }
+    return true;
+}
+
+onerope& onerope::append(const onerope& other)
+{
+    root = join(root, other.root);
+    return *this;
+}
+
+onerope& onerope::erase(size_t pos, size_t len)
+{
+    if (pos > length())
+    {
+        throw std::out_of_range("Onerope::erase(): specified pos out of range");
+    }
+    std::pair<node_t, node_t> parts = split(root, pos);
+    root = join(parts.first, split(parts.second, len).second);
+    return *this;
+}
+
+onerope& onerope::insert(size_t pos, const onestring_view& text)
+{
+    if (pos > length())
+    {
+        throw std::out_of_range("Onerope::insert(): specified pos out of range");
+    }
+    if (text.empty()) { return *this; }
+
+    std::pair<node_t, node_t> parts = split(root, pos);
+    root = join(join(parts.first, build(text)), parts.second);
+    return *this;
+}
+
+onerope& onerope::insert(size_t pos, const onerope& other)
+{
+    if (pos > length())
+    {
+        throw std::out_of_range("Onerope::insert(): specified pos out of range");
+    }
+    std::pair<node_t, node_t> parts = split(root, pos);
+    root = join(join(parts.first, other.root), parts.second);
+    return *this;
+}
+
+onerope& onerope::replace(size_t pos, size_t len, const onestring_view& text)
+{
+    if (pos > length())
+    {
+        throw std::out_of_range("Onerope::replace(): specified pos out of range");
+    }
+    std::pair<node_t, node_t> parts = split(root, pos);
+    node_t after = split(parts.second, len).second;
+    root = join(join(parts.first, build(text)), after);
+    return *this;
+}
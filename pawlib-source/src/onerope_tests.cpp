@@ -0,0 +1,11 @@
+#include "pawlib/onerope_tests.hpp"
+
+void TestSuite_Onerope::load_tests()
+{
+    register_test("P-tB4301", new TestOnerope_Construct());
+    register_test("P-tB4302", new TestOnerope_At());
+    register_test("P-tB4303", new TestOnerope_Edit());
+    register_test("P-tB4304", new TestOnerope_Snapshot());
+    register_test("P-tB4305", new TestOnerope_Chunks());
+    register_test("P-tB4306", new TestOnerope_EditFront(), true, new TestOnestring_EditFront());
+}
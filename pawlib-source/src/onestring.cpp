@@ -1,61 +1,80 @@
 #include "pawlib/onestring.hpp"
 
+#include <thread>
+
 /*******************************************
 * Constructors + Destructor
 *******************************************/
 onestring::onestring()
-:_capacity(BASE_SIZE), _elements(0), internal(nullptr), _c_str(0)
+:_capacity(BASE_SIZE), _elements(0), _bytes(0), _byte_capacity(LOCAL_SIZE - 1),
+ internal(_local)
 {
     allocate(this->_capacity);
     //assign('\0');
 }
 
 onestring::onestring(char ch)
-:_capacity(BASE_SIZE), _elements(0), internal(nullptr), _c_str(0)
+:_capacity(BASE_SIZE), _elements(0), _bytes(0), _byte_capacity(LOCAL_SIZE - 1),
+ internal(_local)
 {
     allocate(this->_capacity);
     assign(ch);
 }
 
 onestring::onestring(const onechar& ochr)
-:_capacity(BASE_SIZE), _elements(0), internal(nullptr), _c_str(0)
+:_capacity(BASE_SIZE), _elements(0), _bytes(0), _byte_capacity(LOCAL_SIZE - 1),
+ internal(_local)
 {
     allocate(this->_capacity);
     assign(ochr);
 }
 
 onestring::onestring(const char* cstr)
-:_capacity(BASE_SIZE), _elements(0), internal(nullptr), _c_str(0)
+:_capacity(BASE_SIZE), _elements(0), _bytes(0), _byte_capacity(LOCAL_SIZE - 1),
+ internal(_local)
 {
     allocate(this->_capacity);
     assign(cstr);
 }
 
 onestring::onestring(const std::string& str)
-:_capacity(BASE_SIZE), _elements(0), internal(nullptr), _c_str(0)
+:_capacity(BASE_SIZE), _elements(0), _bytes(0), _byte_capacity(LOCAL_SIZE - 1),
+ internal(_local)
 {
     allocate(this->_capacity);
     append(str);
 }
 
 onestring::onestring(const onestring& ostr)
-:_capacity(BASE_SIZE), _elements(0), internal(nullptr), _c_str(0)
+:_capacity(BASE_SIZE), _elements(0), _bytes(0), _byte_capacity(LOCAL_SIZE - 1),
+ internal(_local)
 {
     allocate(this->_capacity);
     assign(ostr);
 }
 
-onestring::~onestring()
+onestring::onestring(onestring&& ostr) noexcept
+:_capacity(BASE_SIZE), _elements(0), _bytes(0), _byte_capacity(LOCAL_SIZE - 1),
+ internal(_local)
 {
-    if (_c_str != nullptr)
-    {
-        delete[] _c_str;
-    }
+    take(ostr);
+}
 
-    if (internal != nullptr)
+onestring::onestring(const onestring_view& view)
+:_capacity(BASE_SIZE), _elements(0), _bytes(0), _byte_capacity(LOCAL_SIZE - 1),
+ internal(_local)
+{
+    allocate(this->_capacity);
+    assign(view);
+}
+
+onestring::~onestring()
+{
+    if (!is_local())
     {
         delete[] internal;
     }
+    delete _extras.load(std::memory_order_relaxed);
 }
 
 /*******************************************
@@ -69,27 +88,48 @@ void onestring::allocate(size_t capacity)
     // If we're allocating down, throw away the excess elements.
     if (this->_elements > this->_capacity)
     {
+        this->_hash = 0;
+        this->_bytes = offset(this->_capacity);
         this->_elements = this->_capacity;
+        cut_index(this->_capacity / INDEX_STRIDE);
     }
 
-    // Allocate a new array with the new size.
-    onechar* newArr = new onechar[this->_capacity];
+    // Allocate a new buffer with room for at least one byte per element.
+    rebuffer(std::max(this->_capacity, this->_bytes));
+}
+
+void onestring::rebuffer(size_t bytes)
+{
+    // A heap buffer that is already the right size can stay.
+    if (!is_local() && bytes == this->_byte_capacity)
+    {
+        this->internal[this->_bytes] = '\0';
+        return;
+    }
 
-    // If an old array exists...
-    if(this->internal != nullptr)
+    // Short strings live in the object itself.
+    char* newArr = (bytes < LOCAL_SIZE) ? this->_local : new char[bytes + 1];
+
+    if (newArr != this->internal)
     {
-        for (size_t i = 0; i < this->_elements; ++i)
+        memcpy(newArr, this->internal, this->_bytes);
+        if (!is_local())
         {
-            newArr[i] = std::move(this->internal[i]);
+            delete[] this->internal;
         }
-
-        // Delete the old structure
-        delete[] internal;
-        this->internal = nullptr;
+        this->internal = newArr;
     }
+    this->_byte_capacity = is_local() ? LOCAL_SIZE - 1 : bytes;
+    this->internal[this->_bytes] = '\0';
+}
 
-    // Store the new structure.
-    this->internal = newArr;
+void onestring::reserve_bytes(size_t bytes)
+{
+    // If we're already large enough, don't reallocate.
+    if (this->_byte_capacity >= bytes) { return; }
+
+    size_t grown = this->_byte_capacity * RESIZE_FACTOR;
+    rebuffer((grown > bytes) ? grown : bytes);
 }
 
 void onestring::expand(size_t expansion)
@@ -99,29 +139,71 @@ void onestring::expand(size_t expansion)
 
 void onestring::reserve(size_t elements)
 {
-    // If we're already large enough, don't reallocate.
-    if (this->_capacity >= elements) { return; }
+    make_room(elements, 0);
+}
 
-    // A capacity of 0 will trigger a complete reallocation
-    if (this->_capacity == 0)
+void onestring::make_room(size_t elements, size_t bytes)
+{
+    if (this->_capacity < elements)
     {
-        this->_capacity = BASE_SIZE;
+        // A capacity of 0 will trigger a complete reallocation
+        if (this->_capacity == 0)
+        {
+            this->_capacity = BASE_SIZE;
+        }
+
+        // If we're about to blow past indexing, manually set the capacity.
+        if (elements >= RESIZE_LIMIT)
+        {
+            this->_capacity = npos;
+        }
+
+        // Expand until we have enough space.
+        // cppcheck-suppress knownConditionTrueFalse
+        while (this->_capacity < elements)
+        {
+            // Small capacities must still grow by at least one.
+            size_t grown = this->_capacity * RESIZE_FACTOR;
+            this->_capacity = (grown > this->_capacity) ? grown : this->_capacity + 1;
+        }
     }
 
-    // If we're about to blow past indexing, manually set the capacity.
-    if (elements >= RESIZE_LIMIT)
+    // The buffer holds at least a byte per character, and all the bytes.
+    bytes = std::max(bytes, this->_capacity);
+    if (this->_byte_capacity < bytes)
     {
-        this->_capacity = npos;
+        size_t grown = this->_byte_capacity * RESIZE_FACTOR;
+        rebuffer((grown > bytes) ? grown : bytes);
     }
+}
 
-    // Expand until we have enough space.
-    // cppcheck-suppress knownConditionTrueFalse
-    while (this->_capacity < elements)
+void onestring::take(onestring& ostr) noexcept
+{
+    this->_capacity = ostr._capacity;
+    this->_elements = ostr._elements;
+    this->_bytes = ostr._bytes;
+    this->_byte_capacity = ostr._byte_capacity;
+    if (ostr.is_local())
     {
-        this->_capacity *= RESIZE_FACTOR;
+        memcpy(this->_local, ostr._local, LOCAL_SIZE);
+        this->internal = this->_local;
+    }
+    else
+    {
+        this->internal = ostr.internal;
     }
 
-    allocate(this->_capacity);
+    // References from at() live in the extras, so they move along with it.
+    delete this->_extras.exchange(ostr._extras.exchange(nullptr));
+    this->_hash = ostr._hash.load(std::memory_order_relaxed);
+
+    ostr._capacity = BASE_SIZE;
+    ostr._elements = 0;
+    ostr._bytes = 0;
+    ostr._byte_capacity = LOCAL_SIZE - 1;
+    ostr.internal = ostr._local;
+    ostr._local[0] = '\0';
+    ostr._hash = 0;
 }
 
 void onestring::resize(size_t elements)
@@ -129,6 +211,7 @@ void onestring::resize(size_t elements)
     // Don't reallocate if we already have the exact size needed.
     if (this->_capacity == elements) { return; }
 
+    release();
     // Reallocate to EXACTLY the needed size.
     allocate(elements);
 }
@@ -136,7 +219,6 @@ void onestring::resize(size_t elements)
 void onestring::resize(size_t elements, const onechar& ch)
 {
     int to_add = elements - this->_elements;
-    std::cout << to_add << std::endl;
     resize(elements);
 
     if (to_add > 0)
@@ -145,39 +227,247 @@ void onestring::resize(size_t elements, const onechar& ch)
     }
 }
 
-void onestring::shift(size_t fromIndex, int offset)
+void onestring::shrink_to_fit()
 {
-    // WARNING: We do NOT handle expansion in this function; only shifting.
+    release();
+    // We simply need to reallocate for the EXACT number of elements we have
+    allocate(this->_elements);
+}
+
+void onestring::splice(size_t pos, size_t len, const char* src, size_t n,
+                       size_t repeat)
+{
+    // WARNING: pos and len are not validated. That MUST be done externally!
+
+    // The source may be part of this string, which is about to move.
+    std::string keep;
+    if (n > 0 && owns(src))
+    {
+        keep.assign(src, n);
+        src = keep.data();
+    }
+
+    size_t start = offset(pos);
+    size_t end = offset(pos + len);
+    size_t inserted = n * repeat;
+    size_t tail_chars = this->_elements - pos - len;
+
+    /* We recount from the start of the replaced range. A last character
+     * that was cut short, though, takes in the bytes appended after it,
+     * so in that case recount that character as well. */
+    size_t recount_from = start;
+    size_t recount_pos = pos;
+    if (start == this->_bytes && this->_elements > 0)
+    {
+        size_t last = offset(this->_elements - 1);
+        if (last + onechar::evaluateLength(this->internal + last) > start)
+        {
+            recount_from = last;
+            recount_pos = this->_elements - 1;
+        }
+    }
 
-    // If we're shifting forward...
-    if (offset > 0)
+    // Move the right partition to make room, then copy in the new bytes.
+    size_t bytes = this->_bytes - (end - start) + inserted;
+    reserve_bytes(bytes);
+    memmove(this->internal + start + inserted, this->internal + end,
+            this->_bytes - end);
+    for (size_t i = 0; n > 0 && i < repeat; ++i)
+    {
+        memcpy(this->internal + start + (i * n), src, n);
+    }
+    this->_bytes = bytes;
+    this->internal[bytes] = '\0';
+    this->_hash = 0;
+
+    /* Count the new characters until their boundaries line up with the
+     * old ones after the range again. For valid UTF-8, that is right at
+     * the end of the inserted bytes. */
+    size_t here = recount_from;
+    size_t old = start + inserted;
+    size_t counted = 0;
+    size_t skipped = 0;
+    if (here < old)
     {
-        // Work from last element being moved to first
-        size_t target = _elements;
-        // Copy each element forward to its new position.
-        while (target-- > fromIndex)
+        size_t valid = utf8::count_if_valid(this->internal + here, old - here);
+        if (valid != utf8::npos)
         {
-            this->internal[target + offset] = this->internal[target];
+            counted = valid;
+            here = old;
         }
     }
-    // Otherwise, if we're shifting backward...
-    else if (offset < 0)
+    while (here != old)
     {
-        // Work from first element being moved to last
-        size_t target = fromIndex;
-        // Copy each element back to its new position.
-        while (target < _elements)
+        if (here < old)
+        {
+            here += utf8::char_length(this->internal + here, this->_bytes - here);
+            ++counted;
+        }
+        else
         {
-            this->internal[target + offset] = this->internal[target];
-            ++target;
+            old += utf8::char_length(this->internal + old, this->_bytes - old);
+            ++skipped;
         }
     }
+    this->_elements = recount_pos + counted + (tail_chars - skipped);
+
+    // Offsets before the change are still good; the rest are not.
+    cut_index(recount_pos / INDEX_STRIDE);
 }
 
-void onestring::shrink_to_fit()
+size_t onestring::advance(size_t from, size_t count) const
 {
-    // We simply need to reallocate for the EXACT number of elements we have
-    allocate(this->_elements);
+    if (from >= this->_bytes)
+    {
+        return from;
+    }
+    return from + utf8::advance(this->internal + from, this->_bytes - from, count);
+}
+
+size_t onestring::offset(size_t pos) const
+{
+    // If every character is one byte, the offset is the index.
+    if (this->_bytes == this->_elements)
+    {
+        return (pos < this->_bytes) ? pos : this->_bytes;
+    }
+    if (pos >= this->_elements)
+    {
+        return this->_bytes;
+    }
+
+    /* Start from the nearest indexed character, extending the index
+     * first. Reading a const string from several threads is safe, so
+     * only one of them may touch the index at a time. */
+    size_t block = pos / INDEX_STRIDE;
+    size_t from = 0;
+    if (block > 0)
+    {
+        Extras& found = extras();
+        while (found.index_lock.test_and_set(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+        while (found.index.size() < block)
+        {
+            size_t last = found.index.empty() ? 0 : found.index.back();
+            found.index.push_back(advance(last, INDEX_STRIDE));
+        }
+        from = found.index[block - 1];
+        found.index_lock.clear(std::memory_order_release);
+    }
+    return advance(from, pos - (block * INDEX_STRIDE));
+}
+
+onestring::Extras& onestring::extras() const
+{
+    Extras* found = this->_extras.load(std::memory_order_acquire);
+    if (found == nullptr)
+    {
+        // Another const reader may get there first; if so, use theirs.
+        Extras* made = new Extras();
+        if (this->_extras.compare_exchange_strong(found, made,
+                                                  std::memory_order_acq_rel))
+        {
+            found = made;
+        }
+        else
+        {
+            delete made;
+        }
+    }
+    return *found;
+}
+
+void onestring::cut_index(size_t entries) const
+{
+    Extras* found = this->_extras.load(std::memory_order_acquire);
+    if (found != nullptr && found->index.size() > entries)
+    {
+        found->index.resize(entries);
+    }
+}
+
+onechar onestring::char_at(size_t pos) const
+{
+    onechar ochr;
+    if (pos < this->_elements)
+    {
+        size_t from = offset(pos);
+        ochr.size = utf8::char_length(this->internal + from, this->_bytes - from);
+        memcpy(ochr.internal, this->internal + from, ochr.size);
+    }
+    return ochr;
+}
+
+onechar& onestring::checkout(size_t pos)
+{
+    // Hand out the same reference for the same character.
+    std::unordered_map<size_t, Ref>& refs = extras().refs;
+    auto found = refs.find(pos);
+    if (found == refs.end())
+    {
+        onechar ochr = char_at(pos);
+        found = refs.emplace(pos, Ref{ochr, ochr}).first;
+    }
+    return found->second.ochr;
+}
+
+onechar onestring::peek(size_t pos) const
+{
+    /* A change waiting in a reference is only an overlay; the buffer
+     * itself is still whole, so the rest can be read from it as is. */
+    const Extras* extras = this->_extras.load(std::memory_order_acquire);
+    if (extras != nullptr && !extras->refs.empty())
+    {
+        auto found = extras->refs.find(pos);
+        if (found != extras->refs.end())
+        {
+            return found->second.ochr;
+        }
+    }
+    return char_at(pos);
+}
+
+void onestring::write_back()
+{
+    std::unordered_map<size_t, Ref>& refs = extras().refs;
+    for (auto ref = refs.begin(); ref != refs.end();)
+    {
+        const onechar& ochr = ref->second.ochr;
+        const onechar& stored = ref->second.stored;
+        bool written = ochr.size != stored.size
+                       || memcmp(ochr.internal, stored.internal, ochr.size) != 0;
+        if (!written || ref->first >= this->_elements)
+        {
+            /* Keep it all the same: the reference is valid until the
+             * string is next modified, and may yet be written through. */
+            ++ref;
+            continue;
+        }
+
+        splice(ref->first, 1, ochr.internal, ochr.size);
+        /* Malformed bytes may not come back as the same character,
+         * so mirror what is stored now to write it only once. */
+        ref->second.ochr = char_at(ref->first);
+        ref->second.stored = ref->second.ochr;
+        ++ref;
+    }
+}
+
+void onestring::release()
+{
+    sync();
+    Extras* extras = this->_extras.load(std::memory_order_relaxed);
+    if (extras != nullptr)
+    {
+        extras->refs.clear();
+    }
+}
+
+size_t onestring::characterCount(const char* str, size_t bytes)
+{
+    return utf8::count(str, bytes);
 }
 
 /*******************************************
@@ -191,31 +481,31 @@ onechar& onestring::at(size_t pos)
         throw std::out_of_range("Onestring::at(): Index out of bounds.");
     }
 
-    return internal[pos];
+    return checkout(pos);
 }
 
-const onechar& onestring::at(size_t pos) const
+onechar onestring::at(size_t pos) const
 {
     if (pos > _elements)
     {
         throw std::out_of_range("Onestring::at(): Index out of bounds.");
     }
 
-    return internal[pos];
+    return peek(pos);
 }
 
 onechar& onestring::back()
 {
     // WARNING: If string is empty, this is undefined (but memory safe)
     // Return a reference to the last element in the string.
-    return this->internal[_elements - 1];
+    return checkout(_elements - 1);
 }
 
-const onechar& onestring::back() const
+onechar onestring::back() const
 {
     // WARNING: If string is empty, this is undefined (but memory safe)
-    // Return a reference to the last element in the string.
-    return this->internal[_elements - 1];
+    // Return a copy of the last element in the string.
+    return peek(_elements - 1);
 }
 
 size_t onestring::capacity() const
@@ -232,56 +522,38 @@ size_t onestring::copy(char* arr, size_t max, size_t len, size_t pos) const
         throw std::out_of_range("Onestring::copy(): specified pos out of range");
     }
 
+    sync();
+
     // Remove one char from the max to account for the null terminator.
     --max;
 
-    // The indices for the c-string and (this) onestring.
-    size_t cstr_i = 0;
-    size_t ostr_i = pos;
-
     // Account for unspecified len, or adjust so it doesn't blow past the end.
     if (len == 0 || len + pos > this->_elements)
     {
         len = this->_elements - pos;
     }
 
-    while (cstr_i < max && ostr_i < (pos + len))
+    // Find the whole characters that fit, and copy them in one go.
+    size_t from = offset(pos);
+    size_t to = from;
+    for (size_t i = 0; i < len; ++i)
     {
-        memcpy(arr + cstr_i, this->internal[ostr_i].internal, this->internal[ostr_i].size);
-        cstr_i += this->internal[ostr_i].size;
-        ++ostr_i;
+        size_t n = utf8::char_length(this->internal + to, this->_bytes - to);
+        if (to + n - from > max) { break; }
+        to += n;
     }
 
-    arr[cstr_i] = '\0';
+    memcpy(arr, this->internal + from, to - from);
+    arr[to - from] = '\0';
 
-    return cstr_i;
+    return to - from;
 }
 
 const char* onestring::c_str() const
 {
-    // If we have a c-string instance cached, deallocate it.
-    if (this->_c_str != nullptr)
-    {
-        delete[] this->_c_str;
-    }
-
-    // Allocate a new c-string.
-    size_t n = size();
-    this->_c_str = new char[n];
-
-    // Convert and store each onechar's value in the c-string
-    char* dest = this->_c_str;
-    for(size_t i = 0; i < _elements; ++i)
-    {
-        memcpy(dest, internal[i].internal, internal[i].size);
-        dest += internal[i].size;
-    }
-
-    // Append the null terminator to the end of the c-string
-    this->_c_str[n-1] = '\0';
-
-    // Return the pointer to the new cached c-string
-    return this->_c_str;
+    // The buffer is always null-terminated, so it only needs to be current.
+    sync();
+    return this->internal;
 }
 
 bool onestring::empty() const
@@ -293,14 +565,14 @@ onechar& onestring::front()
 {
     // WARNING: If string is empty, this is undefined (but memory safe)
     // Return a reference to the first element in the string.
-    return this->internal[0];
+    return checkout(0);
 }
 
-const onechar& onestring::front() const
+onechar onestring::front() const
 {
     // WARNING: If string is empty, this is undefined (but memory safe)
-    // Return a reference to the last element in the string.
-    return this->internal[0];
+    // Return a copy of the first element in the string.
+    return peek(0);
 }
 
 size_t onestring::length() const
@@ -315,31 +587,25 @@ onestring onestring::substr(size_t pos, size_t len) const
         throw std::out_of_range("Onestring::substr(): specified pos out of range");
     }
 
+    sync();
+
     onestring r;
     // Calculate size of substr (number of elements)
     size_t elements_to_copy = (len > _elements - pos) ? (_elements - pos) : len;
-    // Reserve necessary space in the new onestring
-    r.reserve(elements_to_copy);
-    // Copy the characters for the substring
-    for (size_t i = 0; i < elements_to_copy; ++i)
-    {
-        r.internal[i] = this->internal[pos + i];
-    }
-    // Record how many elements were copied.
-    r._elements = elements_to_copy;
+    // Reserve exactly the space needed in the new onestring
+    size_t from = offset(pos);
+    size_t bytes = offset(pos + elements_to_copy) - from;
+    r.make_room(elements_to_copy, bytes);
+    // Copy the bytes for the substring
+    r.splice(0, 0, this->internal + from, bytes);
     return r;
 }
 
 size_t onestring::size() const
 {
-    // Start counting at 1 to account for the null terminator.
-    size_t bytes = 1;
-    // Sum all of the byte lengths of the onechars.
-    for(size_t i = 0; i < _elements; ++i)
-    {
-        bytes += this->internal[i].size;
-    }
-    return bytes;
+    sync();
+    // Add 1 to account for the null terminator.
+    return this->_bytes + 1;
 }
 
 size_t onestring::size(size_t len, size_t pos) const
@@ -352,15 +618,13 @@ size_t onestring::size(size_t len, size_t pos) const
         throw std::out_of_range("Onestring::size(): specified pos out of range");
     }
 
-    // Start counting at 1 to account for the null terminator.
-    size_t bytes = 1;
+    sync();
 
-    // Sum all of the byte lengths of the onechars in the range
-    for(size_t i = pos; i < (pos + len) && i < _elements; ++i)
-    {
-        bytes += this->internal[i].size;
-    }
-    return bytes;
+    // Clamp the range to the end of the string.
+    size_t end = (len > _elements - pos) ? _elements : pos + len;
+
+    // Add 1 to account for the null terminator.
+    return offset(end) - offset(pos) + 1;
 }
 
 /*******************************************
@@ -372,7 +636,8 @@ int onestring::compare(const char ch) const
     int sizeDiff = this->_elements - 1;
     if (sizeDiff == 0)
     {
-        return this->internal[0].compare(ch);
+        sync();
+        return char_at(0).compare(ch);
     }
     return sizeDiff;
 }
@@ -382,97 +647,76 @@ int onestring::compare(const onechar& ochr) const
     int sizeDiff = this->_elements - 1;
     if (sizeDiff == 0)
     {
-        return this->internal[0].compare(ochr);
+        sync();
+        return char_at(0).compare(ochr);
     }
     return sizeDiff;
 }
 
 int onestring::compare(const char* cstr) const
 {
-    /* This algorithm will not return a meaningful integer; only its
-        * relation to 0 will be useful */
-
-    int sizeDiff = this->_elements - characterCount(cstr);
-
-    if (sizeDiff == 0)
-    {
-        size_t j = 0;
-        // If the strings are the same length, compare each character...
-        for(size_t i = 0; i < this->_elements; ++i)
-        {
-            // Return the compare result of the first character mismatch
-            int r = this->internal[i].compare(cstr+j);
-            if ( r != 0) { return r; }
-
-            j += onechar::evaluateLength(cstr+j);
-        }
-    }
-    return sizeDiff;
+    return compare(onestring_view(cstr));
 }
 
 int onestring::compare(const std::string& str) const
 {
-    return compare(str.c_str());
+    return compare(onestring_view(str));
 }
 
 int onestring::compare(const onestring& ostr) const
 {
-    /* This algorithm will not return a meaningful integer; only its
-        * relation to 0 will be useful */
+    return compare(onestring_view(ostr));
+}
 
-    int sizeDiff = this->_elements - ostr._elements;
-    if (sizeDiff == 0)
-    {
-        // If the strings are the same length, compare each character...
-        for(size_t i = 0; i < this->_elements; ++i)
-        {
-            // Return the compare result of the first character mismatch
-            int r = this->internal[i].compare(ostr.internal[i]);
-            if ( r != 0) { return r; }
-        }
-    }
-    return sizeDiff;
+int onestring::compare(const onestring_view& view) const
+{
+    return onestring_view(*this).compare(view);
 }
 
 bool onestring::equals(const char ch) const
 {
-    return (this->_elements == 1 && this->internal[0] == ch);
+    sync();
+    return (this->_bytes == 1 && this->internal[0] == ch);
 }
 
 bool onestring::equals(const onechar& ochr) const
 {
-    return (this->_elements == 1 && this->internal[0] == ochr);
+    sync();
+    return (this->_elements == 1 && this->_bytes == ochr.size
+            && memcmp(this->internal, ochr.internal, ochr.size) == 0);
 }
 
 bool onestring::equals(const char* cstr) const
 {
-    size_t index = 0;
-    size_t compare_to = 0;
-    if (this->_elements != characterCount(cstr)) { return false; }
-    while(cstr[index] != '\0')
-    {
-        if (!(this->internal[compare_to].equals_at(cstr + index))) { return false; }
-        index += onechar::evaluateLength(cstr + index);
-        if(compare_to++ > this->_elements) { return false; }
-    }
-
-    return true;
+    // Equal characters are equal bytes.
+    sync();
+    size_t cstr_bytes = strlen(cstr);
+    return (this->_bytes == cstr_bytes
+            && memcmp(this->internal, cstr, cstr_bytes) == 0);
 }
 
 bool onestring::equals(const std::string& str) const
 {
-    return equals(str.c_str());
+    sync();
+    return (this->_bytes == str.size()
+            && memcmp(this->internal, str.data(), this->_bytes) == 0);
 }
 
 bool onestring::equals(const onestring& ostr) const
 {
     if (this->_elements != ostr._elements) { return false; }
 
-    for (size_t index = 0; index < this->_elements; ++index)
-    {
-        if (this->internal[index] != ostr.internal[index]) { return false; }
-    }
-    return true;
+    sync();
+    ostr.sync();
+    return (this->_bytes == ostr._bytes
+            && memcmp(this->internal, ostr.internal, this->_bytes) == 0);
+}
+
+bool onestring::equals(const onestring_view& view) const
+{
+    sync();
+    return (this->_bytes == view.size()
+            && memcmp(this->internal, view.data(), this->_bytes) == 0);
 }
 
 /*******************************************
@@ -481,128 +725,137 @@ bool onestring::equals(const onestring& ostr) const
 
 onestring& onestring::append(const char ch, size_t repeat)
 {
-    expand(repeat);
-
-    for(size_t a = 0; a < repeat; ++a)
-    {
-        // Insert a 1-byte ASCII char
-        internal[_elements++] = ch;
-    }
+    release();
+    make_room(_elements + repeat, _bytes + repeat);
+    splice(_elements, 0, &ch, 1, repeat);
     return *this;
 }
 
 onestring& onestring::append(const onechar& ochr, size_t repeat)
 {
-    expand(repeat);
-
-    for(size_t a = 0; a < repeat; ++a)
-    {
-        internal[_elements++] = ochr;
-    }
+    release();
+    make_room(_elements + repeat, _bytes + (ochr.size * repeat));
+    splice(_elements, 0, ochr.internal, ochr.size, repeat);
     return *this;
 }
 
 onestring& onestring::append(const char* cstr, size_t repeat)
 {
-    size_t len = characterCount(cstr);
-    expand(len * repeat);
-
-    for(size_t a = 0; a < repeat; ++a)
-    {
-        size_t index = 0;
-        // Loop through each character in the string literal
-        while(cstr[index] != '\0')
-        {
-            index += internal[_elements++].parseFromString(cstr, index);
-        }
-    }
-    return *this;
+    return append(onestring_view(cstr), repeat);
 }
 
 onestring& onestring::append(const std::string& str, size_t repeat)
 {
-    // Parse the internal c string directly.
-    append(str.c_str(), repeat);
-    return *this;
+    return append(onestring_view(str), repeat);
 }
 
 onestring& onestring::append(const onestring& ostr, size_t repeat)
 {
-    expand(ostr._elements * repeat);
+    release();
+    ostr.sync();
+    make_room(_elements + (ostr._elements * repeat), _bytes + (ostr._bytes * repeat));
+    splice(_elements, 0, ostr.internal, ostr._bytes, repeat);
+    return *this;
+}
 
-    for(size_t a = 0; a < repeat; ++a)
+onestring& onestring::append(const onestring_view& view, size_t repeat)
+{
+    // A view of this string would not survive it growing.
+    if (owns(view.data()))
     {
-        for(size_t i = 0; i < ostr._elements; ++i)
-        {
-            this->internal[_elements + i] = ostr.internal[i];
-        }
-
-        _elements += ostr._elements;
+        return append(onestring(view), repeat);
     }
 
+    release();
+    make_room(_elements + (view.length() * repeat), _bytes + (view.size() * repeat));
+    splice(_elements, 0, view.data(), view.size(), repeat);
     return *this;
 }
 
 onestring& onestring::assign(const char ch)
 {
-    clear();
-    reserve(1);
-    this->internal[_elements++] = ch;
+    release();
+    splice(0, _elements, &ch, 1);
     return *this;
 }
 
 onestring& onestring::assign(const onechar& ochr)
 {
-    clear();
-    reserve(1);
-    this->internal[_elements++] = ochr;
+    release();
+    splice(0, _elements, ochr.internal, ochr.size);
     return *this;
 }
 
 onestring& onestring::assign(const char* cstr)
 {
-    clear();
+    return assign(onestring_view(cstr));
+}
 
-    size_t len = characterCount(cstr);
-    reserve(len);
+onestring& onestring::assign(const std::string& str)
+{
+    return assign(onestring_view(str));
+}
 
-    // Loop through each character in the string literal
-    size_t index = 0;
-    while(cstr[index] != '\0')
+onestring& onestring::assign(const onestring& ostr)
+{
+    if (this == &ostr)
     {
-        // Parse and store the character.
-        index += internal[_elements++].parseFromString(cstr, index);
+        release();
+        return *this;
     }
+
+    // Keep our buffer, if it is big enough, rather than starting over.
+    release();
+    ostr.sync();
+    make_room(ostr._elements, ostr._bytes);
+    splice(0, _elements, ostr.internal, ostr._bytes);
     return *this;
 }
 
-onestring& onestring::assign(const std::string& str)
+onestring& onestring::assign(onestring&& ostr) noexcept
 {
-    assign(str.c_str());
+    if (this != &ostr)
+    {
+        if (!is_local())
+        {
+            delete[] this->internal;
+        }
+        take(ostr);
+    }
     return *this;
 }
 
-onestring& onestring::assign(const onestring& ostr)
+onestring& onestring::assign(const onestring_view& view)
 {
-    clear();
-    reserve(ostr._elements);
-    for(size_t i = 0; i < ostr._elements; ++i)
+    // The view may be of this string, which clear() would throw away.
+    if (owns(view.data()))
     {
-        this->internal[i] = ostr.internal[i];
+        return assign(onestring(view));
     }
-    _elements = ostr._elements;
+
+    release();
+    make_room(view.length(), view.size());
+    splice(0, _elements, view.data(), view.size());
     return *this;
 }
 
 void onestring::clear()
 {
+    release();
     if (_elements > 0)
     {
-        delete[] this->internal;
-        internal = nullptr;
+        if (!is_local())
+        {
+            delete[] this->internal;
+        }
+        internal = _local;
+        _elements = 0;
+        _bytes = 0;
+        _byte_capacity = LOCAL_SIZE - 1;
+        cut_index(0);
+        _hash = 0;
         _capacity = 0;
         reserve(BASE_SIZE);
-        _elements = 0;
     }
 }
 
@@ -613,18 +866,13 @@ onestring& onestring::erase(size_t pos, size_t len)
         throw std::out_of_range("Onestring::erase(): Index out of bounds.");
     }
 
+    release();
+
     // Calculate the number of elements we need to REMOVE
     len = (len > _elements - pos) ? (_elements - pos) : len;
 
-    // If there are any elements remaining after the erasure...
-    if(_elements - pos - len > 0)
-    {
-        // Move the remaining elements back
-        shift(pos + len, -(len));
-    }
-
-    // Update the number of elements
-    _elements = _elements - len;
+    // Remove them, moving the remaining elements back
+    splice(pos, len, nullptr, 0);
 
     return *this;
 }
@@ -649,20 +897,16 @@ onestring& onestring::insert(size_t pos, char ch)
         throw std::out_of_range("Onestring::insert(): specified pos out of range");
     }
 
+    release();
     // Reserve needed space
     expand(1);
-    // Move the right partition to make room for the new element
-    shift(pos, 1);
-
     // Insert the new element
-    this->internal[pos] = ch;
-    // Increase the element count
-    ++_elements;
+    splice(pos, 0, &ch, 1);
 
     return *this;
 }
 
-onestring& onestring::insert(size_t pos, onechar& ochr)
+onestring& onestring::insert(size_t pos, const onechar& ochr)
 {
     // Ensure the insertion position is in range.
     if (pos >= this->_elements)
@@ -670,20 +914,26 @@ onestring& onestring::insert(size_t pos, onechar& ochr)
         throw std::out_of_range("Onestring::insert(): specified pos out of range");
     }
 
+    release();
     // Reserve needed space
-    expand(1);
-    // Move the right partition to make room for the new element
-    shift(pos, 1);
-
+    make_room(_elements + 1, _bytes + ochr.size);
     // Insert the new element
-    this->internal[pos] = ochr;
-    // Increase the element count
-    ++_elements;
+    splice(pos, 0, ochr.internal, ochr.size);
 
     return *this;
 }
 
-onestring& onestring::insert(size_t pos, char* cstr)
+onestring& onestring::insert(size_t pos, const char* cstr)
+{
+    return insert(pos, onestring_view(cstr));
+}
+
+onestring& onestring::insert(size_t pos, const std::string& str)
+{
+    return insert(pos, onestring_view(str));
+}
+
+onestring& onestring::insert(size_t pos, const onestring& ostr)
 {
     // Ensure the insertion position is in range.
     if (pos >= this->_elements)
@@ -691,31 +941,17 @@ onestring& onestring::insert(size_t pos, char* cstr)
         throw std::out_of_range("Onestring::insert(): specified pos out of range");
     }
 
-    size_t elements_to_insert = characterCount(cstr);
+    release();
+    ostr.sync();
     // Reserve needed space
-    expand(elements_to_insert);
-    // Move the right partition to make room for the new element
-    shift(pos, elements_to_insert);
-
+    make_room(_elements + ostr._elements, _bytes + ostr._bytes);
     // Insert the new elements
-    size_t index = 0;
-    while(cstr[index] != '\0')
-    {
-        // Parse and store the character.
-        index += internal[pos++].parseFromString(cstr, index);
-    }
-    // Increase the element count
-    _elements += elements_to_insert;
+    splice(pos, 0, ostr.internal, ostr._bytes);
 
     return *this;
 }
 
-onestring& onestring::insert(size_t pos, std::string& str)
-{
-    return insert(pos, str.c_str());
-}
-
-onestring& onestring::insert(size_t pos, const onestring& ostr)
+onestring& onestring::insert(size_t pos, const onestring_view& view)
 {
     // Ensure the insertion position is in range.
     if (pos >= this->_elements)
@@ -723,19 +959,17 @@ onestring& onestring::insert(size_t pos, const onestring& ostr)
         throw std::out_of_range("Onestring::insert(): specified pos out of range");
     }
 
-    size_t elements_to_insert = ostr._elements;
-    // Reserve needed space
-    expand(elements_to_insert);
-    // Move the right partition to make room for the new element
-    shift(pos, elements_to_insert);
-
-    // Insert the new elements
-    for(size_t i = 0; i < ostr._elements; ++i)
+    // A view of this string would not survive it growing.
+    if (owns(view.data()))
     {
-        this->internal[pos + i] = ostr.internal[i];
+        return insert(pos, onestring(view));
     }
-    // Increase the element count
-    _elements += elements_to_insert;
+
+    release();
+    // Reserve needed space
+    make_room(_elements + view.length(), _bytes + view.size());
+    // Insert the new elements
+    splice(pos, 0, view.data(), view.size());
 
     return *this;
 }
@@ -744,53 +978,19 @@ void onestring::pop_back()
 {
     if(_elements > 0)
     {
-        /* We don't actually need to delete anything. The space will be
+        release();
+        /* We don't actually need to free anything. The space will be
         * reused or deallocated as needed by other functions. */
-        --_elements;
+        splice(_elements - 1, 1, nullptr, 0);
     }
 }
 
-void onestring::replace_setup(size_t pos, size_t len, size_t sublen)
+onestring& onestring::replace(size_t pos, size_t len, const char ch)
 {
-    // WARNING: pos and len are not validated. That MUST be done externally!
-
-    // Calculate whether we're replacing 1:1, expanding, or erasing
-    int difference = sublen - len;
-    size_t pos_after = pos + len;
-    size_t elements_after = _elements - pos_after;
-
-    // If our replacement expands the string...
-    if (difference > 0)
-    {
-        // Reserve the needed space
-        expand(difference);
-
-        // Move the right partition to make room, if necessary
-        if (elements_after > 0)
-        {
-            shift(pos, difference);
-        }
-
-        // Update the element count
-        _elements += difference;
-    }
-    // Otherwise, if our replacement shrinks the string...
-    else if (difference < 0)
-    {
-        // Move the right partition back, erasing excess characters.
-        if (elements_after > 0)
-        {
-            shift(pos_after, difference);
-        }
-
-        // Update the element count
-        _elements += difference;
-    }
-
-    // If the string size won't change, we need no extra setup.
+    return replace(pos, len, onechar(ch));
 }
 
-onestring& onestring::replace(size_t pos, size_t len, const char ch)
+onestring& onestring::replace(size_t pos, size_t len, const onechar& ochr)
 {
     // Ensure the replacement position is in range.
     if (pos >= this->_elements)
@@ -798,39 +998,28 @@ onestring& onestring::replace(size_t pos, size_t len, const char ch)
         throw std::out_of_range("Onestring::replace(): specified pos out of range");
     }
 
+    release();
+
     // Adjust len so it doesn't run past the end of the string
     len = (len > _elements - pos) ? (_elements - pos) : len;
 
-    // Rearrange the string memory to accommodate the new data
-    replace_setup(pos, len, 1);
-
     // Write the data, using pos as our destination index.
-    this->internal[pos] = ch;
+    splice(pos, len, ochr.internal, ochr.size);
 
     return *this;
 }
 
-onestring& onestring::replace(size_t pos, size_t len, const onechar& ochr)
+onestring& onestring::replace(size_t pos, size_t len, const char* cstr)
 {
-    // Ensure the replacement position is in range.
-    if (pos >= this->_elements)
-    {
-        throw std::out_of_range("Onestring::replace(): specified pos out of range");
-    }
-
-    // Adjust len so it doesn't run past the end of the string
-    len = (len > _elements - pos) ? (_elements - pos) : len;
-
-    // Rearrange the string memory to accommodate the new data
-    replace_setup(pos, len, 1);
-
-    // Write the data, using pos as our destination index.
-    this->internal[pos] = ochr;
+    return replace(pos, len, onestring_view(cstr));
+}
 
-    return *this;
+onestring& onestring::replace(size_t pos, size_t len, const std::string& str)
+{
+    return replace(pos, len, onestring_view(str));
 }
 
-onestring& onestring::replace(size_t pos, size_t len, const char* cstr)
+onestring& onestring::replace(size_t pos, size_t len, const onestring& ostr)
 {
     // Ensure the replacement position is in range.
     if (pos >= this->_elements)
@@ -838,29 +1027,24 @@ onestring& onestring::replace(size_t pos, size_t len, const char* cstr)
         throw std::out_of_range("Onestring::replace(): specified pos out of range");
     }
 
+    release();
+    ostr.sync();
+
     // Adjust len so it doesn't run past the end of the string
     len = (len > _elements - pos) ? (_elements - pos) : len;
 
-    // Rearrange the string memory to accommodate the new data
-    replace_setup(pos, len, characterCount(cstr));
-
-    // Write the data, using pos as our destination index.
-    size_t index = 0;
-    while(cstr[index] != '\0')
+    // Reserve the needed space, if the replacement expands the string
+    if (ostr._elements > len)
     {
-        // Parse and store the character.
-        index += internal[pos++].parseFromString(cstr, index);
+        expand(ostr._elements - len);
     }
 
-    return *this;
-}
+    splice(pos, len, ostr.internal, ostr._bytes);
 
-onestring& onestring::replace(size_t pos, size_t len, const std::string& str)
-{
-    return replace(pos, len, str.c_str());
+    return *this;
 }
 
-onestring& onestring::replace(size_t pos, size_t len, const onestring& ostr)
+onestring& onestring::replace(size_t pos, size_t len, const onestring_view& view)
 {
     // Ensure the replacement position is in range.
     if (pos >= this->_elements)
@@ -868,17 +1052,26 @@ onestring& onestring::replace(size_t pos, size_t len, const onestring& ostr)
         throw std::out_of_range("Onestring::replace(): specified pos out of range");
     }
 
+    // A view of this string would not survive it growing.
+    if (owns(view.data()))
+    {
+        return replace(pos, len, onestring(view));
+    }
+
+    release();
+
     // Adjust len so it doesn't run past the end of the string
     len = (len > _elements - pos) ? (_elements - pos) : len;
 
-    // Rearrange the string memory to accommodate the new data
-    replace_setup(pos, len, ostr._elements);
-
-    for(size_t i = 0; i < ostr._elements; ++i)
+    // Reserve the needed space, if the replacement expands the string
+    size_t subchars = view.length();
+    if (subchars > len)
     {
-        this->internal[pos + i] = ostr.internal[i];
+        expand(subchars - len);
     }
 
+    splice(pos, len, view.data(), view.size());
+
     return *this;
 }
 
@@ -896,24 +1089,22 @@ onestring& onestring::replace(size_t pos, size_t len, const char* cstr, size_t s
         throw std::out_of_range("Onestring::replace(): specified subpos out of range");
     }
 
+    release();
+
     // Adjust len so it doesn't run past the end of the string
     len = (len > _elements - pos) ? (_elements - pos) : len;
     // Adjust sublen so it doesn't run past the end of the c-string.
     sublen = (sublen > cstr_len - subpos) ? (cstr_len - subpos) : sublen;
 
-    // Rearrange the string memory to accommodate the new data
-    replace_setup(pos, len, sublen);
-
-    // Repurpose sublen so it marks the end of the area we are to copy from
-    sublen += subpos;
-
-    // Replace the characters in the specified range, using pos and subpos as our indices.
-    while(subpos < sublen)
+    // Reserve the needed space, if the replacement expands the string
+    size_t subchars = characterCount(cstr + subpos, sublen);
+    if (subchars > len)
     {
-        // Parse and store the character.
-        subpos += internal[pos++].parseFromString(cstr, subpos);
+        expand(subchars - len);
     }
 
+    splice(pos, len, cstr + subpos, sublen);
+
     return *this;
 }
 
@@ -935,39 +1126,53 @@ onestring& onestring::replace(size_t pos, size_t len, const onestring& ostr, siz
         throw std::out_of_range("Onestring::replace(): specified subpos out of range");
     }
 
+    release();
+    ostr.sync();
+
     // Adjust len so it doesn't run past the end of the string
     len = (len > _elements - pos) ? (_elements - pos) : len;
     // Adjust sublen so it doesn't run past the end of the c-string.
     sublen = (sublen > ostr._elements - subpos) ? (ostr._elements - subpos) : sublen;
 
-    // Rearrange the string memory to accommodate the new data
-    replace_setup(pos, len, sublen);
-
-    for(size_t i = 0; i < sublen; ++i)
+    // Reserve the needed space, if the replacement expands the string
+    if (sublen > len)
     {
-        this->internal[pos + i] = ostr.internal[subpos + i];
+        expand(sublen - len);
     }
 
+    size_t from = ostr.offset(subpos);
+    splice(pos, len, ostr.internal + from, ostr.offset(subpos + sublen) - from);
+
     return *this;
 }
 
 onestring& onestring::reverse()
 {
-    // Create temporary storage unit
-    onechar temp;
+    release();
+    _hash = 0;
 
-    // Perform the swap
-    size_t lhe = 0;
-    size_t rhe = _elements - 1;
-    while(lhe < rhe)
+    // If every character is one byte, reverse the bytes in place.
+    if (_bytes == _elements)
     {
-        temp = this->internal[rhe];
-        this->internal[rhe] = this->internal[lhe];
-        this->internal[lhe] = temp;
-        ++lhe;
-        --rhe;
+        std::reverse(this->internal, this->internal + _bytes);
+        return *this;
     }
 
+    // Otherwise, copy each character to its mirrored position.
+    std::string reversed(_bytes, '\0');
+    size_t from = 0;
+    while (from < _bytes)
+    {
+        size_t n = utf8::char_length(this->internal + from, _bytes - from);
+        memcpy(&reversed[_bytes - from - n], this->internal + from, n);
+        from += n;
+    }
+    memcpy(this->internal, reversed.data(), _bytes);
+
+    // A character that was cut short at the end no longer is.
+    _elements = characterCount(this->internal, _bytes);
+    cut_index(0);
+
     return *this;
 }
 
@@ -980,9 +1185,23 @@ void onestring::swap(std::string& str)
 
 void onestring::swap(onestring& ostr)
 {
-    onestring temp = ostr;
-    ostr.assign(*this);
-    this->assign(temp);
+    // The characters move with their buffers, so references stay good.
+    bool this_local = this->is_local();
+    bool ostr_local = ostr.is_local();
+    std::swap(this->_capacity, ostr._capacity);
+    std::swap(this->_elements, ostr._elements);
+    std::swap(this->_bytes, ostr._bytes);
+    std::swap(this->_byte_capacity, ostr._byte_capacity);
+    std::swap(this->internal, ostr.internal);
+    std::swap(this->_local, ostr._local);
+
+    // Short strings stay in their own objects, so point back at them.
+    if (ostr_local) { this->internal = this->_local; }
+    if (this_local) { ostr.internal = ostr._local; }
+    this->_extras = ostr._extras.exchange(this->_extras.load());
+    size_t hash = this->_hash.load(std::memory_order_relaxed);
+    this->_hash = ostr._hash.load(std::memory_order_relaxed);
+    ostr._hash = hash;
 }
 
 /** Combine a onestring and a char.
@@ -993,55 +1212,88 @@ void onestring::swap(onestring& ostr)
 
 onestring operator+(const onestring& lhs, const char& rhs)
 {
-    onestring new_ostr(lhs);
-    new_ostr.append(rhs);
-    return new_ostr;
+    return onestring::concat({lhs, onestring_view(&rhs, 1, 1)});
 }
 
 //Combines a char and a onestring
 onestring operator+(const char& lhs, const onestring& rhs)
 {
-    onestring new_ostr(lhs);
-    new_ostr.append(rhs);
-    return new_ostr;
+    return onestring::concat({onestring_view(&lhs, 1, 1), rhs});
 }
 
 //Combines a onestring and a std::string
 onestring operator+(const onestring& lhs, const std::string& rhs)
 {
-    onestring new_ostr(lhs);
-    new_ostr.append(rhs);
-    return new_ostr;
+    return onestring::concat({lhs, rhs});
 }
 
 //Combines a std::string and a onestring
 onestring operator+(const std::string& lhs, const onestring& rhs)
 {
-    onestring new_ostr(lhs);
-    new_ostr.append(rhs);
-    return new_ostr;
+    return onestring::concat({lhs, rhs});
 }
 
 //Combines a onestring and a cstr
 onestring operator+(const onestring& lhs, const char* rhs)
 {
-    onestring new_ostr(lhs);
-    new_ostr.append(rhs);
-    return new_ostr;
+    return onestring::concat({lhs, rhs});
 }
 
 //Combines a cstr and a onestring
 onestring operator+(const char* lhs, const onestring& rhs)
 {
-    onestring new_ostr(lhs);
-    new_ostr.append(rhs);
-    return new_ostr;
+    return onestring::concat({lhs, rhs});
 }
 
 //Combines a onestring and a onestring
 onestring operator+(const onestring& lhs, const onestring& rhs)
 {
-    onestring new_ostr(lhs);
-    new_ostr.append(rhs);
-    return new_ostr;
+    return onestring::concat({lhs, rhs});
+}
+
+//Appends a char to a temporary onestring
+onestring operator+(onestring&& lhs, const char& rhs)
+{
+    lhs.append(rhs);
+    return std::move(lhs);
+}
+
+//Appends a std::string to a temporary onestring
+onestring operator+(onestring&& lhs, const std::string& rhs)
+{
+    lhs.append(rhs);
+    return std::move(lhs);
+}
+
+//Appends a cstr to a temporary onestring
+onestring operator+(onestring&& lhs, const char* rhs)
+{
+    lhs.append(rhs);
+    return std::move(lhs);
+}
+
+//Appends a onestring to a temporary onestring
+onestring operator+(onestring&& lhs, const onestring& rhs)
+{
+    lhs.append(rhs);
+    return std::move(lhs);
+}
+
+onestring onestring::concat(std::initializer_list<onestring_view> parts)
+{
+    size_t elements = 0;
+    size_t bytes = 0;
+    for (const onestring_view& part : parts)
+    {
+        elements += part.length();
+        bytes += part.size();
+    }
+
+    onestring ostr;
+    ostr.make_room(elements, bytes);
+    for (const onestring_view& part : parts)
+    {
+        ostr.splice(ostr._elements, 0, part.data(), part.size());
+    }
+    return ostr;
 }
@@ -166,11 +166,23 @@ void TestSuite_Onestring::load_tests()
     register_test("P-tB4040f", new TestOnestring_OpPlus(TestOnestring::TestStringType::OSTR_ASCII));
     register_test("P-tB4040g", new TestOnestring_OpPlus(TestOnestring::TestStringType::OSTR_UNICODE));
 
-    // tB4035: find
-    // tB4036: find_first_not_of
-    // tB4037: find_first_of
-    // tB4038: find_last_not_of
-    // tB4039: rfind
+    register_test("P-tB4041", new TestOnestring_Index());
+    register_test("P-tB4042", new TestOnestring_ShortCopy(), true, new TestStdString_ShortCopy());
+    register_test("P-tB4043", new TestOnestring_Data());
+    register_test("P-tB4044", new TestOnestring_Validate());
+    register_test("P-tB4045", new TestOnestring_Transcode());
+    register_test("P-tB4046", new TestOnestring_Move());
+    register_test("P-tB4047", new TestOnestring_Concat(), true, new TestStdString_Concat());
+    register_test("P-tB4048", new TestOnestring_Hash());
+    register_test("P-tB4049", new TestOnestring_HashView(), true, new TestStdString_Hash());
+    register_test("P-tB4050", new TestOnestring_ElementAccess());
+    register_test("P-tB4051", new TestOnestring_ReferenceLifetime());
+
+    register_test("P-tB4035", new TestOnestring_Find(), true, new TestStdString_Find());
+    register_test("P-tB4036", new TestOnestring_FindFirstNotOf());
+    register_test("P-tB4037", new TestOnestring_FindFirstOf());
+    register_test("P-tB4038", new TestOnestring_FindLastNotOf());
+    register_test("P-tB4039", new TestOnestring_RFind());
 
     //TODO: Comparative tests against std::string
 }
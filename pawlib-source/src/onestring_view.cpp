@@ -0,0 +1,317 @@
+#include "pawlib/onestring_view.hpp"
+#include "pawlib/onestring.hpp"
+#include "pawlib/utf8.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    /** Finds bytes in bytes. With SSE2, sixteen candidate positions at a
+     * time are checked against both the first and the last byte of the
+     * needle, and only those matching both are compared in full. This
+     * rules out far more than filtering on the first byte alone, which
+     * is what std::string_view::find does with memchr, and it doesn't
+     * depend on the text's alphabet the way Horspool's skips do.
+     * \param the text to search
+     * \param the bytes to find
+     * \param the byte offset to start searching from
+     * \return the byte offset of the match, or std::string_view::npos */
+    size_t find_bytes(std::string_view haystack, std::string_view needle, size_t from)
+    {
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+        const size_t m = needle.size();
+        if (m >= 2 && from <= haystack.size())
+        {
+            const char* text = haystack.data();
+            const __m128i first = _mm_set1_epi8(needle[0]);
+            const __m128i last = _mm_set1_epi8(needle[m - 1]);
+            for (; from + m + 15 <= haystack.size(); from += 16)
+            {
+                __m128i starts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + from));
+                __m128i ends = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + from + m - 1));
+                unsigned int mask = _mm_movemask_epi8(
+                    _mm_and_si128(_mm_cmpeq_epi8(starts, first),
+                                  _mm_cmpeq_epi8(ends, last)));
+                while (mask != 0)
+                {
+                    size_t at = from + __builtin_ctz(mask);
+                    if (memcmp(text + at + 1, needle.data() + 1, m - 2) == 0)
+                    {
+                        return at;
+                    }
+                    mask &= mask - 1;
+                }
+            }
+        }
+#endif
+        return haystack.find(needle, from);
+    }
+
+    /// The characters given to find_first_of() and the like
+    class CharSet
+    {
+        private:
+            /// Which ASCII characters are in the set
+            bool ascii[128] = {false};
+
+            /// The whole set, searched for any other character
+            const onestring_view& chars;
+
+            /// Whether the set has any characters that aren't ASCII
+            bool wide = false;
+
+        public:
+            explicit CharSet(const onestring_view& set)
+            : chars(set)
+            {
+                const char* data = set.data();
+                for (size_t i = 0; i < set.size();)
+                {
+                    size_t len = utf8::char_length(data + i, set.size() - i);
+                    unsigned char c = data[i];
+                    if (len == 1 && c < 0x80) { ascii[c] = true; }
+                    else { wide = true; }
+                    i += len;
+                }
+            }
+
+            /** \param the first byte of the character
+                 * \param the byte length of the character
+                 * \return whether the character is in the set */
+            bool holds(const char* ch, size_t len) const
+            {
+                unsigned char c = ch[0];
+                if (len == 1 && c < 0x80) { return ascii[c]; }
+                if (!wide) { return false; }
+
+                const char* data = chars.data();
+                for (size_t i = 0; i < chars.size();)
+                {
+                    size_t n = utf8::char_length(data + i, chars.size() - i);
+                    if (n == len && memcmp(data + i, ch, len) == 0) { return true; }
+                    i += n;
+                }
+                return false;
+            }
+    };
+}
+
+onestring_view::onestring_view(const onestring& ostr)
+: _data(ostr.data()), _bytes(ostr.size() - 1), _elements(ostr.length())
+{}
+
+size_t onestring_view::offset(size_t pos) const
+{
+    // In ASCII, characters are bytes.
+    if (length() == _bytes)
+    {
+        return (pos < _bytes) ? pos : _bytes;
+    }
+
+    return utf8::advance(_data, _bytes, pos);
+}
+
+size_t onestring_view::count(size_t bytes) const
+{
+    return utf8::count(_data, bytes);
+}
+
+onechar onestring_view::at(size_t pos) const
+{
+    if (pos >= length())
+    {
+        throw std::out_of_range("Onestring_view::at(): Index out of bounds.");
+    }
+
+    onechar ochr;
+    size_t from = offset(pos);
+    ochr.size = utf8::char_length(_data + from, _bytes - from);
+    memcpy(ochr.internal, _data + from, ochr.size);
+    ochr.internal[ochr.size] = '\0';
+    return ochr;
+}
+
+size_t onestring_view::length() const
+{
+    if (_elements == npos)
+    {
+        _elements = count(_bytes);
+    }
+    return _elements;
+}
+
+onestring_view onestring_view::substr(size_t pos, size_t len) const
+{
+    size_t elements = length();
+    if (pos > elements)
+    {
+        throw std::out_of_range("Onestring_view::substr(): specified pos out of range");
+    }
+
+    len = (len > elements - pos) ? (elements - pos) : len;
+    size_t from = offset(pos);
+    return onestring_view(_data + from, offset(pos + len) - from, len);
+}
+
+void onestring_view::remove_prefix(size_t n)
+{
+    *this = substr((n < length()) ? n : length());
+}
+
+void onestring_view::remove_suffix(size_t n)
+{
+    *this = substr(0, (n < length()) ? length() - n : 0);
+}
+
+size_t onestring_view::index_at(size_t byte) const
+{
+    // A valid prefix ends on a character boundary, and says how many.
+    size_t valid = utf8::count_if_valid(_data, byte);
+    if (valid != utf8::npos)
+    {
+        return valid;
+    }
+
+    size_t from = 0;
+    size_t index = 0;
+    while (from < byte)
+    {
+        from += utf8::char_length(_data + from, _bytes - from);
+        ++index;
+    }
+    return (from == byte) ? index : npos;
+}
+
+size_t onestring_view::find(const onestring_view& needle, size_t pos) const
+{
+    if (pos > length()) { return npos; }
+
+    std::string_view haystack(_data, _bytes);
+    std::string_view bytes(needle._data, needle._bytes);
+
+    // Walk the character index along behind the byte search.
+    size_t index = pos;
+    size_t at = offset(pos);
+    size_t found = find_bytes(haystack, bytes, at);
+    while (found != std::string_view::npos)
+    {
+        size_t valid = utf8::count_if_valid(_data + at, found - at);
+        if (valid != utf8::npos)
+        {
+            index += valid;
+            at = found;
+        }
+        while (at < found)
+        {
+            at += utf8::char_length(_data + at, _bytes - at);
+            ++index;
+        }
+
+        // Only a match that starts on a character counts.
+        if (at == found) { return index; }
+        found = find_bytes(haystack, bytes, at);
+    }
+    return npos;
+}
+
+size_t onestring_view::rfind(const onestring_view& needle, size_t pos) const
+{
+    std::string_view haystack(_data, _bytes);
+    std::string_view bytes(needle._data, needle._bytes);
+
+    size_t found = haystack.rfind(bytes, offset(pos));
+    while (found != std::string_view::npos)
+    {
+        // Only a match that starts on a character counts.
+        size_t index = index_at(found);
+        if (index != npos) { return index; }
+        if (found == 0) { break; }
+        found = haystack.rfind(bytes, found - 1);
+    }
+    return npos;
+}
+
+size_t onestring_view::find_of(const onestring_view& chars, size_t pos, bool in) const
+{
+    CharSet set(chars);
+    size_t index = pos;
+    size_t from = offset(pos);
+    while (from < _bytes)
+    {
+        size_t len = utf8::char_length(_data + from, _bytes - from);
+        if (set.holds(_data + from, len) == in) { return index; }
+        from += len;
+        ++index;
+    }
+    return npos;
+}
+
+size_t onestring_view::rfind_of(const onestring_view& chars, size_t pos, bool in) const
+{
+    CharSet set(chars);
+    size_t elements = length();
+    if (elements == 0) { return npos; }
+    pos = (pos < elements) ? pos : elements - 1;
+
+    // In ASCII, we can search backwards a byte at a time.
+    if (elements == _bytes)
+    {
+        for (size_t i = pos + 1; i-- > 0;)
+        {
+            if (set.holds(_data + i, 1) == in) { return i; }
+        }
+        return npos;
+    }
+
+    // Otherwise, walk forward and keep the last match.
+    size_t found = npos;
+    size_t from = 0;
+    for (size_t index = 0; index <= pos; ++index)
+    {
+        size_t len = utf8::char_length(_data + from, _bytes - from);
+        if (set.holds(_data + from, len) == in) { found = index; }
+        from += len;
+    }
+    return found;
+}
+
+int onestring_view::compare(const onestring_view& other) const
+{
+    /* This algorithm will not return a meaningful integer; only its
+        * relation to 0 will be useful */
+
+    size_t elements = length();
+    if (elements != other.length())
+    {
+        return (elements < other.length()) ? -1 : 1;
+    }
+
+    // If both are ASCII, the first mismatched byte decides it.
+    if (_bytes == elements && other._bytes == elements)
+    {
+        return memcmp(_data, other._data, _bytes);
+    }
+
+    // Otherwise, a shorter character sorts first, and characters of the
+    // same length compare by their bytes.
+    size_t i = 0;
+    size_t j = 0;
+    while (i < _bytes && j < other._bytes)
+    {
+        size_t lhs_len = utf8::char_length(_data + i, _bytes - i);
+        size_t rhs_len = utf8::char_length(other._data + j, other._bytes - j);
+
+        int sizeDiff = lhs_len - rhs_len;
+        if (sizeDiff != 0) { return sizeDiff; }
+
+        // Return the compare result of the first character mismatch
+        int r = memcmp(_data + i, other._data + j, lhs_len);
+        if (r != 0) { return r; }
+
+        i += lhs_len;
+        j += rhs_len;
+    }
+    return 0;
+}
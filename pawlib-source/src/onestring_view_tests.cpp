@@ -0,0 +1,12 @@
+#include "pawlib/onestring_view_tests.hpp"
+
+void TestSuite_OnestringView::load_tests()
+{
+    register_test("P-tB4201", new TestOnestringView_Construct());
+    register_test("P-tB4202", new TestOnestringView_At());
+    register_test("P-tB4203", new TestOnestringView_Substr());
+    register_test("P-tB4204", new TestOnestringView_Find());
+    register_test("P-tB4205", new TestOnestringView_Compare());
+    register_test("P-tB4206", new TestOnestringView_Onestring());
+    register_test("P-tB4207", new TestOnestringView_Tokenize(), true, new TestOnestring_Tokenize());
+}
@@ -201,4 +201,501 @@ void TestSuite_Pawsort::load_tests()
         register_test("P-tB3066",
             new TestPawSortDPQS(TestSort::TestArrayType::ARRAY_NIGHTMARE), true,
             new TestPawSort(TestSort::TestArrayType::ARRAY_NIGHTMARE));
+
+    register_test("P-tB3071",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_SORTED), true);
+
+    register_test("P-tB3072",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_REVERSED), true);
+
+    register_test("P-tB3073",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_NEARLY_2), true);
+
+    register_test("P-tB3074",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_NEARLY_5), true);
+
+    register_test("P-tB3075",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_FEW_UNIQUE), true);
+
+    register_test("P-tB3076",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_BLACK_SHEEP), true);
+
+    register_test("P-tB3077",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_DOUBLE_CLIMB), true);
+
+    register_test("P-tB3078",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_DOUBLE_DROP), true);
+
+    register_test("P-tB3079",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_STAIRS), true);
+
+    register_test("P-tB3080",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_MOUNTAIN), true);
+
+    register_test("P-tB3081",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_DOUBLE_MOUNTAIN), true);
+
+    register_test("P-tB3082",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_EVEREST), true);
+
+    register_test("P-tB3083",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_CLIFF), true);
+
+    register_test("P-tB3084",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_SPIKE), true);
+
+    register_test("P-tB3085",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_CHICKEN), true);
+
+    register_test("P-tB3086",
+        new TestPawSortExternal(TestSort::TestArrayType::ARRAY_NIGHTMARE), true);
+
+    register_test("P-tB3091",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_SORTED), true);
+
+    register_test("P-tB3092",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_REVERSED), true);
+
+    register_test("P-tB3093",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_NEARLY_2), true);
+
+    register_test("P-tB3094",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_NEARLY_5), true);
+
+    register_test("P-tB3095",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_FEW_UNIQUE), true);
+
+    register_test("P-tB3096",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_BLACK_SHEEP), true);
+
+    register_test("P-tB3097",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_DOUBLE_CLIMB), true);
+
+    register_test("P-tB3098",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_DOUBLE_DROP), true);
+
+    register_test("P-tB3099",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_STAIRS), true);
+
+    register_test("P-tB3100",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_MOUNTAIN), true);
+
+    register_test("P-tB3101",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_DOUBLE_MOUNTAIN), true);
+
+    register_test("P-tB3102",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_EVEREST), true);
+
+    register_test("P-tB3103",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_CLIFF), true);
+
+    register_test("P-tB3104",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_SPIKE), true);
+
+    register_test("P-tB3105",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_CHICKEN), true);
+
+    register_test("P-tB3106",
+        new TestPawArgsort(TestSort::TestArrayType::ARRAY_NIGHTMARE), true);
+
+    register_test("P-tB3111",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_SORTED), true);
+
+    register_test("P-tB3112",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_REVERSED), true);
+
+    register_test("P-tB3113",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_NEARLY_2), true);
+
+    register_test("P-tB3114",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_NEARLY_5), true);
+
+    register_test("P-tB3115",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_FEW_UNIQUE), true);
+
+    register_test("P-tB3116",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_BLACK_SHEEP), true);
+
+    register_test("P-tB3117",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_DOUBLE_CLIMB), true);
+
+    register_test("P-tB3118",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_DOUBLE_DROP), true);
+
+    register_test("P-tB3119",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_STAIRS), true);
+
+    register_test("P-tB3120",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_MOUNTAIN), true);
+
+    register_test("P-tB3121",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_DOUBLE_MOUNTAIN), true);
+
+    register_test("P-tB3122",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_EVEREST), true);
+
+    register_test("P-tB3123",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_CLIFF), true);
+
+    register_test("P-tB3124",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_SPIKE), true);
+
+    register_test("P-tB3125",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_CHICKEN), true);
+
+    register_test("P-tB3126",
+        new TestPawSortByKey(TestSort::TestArrayType::ARRAY_NIGHTMARE), true);
+
+    register_test("P-tB3131",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_SORTED, false), true);
+
+    register_test("P-tB3132",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_REVERSED, false), true);
+
+    register_test("P-tB3133",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_NEARLY_2, false), true);
+
+    register_test("P-tB3134",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_NEARLY_5, false), true);
+
+    register_test("P-tB3135",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_FEW_UNIQUE, false), true);
+
+    register_test("P-tB3136",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_BLACK_SHEEP, false), true);
+
+    register_test("P-tB3137",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_DOUBLE_CLIMB, false), true);
+
+    register_test("P-tB3138",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_DOUBLE_DROP, false), true);
+
+    register_test("P-tB3139",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_STAIRS, false), true);
+
+    register_test("P-tB3140",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_MOUNTAIN, false), true);
+
+    register_test("P-tB3141",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_DOUBLE_MOUNTAIN, false), true);
+
+    register_test("P-tB3142",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_EVEREST, false), true);
+
+    register_test("P-tB3143",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_CLIFF, false), true);
+
+    register_test("P-tB3144",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_SPIKE, false), true);
+
+    register_test("P-tB3145",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_CHICKEN, false), true);
+
+    register_test("P-tB3146",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_NIGHTMARE, false), true);
+
+    register_test("P-tB3151",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_SORTED, true), true);
+
+    register_test("P-tB3152",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_REVERSED, true), true);
+
+    register_test("P-tB3153",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_NEARLY_2, true), true);
+
+    register_test("P-tB3154",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_NEARLY_5, true), true);
+
+    register_test("P-tB3155",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_FEW_UNIQUE, true), true);
+
+    register_test("P-tB3156",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_BLACK_SHEEP, true), true);
+
+    register_test("P-tB3157",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_DOUBLE_CLIMB, true), true);
+
+    register_test("P-tB3158",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_DOUBLE_DROP, true), true);
+
+    register_test("P-tB3159",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_STAIRS, true), true);
+
+    register_test("P-tB3160",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_MOUNTAIN, true), true);
+
+    register_test("P-tB3161",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_DOUBLE_MOUNTAIN, true), true);
+
+    register_test("P-tB3162",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_EVEREST, true), true);
+
+    register_test("P-tB3163",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_CLIFF, true), true);
+
+    register_test("P-tB3164",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_SPIKE, true), true);
+
+    register_test("P-tB3165",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_CHICKEN, true), true);
+
+    register_test("P-tB3166",
+        new TestPawMergeK(TestSort::TestArrayType::ARRAY_NIGHTMARE, true), true);
+
+    register_test("P-tB3171",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_SORTED,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_SORTED));
+
+    register_test("P-tB3172",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_REVERSED,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_REVERSED));
+
+    register_test("P-tB3173",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_NEARLY_2,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_NEARLY_2));
+
+    register_test("P-tB3174",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_NEARLY_5,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_NEARLY_5));
+
+    register_test("P-tB3175",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_FEW_UNIQUE,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_FEW_UNIQUE));
+
+    register_test("P-tB3176",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_BLACK_SHEEP,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_BLACK_SHEEP));
+
+    register_test("P-tB3177",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_DOUBLE_CLIMB,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_DOUBLE_CLIMB));
+
+    register_test("P-tB3178",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_DOUBLE_DROP,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_DOUBLE_DROP));
+
+    register_test("P-tB3179",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_STAIRS,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_STAIRS));
+
+    register_test("P-tB3180",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_MOUNTAIN,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_MOUNTAIN));
+
+    register_test("P-tB3181",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_DOUBLE_MOUNTAIN,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_DOUBLE_MOUNTAIN));
+
+    register_test("P-tB3182",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_EVEREST,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_EVEREST));
+
+    register_test("P-tB3183",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_CLIFF,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_CLIFF));
+
+    register_test("P-tB3184",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_SPIKE,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_SPIKE));
+
+    register_test("P-tB3185",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_CHICKEN,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_CHICKEN));
+
+    register_test("P-tB3186",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_NIGHTMARE,
+                              SortAlgorithm::PAWSORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_NIGHTMARE));
+
+    // The corpus benchmarks are very slow, so they only run when named.
+    register_test("P-tB3201",
+        new TestSortCorpus(5, "pawsort_corpus.csv",
+                           BenchmarkReport::Format::csv), false);
+
+    register_test("P-tB3202",
+        new TestSortCorpus(8, "pawsort_corpus.csv",
+                           BenchmarkReport::Format::csv), false);
+
+    register_test("P-tB3203",
+        new TestSortCorpus(8, "pawsort_corpus.json",
+                           BenchmarkReport::Format::json), false);
+
+    register_test("P-tB3211",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_SORTED,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_SORTED));
+
+    register_test("P-tB3212",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_REVERSED,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_REVERSED));
+
+    register_test("P-tB3213",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_NEARLY_2,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_NEARLY_2));
+
+    register_test("P-tB3214",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_NEARLY_5,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_NEARLY_5));
+
+    register_test("P-tB3215",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_FEW_UNIQUE,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_FEW_UNIQUE));
+
+    register_test("P-tB3216",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_BLACK_SHEEP,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_BLACK_SHEEP));
+
+    register_test("P-tB3217",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_DOUBLE_CLIMB,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_DOUBLE_CLIMB));
+
+    register_test("P-tB3218",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_DOUBLE_DROP,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_DOUBLE_DROP));
+
+    register_test("P-tB3219",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_STAIRS,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_STAIRS));
+
+    register_test("P-tB3220",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_MOUNTAIN,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_MOUNTAIN));
+
+    register_test("P-tB3221",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_DOUBLE_MOUNTAIN,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_DOUBLE_MOUNTAIN));
+
+    register_test("P-tB3222",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_EVEREST,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_EVEREST));
+
+    register_test("P-tB3223",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_CLIFF,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_CLIFF));
+
+    register_test("P-tB3224",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_SPIKE,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_SPIKE));
+
+    register_test("P-tB3225",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_CHICKEN,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_CHICKEN));
+
+    register_test("P-tB3226",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_NIGHTMARE,
+                              SortAlgorithm::THREE_WAY_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_NIGHTMARE));
+
+    register_test("P-tB3231",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_SORTED,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_SORTED));
+
+    register_test("P-tB3232",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_REVERSED,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_REVERSED));
+
+    register_test("P-tB3233",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_NEARLY_2,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_NEARLY_2));
+
+    register_test("P-tB3234",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_NEARLY_5,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_NEARLY_5));
+
+    register_test("P-tB3235",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_FEW_UNIQUE,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_FEW_UNIQUE));
+
+    register_test("P-tB3236",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_BLACK_SHEEP,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_BLACK_SHEEP));
+
+    register_test("P-tB3237",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_DOUBLE_CLIMB,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_DOUBLE_CLIMB));
+
+    register_test("P-tB3238",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_DOUBLE_DROP,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_DOUBLE_DROP));
+
+    register_test("P-tB3239",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_STAIRS,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_STAIRS));
+
+    register_test("P-tB3240",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_MOUNTAIN,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_MOUNTAIN));
+
+    register_test("P-tB3241",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_DOUBLE_MOUNTAIN,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_DOUBLE_MOUNTAIN));
+
+    register_test("P-tB3242",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_EVEREST,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_EVEREST));
+
+    register_test("P-tB3243",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_CLIFF,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_CLIFF));
+
+    register_test("P-tB3244",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_SPIKE,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_SPIKE));
+
+    register_test("P-tB3245",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_CHICKEN,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_CHICKEN));
+
+    register_test("P-tB3246",
+        new TestPawSortEngine(TestSort::TestArrayType::ARRAY_NIGHTMARE,
+                              SortAlgorithm::RADIX_SORT), true,
+        new TestStdSort(TestSort::TestArrayType::ARRAY_NIGHTMARE));
+
+    register_test("P-tB3251", new TestPawSortBool());
+    register_test("P-tB3252", new TestPawMergeKInserter());
+    register_test("P-tB3253", new TestPawSortExternalCleanup());
 }
@@ -1,5 +1,13 @@
 #include "pawlib/stdutils.hpp"
 
+#include <charconv>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PAWLIB_STDUTILS_X86
+#include <immintrin.h>
+#endif
+
 stdutils::stdutils()
 {
     //ctor
@@ -549,23 +557,267 @@ template void stdutils::ftoa<float>(char*, float, int, int);
 template void stdutils::ftoa<double>(char*, double, int, int);
 template void stdutils::ftoa<long double>(char*, long double, int, int);
 
+namespace
+{
+    // Every number from 00 to 99, for writing two digits at a time.
+    const char DIGIT_PAIRS[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    const char DIGITS_LOWER[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    const char DIGITS_UPPER[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+    /* Drops the trailing zeros after a decimal point, and the point
+     * too if nothing is left after it.
+     * Returns the new end. */
+    char* trim_zeros(char* first, char* last)
+    {
+        if(std::find(first, last, '.') == last){return last;}
+        while(last[-1] == '0'){--last;}
+        if(last[-1] == '.'){--last;}
+        return last;
+    }
+
+    /* Copies a scientific notation number from `std::to_chars`, trimming
+     * the mantissa and writing the exponent without leading zeros.
+     * Returns the new end. */
+    char* tidy_scientific(char* first, char* last)
+    {
+        char* e = std::find(first, last, 'e');
+        char* out = trim_zeros(first, e);
+        *(out++) = 'e';
+        *(out++) = e[1];
+        const char* exp = e + 2;
+        while(exp < last - 1 && *exp == '0'){++exp;}
+        // The exponent only ever moves left, so this can't overlap wrongly.
+        while(exp < last){*(out++) = *(exp++);}
+        return out;
+    }
+
+    /* Writes the digits of a scientific notation number, such as "-1.25"
+     * with an exponent of 2, in fixed notation, such as "-125".
+     * Returns the new end. */
+    char* place_point(char* out, const char* first, const char* last, int exp)
+    {
+        if(*first == '-'){*(out++) = *(first++);}
+
+        // Gather the digits without the point.
+        char digits[64];
+        size_t count = 0;
+        for(const char* c = first; c < last; ++c)
+        {
+            if(*c != '.'){digits[count++] = *c;}
+        }
+
+        if(exp < 0)
+        {
+            *(out++) = '0';
+            *(out++) = '.';
+            out = std::fill_n(out, -exp - 1, '0');
+            memcpy(out, digits, count);
+            return out + count;
+        }
+
+        size_t whole = static_cast<size_t>(exp) + 1;
+        if(whole >= count)
+        {
+            memcpy(out, digits, count);
+            return std::fill_n(out + count, whole - count, '0');
+        }
+        memcpy(out, digits, whole);
+        out += whole;
+        *(out++) = '.';
+        memcpy(out, digits + whole, count - whole);
+        return out + (count - whole);
+    }
+}
+
 template <typename T>
-std::string stdutils::itos(T val, int base, bool use_caps)
+int stdutils::write_int(char* str, T val, int base, bool use_caps)
 {
-    int len = intlen(val, base, true) + 1;
+    if(base < 2 || base > 36)
+    {
+        throw std::invalid_argument("stdutils::write_int: Invalid base. Must be between 2 and 36.");
+    }
 
-    //char cstr[len];
-    char* cstr = new char[len];
-    /* We have to initialize after the fact to keep Clang happy,
-        * but we must fill the array to avoid memory issues.
-        * Thus, we'll use the std::fill_n function to fill the array
-        * with null characters. */
-    std::fill_n(cstr, len, '\0');
+    typedef typename std::make_unsigned<T>::type U;
+    U mag = static_cast<U>(val);
+    char* pos = str;
+    if constexpr(std::is_signed<T>::value)
+    {
+        if(val < 0)
+        {
+            *(pos++) = '-';
+            // Negating the unsigned value works even for the lowest value.
+            mag = static_cast<U>(U(0) - mag);
+        }
+    }
 
-    itoa(cstr, val, base, len, use_caps);
-    std::string str = cstr;
-    delete[] cstr;
-    return str;
+    // Write the digits backwards from the end of a scratch buffer.
+    char digits[sizeof(U) * 8];
+    char* end = digits + sizeof(digits);
+    char* at = end;
+    if(base == 10)
+    {
+        while(mag >= 100)
+        {
+            at -= 2;
+            memcpy(at, DIGIT_PAIRS + (mag % 100) * 2, 2);
+            mag /= 100;
+        }
+        if(mag >= 10)
+        {
+            at -= 2;
+            memcpy(at, DIGIT_PAIRS + mag * 2, 2);
+        }
+        else
+        {
+            *(--at) = static_cast<char>('0' + mag);
+        }
+    }
+    else if((base & (base - 1)) == 0)
+    {
+        // Hex, octal, and binary are shifts and masks, rather than division.
+        const char* table = use_caps ? DIGITS_UPPER : DIGITS_LOWER;
+        int shift = __builtin_ctz(static_cast<unsigned int>(base));
+        U mask = static_cast<U>(base - 1);
+        do
+        {
+            *(--at) = table[mag & mask];
+            mag >>= shift;
+        }
+        while(mag);
+    }
+    else
+    {
+        const char* table = use_caps ? DIGITS_UPPER : DIGITS_LOWER;
+        do
+        {
+            *(--at) = table[mag % static_cast<U>(base)];
+            mag /= static_cast<U>(base);
+        }
+        while(mag);
+    }
+
+    memcpy(pos, at, static_cast<size_t>(end - at));
+    return static_cast<int>(pos - str + (end - at));
+}
+
+template int stdutils::write_int<char>(char*, char, int, bool);
+template int stdutils::write_int<unsigned char>(char*, unsigned char, int, bool);
+template int stdutils::write_int<int>(char*, int, int, bool);
+template int stdutils::write_int<unsigned int>(char*, unsigned int, int, bool);
+template int stdutils::write_int<short int>(char*, short int, int, bool);
+template int stdutils::write_int<unsigned short int>(char*, unsigned short int, int, bool);
+template int stdutils::write_int<long int>(char*, long int, int, bool);
+template int stdutils::write_int<unsigned long int>(char*, unsigned long int, int, bool);
+template int stdutils::write_int<long long int>(char*, long long int, int, bool);
+template int stdutils::write_int<unsigned long long int>(char*, unsigned long long int, int, bool);
+
+template <typename T>
+size_t stdutils::write_float(char* str, size_t size, T val, int significand, int sci)
+{
+    const char* special = nullptr;
+    if(isnan(val)){special = "NaN";}
+    else if(isinf(val)){special = (val < 0) ? "-Inf" : "Inf";}
+    else if(val == 0){special = "0";}
+    if(special)
+    {
+        size_t len = strlen(special);
+        if(len <= size){memcpy(str, special, len);}
+        return len;
+    }
+    if(significand < 0){significand = 0;}
+    bool neg = (val < 0);
+
+    /* The shortest digits that read back as the same number, which are
+     * seldom more than 20, and an exponent of at most five digits. */
+    char shortest[64];
+    char* last = std::to_chars(shortest, shortest + sizeof(shortest), val,
+                               std::chars_format::scientific).ptr;
+    char* e = std::find(shortest, last, 'e');
+    // The exponent is a sign and at least two digits, with no terminator.
+    int exp = 0;
+    std::from_chars(e + 2, last, exp);
+    if(e[1] == '-'){exp = -exp;}
+    // Every digit in the mantissa, less the one before the point.
+    int decimals = static_cast<int>(e - shortest) - (neg ? 1 : 0);
+    decimals = (decimals > 1) ? decimals - 2 : 0;
+
+    bool use_exp = ((sci == 1) && (exp >= 14 || (neg && exp >= 9) || exp <= -9))
+                   || (sci == 2);
+
+    size_t need;
+    if(use_exp)
+    {
+        // Sign, one digit, point, the decimals, and "e+" with the exponent.
+        need = (neg ? 1 : 0) + 2 + static_cast<size_t>(significand) + 2 + 5;
+    }
+    else
+    {
+        // Sign, the whole part, point, and the decimals.
+        need = (neg ? 1 : 0) + static_cast<size_t>(exp > 0 ? exp + 1 : 1)
+               + 1 + static_cast<size_t>(significand);
+    }
+
+    /* If the worst case might not fit, write to the side first, since
+     * the real length is usually far less. */
+    char spill[64];
+    char* out = (need <= size) ? str : spill;
+    size_t room = (need <= size) ? size : sizeof(spill);
+    if(need > size && need > sizeof(spill))
+    {
+        return need;
+    }
+
+    char* end;
+    if(use_exp)
+    {
+        if(decimals <= significand)
+        {
+            memcpy(out, shortest, static_cast<size_t>(last - shortest));
+            end = tidy_scientific(out, out + (last - shortest));
+        }
+        else
+        {
+            end = std::to_chars(out, out + room, val, std::chars_format::scientific,
+                                significand).ptr;
+            end = tidy_scientific(out, end);
+        }
+    }
+    else
+    {
+        // Shifting the point moves the exponent into the decimals.
+        if(decimals - exp <= significand)
+        {
+            end = place_point(out, shortest, e, exp);
+        }
+        else
+        {
+            end = std::to_chars(out, out + room, val, std::chars_format::fixed,
+                                significand).ptr;
+            end = trim_zeros(out, end);
+        }
+    }
+
+    size_t len = static_cast<size_t>(end - out);
+    if(out == spill && len <= size)
+    {
+        memcpy(str, spill, len);
+    }
+    return len;
+}
+
+template size_t stdutils::write_float<float>(char*, size_t, float, int, int);
+template size_t stdutils::write_float<double>(char*, size_t, double, int, int);
+template size_t stdutils::write_float<long double>(char*, size_t, long double, int, int);
+
+template <typename T>
+std::string stdutils::itos(T val, int base, bool use_caps)
+{
+    char cstr[INT_CHARS];
+    return std::string(cstr, write_int(cstr, val, base, use_caps));
 }
 template std::string stdutils::itos<char>(char, int, bool);
 template std::string stdutils::itos<unsigned char>(unsigned char, int, bool);
@@ -619,32 +871,308 @@ std::string stdutils::ptrtos(uintptr_t val, bool use_caps)
     return str;
 }
 
-void stdutils::memdump(char* str, const void* mem, unsigned int bytes, bool use_caps, char memformat)
+namespace
 {
-    bool bytespacing = memformat & (1 << 0);
-    bool wordspacing = memformat & (1 << 1);
-    char byte[3] = {'\0'};
-    const uint8_t* p = reinterpret_cast<const uint8_t*>(mem);
-    for (unsigned int i = 0; i < bytes; i++)
+    /// Every byte as two hex digits, lowercase and then uppercase.
+    struct HexPairs
     {
-        btoa(byte, p[i], 2, use_caps);
-        strcat(str, byte);
-        //If we use byte spacing and we're not on the last byte...
-        if(bytespacing && i != (bytes-1))
+        char lower[512];
+        char upper[512];
+
+        constexpr HexPairs() : lower(), upper()
         {
-            strcat(str, " ");
+            const char* lower_digits = "0123456789abcdef";
+            const char* upper_digits = "0123456789ABCDEF";
+            for(int i = 0; i < 256; ++i)
+            {
+                lower[i * 2] = lower_digits[i >> 4];
+                lower[i * 2 + 1] = lower_digits[i & 15];
+                upper[i * 2] = upper_digits[i >> 4];
+                upper[i * 2 + 1] = upper_digits[i & 15];
+            }
         }
+    };
+    constexpr HexPairs HEX_PAIRS;
 
-        //If we use word spacing and we're between words (and not on last byte).
-        if(wordspacing && (i+1)%8 == 0 && i != (bytes-1))
+    void write_hex_scalar(char* out, const uint8_t* in, size_t bytes, bool use_caps)
+    {
+        const char* pairs = use_caps ? HEX_PAIRS.upper : HEX_PAIRS.lower;
+        for(size_t i = 0; i < bytes; ++i)
+        {
+            memcpy(out + i * 2, pairs + in[i] * 2, 2);
+        }
+    }
+
+#ifdef PAWLIB_STDUTILS_X86
+    /* The vector kernels split each byte into its two nibbles, look both
+     * up as digits with one shuffle each, and interleave them back into
+     * memory order. */
+
+    /// \return the number of bytes written, a multiple of 16
+    __attribute__((target("ssse3")))
+    size_t write_hex_ssse3(char* out, const uint8_t* in, size_t bytes, bool use_caps)
+    {
+        const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+            use_caps ? "0123456789ABCDEF" : "0123456789abcdef"));
+        const __m128i nibble = _mm_set1_epi8(0x0F);
+        size_t i = 0;
+        for(; i + 16 <= bytes; i += 16)
         {
-            strcat(str, "|");
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+            __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(v, nibble));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2),
+                             _mm_unpacklo_epi8(high, low));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 16),
+                             _mm_unpackhi_epi8(high, low));
+        }
+        return i;
+    }
+
+    /// \return the number of bytes written, a multiple of 16
+    __attribute__((target("avx2")))
+    size_t write_hex_avx2(char* out, const uint8_t* in, size_t bytes, bool use_caps)
+    {
+        const __m256i digits = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                use_caps ? "0123456789ABCDEF" : "0123456789abcdef")));
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+        size_t i = 0;
+        for(; i + 32 <= bytes; i += 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            __m256i high = _mm256_shuffle_epi8(digits,
+                                               _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+            __m256i low = _mm256_shuffle_epi8(digits, _mm256_and_si256(v, nibble));
+            // Interleaving works within each half, so put the halves back in order.
+            __m256i first = _mm256_unpacklo_epi8(high, low);
+            __m256i second = _mm256_unpackhi_epi8(high, low);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2),
+                                _mm256_permute2x128_si256(first, second, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2 + 32),
+                                _mm256_permute2x128_si256(first, second, 0x31));
+        }
+        // AVX2 implies SSSE3, which can take another 16.
+        return i + write_hex_ssse3(out + i * 2, in + i, bytes - i, use_caps);
+    }
+
+    /// \return 2 for AVX2, 1 for SSSE3, or 0 for neither
+    int simd_level()
+    {
+        static const int level = []()
+        {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) { return 2; }
+            if (__builtin_cpu_supports("ssse3")) { return 1; }
+            return 0;
+        }();
+        return level;
+    }
+#endif // PAWLIB_STDUTILS_X86
+}
+
+void stdutils::write_hex(char* str, const void* mem, size_t bytes, bool use_caps)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(mem);
+    size_t done = 0;
+#ifdef PAWLIB_STDUTILS_X86
+    if(bytes >= 16)
+    {
+        switch(simd_level())
+        {
+            case 2: done = write_hex_avx2(str, p, bytes, use_caps); break;
+            case 1: done = write_hex_ssse3(str, p, bytes, use_caps); break;
+            default: break;
+        }
+    }
+#endif
+    write_hex_scalar(str + done * 2, p + done, bytes - done, use_caps);
+}
+
+size_t stdutils::memdump_length(size_t bytes, char memformat, bool last)
+{
+    if(bytes == 0){return 0;}
+    bool bytespacing = memformat & (1 << 0);
+    bool wordspacing = memformat & (1 << 1);
+    // The places a separator can go; there's none after the last byte.
+    size_t gaps = last ? bytes - 1 : bytes;
+    size_t len = bytes * 2;
+    if(bytespacing)
+    {
+        len += gaps;
+    }
+    if(wordspacing)
+    {
+        // A bar, and a space after it when spacing bytes, between words.
+        size_t words = last ? (bytes - 1) / 8 : bytes / 8;
+        len += words * (bytespacing ? 2 : 1);
+    }
+    return len;
+}
+
+size_t stdutils::write_memdump(char* str, const void* mem, size_t bytes, bool use_caps,
+                               char memformat, bool last)
+{
+    bool bytespacing = memformat & (1 << 0);
+    bool wordspacing = memformat & (1 << 1);
+    if(!bytespacing && !wordspacing)
+    {
+        write_hex(str, mem, bytes, use_caps);
+        return bytes * 2;
+    }
+
+    // Convert a block at a time, then spread it out between the separators.
+    const size_t BLOCK = 512;
+    char hex[BLOCK * 2];
+    const uint8_t* p = static_cast<const uint8_t*>(mem);
+    char* out = str;
+    for(size_t from = 0; from < bytes; from += BLOCK)
+    {
+        size_t n = std::min(BLOCK, bytes - from);
+        write_hex(hex, p + from, n, use_caps);
+        for(size_t i = 0; i < n; ++i)
+        {
+            memcpy(out, hex + i * 2, 2);
+            out += 2;
+
+            size_t index = from + i;
+            if(last && index == bytes - 1){break;}
             if(bytespacing)
             {
-                strcat(str, " ");
+                *(out++) = ' ';
             }
+            if(wordspacing && (index + 1) % 8 == 0)
+            {
+                *(out++) = '|';
+                if(bytespacing)
+                {
+                    *(out++) = ' ';
+                }
+            }
+        }
+    }
+    return static_cast<size_t>(out - str);
+}
+
+void stdutils::memdump(char* str, const void* mem, unsigned int bytes, bool use_caps, char memformat)
+{
+    str += strlen(str);
+    str[write_memdump(str, mem, bytes, use_caps, memformat)] = '\0';
+}
+
+namespace
+{
+    /* The constants and structure are those of wyhash by Wang Yi,
+     * released into the public domain. */
+    const uint64_t WYP[4] = {0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+                             0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull};
+
+    /// Multiplies two 64-bit values into their 128-bit product, in place.
+    inline void wymum(uint64_t& a, uint64_t& b)
+    {
+#if defined(__SIZEOF_INT128__)
+        __extension__ typedef unsigned __int128 uint128_t;
+        uint128_t r = static_cast<uint128_t>(a) * b;
+        a = static_cast<uint64_t>(r);
+        b = static_cast<uint64_t>(r >> 64);
+#else
+        uint64_t ha = a >> 32, hb = b >> 32, la = a & 0xFFFFFFFF, lb = b & 0xFFFFFFFF;
+        uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+        uint64_t t = rl + (rm0 << 32);
+        uint64_t c = (t < rl);
+        uint64_t lo = t + (rm1 << 32);
+        c += (lo < t);
+        b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+        a = lo;
+#endif
+    }
+
+    inline uint64_t wymix(uint64_t a, uint64_t b)
+    {
+        wymum(a, b);
+        return a ^ b;
+    }
+
+    inline uint64_t wyr8(const uint8_t* p)
+    {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        return v;
+    }
+
+    inline uint64_t wyr4(const uint8_t* p)
+    {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        return v;
+    }
+
+    /// Reads one to three bytes, taking the first, middle, and last.
+    inline uint64_t wyr3(const uint8_t* p, size_t k)
+    {
+        return (static_cast<uint64_t>(p[0]) << 16)
+             | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+    }
+}
+
+uint64_t stdutils::hash(const void* data, size_t bytes, uint64_t seed)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    seed ^= wymix(seed ^ WYP[0], WYP[1]);
+    uint64_t a;
+    uint64_t b;
+
+    // Short keys, which most strings are, are read in at most four loads.
+    if (bytes <= 16)
+    {
+        if (bytes >= 4)
+        {
+            size_t mid = (bytes >> 3) << 2;
+            a = (wyr4(p) << 32) | wyr4(p + mid);
+            b = (wyr4(p + bytes - 4) << 32) | wyr4(p + bytes - 4 - mid);
+        }
+        else if (bytes > 0)
+        {
+            a = wyr3(p, bytes);
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        // Longer keys are mixed 48 bytes at a time, in three lanes.
+        size_t i = bytes;
+        if (i > 48)
+        {
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+            do
+            {
+                seed = wymix(wyr8(p) ^ WYP[1], wyr8(p + 8) ^ seed);
+                see1 = wymix(wyr8(p + 16) ^ WYP[2], wyr8(p + 24) ^ see1);
+                see2 = wymix(wyr8(p + 32) ^ WYP[3], wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
         }
+        while (i > 16)
+        {
+            seed = wymix(wyr8(p) ^ WYP[1], wyr8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = wyr8(p + i - 16);
+        b = wyr8(p + i - 8);
     }
+
+    a ^= WYP[1];
+    b ^= seed;
+    wymum(a, b);
+    return wymix(a ^ WYP[0] ^ bytes, b ^ WYP[1]);
 }
 
 stdutils::~stdutils()
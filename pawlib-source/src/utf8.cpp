@@ -0,0 +1,606 @@
+#include "pawlib/utf8.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PAWLIB_UTF8_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    const char32_t REPLACEMENT = 0xFFFD;
+
+    /** Scalar validation, which also finishes off what the vector
+     * kernels leave over. Whole words of ASCII are skipped at once.
+     * \return the number of characters, or utf8::npos if invalid */
+    size_t count_if_valid_scalar(const unsigned char* str, size_t bytes)
+    {
+        const uint64_t HIGH_BITS = 0x8080808080808080ULL;
+        size_t count = 0;
+        size_t i = 0;
+        while (i < bytes)
+        {
+            if (bytes - i >= 8)
+            {
+                uint64_t word;
+                memcpy(&word, str + i, 8);
+                if ((word & HIGH_BITS) == 0)
+                {
+                    i += 8;
+                    count += 8;
+                    continue;
+                }
+            }
+
+            unsigned char c = str[i];
+            if (c < 0x80)
+            {
+                ++i;
+                ++count;
+                continue;
+            }
+
+            size_t len;
+            if (c >= 0xC2 && c <= 0xDF) { len = 2; }
+            else if (c >= 0xE0 && c <= 0xEF) { len = 3; }
+            else if (c >= 0xF0 && c <= 0xF4) { len = 4; }
+            else { return utf8::npos; }
+
+            if (bytes - i < len) { return utf8::npos; }
+
+            // The second byte has the tightest bounds.
+            unsigned char c1 = str[i + 1];
+            unsigned char low = 0x80;
+            unsigned char high = 0xBF;
+            if (c == 0xE0) { low = 0xA0; }
+            else if (c == 0xED) { high = 0x9F; }
+            else if (c == 0xF0) { low = 0x90; }
+            else if (c == 0xF4) { high = 0x8F; }
+            if (c1 < low || c1 > high) { return utf8::npos; }
+
+            for (size_t k = 2; k < len; ++k)
+            {
+                if ((str[i + k] & 0xC0) != 0x80) { return utf8::npos; }
+            }
+
+            i += len;
+            ++count;
+        }
+        return count;
+    }
+
+#ifdef PAWLIB_UTF8_X86
+    /* The vector kernels use the lookup-table validator of Keiser and
+     * Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte"
+     * (2021). Each byte is classified by the high and low nibbles of the
+     * byte before it and the high nibble of itself; the three lookups
+     * only share a bit where that pair of bytes is an error. */
+    const uint8_t TOO_SHORT = 1 << 0;
+    const uint8_t TOO_LONG = 1 << 1;
+    const uint8_t OVERLONG_3 = 1 << 2;
+    const uint8_t TOO_LARGE = 1 << 3;
+    const uint8_t SURROGATE = 1 << 4;
+    const uint8_t OVERLONG_2 = 1 << 5;
+    const uint8_t TOO_LARGE_1000 = 1 << 6;
+    const uint8_t OVERLONG_4 = 1 << 6;
+    const uint8_t TWO_CONTS = 1 << 7;
+    const uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+    alignas(16) const uint8_t BYTE_1_HIGH[16] = {
+        // 0_______: ASCII, so it can't be followed by a continuation.
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        // 10______: a continuation
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        // 1100____, 1101____: two-byte leads
+        TOO_SHORT | OVERLONG_2,
+        TOO_SHORT,
+        // 1110____: three-byte leads
+        TOO_SHORT | OVERLONG_3 | SURROGATE,
+        // 1111____: four-byte leads
+        TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+    };
+
+    alignas(16) const uint8_t BYTE_1_LOW[16] = {
+        CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+        CARRY | OVERLONG_2,
+        CARRY,
+        CARRY,
+        CARRY | TOO_LARGE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000
+    };
+
+    alignas(16) const uint8_t BYTE_2_HIGH[16] = {
+        // 0_______: a lead byte can't be followed by ASCII.
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        // 1000____, 1001____, 101_____: continuations
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        // 11______: nor by another lead byte.
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+    };
+
+    /** The largest byte that can end a block at each position without
+     * leaving a character unfinished. */
+    alignas(32) const uint8_t INCOMPLETE_32[32] = {
+        255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+    };
+
+    /// The state carried from one 16-byte block to the next.
+    struct BlockState16
+    {
+        __m128i error;
+        __m128i prev_input;
+        __m128i prev_incomplete;
+    };
+
+    /// The state carried from one 32-byte block to the next.
+    struct BlockState32
+    {
+        __m256i error;
+        __m256i prev_input;
+        __m256i prev_incomplete;
+    };
+
+    __attribute__((target("ssse3")))
+    inline void check_block_ssse3(BlockState16& state, __m128i input)
+    {
+        const __m128i nibble = _mm_set1_epi8(0x0F);
+
+        // Pure ASCII can only be an error if it ends a character early.
+        if (_mm_movemask_epi8(input) == 0)
+        {
+            state.error = _mm_or_si128(state.error, state.prev_incomplete);
+            state.prev_incomplete = _mm_setzero_si128();
+            state.prev_input = input;
+            return;
+        }
+
+        __m128i prev1 = _mm_alignr_epi8(input, state.prev_input, 15);
+        __m128i byte_1_high = _mm_shuffle_epi8(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_HIGH)),
+            _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+        __m128i byte_1_low = _mm_shuffle_epi8(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_LOW)),
+            _mm_and_si128(prev1, nibble));
+        __m128i byte_2_high = _mm_shuffle_epi8(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_2_HIGH)),
+            _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+        __m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low),
+                                        byte_2_high);
+
+        // The third and fourth bytes of a character must be continuations.
+        __m128i prev2 = _mm_alignr_epi8(input, state.prev_input, 14);
+        __m128i prev3 = _mm_alignr_epi8(input, state.prev_input, 13);
+        __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80));
+        __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80));
+        __m128i must_continue = _mm_and_si128(_mm_or_si128(third, fourth),
+                                              _mm_set1_epi8(char(0x80)));
+
+        state.error = _mm_or_si128(state.error,
+                                   _mm_xor_si128(must_continue, special));
+        state.prev_incomplete = _mm_subs_epu8(input,
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(INCOMPLETE_32 + 16)));
+        state.prev_input = input;
+    }
+
+    __attribute__((target("ssse3")))
+    size_t count_if_valid_ssse3(const char* str, size_t bytes)
+    {
+        BlockState16 state = {_mm_setzero_si128(),
+                                         _mm_setzero_si128(),
+                                         _mm_setzero_si128()};
+        // Every byte but a continuation starts a character.
+        const __m128i last_continuation = _mm_set1_epi8(char(0xBF));
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 16 <= bytes; i += 16)
+        {
+            __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+            check_block_ssse3(state, input);
+            count += __builtin_popcount(_mm_movemask_epi8(
+                _mm_cmpgt_epi8(input, last_continuation)));
+        }
+
+        // Pad the rest with ASCII nulls, which aren't counted.
+        if (i < bytes)
+        {
+            alignas(16) char tail[16] = {0};
+            memcpy(tail, str + i, bytes - i);
+            __m128i input = _mm_load_si128(reinterpret_cast<const __m128i*>(tail));
+            check_block_ssse3(state, input);
+            int mask = (1 << (bytes - i)) - 1;
+            count += __builtin_popcount(mask & _mm_movemask_epi8(
+                _mm_cmpgt_epi8(input, last_continuation)));
+        }
+
+        __m128i error = _mm_or_si128(state.error, state.prev_incomplete);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xFFFF)
+        {
+            return utf8::npos;
+        }
+        return count;
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i prev_avx2(__m256i input, __m256i prev_input, const int n)
+    {
+        // n is always a constant once inlined.
+        __m256i across = _mm256_permute2x128_si256(prev_input, input, 0x21);
+        switch (n)
+        {
+            case 1: return _mm256_alignr_epi8(input, across, 15);
+            case 2: return _mm256_alignr_epi8(input, across, 14);
+            default: return _mm256_alignr_epi8(input, across, 13);
+        }
+    }
+
+    __attribute__((target("avx2")))
+    inline void check_block_avx2(BlockState32& state, __m256i input)
+    {
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+        // Pure ASCII can only be an error if it ends a character early.
+        if (_mm256_movemask_epi8(input) == 0)
+        {
+            state.error = _mm256_or_si256(state.error, state.prev_incomplete);
+            state.prev_incomplete = _mm256_setzero_si256();
+            state.prev_input = input;
+            return;
+        }
+
+        __m256i prev1 = prev_avx2(input, state.prev_input, 1);
+        __m256i byte_1_high = _mm256_shuffle_epi8(
+            _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_HIGH))),
+            _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+        __m256i byte_1_low = _mm256_shuffle_epi8(
+            _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_LOW))),
+            _mm256_and_si256(prev1, nibble));
+        __m256i byte_2_high = _mm256_shuffle_epi8(
+            _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_2_HIGH))),
+            _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+        __m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low),
+                                           byte_2_high);
+
+        // The third and fourth bytes of a character must be continuations.
+        __m256i prev2 = prev_avx2(input, state.prev_input, 2);
+        __m256i prev3 = prev_avx2(input, state.prev_input, 3);
+        __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80));
+        __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xF0 - 0x80));
+        __m256i must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth),
+                                                 _mm256_set1_epi8(char(0x80)));
+
+        state.error = _mm256_or_si256(state.error,
+                                      _mm256_xor_si256(must_continue, special));
+        state.prev_incomplete = _mm256_subs_epu8(input,
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(INCOMPLETE_32)));
+        state.prev_input = input;
+    }
+
+    __attribute__((target("avx2")))
+    size_t count_if_valid_avx2(const char* str, size_t bytes)
+    {
+        BlockState32 state = {_mm256_setzero_si256(),
+                                         _mm256_setzero_si256(),
+                                         _mm256_setzero_si256()};
+        // Every byte but a continuation starts a character.
+        const __m256i last_continuation = _mm256_set1_epi8(char(0xBF));
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 32 <= bytes; i += 32)
+        {
+            __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + i));
+            check_block_avx2(state, input);
+            count += __builtin_popcount(static_cast<unsigned int>(
+                _mm256_movemask_epi8(_mm256_cmpgt_epi8(input, last_continuation))));
+        }
+
+        // Pad the rest with ASCII nulls, which aren't counted.
+        if (i < bytes)
+        {
+            alignas(32) char tail[32] = {0};
+            memcpy(tail, str + i, bytes - i);
+            __m256i input = _mm256_load_si256(reinterpret_cast<const __m256i*>(tail));
+            check_block_avx2(state, input);
+            unsigned int mask = (1u << (bytes - i)) - 1;
+            count += __builtin_popcount(mask & static_cast<unsigned int>(
+                _mm256_movemask_epi8(_mm256_cmpgt_epi8(input, last_continuation))));
+        }
+
+        __m256i error = _mm256_or_si256(state.error, state.prev_incomplete);
+        if (!_mm256_testz_si256(error, error))
+        {
+            return utf8::npos;
+        }
+        return count;
+    }
+
+    /// \return 2 for AVX2, 1 for SSSE3, or 0 for neither
+    int simd_level()
+    {
+        static const int level = []()
+        {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) { return 2; }
+            if (__builtin_cpu_supports("ssse3")) { return 1; }
+            return 0;
+        }();
+        return level;
+    }
+#endif // PAWLIB_UTF8_X86
+}
+
+size_t utf8::count_if_valid(const char* str, size_t bytes)
+{
+#ifdef PAWLIB_UTF8_X86
+    // Below a block, the setup costs more than it saves.
+    if (bytes >= 16)
+    {
+        switch (simd_level())
+        {
+            case 2: return count_if_valid_avx2(str, bytes);
+            case 1: return count_if_valid_ssse3(str, bytes);
+            default: break;
+        }
+    }
+#endif
+    return count_if_valid_scalar(reinterpret_cast<const unsigned char*>(str), bytes);
+}
+
+size_t utf8::count(const char* str, size_t bytes)
+{
+    size_t count = count_if_valid(str, bytes);
+    if (count != npos)
+    {
+        return count;
+    }
+
+    // Malformed text has to be walked the way onechar reads it.
+    count = 0;
+    size_t index = 0;
+    while (index < bytes)
+    {
+        index += char_length(str + index, bytes - index);
+        ++count;
+    }
+    return count;
+}
+
+size_t utf8::advance(const char* str, size_t bytes, size_t n)
+{
+    /* Valid UTF-8 never carries a character past the end of a chunk that
+     * validates, so a whole chunk can be skipped by its count. */
+    const size_t CHUNK = 64;
+
+    size_t from = 0;
+    while (n > 0 && bytes - from >= CHUNK)
+    {
+        size_t count = count_if_valid(str + from, CHUNK);
+        if (count == npos)
+        {
+            // Walk through a malformed chunk the slow way.
+            size_t end = from + CHUNK;
+            while (n > 0 && from < end)
+            {
+                from += char_length(str + from, bytes - from);
+                --n;
+            }
+            continue;
+        }
+        if (count > n) { break; }
+
+        from += CHUNK;
+        n -= count;
+    }
+
+    while (n-- > 0 && from < bytes)
+    {
+        from += char_length(str + from, bytes - from);
+    }
+    return from;
+}
+
+char32_t utf8::decode(const char* str, size_t len)
+{
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(str);
+    unsigned char c = s[0];
+    if (c < 0x80) { return c; }
+
+    // A character cut short, or a stray continuation or bad lead byte.
+    if (len != onechar::evaluateLength(str) || len == 1 || c >= 0xF8)
+    {
+        return REPLACEMENT;
+    }
+
+    char32_t cp = c & (0x7F >> len);
+    for (size_t k = 1; k < len; ++k)
+    {
+        if ((s[k] & 0xC0) != 0x80) { return REPLACEMENT; }
+        cp = (cp << 6) | (s[k] & 0x3F);
+    }
+
+    // Reject overlong encodings, surrogates, and anything past Unicode.
+    const char32_t smallest[5] = {0, 0, 0x80, 0x800, 0x10000};
+    if (cp < smallest[len] || (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF)
+    {
+        return REPLACEMENT;
+    }
+    return cp;
+}
+
+void utf8::encode(char32_t cp, std::string& out)
+{
+    if ((cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF)
+    {
+        cp = REPLACEMENT;
+    }
+
+    if (cp < 0x80)
+    {
+        out.push_back(static_cast<char>(cp));
+    }
+    else if (cp < 0x800)
+    {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+    else if (cp < 0x10000)
+    {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+std::u16string utf8::to_utf16(const char* str, size_t bytes)
+{
+    // No character takes more UTF-16 code units than it has bytes.
+    std::u16string out(bytes, u'\0');
+    size_t units = 0;
+    size_t i = 0;
+    while (i < bytes)
+    {
+#ifdef __SSE2__
+        // Widen runs of ASCII sixteen bytes at a time.
+        if (bytes - i >= 16)
+        {
+            __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+            if (_mm_movemask_epi8(input) == 0)
+            {
+                __m128i zero = _mm_setzero_si128();
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[units]),
+                                 _mm_unpacklo_epi8(input, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[units + 8]),
+                                 _mm_unpackhi_epi8(input, zero));
+                i += 16;
+                units += 16;
+                continue;
+            }
+        }
+#endif
+        size_t len = char_length(str + i, bytes - i);
+        char32_t cp = decode(str + i, len);
+        if (cp >= 0x10000)
+        {
+            cp -= 0x10000;
+            out[units++] = static_cast<char16_t>(0xD800 | (cp >> 10));
+            out[units++] = static_cast<char16_t>(0xDC00 | (cp & 0x3FF));
+        }
+        else
+        {
+            out[units++] = static_cast<char16_t>(cp);
+        }
+        i += len;
+    }
+    out.resize(units);
+    return out;
+}
+
+std::u32string utf8::to_utf32(const char* str, size_t bytes)
+{
+    // No character takes more than one code point.
+    std::u32string out(bytes, U'\0');
+    size_t units = 0;
+    size_t i = 0;
+    while (i < bytes)
+    {
+#ifdef __SSE2__
+        // Widen runs of ASCII sixteen bytes at a time.
+        if (bytes - i >= 16)
+        {
+            __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+            if (_mm_movemask_epi8(input) == 0)
+            {
+                __m128i zero = _mm_setzero_si128();
+                __m128i low = _mm_unpacklo_epi8(input, zero);
+                __m128i high = _mm_unpackhi_epi8(input, zero);
+                __m128i* to = reinterpret_cast<__m128i*>(&out[units]);
+                _mm_storeu_si128(to, _mm_unpacklo_epi16(low, zero));
+                _mm_storeu_si128(to + 1, _mm_unpackhi_epi16(low, zero));
+                _mm_storeu_si128(to + 2, _mm_unpacklo_epi16(high, zero));
+                _mm_storeu_si128(to + 3, _mm_unpackhi_epi16(high, zero));
+                i += 16;
+                units += 16;
+                continue;
+            }
+        }
+#endif
+        size_t len = char_length(str + i, bytes - i);
+        out[units++] = decode(str + i, len);
+        i += len;
+    }
+    out.resize(units);
+    return out;
+}
+
+std::string utf8::from_utf16(const char16_t* str, size_t units)
+{
+    std::string out;
+    out.reserve(units);
+    size_t i = 0;
+    while (i < units)
+    {
+#ifdef __SSE2__
+        // Narrow runs of ASCII eight code units at a time.
+        if (units - i >= 8)
+        {
+            __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+            __m128i high = _mm_and_si128(input, _mm_set1_epi16(short(0xFF80)));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) == 0xFFFF)
+            {
+                char narrow[16];
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(narrow),
+                                 _mm_packus_epi16(input, input));
+                out.append(narrow, 8);
+                i += 8;
+                continue;
+            }
+        }
+#endif
+        char32_t cp = str[i++];
+        if (cp >= 0xD800 && cp <= 0xDBFF && i < units
+            && str[i] >= 0xDC00 && str[i] <= 0xDFFF)
+        {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (str[i++] - 0xDC00);
+        }
+        // An unpaired surrogate is left for encode() to replace.
+        encode(cp, out);
+    }
+    return out;
+}
+
+std::string utf8::from_utf32(const char32_t* str, size_t units)
+{
+    std::string out;
+    out.reserve(units);
+    for (size_t i = 0; i < units; ++i)
+    {
+        encode(str[i], out);
+    }
+    return out;
+}
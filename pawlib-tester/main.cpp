@@ -50,9 +50,13 @@
 #include "pawlib/flex_bit_tests.hpp"
 #include "pawlib/flex_queue_tests.hpp"
 #include "pawlib/flex_stack_tests.hpp"
-//#include "pawlib/pawsort_tests.hpp"
+#include "pawlib/iochannel_tests.hpp"
+#include "pawlib/pawsort_tests.hpp"
 #include "pawlib/onestring_tests.hpp"
 #include "pawlib/onechar_tests.hpp"
+#include "pawlib/onestring_view_tests.hpp"
+#include "pawlib/onerope_tests.hpp"
+#include "pawlib/oneatom_tests.hpp"
 #include "pawlib/pool_tests.hpp"
 
 /** Temporary test code goes in this function ONLY.
@@ -81,9 +85,13 @@ int main(int argc, char* argv[])
     shell->register_suite<TestSuite_FlexStack>("P-sB13");
     shell->register_suite<TestSuite_FlexBit>("P-sB15");
     shell->register_suite<TestSuite_Pool>("P-sB16");
-    //shell->register_suite<TestSuite_Pawsort>("P-sB30");
+    shell->register_suite<TestSuite_IOChannel>("P-sB20");
+    shell->register_suite<TestSuite_Pawsort>("P-sB30");
     shell->register_suite<TestSuite_Onestring>("P-sB40");
     shell->register_suite<TestSuite_Onechar>("P-sB41");
+    shell->register_suite<TestSuite_OnestringView>("P-sB42");
+    shell->register_suite<TestSuite_Onerope>("P-sB43");
+    shell->register_suite<TestSuite_Oneatom>("P-sB44");
 
     // If we got command-line arguments.
     if(argc > 1)